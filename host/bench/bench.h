@@ -0,0 +1,74 @@
+//
+// bench.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Timing for the host benchmarks: TSC cycles on x86, nanoseconds elsewhere
+//
+#ifndef _bench_h
+#define _bench_h
+
+#include <stdint.h>
+#include <algorithm>
+
+#include <chrono>
+
+static inline uint64_t BenchNanoseconds (void)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds> (
+		std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
+
+#if defined (__x86_64__) || defined (__i386__)
+	#include <x86intrin.h>
+
+	#define BENCH_UNIT	"cycles"
+
+	static inline uint64_t BenchTime (void)
+	{
+		return __rdtsc ();
+	}
+#else
+	#define BENCH_UNIT	"ns"
+
+	static inline uint64_t BenchTime (void)
+	{
+		return BenchNanoseconds ();
+	}
+#endif
+
+// Runs Function nRuns times and returns the shortest time of one run, which
+// is the least disturbed by interrupts and other processes on the host.
+template <typename TFunction>
+static uint64_t BenchBest (unsigned nRuns, TFunction Function,
+			   uint64_t (*pClock) (void) = BenchTime)
+{
+	uint64_t nBest = UINT64_MAX;
+
+	Function ();			// warm up the caches
+
+	for (unsigned i = 0; i < nRuns; i++)
+	{
+		uint64_t nStart = (*pClock) ();
+		Function ();
+		nBest = std::min (nBest, (*pClock) () - nStart);
+	}
+
+	return nBest;
+}
+
+#endif
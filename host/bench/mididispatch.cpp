@@ -0,0 +1,150 @@
+//
+// mididispatch.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Benchmark of the MIDI input dispatch (CMIDIDevice::MIDIMessageHandler()):
+// messages per second for random notes, controllers and pitch bends on all
+// channels, with the TGs on channels, which are not used, on one channel each
+// and all in OMNI mode. The messages are received in interrupt context, as
+// from a serial or USB device, and include the check for channel changes of
+// CHostMIDIDevice. The TG commands are applied by rendering a chunk after
+// each batch, which is not measured.
+//
+#include "bench.h"
+#include <test/testsdcard.h>
+#include <hostsystem.h>
+#include <circle/synchronize.h>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BATCH		32		// messages between two chunks
+#define BATCHES		500
+
+struct TMessage
+{
+	u8	Data[3];
+	size_t	nLength;
+};
+
+static std::vector<TMessage> RandomMessages (unsigned nCount)
+{
+	std::vector<TMessage> Messages (nCount);
+	for (TMessage &rMessage : Messages)
+	{
+		u8 ucChannel = rand () % 16;
+		u8 ucNote = 36 + rand () % 48;
+
+		rMessage.nLength = 3;
+		switch (rand () % 10)
+		{
+		case 0: case 1: case 2: case 3:
+			rMessage.Data[0] = 0x90 | ucChannel;
+			rMessage.Data[1] = ucNote;
+			rMessage.Data[2] = 1 + rand () % 127;
+			break;
+
+		case 4: case 5: case 6: case 7:
+			rMessage.Data[0] = 0x80 | ucChannel;
+			rMessage.Data[1] = ucNote;
+			rMessage.Data[2] = 64;
+			break;
+
+		case 8:
+			rMessage.Data[0] = 0xB0 | ucChannel;
+			rMessage.Data[1] = 1;			// modulation wheel
+			rMessage.Data[2] = rand () % 128;
+			break;
+
+		default:
+			rMessage.Data[0] = 0xE0 | ucChannel;
+			rMessage.Data[1] = rand () % 128;
+			rMessage.Data[2] = rand () % 128;
+			break;
+		}
+	}
+
+	return Messages;
+}
+
+// returns the messages per second of the fastest batch
+static double Measure (CHostSystem *pSystem, const std::vector<TMessage> &rMessages)
+{
+	CHostMIDIDevice *pMIDIDevice = pSystem->GetMIDIDevice ();
+	std::vector<s32> Buffer (pSystem->GetChunkFrames () * 2);
+
+	uint64_t nBest = UINT64_MAX;
+	for (unsigned nBatch = 0; nBatch < BATCHES; nBatch++)
+	{
+		const TMessage *pMessage = &rMessages[nBatch * BATCH];
+		unsigned nTimestamp = pSystem->GetClockTicks ();
+
+		HostSetExecutionLevel (IRQ_LEVEL);
+
+		uint64_t nStart = BenchNanoseconds ();
+		for (unsigned i = 0; i < BATCH; i++)
+		{
+			pMIDIDevice->Receive (pMessage[i].Data, pMessage[i].nLength, nTimestamp);
+		}
+		nBest = std::min (nBest, BenchNanoseconds () - nStart);
+
+		HostSetExecutionLevel (TASK_LEVEL);
+
+		pSystem->Tick (Buffer.data ());
+	}
+
+	return BATCH * 1e9 / nBest;
+}
+
+int main (void)
+{
+	std::string SDCard = CreateTestSDCard ();
+
+	CHostSystem System (SDCard.c_str ());
+	if (!System.Initialize ())
+	{
+		return 1;
+	}
+
+	CMiniDexed *pMiniDexed = System.GetMiniDexed ();
+	unsigned nTGs = System.GetConfig ()->GetToneGenerators ();
+
+	srand (1);
+	std::vector<TMessage> Messages = RandomMessages (BATCH * BATCHES);
+
+	printf ("MIDI messages per second (%u TGs, %u messages per chunk)\n", nTGs, BATCH);
+
+	static const char *Layouts[] = {"no TG receives", "one TG per channel", "all TGs OMNI"};
+	for (unsigned nLayout = 0; nLayout < 3; nLayout++)
+	{
+		for (unsigned nTG = 0; nTG < nTGs; nTG++)
+		{
+			unsigned nChannel = nLayout == 0 ? CMIDIDevice::Disabled
+					  : nLayout == 1 ? nTG % CMIDIDevice::Channels
+					  : CMIDIDevice::OmniMode;
+
+			pMiniDexed->SetMIDIChannel (nChannel, nTG);
+		}
+
+		printf ("%-20s %8.2f M\n", Layouts[nLayout], Measure (&System, Messages) / 1e6);
+	}
+
+	RemoveTestSDCard (SDCard);
+
+	return 0;
+}
@@ -0,0 +1,126 @@
+//
+// mixer.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Benchmark of the TG mixing in ProcessSound(): the fused doAddMix() for the
+// dry and the reverb send buses against two mixers with one doAddMix() call
+// per TG each, as before. Prints the time per frame for several chunk sizes
+// and checks, that both produce the same output.
+//
+#include "bench.h"
+#include <arm_math.h>
+#include <common.h>
+#include <effect_mixer.hpp>
+#include <reference/effect_mixer_ref.hpp>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define TGS	8
+
+static const unsigned ChunkSizes[] = {64, 128, 256, 512, 1024};
+
+static const unsigned Runs = 2000;
+
+int main (void)
+{
+	bool bOK = true;
+
+	printf ("%d TGs, " BENCH_UNIT " per frame\n", TGS);
+	printf ("chunk    two mixers   fused   speedup\n");
+
+	for (unsigned nFrames : ChunkSizes)
+	{
+		std::vector<float32_t> Input (TGS * nFrames);
+		for (float32_t &rSample : Input)
+		{
+			rSample = (float32_t) rand () / RAND_MAX * 2.0f - 1.0f;
+		}
+
+		const float32_t *pInput[TGS];
+		float32_t *pInputRef[TGS];
+		for (unsigned i = 0; i < TGS; i++)
+		{
+			pInput[i] = &Input[i * nFrames];
+			pInputRef[i] = &Input[i * nFrames];
+		}
+
+		AudioStereoMixerRef<TGS> TGMixerRef (nFrames);
+		AudioStereoMixerRef<TGS> SendMixerRef (nFrames);
+		AudioStereoMixer<TGS> TGMixer (nFrames);
+		AudioStereoMixer<TGS> SendMixer (nFrames);
+
+		for (unsigned i = 0; i < TGS; i++)
+		{
+			float32_t fPan = (float32_t) i / (TGS - 1);
+			float32_t fGain = 0.5f + 0.05f * i;
+			float32_t fSend = 0.2f + 0.1f * i;
+
+			TGMixerRef.pan (i, fPan);
+			TGMixerRef.gain (i, fGain);
+			SendMixerRef.pan (i, fPan);
+			SendMixerRef.gain (i, fSend);
+
+			TGMixer.pan (i, fPan);
+			TGMixer.gain (i, fGain);
+			SendMixer.pan (i, fPan);
+			SendMixer.gain (i, fSend);
+		}
+
+		std::vector<float32_t> OutRef (4 * nFrames);
+		std::vector<float32_t> Out (4 * nFrames);
+
+		uint64_t nTimeRef = BenchBest (Runs, [&] {
+			for (unsigned i = 0; i < TGS; i++)
+			{
+				TGMixerRef.doAddMix (i, pInputRef[i]);
+			}
+			for (unsigned i = 0; i < TGS; i++)
+			{
+				SendMixerRef.doAddMix (i, pInputRef[i]);
+			}
+			TGMixerRef.getMix (&OutRef[0], &OutRef[nFrames]);
+			SendMixerRef.getMix (&OutRef[2 * nFrames], &OutRef[3 * nFrames]);
+		});
+
+		uint64_t nTime = BenchBest (Runs, [&] {
+			TGMixer.doAddMix (pInput, TGS, &SendMixer);
+			TGMixer.getMix (&Out[0], &Out[nFrames]);
+			SendMixer.getMix (&Out[2 * nFrames], &Out[3 * nFrames]);
+		});
+
+		float32_t fMaxDiff = 0.0f;
+		for (unsigned i = 0; i < 4 * nFrames; i++)
+		{
+			fMaxDiff = fmaxf (fMaxDiff, fabsf (Out[i] - OutRef[i]));
+		}
+
+		if (fMaxDiff > 1e-5f)
+		{
+			fprintf (stderr, "chunk %u: output differs by %g\n", nFrames, fMaxDiff);
+			bOK = false;
+		}
+
+		printf ("%5u %12.2f %7.2f %8.2fx\n", nFrames,
+			(double) nTimeRef / nFrames, (double) nTime / nFrames,
+			(double) nTimeRef / nTime);
+	}
+
+	return bOK ? 0 : 1;
+}
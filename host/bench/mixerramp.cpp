@@ -0,0 +1,120 @@
+//
+// mixerramp.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Benchmark of the gain ramps of AudioStereoMixer: the fused doAddMix() of
+// eight TGs into the dry and the reverb send buses, with all channels
+// ramping in every chunk, against the step behaviour (MixerRampTime=0) with
+// the same gain changes. The overhead is only reported, because it is within
+// the noise of the host timing (the target is meant to stay below about 5%).
+//
+#include "bench.h"
+#include <arm_math.h>
+#include <common.h>
+#include <effect_mixer.hpp>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TGS	8
+
+static const unsigned ChunkSizes[] = {64, 128, 256, 512, 1024};
+
+static const unsigned Runs = 2000;
+static const unsigned Rounds = 10;
+
+// Mixes one chunk after changing the gain and the send level of all
+// channels, so that they ramp all the time, if a ramp length is set
+static void MixChunk (AudioStereoMixer<TGS> *pMixer, AudioStereoMixer<TGS> *pSendMixer,
+		      const float32_t * const *ppInput, float32_t *pOutput, unsigned nFrames)
+{
+	static unsigned s_nChunk = 0;
+	s_nChunk++;
+
+	for (unsigned i = 0; i < TGS; i++)
+	{
+		float32_t fGain = (s_nChunk + i) & 1 ? 0.9f : 0.7f;
+
+		pMixer->volume (i, fGain);
+		pSendMixer->volume (i, fGain);
+	}
+
+	pMixer->doAddMix (ppInput, TGS, pSendMixer);
+	pMixer->getMix (&pOutput[0], &pOutput[nFrames]);
+	pSendMixer->getMix (&pOutput[2 * nFrames], &pOutput[3 * nFrames]);
+}
+
+int main (void)
+{
+	printf ("%d TGs, " BENCH_UNIT " per frame\n", TGS);
+	printf ("chunk     step    ramp  overhead\n");
+
+	for (unsigned nFrames : ChunkSizes)
+	{
+		std::vector<float32_t> Input (TGS * nFrames);
+		for (float32_t &rSample : Input)
+		{
+			rSample = (float32_t) rand () / RAND_MAX * 2.0f - 1.0f;
+		}
+
+		const float32_t *pInput[TGS];
+		for (unsigned i = 0; i < TGS; i++)
+		{
+			pInput[i] = &Input[i * nFrames];
+		}
+
+		std::vector<float32_t> Output (4 * nFrames);
+
+		AudioStereoMixer<TGS> Mixer[2] = {nFrames, nFrames};
+		AudioStereoMixer<TGS> SendMixer[2] = {nFrames, nFrames};
+		for (unsigned nRamp = 0; nRamp < 2; nRamp++)
+		{
+			for (unsigned i = 0; i < TGS; i++)
+			{
+				Mixer[nRamp].pan (i, (float32_t) i / (TGS - 1));
+				SendMixer[nRamp].pan (i, (float32_t) i / (TGS - 1));
+				SendMixer[nRamp].gain (i, 0.5f);
+			}
+
+			// 10 ms at 48 kHz (the default), but at least two chunks, so
+			// that the ramps are restarted before they end
+			unsigned nRampLength = nRamp ? std::max (480U, 2 * nFrames) : 0;
+			Mixer[nRamp].rampLength (nRampLength);
+			SendMixer[nRamp].rampLength (nRampLength);
+		}
+
+		// alternate between both, so that they see the same host load
+		uint64_t nTime[2] = {UINT64_MAX, UINT64_MAX};
+		for (unsigned nRound = 0; nRound < Rounds; nRound++)
+		{
+			for (unsigned nRamp = 0; nRamp < 2; nRamp++)
+			{
+				nTime[nRamp] = std::min (nTime[nRamp], BenchBest (Runs / Rounds, [&] {
+					MixChunk (&Mixer[nRamp], &SendMixer[nRamp], pInput,
+						  Output.data (), nFrames);
+				}));
+			}
+		}
+
+		double fOverhead = 100.0 * ((double) nTime[1] / nTime[0] - 1.0);
+		printf ("%5u %8.2f %7.2f %8.1f%%\n", nFrames,
+			(double) nTime[0] / nFrames, (double) nTime[1] / nFrames, fOverhead);
+	}
+
+	return 0;
+}
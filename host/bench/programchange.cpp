@@ -0,0 +1,141 @@
+//
+// programchange.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Benchmark of the voice lookup of a program change (CSysExFileLoader::
+// GetVoice()) with the decoded voice cache cold and warm, with all banks in
+// memory and with banks read on demand. The cold lookups cycle through more
+// banks than are kept decoded. Checks before, that the cached voices are the
+// same as freshly decoded ones.
+//
+#include "bench.h"
+#include <test/testsdcard.h>
+#include <sysexfileloader.h>
+#include <sdcard.h>
+#include <vector>
+#include <stdio.h>
+
+#define BANKS		16		// more than the decoded and the bank cache hold
+#define CACHE_SIZE	4
+
+static const unsigned Runs = 2000;
+
+// all voices of all banks, cold and warm, against a fresh loader
+static bool Compare (unsigned nCacheSize)
+{
+	CSysExFileLoader Loader;
+	Loader.Load (false, nCacheSize);
+
+	bool bOK = true;
+	for (unsigned nBank = 0; nBank < BANKS; nBank++)
+	{
+		CSysExFileLoader Fresh;
+		Fresh.Load (false, nCacheSize);
+
+		for (unsigned nRound = 0; nRound < 2; nRound++)
+		{
+			for (unsigned nVoice = 0; nVoice < CSysExFileLoader::VoicesPerBank; nVoice++)
+			{
+				uint8_t Voice[CSysExFileLoader::SizeSingleVoice];
+				uint8_t Expected[CSysExFileLoader::SizeSingleVoice];
+				Loader.GetVoice (nBank, nVoice, Voice);
+				Fresh.GetVoice (nBank, nVoice, Expected);
+
+				if (memcmp (Voice, Expected, sizeof Voice) != 0)
+				{
+					fprintf (stderr, "cache %u: bank %u voice %u differs\n",
+						 nCacheSize, nBank, nVoice);
+					bOK = false;
+				}
+			}
+		}
+	}
+
+	// the second round was served from the decoded voices
+	return bOK && Loader.TakeDecodedVoiceHits () == BANKS * CSysExFileLoader::VoicesPerBank;
+}
+
+// returns ns per GetVoice(), sets the number of decoded voice hits and misses
+static double Measure (unsigned nCacheSize, bool bWarm, unsigned *pHits, unsigned *pMisses)
+{
+	CSysExFileLoader Loader;
+	Loader.Load (false, nCacheSize);
+
+	uint8_t Voice[CSysExFileLoader::SizeSingleVoice];
+	unsigned nCount = 0;
+
+	Loader.TakeDecodedVoiceHits ();
+	Loader.TakeDecodedVoiceMisses ();
+
+	uint64_t nTime = BenchBest (Runs, [&] {
+		// a cold lookup is in the least recently used bank
+		unsigned nBank = bWarm ? 0 : nCount % BANKS;
+		unsigned nVoice = nCount / BANKS % CSysExFileLoader::VoicesPerBank;
+		Loader.GetVoice (nBank, nVoice, Voice);
+		nCount++;
+	}, BenchNanoseconds);
+
+	*pHits = Loader.TakeDecodedVoiceHits ();
+	*pMisses = Loader.TakeDecodedVoiceMisses ();
+
+	return nTime;
+}
+
+int main (void)
+{
+	std::string SDCard = CreateTestSDCard ();
+	HostSetSDCard (SDCard.c_str ());
+
+	char Name[20];
+	for (unsigned nBank = 1; nBank <= BANKS; nBank++)
+	{
+		snprintf (Name, sizeof Name, "BANK%03u", nBank);
+		WriteTestBank (SDCard, nBank, Name);
+	}
+
+	bool bOK = Compare (0) && Compare (CACHE_SIZE);
+
+	printf ("ns per program change (GetVoice)\n");
+	printf ("banks          cold     warm  speedup  hits/misses cold, warm\n");
+
+	static const unsigned CacheSizes[] = {0, CACHE_SIZE};
+	for (unsigned nCacheSize : CacheSizes)
+	{
+		unsigned nColdHits, nColdMisses, nWarmHits, nWarmMisses;
+		double fCold = Measure (nCacheSize, false, &nColdHits, &nColdMisses);
+		double fWarm = Measure (nCacheSize, true, &nWarmHits, &nWarmMisses);
+
+		printf ("%-11s %7.0f  %7.0f  %6.1fx  %u/%u, %u/%u\n",
+			nCacheSize ? "on demand" : "in memory", fCold, fWarm, fCold / fWarm,
+			nColdHits, nColdMisses, nWarmHits, nWarmMisses);
+
+		// the first warm lookup of each voice decodes it
+		if (   nColdHits != 0
+		    || nWarmMisses > CSysExFileLoader::VoicesPerBank
+		    || !(fWarm < fCold))
+		{
+			fprintf (stderr, "%s: the decoded voice cache is not effective\n",
+				 nCacheSize ? "on demand" : "in memory");
+			bOK = false;
+		}
+	}
+
+	RemoveTestSDCard (SDCard);
+
+	return bOK ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+//
+// reverb.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Benchmark of the plate reverb: doReverb() against the previous
+// implementation, in ns per frame for chunks of 64 to 1024 frames. Checks
+// before, that both produce the same output within a tolerance, also for
+// odd chunk lengths and with bypass toggles.
+//
+#include "bench.h"
+#include <effect_platervbstereo.h>
+#include <reference/effect_platervbstereo_ref.h>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static const unsigned SampleRate = 48000;
+
+static const unsigned ChunkSizes[] = {37, 64, 128, 256, 512, 1024};
+
+static const unsigned Runs = 1000;
+
+// the outputs are bit-identical without FMA contraction, which GCC does not
+// use for the generic x86-64 target
+static const float32_t Tolerance = 1e-6f;
+
+template <class TReverb>
+static void SetParameters (TReverb *pReverb)
+{
+	pReverb->size (0.7f);
+	pReverb->hidamp (0.5f);
+	pReverb->lodamp (0.5f);
+	pReverb->lowpass (0.3f);
+	pReverb->diffusion (0.65f);
+	pReverb->level (1.0f);
+}
+
+// Runs one second of noise bursts through both reverbs in chunks of nFrames
+// and returns the largest difference of the outputs
+static float32_t Compare (unsigned nFrames)
+{
+	AudioEffectPlateReverb Reverb (SampleRate);
+	AudioEffectPlateReverbRef ReverbRef (SampleRate);
+	SetParameters (&Reverb);
+	SetParameters (&ReverbRef);
+
+	std::vector<float32_t> In (2 * nFrames);
+	std::vector<float32_t> Out (2 * nFrames);
+	std::vector<float32_t> OutRef (2 * nFrames);
+
+	float32_t fMaxDiff = 0.0f;
+	unsigned nChunks = SampleRate / nFrames;
+	for (unsigned nChunk = 0; nChunk < nChunks; nChunk++)
+	{
+		bool bBurst = nChunk % 64 < 8;
+		for (float32_t &rSample : In)
+		{
+			rSample = bBurst ? (float32_t) rand () / RAND_MAX - 0.5f : 0.0f;
+		}
+
+		// bypass for a short time in the middle
+		bool bBypass = nChunk >= nChunks / 2 && nChunk < nChunks / 2 + 4;
+		Reverb.set_bypass (bBypass);
+		ReverbRef.set_bypass (bBypass);
+
+		Reverb.doReverb (&In[0], &In[nFrames], &Out[0], &Out[nFrames], nFrames);
+		ReverbRef.doReverb (&In[0], &In[nFrames], &OutRef[0], &OutRef[nFrames], nFrames);
+
+		for (unsigned i = 0; i < 2 * nFrames; i++)
+		{
+			fMaxDiff = fmaxf (fMaxDiff, fabsf (Out[i] - OutRef[i]));
+		}
+	}
+
+	return fMaxDiff;
+}
+
+template <class TReverb>
+static double Measure (unsigned nFrames)
+{
+	TReverb Reverb (SampleRate);
+	SetParameters (&Reverb);
+
+	std::vector<float32_t> In (2 * nFrames);
+	std::vector<float32_t> Out (2 * nFrames);
+	for (float32_t &rSample : In)
+	{
+		rSample = (float32_t) rand () / RAND_MAX - 0.5f;
+	}
+
+	uint64_t nTime = BenchBest (Runs, [&] {
+		Reverb.doReverb (&In[0], &In[nFrames], &Out[0], &Out[nFrames], nFrames);
+	}, BenchNanoseconds);
+
+	return (double) nTime / nFrames;
+}
+
+int main (void)
+{
+	bool bOK = true;
+
+	printf ("ns per frame\n");
+	printf ("chunk  previous  current  speedup  max. difference\n");
+
+	for (unsigned nFrames : ChunkSizes)
+	{
+		float32_t fMaxDiff = Compare (nFrames);
+		if (fMaxDiff > Tolerance)
+		{
+			fprintf (stderr, "chunk %u: output differs by %g\n", nFrames, fMaxDiff);
+			bOK = false;
+		}
+
+		double fTimeRef = Measure<AudioEffectPlateReverbRef> (nFrames);
+		double fTime = Measure<AudioEffectPlateReverb> (nFrames);
+
+		printf ("%5u %9.2f %8.2f %7.2fx  %g\n", nFrames, fTimeRef, fTime,
+			fTimeRef / fTime, fMaxDiff);
+	}
+
+	return bOK ? 0 : 1;
+}
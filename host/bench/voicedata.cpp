@@ -0,0 +1,135 @@
+//
+// voicedata.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Benchmark of the voice data formats of the performance files: encoding and
+// decoding of one voice in hex and in Base64, and loading (without the cache)
+// and saving of a performance with the voice data of all TGs in each format.
+// Checks before, that the saved performances load with the same voice data.
+//
+#include "bench.h"
+#include <test/testsdcard.h>
+#include <test/performanceconfigprobe.h>
+#include <sdcard.h>
+#include <fatfs/ff.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TGS		8
+
+static const unsigned Runs = 10000;
+static const unsigned FileRuns = 200;
+
+typedef CPerformanceConfigProbe Probe;
+
+static void MeasureCodec (void)
+{
+	uint8_t Voice[NUM_VOICE_PARAM];
+	for (unsigned i = 0; i < NUM_VOICE_PARAM; i++)
+	{
+		Voice[i] = rand () % 100;
+	}
+
+	char Hex[Probe::HexLength+1];
+	char Base64[Probe::Base64Length+1];
+	uint8_t Decoded[NUM_VOICE_PARAM];
+
+	uint64_t nEncodeHex = BenchBest (Runs, [&] { Probe::EncodeHex (Voice, Hex); }, BenchNanoseconds);
+	uint64_t nDecodeHex = BenchBest (Runs, [&] { Probe::DecodeHex (Hex, Decoded); }, BenchNanoseconds);
+	uint64_t nEncodeBase64 = BenchBest (Runs, [&] { Probe::EncodeBase64 (Voice, Base64); }, BenchNanoseconds);
+	uint64_t nDecodeBase64 = BenchBest (Runs, [&] { Probe::DecodeBase64 (Base64, Decoded); }, BenchNanoseconds);
+
+	printf ("ns per voice    encode  decode  characters\n");
+	printf ("hex            %7u %7u %11u\n", (unsigned) nEncodeHex, (unsigned) nDecodeHex,
+		Probe::HexLength);
+	printf ("Base64         %7u %7u %11u\n", (unsigned) nEncodeBase64, (unsigned) nDecodeBase64,
+		Probe::Base64Length);
+}
+
+static long GetFileSize (const std::string &FileName)
+{
+	struct stat Stat;
+
+	return stat (FileName.c_str (), &Stat) == 0 ? Stat.st_size : -1;
+}
+
+// saves the performance with the voice data of all TGs in the given format,
+// returns false, if it does not load with the same voice data
+static bool MeasureFile (const std::string &SDCard, bool bBase64)
+{
+	FATFS FileSystem;
+	CPerformanceConfig Config (&FileSystem);
+	Config.Init (TGS, bBase64);
+	Config.Load ();
+
+	uint8_t Voice[TGS][NUM_VOICE_PARAM];
+	for (unsigned nTG = 0; nTG < TGS; nTG++)
+	{
+		for (unsigned i = 0; i < NUM_VOICE_PARAM; i++)
+		{
+			Voice[nTG][i] = rand () % 100;
+		}
+
+		Config.SetVoiceData (Voice[nTG], nTG);
+	}
+
+	// a new file, so that it only has the voice data of one format
+	remove ((SDCard + "/performance.ini").c_str ());
+
+	uint64_t nSave = BenchBest (FileRuns, [&] { Config.Save (); }, BenchNanoseconds);
+	uint64_t nLoad = BenchBest (FileRuns, [&] { Probe::Reload (&Config); }, BenchNanoseconds);
+
+	printf ("%-14s %7.1f %7.1f %11ld\n", bBase64 ? "Base64" : "hex",
+		nLoad / 1000.0, nSave / 1000.0, GetFileSize (SDCard + "/performance.ini"));
+
+	CPerformanceConfig Reloaded (&FileSystem);
+	Reloaded.Init (TGS, false);
+	Reloaded.Load ();
+
+	bool bOK = true;
+	for (unsigned nTG = 0; nTG < TGS; nTG++)
+	{
+		if (   !Reloaded.VoiceDataFilled (nTG)
+		    || memcmp (Reloaded.GetVoiceData (nTG), Voice[nTG], NUM_VOICE_PARAM) != 0)
+		{
+			fprintf (stderr, "%s: voice data of TG%u differs\n", bBase64 ? "Base64" : "hex", nTG+1);
+			bOK = false;
+		}
+	}
+
+	return bOK;
+}
+
+int main (void)
+{
+	std::string SDCard = CreateTestSDCard ();
+	HostSetSDCard (SDCard.c_str ());
+
+	MeasureCodec ();
+
+	printf ("\nus per performance (%u TGs)\n", TGS);
+	printf ("format            load    save  file bytes\n");
+	bool bOK = MeasureFile (SDCard, false);
+	bOK = MeasureFile (SDCard, true) && bOK;
+
+	RemoveTestSDCard (SDCard);
+
+	return bOK ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+//
+// circle.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host implementations of the Circle stand-ins for the sound device and the
+// multi-core support (see include/circle)
+//
+#include <circle/sound/soundbasedevice.h>
+#include <circle/multicore.h>
+#include <circle/spinlock.h>
+#include <circle/synchronize.h>
+#include <chrono>
+#include <thread>
+#include <string.h>
+#include <assert.h>
+
+CSoundBaseDevice *CSoundBaseDevice::s_pThis = nullptr;
+
+CSoundBaseDevice::CSoundBaseDevice (unsigned nSampleRate)
+:	m_nSampleRate (nSampleRate),
+	m_nChannels (2),
+	m_nQueueSizeFrames (0),
+	m_bActive (false),
+	m_nQueueIn (0),
+	m_nQueueOut (0),
+	m_nFullPolls (0),
+	m_bConsuming (false),
+	m_nUnderruns (0),
+	m_nPollDelayMicros (0)
+{
+	s_pThis = this;
+}
+
+CSoundBaseDevice::~CSoundBaseDevice (void)
+{
+	StopConsumer ();
+
+	s_pThis = nullptr;
+}
+
+boolean CSoundBaseDevice::AllocateQueueFrames (unsigned nSizeFrames)
+{
+	m_nQueueSizeFrames = nSizeFrames;
+
+	return TRUE;
+}
+
+void CSoundBaseDevice::SetWriteFormat (TSoundFormat Format, unsigned nChannels)
+{
+	assert (Format == SoundFormatSigned24_32);
+	assert (m_nQueueSizeFrames > 0);
+
+	m_nChannels = nChannels;
+	m_Queue.assign (m_nQueueSizeFrames * m_nChannels, 0);
+}
+
+boolean CSoundBaseDevice::Start (void)
+{
+	m_bActive = true;
+
+	return TRUE;
+}
+
+boolean CSoundBaseDevice::IsActive (void) const
+{
+	return m_bActive;
+}
+
+unsigned CSoundBaseDevice::GetQueueSizeFrames (void)
+{
+	return m_nQueueSizeFrames;
+}
+
+unsigned CSoundBaseDevice::GetQueueFramesAvail (void)
+{
+	unsigned nDelayMicros = m_nPollDelayMicros.exchange (0);
+	if (nDelayMicros)
+	{
+		std::this_thread::sleep_for (std::chrono::microseconds (nDelayMicros));
+	}
+
+	std::lock_guard<std::mutex> Lock (m_Mutex);
+
+	unsigned nFrames = m_nQueueIn - m_nQueueOut;
+	if (nFrames == m_nQueueSizeFrames)
+	{
+		m_nFullPolls++;
+	}
+
+	return nFrames;
+}
+
+int CSoundBaseDevice::Write (const void *pBuffer, size_t nCount)
+{
+	std::lock_guard<std::mutex> Lock (m_Mutex);
+
+	unsigned nFrames = nCount / (m_nChannels * sizeof (s32));
+	unsigned nFree = m_nQueueSizeFrames - (m_nQueueIn - m_nQueueOut);
+	if (nFrames > nFree)
+	{
+		nFrames = nFree;
+	}
+
+	const s32 *pSamples = static_cast<const s32 *> (pBuffer);
+	for (unsigned i = 0; i < nFrames; i++, m_nQueueIn++)
+	{
+		memcpy (&m_Queue[(m_nQueueIn % m_nQueueSizeFrames) * m_nChannels],
+			&pSamples[i * m_nChannels], m_nChannels * sizeof (s32));
+	}
+
+	m_nFullPolls = 0;
+
+	return nFrames * m_nChannels * sizeof (s32);
+}
+
+CSoundBaseDevice *CSoundBaseDevice::Get (void)
+{
+	return s_pThis;
+}
+
+void CSoundBaseDevice::WaitIdle (void)
+{
+	while (1)
+	{
+		{
+			std::lock_guard<std::mutex> Lock (m_Mutex);
+
+			if (m_nFullPolls >= IdlePolls)
+			{
+				return;
+			}
+		}
+
+		std::this_thread::yield ();
+	}
+}
+
+unsigned CSoundBaseDevice::Read (s32 *pBuffer, unsigned nFrames)
+{
+	std::lock_guard<std::mutex> Lock (m_Mutex);
+
+	unsigned nRead = 0;
+	for (; nRead < nFrames && m_nQueueOut != m_nQueueIn; nRead++, m_nQueueOut++)
+	{
+		memcpy (&pBuffer[nRead * m_nChannels],
+			&m_Queue[(m_nQueueOut % m_nQueueSizeFrames) * m_nChannels],
+			m_nChannels * sizeof (s32));
+	}
+
+	memset (&pBuffer[nRead * m_nChannels], 0, (nFrames - nRead) * m_nChannels * sizeof (s32));
+
+	m_nFullPolls = 0;
+
+	return nRead;
+}
+
+void CSoundBaseDevice::StartConsumer (unsigned nFrames)
+{
+	assert (!m_bConsuming);
+	m_bConsuming = true;
+
+	m_Consumer = std::thread ([this, nFrames] {
+		std::vector<s32> Buffer (nFrames * m_nChannels);
+		auto Period = std::chrono::microseconds ((u64) nFrames * 1000000 / m_nSampleRate);
+		auto Next = std::chrono::steady_clock::now ();
+
+		while (m_bConsuming)
+		{
+			Next += Period;
+			std::this_thread::sleep_until (Next);
+
+			if (Read (Buffer.data (), nFrames) < nFrames)
+			{
+				m_nUnderruns++;
+			}
+		}
+	});
+}
+
+void CSoundBaseDevice::StopConsumer (void)
+{
+	if (m_bConsuming)
+	{
+		m_bConsuming = false;
+		m_Consumer.join ();
+	}
+}
+
+static thread_local unsigned s_nThisCore = 0;
+
+boolean CMultiCoreSupport::Initialize (void)
+{
+	for (unsigned nCore = 1; nCore < CORES; nCore++)
+	{
+		std::thread ([this, nCore] { s_nThisCore = nCore; Run (nCore); }).detach ();
+	}
+
+	return TRUE;
+}
+
+unsigned CMultiCoreSupport::ThisCore (void)
+{
+	return s_nThisCore;
+}
+
+std::atomic<unsigned> CSpinLock::s_nWaits[CORES];
+
+thread_local unsigned g_nHostExecutionLevel = TASK_LEVEL;
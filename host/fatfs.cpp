@@ -0,0 +1,177 @@
+//
+// fatfs.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host implementation of the FatFs stand-in (see include/fatfs/ff.h)
+//
+#define DIR FF_DIR
+#include <fatfs/ff.h>
+#undef DIR
+#include <sdcard.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static std::string SDCardRoot (".");
+
+void HostSetSDCard (const char *pDirectory)
+{
+	SDCardRoot = pDirectory;
+}
+
+// All paths are on the SD card, with or without the volume prefix "SD:"
+std::string HostSDCardPath (const char *pPath)
+{
+	if (strncmp (pPath, "SD:", 3) == 0)
+	{
+		pPath += 3;
+	}
+
+	while (*pPath == '/')
+	{
+		pPath++;
+	}
+
+	return *pPath ? SDCardRoot + "/" + pPath : SDCardRoot;
+}
+
+FRESULT f_opendir (FF_DIR *dp, const TCHAR *path)
+{
+	snprintf (dp->Path, sizeof dp->Path, "%s", HostSDCardPath (path).c_str ());
+
+	dp->pHandle = opendir (dp->Path);
+
+	return dp->pHandle ? FR_OK : FR_NO_PATH;
+}
+
+FRESULT f_readdir (FF_DIR *dp, FILINFO *fno)
+{
+	dirent *pEntry;
+	do
+	{
+		pEntry = readdir ((DIR *) dp->pHandle);
+		if (!pEntry)
+		{
+			fno->fname[0] = '\0';
+
+			return FR_OK;
+		}
+	}
+	while (   strcmp (pEntry->d_name, ".") == 0
+	       || strcmp (pEntry->d_name, "..") == 0);
+
+	snprintf (fno->fname, sizeof fno->fname, "%s", pEntry->d_name);
+
+	char Path[512];
+	snprintf (Path, sizeof Path, "%s/%s", dp->Path, pEntry->d_name);
+
+	struct stat Stat;
+	if (stat (Path, &Stat) != 0)
+	{
+		return FR_DISK_ERR;
+	}
+
+	// FAT date and time format
+	struct tm Time;
+	localtime_r (&Stat.st_mtime, &Time);
+	fno->fdate = (Time.tm_year - 80) << 9 | (Time.tm_mon + 1) << 5 | Time.tm_mday;
+	fno->ftime = Time.tm_hour << 11 | Time.tm_min << 5 | Time.tm_sec / 2;
+
+	fno->fsize = Stat.st_size;
+	fno->fattrib = S_ISDIR (Stat.st_mode) ? AM_DIR : 0;
+
+	return FR_OK;
+}
+
+FRESULT f_closedir (FF_DIR *dp)
+{
+	closedir ((DIR *) dp->pHandle);
+
+	return FR_OK;
+}
+
+// Like FatFs, f_findfirst() opens the directory itself.
+FRESULT f_findfirst (FF_DIR *dp, FILINFO *fno, const TCHAR *path, const TCHAR *pattern)
+{
+	snprintf (dp->Pattern, sizeof dp->Pattern, "%s", pattern);
+
+	FRESULT Result = f_opendir (dp, path);
+	if (Result != FR_OK)
+	{
+		return Result;
+	}
+
+	return f_findnext (dp, fno);
+}
+
+FRESULT f_findnext (FF_DIR *dp, FILINFO *fno)
+{
+	FRESULT Result;
+	while (   (Result = f_readdir (dp, fno)) == FR_OK
+	       && fno->fname[0]
+	       && fnmatch (dp->Pattern, fno->fname, FNM_CASEFOLD) != 0)
+	{
+		// skip
+	}
+
+	return Result;
+}
+
+FRESULT f_open (FIL *fp, const TCHAR *path, BYTE mode)
+{
+	FILE *pFile = fopen (HostSDCardPath (path).c_str (), mode & FA_WRITE ? "wb" : "rb");
+	if (!pFile)
+	{
+		return FR_NO_FILE;
+	}
+
+	fseek (pFile, 0, SEEK_END);
+	fp->nSize = ftell (pFile);
+	fseek (pFile, 0, SEEK_SET);
+
+	fp->pHandle = pFile;
+
+	return FR_OK;
+}
+
+FRESULT f_read (FIL *fp, void *buff, UINT btr, UINT *br)
+{
+	*br = fread (buff, 1, btr, (FILE *) fp->pHandle);
+
+	return FR_OK;
+}
+
+FRESULT f_write (FIL *fp, const void *buff, UINT btw, UINT *bw)
+{
+	*bw = fwrite (buff, 1, btw, (FILE *) fp->pHandle);
+
+	return *bw == btw ? FR_OK : FR_DISK_ERR;
+}
+
+FRESULT f_close (FIL *fp)
+{
+	return fclose ((FILE *) fp->pHandle) == 0 ? FR_OK : FR_DISK_ERR;
+}
+
+FRESULT f_unlink (const TCHAR *path)
+{
+	return remove (HostSDCardPath (path).c_str ()) == 0 ? FR_OK : FR_NO_FILE;
+}
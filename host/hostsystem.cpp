@@ -0,0 +1,143 @@
+//
+// hostsystem.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "hostsystem.h"
+#include <sdcard.h>
+#include <circle/timer.h>
+#include <assert.h>
+
+CHostMIDIDevice::CHostMIDIDevice (CMiniDexed *pSynthesizer, CConfig *pConfig, CUserInterface *pUI)
+:	CMIDIDevice (pSynthesizer, pConfig, pUI),
+	m_pSynthesizer (pSynthesizer),
+	m_nToneGenerators (pConfig->GetToneGenerators ())
+{
+	for (unsigned nTG = 0; nTG < CConfig::AllToneGenerators; nTG++)
+	{
+		m_nChannel[nTG] = Disabled;
+	}
+
+	AddDevice ("host");
+}
+
+void CHostMIDIDevice::Receive (const u8 *pMessage, size_t nLength, unsigned nTimestamp)
+{
+	UpdateChannels ();
+
+	MIDIMessageHandler (pMessage, nLength, 0, nTimestamp);
+}
+
+// Only changes on the synth are copied, so that this device keeps its own
+// OMNI mode (CC 124/125) like the other MIDI devices.
+void CHostMIDIDevice::UpdateChannels (void)
+{
+	for (unsigned nTG = 0; nTG < m_nToneGenerators; nTG++)
+	{
+		unsigned nChannel = m_pSynthesizer->GetTGParameter (CMiniDexed::TGParameterMIDIChannel, nTG);
+		if (nChannel != m_nChannel[nTG])
+		{
+			m_nChannel[nTG] = nChannel;
+
+			SetChannel (nChannel, nTG);
+		}
+	}
+}
+
+CHostSystem::CHostSystem (const char *pSDCard)
+:	m_Config (&m_FileSystem),
+	m_pMiniDexed (nullptr),
+	m_pUI (nullptr),
+	m_pMIDIDevice (nullptr),
+	m_pSoundDevice (nullptr),
+	m_nChunk (0)
+{
+	HostSetSDCard (pSDCard);
+
+	CTimer::SetClockTicks (0);
+}
+
+CHostSystem::~CHostSystem (void)
+{
+	// CMiniDexed cannot be deleted, because the secondary cores keep running
+}
+
+bool CHostSystem::Initialize (void)
+{
+	m_Config.Load ();
+
+	m_pMiniDexed = new CMiniDexed (&m_Config, &m_Interrupt, &m_GPIOManager,
+				       &m_I2CMaster, &m_SPIMaster, &m_FileSystem);
+	assert (m_pMiniDexed);
+
+	if (!m_pMiniDexed->Initialize ())
+	{
+		return false;
+	}
+
+	m_pSoundDevice = CSoundBaseDevice::Get ();
+	assert (m_pSoundDevice);
+	if (m_pSoundDevice->GetChannels () != 2)
+	{
+		fprintf (stderr, "Only stereo output is supported on the host\n");
+
+		return false;
+	}
+
+	m_pUI = new CUserInterface (m_pMiniDexed, &m_GPIOManager, &m_I2CMaster,
+				    &m_SPIMaster, &m_Config);
+	m_pMIDIDevice = new CHostMIDIDevice (m_pMiniDexed, &m_Config, m_pUI);
+
+	// the first chunks are rendered at clock time 0
+	m_pSoundDevice->WaitIdle ();
+
+	return true;
+}
+
+unsigned CHostSystem::GetSampleRate (void) const
+{
+	return m_Config.GetSampleRate ();
+}
+
+unsigned CHostSystem::GetChunkFrames (void) const
+{
+	assert (m_pSoundDevice);
+
+	// as in CMiniDexed::ProcessSound()
+	return m_pSoundDevice->GetQueueSizeFrames () / 2;
+}
+
+unsigned CHostSystem::GetClockTicks (void) const
+{
+	return (u64) (m_nChunk + 1) * GetChunkFrames () * CLOCKHZ / GetSampleRate ();
+}
+
+void CHostSystem::Tick (s32 *pBuffer)
+{
+	assert (m_pMiniDexed);
+	m_pMiniDexed->Process (m_nChunk == 0);
+
+	// The sound engine is idle, until the device has room again. Then it
+	// renders the next chunk with the new clock time (see UpdateChunkWindow()).
+	CTimer::SetClockTicks (GetClockTicks ());
+	m_nChunk++;
+
+	assert (m_pSoundDevice);
+	m_pSoundDevice->Read (pBuffer, GetChunkFrames ());
+
+	m_pSoundDevice->WaitIdle ();
+}
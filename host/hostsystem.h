@@ -0,0 +1,98 @@
+//
+// hostsystem.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// The MiniDexed sound engine on the host: CConfig and CMiniDexed as on the
+// target, and a MIDI input device, which is fed by the host program. The
+// clock is simulated and advanced by one chunk per Tick(), after the sound
+// engine has rendered everything it can. So the output only depends on the
+// configuration and the MIDI input, not on the host timing.
+//
+#ifndef _hostsystem_h
+#define _hostsystem_h
+
+#include <minidexed.h>
+#include <config.h>
+#include <mididevice.h>
+#include <userinterface.h>
+#include <circle/sound/soundbasedevice.h>
+#include <circle/interrupt.h>
+#include <circle/gpiomanager.h>
+#include <circle/i2cmaster.h>
+#include <circle/spimaster.h>
+#include <circle/types.h>
+#include <fatfs/ff.h>
+
+class CHostMIDIDevice : public CMIDIDevice	// the MIDI input of the host program
+{
+public:
+	CHostMIDIDevice (CMiniDexed *pSynthesizer, CConfig *pConfig, CUserInterface *pUI);
+
+	// nTimestamp is the arrival time in CTimer clock ticks
+	void Receive (const u8 *pMessage, size_t nLength, unsigned nTimestamp);
+
+private:
+	// CMiniDexed assigns the TG channels to its own MIDI devices only
+	void UpdateChannels (void);
+
+private:
+	CMiniDexed *m_pSynthesizer;
+	unsigned m_nToneGenerators;
+
+	unsigned m_nChannel[CConfig::AllToneGenerators];	// as last seen on the synth
+};
+
+class CHostSystem
+{
+public:
+	CHostSystem (const char *pSDCard);		// directory with minidexed.ini etc.
+	~CHostSystem (void);
+
+	bool Initialize (void);
+
+	CConfig *GetConfig (void)		{ return &m_Config; }
+	CMiniDexed *GetMiniDexed (void)		{ return m_pMiniDexed; }
+	CHostMIDIDevice *GetMIDIDevice (void)	{ return m_pMIDIDevice; }
+
+	unsigned GetSampleRate (void) const;
+	unsigned GetChunkFrames (void) const;	// per Tick()
+	unsigned GetClockTicks (void) const;	// time of the next Tick()
+
+	// Runs CMiniDexed::Process(), advances the clock by one chunk and reads
+	// the chunk, which the sound device outputs next, into pBuffer (stereo).
+	// MIDI events up to GetClockTicks() must be received before.
+	void Tick (s32 *pBuffer);
+
+private:
+	FATFS m_FileSystem;
+	CConfig m_Config;
+
+	CInterruptSystem m_Interrupt;
+	CGPIOManager m_GPIOManager;
+	CI2CMaster m_I2CMaster;
+	CSPIMaster m_SPIMaster;
+
+	CMiniDexed *m_pMiniDexed;
+	CUserInterface *m_pUI;
+	CHostMIDIDevice *m_pMIDIDevice;
+	CSoundBaseDevice *m_pSoundDevice;
+
+	unsigned m_nChunk;			// number of Tick() calls
+};
+
+#endif
@@ -0,0 +1,66 @@
+//
+// propertiesfatfsfile.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle addon header of the same name, implemented in
+// properties.cpp. The properties keep the order, in which they were set.
+//
+#ifndef _Properties_propertiesfatfsfile_h
+#define _Properties_propertiesfatfsfile_h
+
+#include <fatfs/ff.h>
+#include <circle/types.h>
+#include <assert.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+class CPropertiesFatFsFile
+{
+public:
+	CPropertiesFatFsFile (const char *pFileName, FATFS *pFileSystem);
+	~CPropertiesFatFsFile (void);
+
+	boolean Load (void);
+	boolean Save (void);
+
+	void RemoveAll (void);
+
+	boolean IsSet (const char *pPropertyName) const;
+
+	const char *GetString (const char *pPropertyName, const char *pDefault = 0) const;
+	unsigned GetNumber (const char *pPropertyName, unsigned nDefault = 0) const;
+	int GetSignedNumber (const char *pPropertyName, int nDefault = 0) const;
+	const u8 *GetIPAddress (const char *pPropertyName) const;	// 0 if not set or invalid
+
+	void SetString (const char *pPropertyName, const char *pValue);
+	void SetNumber (const char *pPropertyName, unsigned nValue, unsigned nBase = 10);
+	void SetSignedNumber (const char *pPropertyName, int nValue);
+
+private:
+	const std::string *Find (const char *pPropertyName) const;
+
+private:
+	std::string m_FileName;
+
+	std::vector<std::pair<std::string, std::string>> m_Properties;
+
+	mutable u8 m_IPAddress[4];
+};
+
+#endif
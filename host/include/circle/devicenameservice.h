@@ -0,0 +1,45 @@
+//
+// devicenameservice.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name. There are no USB devices on
+// the host, so no device is ever found.
+//
+#ifndef _circle_devicenameservice_h
+#define _circle_devicenameservice_h
+
+#include <circle/device.h>
+#include <circle/types.h>
+
+class CDeviceNameService
+{
+public:
+	static CDeviceNameService *Get (void)
+	{
+		static CDeviceNameService s_DeviceNameService;
+
+		return &s_DeviceNameService;
+	}
+
+	CDevice *GetDevice (const char *pName, boolean bBlockDevice)
+	{
+		return nullptr;
+	}
+};
+
+#endif
@@ -0,0 +1,52 @@
+//
+// logger.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name, writes to stderr
+//
+#ifndef _circle_logger_h
+#define _circle_logger_h
+
+#include <stdio.h>
+#include <stdarg.h>
+
+class CLogger
+{
+public:
+	static void Write (const char *pSource, const char *pSeverity, const char *pMessage, ...)
+	{
+		va_list var;
+		va_start (var, pMessage);
+
+		fprintf (stderr, "%s: %s: ", pSource, pSeverity);
+		vfprintf (stderr, pMessage, var);
+		fprintf (stderr, "\n");
+
+		va_end (var);
+	}
+};
+
+#define LOGMODULE(name)	static const char From[] = name
+
+#define LOGPANIC(...)	CLogger::Write (From, "panic", __VA_ARGS__)
+#define LOGERR(...)	CLogger::Write (From, "error", __VA_ARGS__)
+#define LOGWARN(...)	CLogger::Write (From, "warning", __VA_ARGS__)
+#define LOGNOTE(...)	CLogger::Write (From, "note", __VA_ARGS__)
+#define LOGDBG(...)	((void) 0)
+
+#endif
@@ -0,0 +1,43 @@
+//
+// multicore.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name. The secondary cores
+// are host threads, which are started by Initialize() and never return.
+//
+#ifndef _circle_multicore_h
+#define _circle_multicore_h
+
+#include <circle/memory.h>
+#include <circle/sysconfig.h>
+#include <circle/types.h>
+
+class CMultiCoreSupport
+{
+public:
+	CMultiCoreSupport (CMemorySystem *pMemorySystem) {}
+	virtual ~CMultiCoreSupport (void) {}
+
+	boolean Initialize (void);
+
+	virtual void Run (unsigned nCore) = 0;		// called on the secondary cores
+
+	static unsigned ThisCore (void);		// 0 for the main thread
+};
+
+#endif
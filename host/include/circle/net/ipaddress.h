@@ -0,0 +1,70 @@
+//
+// ipaddress.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name
+//
+#ifndef _circle_net_ipaddress_h
+#define _circle_net_ipaddress_h
+
+#include <circle/string.h>
+#include <circle/types.h>
+#include <string.h>
+
+#define IP_ADDRESS_SIZE	4
+
+class CIPAddress
+{
+public:
+	CIPAddress (void) {}
+
+	void Set (const u8 *pAddress)
+	{
+		memcpy (m_Address, pAddress, IP_ADDRESS_SIZE);
+		m_bValid = true;
+	}
+
+	bool IsSet (void) const
+	{
+		return m_bValid;
+	}
+
+	bool IsNull (void) const
+	{
+		static const u8 Null[IP_ADDRESS_SIZE] = {0};
+
+		return memcmp (m_Address, Null, IP_ADDRESS_SIZE) == 0;
+	}
+
+	const u8 *Get (void) const
+	{
+		return m_Address;
+	}
+
+	void Format (CString *pString) const
+	{
+		pString->Format ("%u.%u.%u.%u", m_Address[0], m_Address[1],
+				 m_Address[2], m_Address[3]);
+	}
+
+private:
+	u8 m_Address[IP_ADDRESS_SIZE] = {0};
+	bool m_bValid = false;
+};
+
+#endif
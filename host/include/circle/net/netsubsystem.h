@@ -0,0 +1,95 @@
+//
+// netsubsystem.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name. There is no network on the
+// host, so Initialize() fails and the network services are not started.
+//
+#ifndef _circle_net_netsubsystem_h
+#define _circle_net_netsubsystem_h
+
+#include <circle/net/ipaddress.h>
+#include <circle/types.h>
+
+enum TNetDeviceType
+{
+	NetDeviceTypeEthernet,
+	NetDeviceTypeWLAN,
+	NetDeviceTypeAny,
+	NetDeviceTypeUnknown
+};
+
+class CNetDevice
+{
+public:
+	TNetDeviceType GetType (void)
+	{
+		return NetDeviceTypeUnknown;
+	}
+
+	boolean IsLinkUp (void)
+	{
+		return FALSE;
+	}
+
+	static CNetDevice *GetNetDevice (TNetDeviceType Type)
+	{
+		return nullptr;
+	}
+};
+
+class CNetConfig
+{
+public:
+	const CIPAddress *GetIPAddress (void) const
+	{
+		return &m_IPAddress;
+	}
+
+private:
+	CIPAddress m_IPAddress;
+};
+
+class CNetSubSystem
+{
+public:
+	CNetSubSystem (const u8 *pIPAddress = 0, const u8 *pNetMask = 0,
+		       const u8 *pDefaultGateway = 0, const u8 *pDNSServer = 0,
+		       const char *pHostname = "raspberrypi",
+		       TNetDeviceType DeviceType = NetDeviceTypeEthernet) {}
+
+	boolean Initialize (boolean bWaitForActivate = TRUE)
+	{
+		return FALSE;
+	}
+
+	boolean IsRunning (void) const
+	{
+		return FALSE;
+	}
+
+	CNetConfig *GetConfig (void)
+	{
+		return &m_Config;
+	}
+
+private:
+	CNetConfig m_Config;
+};
+
+#endif
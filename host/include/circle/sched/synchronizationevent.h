@@ -0,0 +1,56 @@
+//
+// synchronizationevent.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name
+//
+#ifndef _circle_sched_synchronizationevent_h
+#define _circle_sched_synchronizationevent_h
+
+#include <condition_variable>
+#include <mutex>
+
+class CSynchronizationEvent
+{
+public:
+	void Set (void)
+	{
+		std::lock_guard<std::mutex> Lock (m_Mutex);
+		m_bState = true;
+		m_Condition.notify_all ();
+	}
+
+	void Clear (void)
+	{
+		std::lock_guard<std::mutex> Lock (m_Mutex);
+		m_bState = false;
+	}
+
+	void Wait (void)
+	{
+		std::unique_lock<std::mutex> Lock (m_Mutex);
+		m_Condition.wait (Lock, [this] { return m_bState; });
+	}
+
+private:
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_bState = false;
+};
+
+#endif
@@ -0,0 +1,37 @@
+//
+// task.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name. Tasks are not started on the
+// host: The network services do not exist there and the voice prefetcher is an
+// optimisation only, so Run() is never called.
+//
+#ifndef _circle_sched_task_h
+#define _circle_sched_task_h
+
+class CTask
+{
+public:
+	virtual ~CTask (void) {}
+
+	virtual void Run (void) = 0;
+
+	void SetName (const char *pName) {}
+};
+
+#endif
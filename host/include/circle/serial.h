@@ -0,0 +1,71 @@
+//
+// serial.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name. The host has no UART, so
+// Initialize() fails and the serial MIDI interface stays disabled.
+//
+#ifndef _circle_serial_h
+#define _circle_serial_h
+
+#include <circle/device.h>
+#include <circle/interrupt.h>
+#include <circle/types.h>
+
+#define SERIAL_OPTION_ONLCR	(1 << 0)
+
+#define SERIAL_ERROR_BREAK	1
+#define SERIAL_ERROR_OVERRUN	2
+#define SERIAL_ERROR_FRAMING	3
+
+class CSerialDevice : public CDevice
+{
+public:
+	CSerialDevice (CInterruptSystem *pInterruptSystem = 0, boolean bUseFIQ = FALSE,
+		       unsigned nDevice = 0) {}
+
+	boolean Initialize (unsigned nBaudrate = 115200)
+	{
+		return FALSE;
+	}
+
+	int Read (void *pBuffer, size_t nCount) override
+	{
+		return 0;
+	}
+
+	int Write (const void *pBuffer, size_t nCount) override
+	{
+		return (int) nCount;
+	}
+
+	unsigned GetOptions (void) const
+	{
+		return m_nOptions;
+	}
+
+	void SetOptions (unsigned nOptions)
+	{
+		m_nOptions = nOptions;
+	}
+
+private:
+	unsigned m_nOptions = SERIAL_OPTION_ONLCR;
+};
+
+#endif
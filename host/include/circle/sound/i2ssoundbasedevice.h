@@ -0,0 +1,51 @@
+//
+// i2ssoundbasedevice.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name
+//
+#ifndef _circle_sound_i2ssoundbasedevice_h
+#define _circle_sound_i2ssoundbasedevice_h
+
+#include <circle/sound/soundbasedevice.h>
+#include <circle/interrupt.h>
+#include <circle/i2cmaster.h>
+#include <circle/types.h>
+
+class CI2SSoundBaseDevice : public CSoundBaseDevice
+{
+public:
+	enum TDeviceMode
+	{
+		DeviceModeTXOnly,
+		DeviceModeRXOnly,
+		DeviceModeTXRX,
+		DeviceModeUnknown
+	};
+
+public:
+	CI2SSoundBaseDevice (CInterruptSystem *pInterrupt, unsigned nSampleRate = 192000,
+			     unsigned nChunkSize = 8192, bool bSlave = FALSE,
+			     CI2CMaster *pI2CMaster = nullptr, u8 ucI2CAddress = 0,
+			     TDeviceMode DeviceMode = DeviceModeTXOnly, unsigned nHWChannels = 2)
+	:	CSoundBaseDevice (nSampleRate)
+	{
+	}
+};
+
+#endif
@@ -0,0 +1,113 @@
+//
+// soundbasedevice.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name. The sound device is
+// a queue, which is drained by the host program with Read(), or by a consumer
+// thread at the fixed rate of the sample clock, like the hardware. Only the
+// format of the multi-core targets (SoundFormatSigned24_32) is supported.
+//
+#ifndef _circle_sound_soundbasedevice_h
+#define _circle_sound_soundbasedevice_h
+
+#include <circle/types.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum TSoundFormat
+{
+	SoundFormatUnsigned8,
+	SoundFormatSigned16,
+	SoundFormatSigned24,
+	SoundFormatSigned24_32,
+	SoundFormatUnsigned32,
+	SoundFormatUnknown
+};
+
+class CSoundBaseDevice
+{
+public:
+	CSoundBaseDevice (unsigned nSampleRate);
+	virtual ~CSoundBaseDevice (void);
+
+	boolean AllocateQueueFrames (unsigned nSizeFrames);
+	void SetWriteFormat (TSoundFormat Format, unsigned nChannels = 2);
+
+	boolean Start (void);
+	boolean IsActive (void) const;
+
+	unsigned GetQueueSizeFrames (void);
+	unsigned GetQueueFramesAvail (void);		// number of queued frames
+
+	int Write (const void *pBuffer, size_t nCount);
+
+	// host only: the last created device
+	static CSoundBaseDevice *Get (void);
+
+	// host only: Waits until the writer has filled the queue and keeps polling
+	// it without writing. Then the writer has finished its work for the
+	// current clock time, and nothing changes until the next Read().
+	void WaitIdle (void);
+
+	// host only: Takes nFrames from the queue. Returns the number of frames
+	// read, missing frames are filled with silence.
+	unsigned Read (s32 *pBuffer, unsigned nFrames);
+
+	// host only: Starts a thread, which takes nFrames from the queue once per
+	// nFrames sample periods in real time (use with CTimer::SetRealTime()).
+	void StartConsumer (unsigned nFrames);
+	void StopConsumer (void);
+
+	// host only: number of consumer periods, which found less than nFrames
+	unsigned GetUnderruns (void) const	{ return m_nUnderruns; }
+
+	// host only: the next GetQueueFramesAvail() sleeps before it looks at the
+	// queue, like a writer, which was held up
+	void DelayNextPoll (unsigned nMicros)	{ m_nPollDelayMicros = nMicros; }
+
+	unsigned GetChannels (void) const	{ return m_nChannels; }	// host only
+	unsigned GetSampleRate (void) const	{ return m_nSampleRate; }	// host only
+
+private:
+	// CMiniDexed::ProcessSound() polls the full queue at most twice per chunk,
+	// which it renders ahead (up to CConfig::MaxOutputLookahead). After more
+	// polls without a Write() it has nothing left to do.
+	static const unsigned IdlePolls = 32;
+
+	unsigned m_nSampleRate;
+	unsigned m_nChannels;
+	unsigned m_nQueueSizeFrames;
+	bool m_bActive;
+
+	std::mutex m_Mutex;
+	std::vector<s32> m_Queue;
+	unsigned m_nQueueIn;				// frames, free-running
+	unsigned m_nQueueOut;
+	unsigned m_nFullPolls;				// since the last Read() or Write()
+
+	std::thread m_Consumer;
+	std::atomic<bool> m_bConsuming;
+	std::atomic<unsigned> m_nUnderruns;
+	std::atomic<unsigned> m_nPollDelayMicros;
+
+	static CSoundBaseDevice *s_pThis;
+};
+
+#endif
@@ -0,0 +1,69 @@
+//
+// spinlock.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name. The secondary cores
+// are host threads, so the lock spins on an atomic flag. Interrupts are not
+// simulated, the target level is ignored. The tests can check, how often a
+// core had to wait for a lock.
+//
+#ifndef _circle_spinlock_h
+#define _circle_spinlock_h
+
+#include <circle/synchronize.h>
+#include <circle/multicore.h>
+#include <circle/sysconfig.h>
+#include <atomic>
+#include <thread>
+
+class CSpinLock
+{
+public:
+	CSpinLock (unsigned nTargetLevel = IRQ_LEVEL) {}
+
+	void Acquire (void)
+	{
+		if (m_bLocked.test_and_set (std::memory_order_acquire))
+		{
+			s_nWaits[CMultiCoreSupport::ThisCore ()]++;
+
+			while (m_bLocked.test_and_set (std::memory_order_acquire))
+			{
+				std::this_thread::yield ();
+			}
+		}
+	}
+
+	void Release (void)
+	{
+		m_bLocked.clear (std::memory_order_release);
+	}
+
+	// host only: number of Acquire() calls on a core, which found the lock taken
+	static unsigned GetWaits (unsigned nCore)
+	{
+		return s_nWaits[nCore];
+	}
+
+private:
+	std::atomic_flag m_bLocked = ATOMIC_FLAG_INIT;
+
+	static std::atomic<unsigned> s_nWaits[CORES];
+};
+
+#endif
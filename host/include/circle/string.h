@@ -0,0 +1,78 @@
+//
+// string.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name
+//
+#ifndef _circle_string_h
+#define _circle_string_h
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+
+class CString
+{
+public:
+	CString (void) {}
+	CString (const char *pString) : m_String (pString) {}
+
+	operator const char * (void) const
+	{
+		return m_String.c_str ();
+	}
+
+	const char *operator = (const char *pString)
+	{
+		m_String = pString;
+
+		return m_String.c_str ();
+	}
+
+	size_t GetLength (void) const
+	{
+		return m_String.size ();
+	}
+
+	void Append (const char *pString)
+	{
+		m_String += pString;
+	}
+
+	int Compare (const char *pString) const
+	{
+		return m_String.compare (pString);
+	}
+
+	void Format (const char *pFormat, ...)
+	{
+		va_list var;
+		va_start (var, pFormat);
+
+		char Buffer[1024];
+		vsnprintf (Buffer, sizeof Buffer, pFormat, var);
+		m_String = Buffer;
+
+		va_end (var);
+	}
+
+private:
+	std::string m_String;
+};
+
+#endif
@@ -0,0 +1,45 @@
+//
+// synchronize.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name. There are no
+// interrupts on the host, all threads run at task level, unless a test sets
+// another level for the calling thread with HostSetExecutionLevel().
+//
+#ifndef _circle_synchronize_h
+#define _circle_synchronize_h
+
+#define TASK_LEVEL	0
+#define IRQ_LEVEL	1
+#define FIQ_LEVEL	2
+
+extern thread_local unsigned g_nHostExecutionLevel;
+
+inline unsigned CurrentExecutionLevel (void)
+{
+	return g_nHostExecutionLevel;
+}
+
+inline void HostSetExecutionLevel (unsigned nLevel)
+{
+	g_nHostExecutionLevel = nLevel;
+}
+
+#define DataMemBarrier()	__atomic_thread_fence (__ATOMIC_SEQ_CST)
+
+#endif
@@ -0,0 +1,64 @@
+//
+// timer.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name. The clock is either
+// simulated and advanced by the host program (e.g. the offline renderer), or
+// follows the real time after SetRealTime().
+//
+#ifndef _circle_timer_h
+#define _circle_timer_h
+
+#include <circle/types.h>
+#include <atomic>
+#include <chrono>
+
+#define CLOCKHZ		1000000
+
+typedef uintptr TKernelTimerHandle;
+
+class CTimer
+{
+public:
+	static unsigned GetClockTicks (void)
+	{
+		if (s_bRealTime.load (std::memory_order_relaxed))
+		{
+			return (unsigned) std::chrono::duration_cast<std::chrono::microseconds> (
+				std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+		}
+
+		return s_nClockTicks.load (std::memory_order_acquire);
+	}
+
+	static void SetClockTicks (unsigned nTicks)		// host only
+	{
+		s_nClockTicks.store (nTicks, std::memory_order_release);
+	}
+
+	static void SetRealTime (bool bRealTime)		// host only
+	{
+		s_bRealTime.store (bRealTime, std::memory_order_relaxed);
+	}
+
+private:
+	static inline std::atomic<unsigned> s_nClockTicks {0};
+	static inline std::atomic<bool> s_bRealTime {false};
+};
+
+#endif
@@ -0,0 +1,44 @@
+//
+// writebuffer.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the Circle header of the same name, writes through
+//
+#ifndef _circle_writebuffer_h
+#define _circle_writebuffer_h
+
+#include <circle/device.h>
+#include <circle/types.h>
+
+class CWriteBufferDevice : public CDevice
+{
+public:
+	CWriteBufferDevice (CDevice *pDevice) : m_pDevice (pDevice) {}
+
+	int Write (const void *pBuffer, size_t nCount) override
+	{
+		return m_pDevice->Write (pBuffer, nCount);
+	}
+
+	void Update (void) {}
+
+private:
+	CDevice *m_pDevice;
+};
+
+#endif
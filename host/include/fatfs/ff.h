@@ -0,0 +1,103 @@
+//
+// ff.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host stand-in for the subset of the FatFs API used by the sound engine,
+// implemented with POSIX calls in fatfs.cpp. All paths are on the SD card,
+// which is a host directory (see sdcard.h).
+//
+#ifndef _fatfs_ff_h
+#define _fatfs_ff_h
+
+#include <stdint.h>
+
+typedef uint8_t		BYTE;
+typedef uint16_t	WORD;
+typedef uint32_t	DWORD;
+typedef unsigned	UINT;
+typedef char		TCHAR;
+typedef uint64_t	FSIZE_t;
+
+typedef enum
+{
+	FR_OK = 0,
+	FR_DISK_ERR,
+	FR_INT_ERR,
+	FR_NOT_READY,
+	FR_NO_FILE,
+	FR_NO_PATH,
+	FR_INVALID_NAME,
+	FR_DENIED
+}
+FRESULT;
+
+#define AM_HID			0x02
+#define AM_SYS			0x04
+#define AM_DIR			0x10
+
+#define FA_READ			0x01
+#define FA_WRITE		0x02
+#define FA_OPEN_EXISTING	0x00
+#define FA_CREATE_ALWAYS	0x08
+
+typedef struct
+{
+	FSIZE_t	fsize;
+	WORD	fdate;
+	WORD	ftime;
+	BYTE	fattrib;
+	TCHAR	fname[256];
+}
+FILINFO;
+
+typedef struct
+{
+	int	nUnused;
+}
+FATFS;
+
+typedef struct __dir		// named for linkage, see fatfs.cpp
+{
+	void	*pHandle;
+	char	Path[256];
+	char	Pattern[256];	// of f_findfirst()
+}
+DIR;
+
+typedef struct
+{
+	void	*pHandle;
+	FSIZE_t	nSize;
+}
+FIL;
+
+#define f_size(fp)	((fp)->nSize)
+
+FRESULT f_opendir (DIR *dp, const TCHAR *path);
+FRESULT f_readdir (DIR *dp, FILINFO *fno);	// fname[0] == 0 at the end
+FRESULT f_closedir (DIR *dp);
+FRESULT f_findfirst (DIR *dp, FILINFO *fno, const TCHAR *path, const TCHAR *pattern);
+FRESULT f_findnext (DIR *dp, FILINFO *fno);	// fname[0] == 0 at the end
+
+FRESULT f_open (FIL *fp, const TCHAR *path, BYTE mode);
+FRESULT f_read (FIL *fp, void *buff, UINT btr, UINT *br);
+FRESULT f_write (FIL *fp, const void *buff, UINT btw, UINT *bw);
+FRESULT f_close (FIL *fp);
+FRESULT f_unlink (const TCHAR *path);
+
+#endif
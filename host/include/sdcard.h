@@ -0,0 +1,44 @@
+//
+// sdcard.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// The SD card of the host build is a directory (default: the current directory).
+// FatFs paths (see fatfs/ff.h) are always on it. Sources, which use the POSIX
+// file API of circle-stdlib instead, are compiled with -include sdcard.h and
+// -DHOST_MAP_POSIX_PATHS, so that their absolute paths are on it too.
+//
+#ifndef _sdcard_h
+#define _sdcard_h
+
+#include <string>
+
+void HostSetSDCard (const char *pDirectory);
+
+std::string HostSDCardPath (const char *pPath);
+
+#ifdef HOST_MAP_POSIX_PATHS
+
+#include <stdio.h>
+#include <dirent.h>
+
+#define fopen(path, mode)	fopen (HostSDCardPath (path).c_str (), mode)
+#define opendir(path)		opendir (HostSDCardPath (path).c_str ())
+
+#endif
+
+#endif
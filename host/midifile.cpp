@@ -0,0 +1,255 @@
+//
+// midifile.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "midifile.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+static unsigned ReadBE (const uint8_t *pData, unsigned nBytes)
+{
+	unsigned nResult = 0;
+	for (unsigned i = 0; i < nBytes; i++)
+	{
+		nResult = nResult << 8 | pData[i];
+	}
+
+	return nResult;
+}
+
+// variable-length quantity
+static bool ReadVLQ (const uint8_t *pData, size_t nLength, size_t *pOffset, unsigned *pValue)
+{
+	unsigned nValue = 0;
+	do
+	{
+		if (*pOffset >= nLength)
+		{
+			return false;
+		}
+
+		nValue = nValue << 7 | (pData[*pOffset] & 0x7F);
+	}
+	while (pData[(*pOffset)++] & 0x80);
+
+	*pValue = nValue;
+
+	return true;
+}
+
+bool CMIDIFile::Load (const char *pFileName)
+{
+	FILE *pFile = fopen (pFileName, "rb");
+	if (!pFile)
+	{
+		fprintf (stderr, "%s: Cannot open file\n", pFileName);
+
+		return false;
+	}
+
+	std::vector<uint8_t> Data;
+	uint8_t Buffer[4096];
+	size_t nRead;
+	while ((nRead = fread (Buffer, 1, sizeof Buffer, pFile)) > 0)
+	{
+		Data.insert (Data.end (), Buffer, Buffer + nRead);
+	}
+
+	fclose (pFile);
+
+	if (   Data.size () < 14
+	    || memcmp (Data.data (), "MThd", 4) != 0
+	    || ReadBE (&Data[4], 4) < 6)
+	{
+		fprintf (stderr, "%s: Not a MIDI file\n", pFileName);
+
+		return false;
+	}
+
+	unsigned nFormat = ReadBE (&Data[8], 2);
+	unsigned nTracks = ReadBE (&Data[10], 2);
+	unsigned nDivision = ReadBE (&Data[12], 2);
+	if (   nFormat > 1
+	    || (nDivision & 0x8000))
+	{
+		fprintf (stderr, "%s: Format %u or SMPTE time is not supported\n", pFileName, nFormat);
+
+		return false;
+	}
+
+	m_TrackEvents.clear ();
+
+	size_t nOffset = 8 + ReadBE (&Data[4], 4);
+	for (unsigned nTrack = 0; nTrack < nTracks && nOffset + 8 <= Data.size (); nTrack++)
+	{
+		unsigned nLength = ReadBE (&Data[nOffset+4], 4);
+		if (nOffset + 8 + nLength > Data.size ())
+		{
+			fprintf (stderr, "%s: Track %u is truncated\n", pFileName, nTrack+1);
+
+			return false;
+		}
+
+		if (   memcmp (&Data[nOffset], "MTrk", 4) == 0
+		    && !ParseTrack (&Data[nOffset+8], nLength, nTrack))
+		{
+			fprintf (stderr, "%s: Track %u is invalid\n", pFileName, nTrack+1);
+
+			return false;
+		}
+
+		nOffset += 8 + nLength;
+	}
+
+	// merge the tracks and convert the ticks using the tempo map
+	std::sort (m_TrackEvents.begin (), m_TrackEvents.end (),
+		   [] (const TTrackEvent &A, const TTrackEvent &B)
+		   {
+			if (A.nTick != B.nTick)		return A.nTick < B.nTick;
+			if (A.nTrack != B.nTrack)	return A.nTrack < B.nTrack;
+			return A.nOrder < B.nOrder;
+		   });
+
+	m_Events.clear ();
+
+	unsigned nTempo = 500000;		// 120 BPM
+	unsigned nLastTick = 0;
+	double fMicros = 0.0;
+	for (const TTrackEvent &rEvent : m_TrackEvents)
+	{
+		fMicros += (double) (rEvent.nTick - nLastTick) * nTempo / nDivision;
+		nLastTick = rEvent.nTick;
+
+		if (rEvent.nTempo != 0)
+		{
+			nTempo = rEvent.nTempo;
+
+			continue;
+		}
+
+		TEvent Event = rEvent.Event;
+		Event.nMicros = (unsigned) fMicros;
+		m_Events.push_back (Event);
+	}
+
+	m_TrackEvents.clear ();
+
+	return true;
+}
+
+const std::vector<CMIDIFile::TEvent> &CMIDIFile::GetEvents (void) const
+{
+	return m_Events;
+}
+
+bool CMIDIFile::ParseTrack (const uint8_t *pData, size_t nLength, unsigned nTrack)
+{
+	size_t i = 0;
+	unsigned nTick = 0;
+	unsigned nOrder = 0;
+	uint8_t uchRunningStatus = 0;
+
+	while (i < nLength)
+	{
+		unsigned nDelta;
+		if (!ReadVLQ (pData, nLength, &i, &nDelta))
+		{
+			return false;
+		}
+
+		nTick += nDelta;
+
+		if (i >= nLength)
+		{
+			return false;
+		}
+
+		uint8_t uchStatus = pData[i];
+		if (uchStatus == 0xFF)				// meta event
+		{
+			if (i + 2 > nLength)
+			{
+				return false;
+			}
+
+			uint8_t uchType = pData[i+1];
+			i += 2;
+
+			unsigned nMetaLength;
+			if (   !ReadVLQ (pData, nLength, &i, &nMetaLength)
+			    || i + nMetaLength > nLength)
+			{
+				return false;
+			}
+
+			if (uchType == 0x51 && nMetaLength == 3)
+			{
+				TTrackEvent Event {nTick, nTrack, nOrder++, ReadBE (&pData[i], 3), {}};
+				m_TrackEvents.push_back (Event);
+			}
+			else if (uchType == 0x2F)		// end of track
+			{
+				break;
+			}
+
+			i += nMetaLength;
+		}
+		else if (uchStatus == 0xF0 || uchStatus == 0xF7)	// SysEx is ignored
+		{
+			i++;
+
+			unsigned nSysExLength;
+			if (!ReadVLQ (pData, nLength, &i, &nSysExLength))
+			{
+				return false;
+			}
+
+			i += nSysExLength;
+		}
+		else
+		{
+			if (uchStatus & 0x80)
+			{
+				uchRunningStatus = uchStatus;
+				i++;
+			}
+			else if (!uchRunningStatus)
+			{
+				return false;
+			}
+
+			unsigned nDataBytes = (uchRunningStatus & 0xE0) == 0xC0 ? 1 : 2;
+			if (i + nDataBytes > nLength)
+			{
+				return false;
+			}
+
+			TTrackEvent Event {nTick, nTrack, nOrder++, 0, {}};
+			Event.Event.Message[0] = uchRunningStatus;
+			Event.Event.Message[1] = pData[i];
+			Event.Event.Message[2] = nDataBytes > 1 ? pData[i+1] : 0;
+			Event.Event.nLength = 1 + nDataBytes;
+			m_TrackEvents.push_back (Event);
+
+			i += nDataBytes;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,59 @@
+//
+// midifile.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _midifile_h
+#define _midifile_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+class CMIDIFile		// Reader for Standard MIDI Files (format 0 and 1)
+{
+public:
+	struct TEvent
+	{
+		unsigned	nMicros;	// from start of song
+		uint8_t		Message[3];	// channel voice messages only
+		unsigned	nLength;
+	};
+
+public:
+	bool Load (const char *pFileName);
+
+	const std::vector<TEvent> &GetEvents (void) const;
+
+private:
+	bool ParseTrack (const uint8_t *pData, size_t nLength, unsigned nTrack);
+
+private:
+	struct TTrackEvent
+	{
+		unsigned	nTick;
+		unsigned	nTrack;
+		unsigned	nOrder;		// within the track
+		unsigned	nTempo;		// microseconds per quarter note, 0 for MIDI events
+		TEvent		Event;
+	};
+
+	std::vector<TTrackEvent> m_TrackEvents;
+	std::vector<TEvent> m_Events;
+};
+
+#endif
@@ -0,0 +1,241 @@
+//
+// properties.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Host implementation of the Properties stand-in (see
+// include/Properties/propertiesfatfsfile.h)
+//
+#include <Properties/propertiesfatfsfile.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+CPropertiesFatFsFile::CPropertiesFatFsFile (const char *pFileName, FATFS *pFileSystem)
+:	m_FileName (pFileName)
+{
+}
+
+CPropertiesFatFsFile::~CPropertiesFatFsFile (void)
+{
+}
+
+boolean CPropertiesFatFsFile::Load (void)
+{
+	RemoveAll ();
+
+	FIL File;
+	if (f_open (&File, m_FileName.c_str (), FA_READ | FA_OPEN_EXISTING) != FR_OK)
+	{
+		return FALSE;
+	}
+
+	std::string Text (f_size (&File), '\0');
+	UINT nBytesRead;
+	FRESULT Result = f_read (&File, &Text[0], Text.size (), &nBytesRead);
+	f_close (&File);
+	if (   Result != FR_OK
+	    || nBytesRead != Text.size ())
+	{
+		return FALSE;
+	}
+
+	size_t nPos = 0;
+	while (nPos < Text.size ())
+	{
+		size_t nEnd = Text.find ('\n', nPos);
+		if (nEnd == std::string::npos)
+		{
+			nEnd = Text.size ();
+		}
+
+		std::string Line = Text.substr (nPos, nEnd - nPos);
+		nPos = nEnd + 1;
+
+		while (   !Line.empty ()
+		       && (Line.back () == '\r' || Line.back () == ' ' || Line.back () == '\t'))
+		{
+			Line.pop_back ();
+		}
+
+		size_t nEqual = Line.find ('=');
+		if (   Line.empty ()
+		    || Line[0] == '#'
+		    || nEqual == std::string::npos
+		    || nEqual == 0)
+		{
+			continue;
+		}
+
+		SetString (Line.substr (0, nEqual).c_str (), Line.substr (nEqual + 1).c_str ());
+	}
+
+	return TRUE;
+}
+
+boolean CPropertiesFatFsFile::Save (void)
+{
+	std::string Text;
+	for (auto &rProperty : m_Properties)
+	{
+		Text += rProperty.first + "=" + rProperty.second + "\n";
+	}
+
+	FIL File;
+	if (f_open (&File, m_FileName.c_str (), FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)
+	{
+		return FALSE;
+	}
+
+	UINT nBytesWritten;
+	FRESULT Result = f_write (&File, Text.data (), Text.size (), &nBytesWritten);
+
+	return    f_close (&File) == FR_OK
+	       && Result == FR_OK;
+}
+
+void CPropertiesFatFsFile::RemoveAll (void)
+{
+	m_Properties.clear ();
+}
+
+boolean CPropertiesFatFsFile::IsSet (const char *pPropertyName) const
+{
+	return Find (pPropertyName) != nullptr;
+}
+
+const char *CPropertiesFatFsFile::GetString (const char *pPropertyName, const char *pDefault) const
+{
+	const std::string *pValue = Find (pPropertyName);
+
+	return pValue ? pValue->c_str () : pDefault;
+}
+
+unsigned CPropertiesFatFsFile::GetNumber (const char *pPropertyName, unsigned nDefault) const
+{
+	const std::string *pValue = Find (pPropertyName);
+	if (   !pValue
+	    || pValue->empty ())
+	{
+		return nDefault;
+	}
+
+	const char *pString = pValue->c_str ();
+	int nBase = 10;
+	if (   pString[0] == '0'
+	    && (pString[1] == 'x' || pString[1] == 'X'))
+	{
+		pString += 2;
+		nBase = 16;
+	}
+
+	char *pEnd;
+	unsigned long nValue = strtoul (pString, &pEnd, nBase);
+
+	return *pString && !*pEnd ? (unsigned) nValue : nDefault;
+}
+
+int CPropertiesFatFsFile::GetSignedNumber (const char *pPropertyName, int nDefault) const
+{
+	const std::string *pValue = Find (pPropertyName);
+	if (   !pValue
+	    || pValue->empty ())
+	{
+		return nDefault;
+	}
+
+	char *pEnd;
+	long nValue = strtol (pValue->c_str (), &pEnd, 10);
+
+	return !*pEnd ? (int) nValue : nDefault;
+}
+
+const u8 *CPropertiesFatFsFile::GetIPAddress (const char *pPropertyName) const
+{
+	const std::string *pValue = Find (pPropertyName);
+	if (!pValue)
+	{
+		return nullptr;
+	}
+
+	unsigned nByte[4];
+	char chEnd;
+	if (sscanf (pValue->c_str (), "%u.%u.%u.%u%c", &nByte[0], &nByte[1],
+		    &nByte[2], &nByte[3], &chEnd) != 4)
+	{
+		return nullptr;
+	}
+
+	for (unsigned i = 0; i < 4; i++)
+	{
+		if (nByte[i] > 255)
+		{
+			return nullptr;
+		}
+
+		m_IPAddress[i] = nByte[i];
+	}
+
+	return m_IPAddress;
+}
+
+void CPropertiesFatFsFile::SetString (const char *pPropertyName, const char *pValue)
+{
+	for (auto &rProperty : m_Properties)
+	{
+		if (rProperty.first == pPropertyName)
+		{
+			rProperty.second = pValue;
+
+			return;
+		}
+	}
+
+	m_Properties.emplace_back (pPropertyName, pValue);
+}
+
+void CPropertiesFatFsFile::SetNumber (const char *pPropertyName, unsigned nValue, unsigned nBase)
+{
+	assert (nBase == 10 || nBase == 16);
+
+	char Buffer[20];
+	snprintf (Buffer, sizeof Buffer, nBase == 16 ? "0x%X" : "%u", nValue);
+
+	SetString (pPropertyName, Buffer);
+}
+
+void CPropertiesFatFsFile::SetSignedNumber (const char *pPropertyName, int nValue)
+{
+	char Buffer[20];
+	snprintf (Buffer, sizeof Buffer, "%d", nValue);
+
+	SetString (pPropertyName, Buffer);
+}
+
+const std::string *CPropertiesFatFsFile::Find (const char *pPropertyName) const
+{
+	for (auto &rProperty : m_Properties)
+	{
+		if (rProperty.first == pPropertyName)
+		{
+			return &rProperty.second;
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,45 @@
+//
+// midiparser_ref.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Reference copy of the serial MIDI parser of CSerialMIDIDevice::Process()
+// before CMIDIParser, for comparisons on the host. The parsing is unchanged,
+// only the state is moved into this class with the interface of CMIDIParser.
+//
+#ifndef _midiparser_ref_h
+#define _midiparser_ref_h
+
+#include <midiparser.h>
+
+class CMIDIParserRef
+{
+public:
+	CMIDIParserRef (CMIDIParser::TMessageHandler *pHandler, void *pParam);
+
+	void Parse (const u8 *pData, size_t nLength, unsigned nTimestamp);
+
+private:
+	CMIDIParser::TMessageHandler *m_pHandler;
+	void *m_pParam;
+
+	unsigned m_nSerialState;
+	unsigned m_nSysEx;
+	u8 m_SerialMessage[MAX_MIDI_MESSAGE];
+};
+
+#endif
@@ -0,0 +1,161 @@
+//
+// render.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//
+// Offline renderer for the MiniDexed sound engine on the host (Linux). It
+// plays a Standard MIDI File through CMiniDexed, configured by minidexed.ini
+// and performance.ini as on the target, and writes its output to a 24-bit
+// stereo WAV file. The output includes the latency of the sound device queue
+// and of the output lookahead.
+//
+// Usage: minidexed-render [options] input.mid output.wav
+//	-d directory		SD card contents (default: current directory)
+//	-l seconds		time after the last event (default: 2)
+//
+#include "hostsystem.h"
+#include "midifile.h"
+#include <circle/types.h>
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void WriteLE (FILE *pFile, unsigned nValue, unsigned nBytes)
+{
+	for (unsigned i = 0; i < nBytes; i++)
+	{
+		fputc ((nValue >> (8 * i)) & 0xFF, pFile);
+	}
+}
+
+static void WriteWAVHeader (FILE *pFile, unsigned nSampleRate, unsigned nFrames)
+{
+	unsigned nDataSize = nFrames * 2 * 3;
+
+	fwrite ("RIFF", 1, 4, pFile);
+	WriteLE (pFile, 36 + nDataSize, 4);
+	fwrite ("WAVEfmt ", 1, 8, pFile);
+	WriteLE (pFile, 16, 4);
+	WriteLE (pFile, 1, 2);			// PCM
+	WriteLE (pFile, 2, 2);			// stereo
+	WriteLE (pFile, nSampleRate, 4);
+	WriteLE (pFile, nSampleRate * 2 * 3, 4);
+	WriteLE (pFile, 2 * 3, 2);
+	WriteLE (pFile, 24, 2);
+	fwrite ("data", 1, 4, pFile);
+	WriteLE (pFile, nDataSize, 4);
+}
+
+static void Usage (void)
+{
+	fprintf (stderr, "Usage: minidexed-render [-d sdcard] [-l tail] input.mid output.wav\n");
+	exit (1);
+}
+
+int main (int argc, char **argv)
+{
+	const char *pSDCard = ".";
+	unsigned nTailSeconds = 2;
+
+	int nOption;
+	while ((nOption = getopt (argc, argv, "d:l:")) != -1)
+	{
+		switch (nOption)
+		{
+		case 'd':	pSDCard = optarg;			break;
+		case 'l':	nTailSeconds = atoi (optarg);		break;
+		default:	Usage ();
+		}
+	}
+
+	if (optind + 2 != argc)
+	{
+		Usage ();
+	}
+
+	CMIDIFile MIDIFile;
+	if (!MIDIFile.Load (argv[optind]))
+	{
+		return 1;
+	}
+
+	FILE *pOutput = fopen (argv[optind+1], "wb");
+	if (!pOutput)
+	{
+		fprintf (stderr, "%s: Cannot create file\n", argv[optind+1]);
+
+		return 1;
+	}
+
+	CHostSystem System (pSDCard);
+	if (!System.Initialize ())
+	{
+		return 1;
+	}
+
+	unsigned nSampleRate = System.GetSampleRate ();
+	unsigned nFrames = System.GetChunkFrames ();
+
+	WriteWAVHeader (pOutput, nSampleRate, 0);	// updated at the end
+
+	const std::vector<CMIDIFile::TEvent> &rEvents = MIDIFile.GetEvents ();
+	unsigned nEndMicros = (rEvents.empty () ? 0 : rEvents.back ().nMicros)
+			      + nTailSeconds * 1000000;
+
+	std::vector<s32> Buffer (nFrames * 2);
+
+	auto StartTime = std::chrono::steady_clock::now ();
+
+	unsigned nEvent = 0;
+	unsigned nFramesWritten = 0;
+	while (nFramesWritten < (u64) nEndMicros * nSampleRate / 1000000)
+	{
+		// the events until the end of the next chunk
+		for (; nEvent < rEvents.size () && rEvents[nEvent].nMicros <= System.GetClockTicks (); nEvent++)
+		{
+			const CMIDIFile::TEvent &rEvent = rEvents[nEvent];
+
+			System.GetMIDIDevice ()->Receive (rEvent.Message, rEvent.nLength, rEvent.nMicros);
+		}
+
+		System.Tick (Buffer.data ());
+
+		for (unsigned i = 0; i < nFrames * 2; i++)
+		{
+			WriteLE (pOutput, Buffer[i], 3);
+		}
+
+		nFramesWritten += nFrames;
+	}
+
+	double fWallSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - StartTime).count ();
+	double fAudioSeconds = (double) nFramesWritten / nSampleRate;
+
+	fseek (pOutput, 0, SEEK_SET);
+	WriteWAVHeader (pOutput, nSampleRate, nFramesWritten);
+	fclose (pOutput);
+
+	printf ("%.2f s of audio rendered in %.2f s (%.1fx real time)\n",
+		fAudioSeconds, fWallSeconds, fWallSeconds > 0.0 ? fAudioSeconds / fWallSeconds : 0.0);
+
+	// the secondary cores do not return
+	fflush (stdout);
+	_exit (0);
+}
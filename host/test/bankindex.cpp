@@ -0,0 +1,240 @@
+//
+// bankindex.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Bank index of the voice directory tree: A synthetic tree with subdirectories,
+// duplicate bank numbers and invalid files is loaded with a full scan, which
+// writes the index, and reloaded from the index. The banks, names and voices
+// must be the same as with a full scan, with all banks in memory or read on
+// demand. A changed tree, a corrupt index or other load options must lead to
+// a new scan.
+//
+#include "test.h"
+#include "testsdcard.h"
+#include <sysexfileloader.h>
+#include <sdcard.h>
+#include <string>
+#include <stdio.h>
+#include <unistd.h>
+#include <utime.h>
+
+#define CACHE_SIZE	4
+
+// everything, which can be read from the loader
+static std::string Snapshot (CSysExFileLoader *pLoader)
+{
+	std::string Result;
+
+	for (unsigned nBankID = 0; nBankID <= CSysExFileLoader::MaxVoiceBankID; nBankID++)
+	{
+		if (!pLoader->IsValidBank (nBankID))
+		{
+			continue;
+		}
+
+		Result += std::to_string (nBankID) + " " + pLoader->GetBankName (nBankID) + "\n";
+
+		for (unsigned nVoice = 0; nVoice < CSysExFileLoader::VoicesPerBank; nVoice++)
+		{
+			uint8_t Voice[CSysExFileLoader::SizeSingleVoice];
+			pLoader->GetVoice (nBankID, nVoice, Voice);
+
+			Result += pLoader->GetVoiceName (nBankID, nVoice) + " ";
+			Result.append ((const char *) Voice, sizeof Voice);
+			Result += "\n";
+		}
+	}
+
+	return Result;
+}
+
+static std::string Load (bool bHeaderless, unsigned nCacheSize)
+{
+	CSysExFileLoader Loader;
+	Loader.Load (bHeaderless, nCacheSize);
+
+	return Snapshot (&Loader);
+}
+
+static std::string GetVoiceName (unsigned nBankID, unsigned nVoice)
+{
+	CSysExFileLoader Loader;
+	Loader.Load (false, CACHE_SIZE);
+
+	return Loader.GetVoiceName (nBankID, nVoice);
+}
+
+static unsigned CountBanks (void)
+{
+	CSysExFileLoader Loader;
+	Loader.Load (false, CACHE_SIZE);
+
+	unsigned nBanks = 0;
+	for (unsigned nBankID = 0; nBankID <= CSysExFileLoader::MaxVoiceBankID; nBankID++)
+	{
+		nBanks += Loader.IsValidBank (nBankID);
+	}
+
+	return nBanks;
+}
+
+static void MoveFile (const std::string &From, const std::string &To)
+{
+	if (rename (From.c_str (), To.c_str ()) != 0)
+	{
+		perror (To.c_str ());
+		exit (1);
+	}
+}
+
+// modifies a file in place and keeps its size and time, as on FAT, where the
+// time may not be updated
+static void PatchFile (const std::string &FileName, long nOffset, const void *pData, size_t nLength,
+		       bool bKeepTime)
+{
+	struct stat Stat;
+	CHECK (stat (FileName.c_str (), &Stat) == 0);
+
+	FILE *pFile = fopen (FileName.c_str (), "r+b");
+	CHECK (pFile != nullptr);
+	fseek (pFile, nOffset, SEEK_SET);
+	fwrite (pData, 1, nLength, pFile);
+	fclose (pFile);
+
+	utimbuf Time;
+	Time.actime = Stat.st_atime;
+	Time.modtime = bKeepTime ? Stat.st_mtime : Stat.st_mtime + 10;
+	CHECK (utime (FileName.c_str (), &Time) == 0);
+}
+
+int main (void)
+{
+	std::string SDCard = CreateTestSDCard ();
+	HostSetSDCard (SDCard.c_str ());
+
+	std::string VoiceDir = SDCard + "/sysex/voice";
+	std::string IndexFile = SDCard + "/sysex/bankindex.bin";
+
+	char Name[20];
+	for (unsigned nBank = 1; nBank <= 40; nBank++)
+	{
+		snprintf (Name, sizeof Name, "ROOT%03u", nBank);
+		WriteTestBank (SDCard, nBank, Name);
+	}
+
+	mkdir ((VoiceDir + "/sub").c_str (), 0755);
+	mkdir ((VoiceDir + "/sub/deeper").c_str (), 0755);
+	for (unsigned nBank = 100; nBank < 110; nBank++)
+	{
+		snprintf (Name, sizeof Name, "SUB%03u", nBank);
+		std::string FileName = WriteTestBank (SDCard, nBank, Name);
+		MoveFile (FileName, VoiceDir + "/sub/" + FileName.substr (VoiceDir.length () + 1));
+	}
+	for (unsigned nBank = 200; nBank < 205; nBank++)
+	{
+		snprintf (Name, sizeof Name, "DEEP%03u", nBank);
+		std::string FileName = WriteTestBank (SDCard, nBank, Name);
+		MoveFile (FileName, VoiceDir + "/sub/deeper/" + FileName.substr (VoiceDir.length () + 1));
+	}
+
+	// a second bank #3, only one of them is used
+	std::string FileName = WriteTestBank (SDCard, 3, "DUP");
+	MoveFile (FileName, VoiceDir + "/sub/000003_DUP.syx");
+
+	// invalid files: too short, wrong end byte, no bank file
+	FileName = WriteTestBank (SDCard, 50, "SHORT");
+	CHECK (truncate (FileName.c_str (), 4000) == 0);
+	FileName = WriteTestBank (SDCard, 51, "BADEND");
+	PatchFile (FileName, sizeof (CSysExFileLoader::TVoiceBank) - 1, "\x00", 1, false);
+	FILE *pFile = fopen ((VoiceDir + "/readme.txt").c_str (), "w");
+	fputs ("no bank\n", pFile);
+	fclose (pFile);
+
+	// a bank without header, only valid with bHeaderless
+	FileName = WriteTestBank (SDCard, 60, "NOHDR");
+	{
+		FILE *pIn = fopen (FileName.c_str (), "rb");
+		uint8_t Bank[4104];
+		CHECK (fread (Bank, sizeof Bank, 1, pIn) == 1);
+		fclose (pIn);
+
+		FILE *pOut = fopen (FileName.c_str (), "wb");
+		fwrite (Bank + 6, 1, 4096, pOut);
+		fclose (pOut);
+	}
+
+	// full scan with all banks in memory, writes the index
+	std::string Reference = Load (false, 0);
+	CHECK (access (IndexFile.c_str (), F_OK) == 0);
+	CHECK (Reference.find ("ROOT040") != std::string::npos);
+	CHECK (Reference.find ("SUB109") != std::string::npos);
+	CHECK (Reference.find ("DEEP204") != std::string::npos);
+	CHECK (Reference.find ("SHORT") == std::string::npos);
+	CHECK (Reference.find ("BADEND") == std::string::npos);
+	CHECK (Reference.find ("NOHDR") == std::string::npos);
+	CHECK (CountBanks () == 40 + 10 + 5);
+
+	// full scan with banks read on demand, the voice names are read only
+	CHECK (unlink (IndexFile.c_str ()) == 0);
+	CHECK (Load (false, CACHE_SIZE) == Reference);
+	CHECK (access (IndexFile.c_str (), F_OK) == 0);
+
+	// from the index
+	CHECK (Load (false, CACHE_SIZE) == Reference);
+	CHECK (Load (false, 0) == Reference);
+
+	// the index is used: a changed voice name, which is not visible in the
+	// directory, is not seen
+	std::string Bank7 = VoiceDir + "/000007_ROOT007.syx";
+	long nNameOffset = 6 + 128 - 10;
+	CHECK (GetVoiceName (6, 0) == "ROOT007 00");
+	PatchFile (Bank7, nNameOffset, "CHANGED!!!", 10, true);
+	CHECK (GetVoiceName (6, 0) == "ROOT007 00");
+
+	// a changed file time leads to a new scan
+	PatchFile (Bank7, nNameOffset, "CHANGED!!!", 10, false);
+	CHECK (GetVoiceName (6, 0) == "CHANGED!!!");
+	PatchFile (Bank7, nNameOffset, "ROOT007 00", 10, false);
+	CHECK (GetVoiceName (6, 0) == "ROOT007 00");
+
+	// a new bank
+	WriteTestBank (SDCard, 41, "NEW");
+	std::string Changed = Load (false, CACHE_SIZE);
+	CHECK (Changed.find ("NEW") != std::string::npos);
+	CHECK (Load (false, 0) == Changed);
+	CHECK (unlink (IndexFile.c_str ()) == 0);
+	CHECK (Load (false, 0) == Changed);
+
+	// a corrupt index
+	pFile = fopen (IndexFile.c_str (), "r+b");
+	fseek (pFile, 20, SEEK_SET);
+	fputs ("garbage", pFile);
+	fclose (pFile);
+	CHECK (Load (false, CACHE_SIZE) == Changed);
+	CHECK (Load (false, CACHE_SIZE) == Changed);
+
+	// headerless banks are part of the signature
+	std::string Headerless = Load (true, CACHE_SIZE);
+	CHECK (Headerless.find ("NOHDR") != std::string::npos);
+	CHECK (Load (true, 0) == Headerless);
+	CHECK (Load (false, CACHE_SIZE) == Changed);
+
+	RemoveTestSDCard (SDCard);
+
+	return TestResult ();
+}
@@ -0,0 +1,130 @@
+//
+// fxparameters.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Stress test of the global effect parameters: several threads call
+// SetParameter() for the reverb and the compressor as fast as they can, while
+// the sound engine renders. The audio cores must never wait for a lock, and
+// the last values must be applied at the next chunk.
+//
+#include "test.h"
+#include "testsdcard.h"
+#include "minidexedprobe.h"
+#include <hostsystem.h>
+#include <circle/spinlock.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+
+#define SETTERS		3
+#define CHUNKS		300
+
+static const CMiniDexed::TParameter Parameters[] =
+{
+	CMiniDexed::ParameterCompressorEnable,
+	CMiniDexed::ParameterReverbEnable,
+	CMiniDexed::ParameterReverbSize,
+	CMiniDexed::ParameterReverbHighDamp,
+	CMiniDexed::ParameterReverbLowDamp,
+	CMiniDexed::ParameterReverbLowPass,
+	CMiniDexed::ParameterReverbDiffusion,
+	CMiniDexed::ParameterReverbLevel
+};
+
+static std::atomic<bool> s_bStop (false);
+static std::atomic<unsigned> s_nCalls (0);
+
+static void Setter (CMiniDexed *pMiniDexed, unsigned nSeed)
+{
+	while (!s_bStop)
+	{
+		unsigned nParameter = rand_r (&nSeed) % (sizeof Parameters / sizeof Parameters[0]);
+		pMiniDexed->SetParameter (Parameters[nParameter], rand_r (&nSeed) % 100);
+
+		s_nCalls++;
+	}
+}
+
+int main (void)
+{
+	std::string SDCard = CreateTestSDCard ();
+
+	CHostSystem System (SDCard.c_str ());
+	if (!System.Initialize ())
+	{
+		return 1;
+	}
+
+	CMiniDexed *pMiniDexed = System.GetMiniDexed ();
+
+	unsigned nWaits[CORES];
+	for (unsigned nCore = 0; nCore < CORES; nCore++)
+	{
+		nWaits[nCore] = CSpinLock::GetWaits (nCore);
+	}
+
+	std::vector<std::thread> Setters;
+	for (unsigned i = 0; i < SETTERS; i++)
+	{
+		Setters.emplace_back (Setter, pMiniDexed, i + 1);
+	}
+
+	// keep a note sounding, so that the TGs and the reverb are busy
+	u8 NoteOn[] = {0x90, 60, 100};
+	System.GetMIDIDevice ()->Receive (NoteOn, sizeof NoteOn, System.GetClockTicks ());
+
+	std::vector<s32> Buffer (System.GetChunkFrames () * 2);
+	for (unsigned nChunk = 0; nChunk < CHUNKS; nChunk++)
+	{
+		System.Tick (Buffer.data ());
+	}
+
+	s_bStop = true;
+	for (std::thread &rSetter : Setters)
+	{
+		rSetter.join ();
+	}
+
+	printf ("%u calls of SetParameter() during %u chunks\n", s_nCalls.load (), CHUNKS);
+	CHECK (s_nCalls > CHUNKS);
+
+	// the audio cores (1 to CORES-1) never waited for a lock
+	for (unsigned nCore = 1; nCore < CORES; nCore++)
+	{
+		CHECK (CSpinLock::GetWaits (nCore) == nWaits[nCore]);
+	}
+
+	// the last values are applied before the next chunk
+	pMiniDexed->SetParameter (CMiniDexed::ParameterReverbEnable, 1);
+	pMiniDexed->SetParameter (CMiniDexed::ParameterReverbSize, 42);
+	pMiniDexed->SetParameter (CMiniDexed::ParameterReverbLevel, 99);
+	System.Tick (Buffer.data ());
+
+	AudioEffectPlateReverb *pReverb = CMiniDexedProbe::GetReverb (pMiniDexed);
+	CHECK (!pReverb->get_bypass ());
+	CHECK (pReverb->get_level () == 1.0f);
+
+	pMiniDexed->SetParameter (CMiniDexed::ParameterReverbEnable, 0);
+	System.Tick (Buffer.data ());
+	CHECK (pReverb->get_bypass ());
+
+	RemoveTestSDCard (SDCard);
+
+	TestExit ();
+}
@@ -0,0 +1,301 @@
+//
+// midiparser.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Replay of MIDI byte streams through CMIDIParser: SysEx, running status and
+// System Real Time bytes interleaved anywhere, split into arbitrary reads.
+// Random streams, which the previous serial parser handled correctly, must
+// give the same messages as with it. The intended differences are checked
+// separately: a status byte ends an incomplete SysEx and starts its own
+// message, System Common messages are passed on and cancel the running
+// status, and an overlong SysEx is discarded up to its end.
+//
+#include "test.h"
+#include <midiparser.h>
+#include <reference/midiparser_ref.h>
+#include <vector>
+#include <stdlib.h>
+
+typedef std::vector<u8> TBytes;
+typedef std::vector<TBytes> TMessages;
+
+struct TReplay
+{
+	TMessages		Messages;
+	std::vector<unsigned>	Timestamps;
+};
+
+static void MessageHandler (const u8 *pMessage, size_t nLength, unsigned nTimestamp, void *pParam)
+{
+	TReplay *pReplay = (TReplay *) pParam;
+
+	pReplay->Messages.push_back (TBytes (pMessage, pMessage + nLength));
+	pReplay->Timestamps.push_back (nTimestamp);
+}
+
+// parses the stream in reads of up to nMaxRead bytes (0: all at once)
+template <class TParser>
+static TMessages Replay (const TBytes &rStream, unsigned nMaxRead = 0)
+{
+	TReplay Replay;
+	TParser Parser (MessageHandler, &Replay);
+
+	size_t nPos = 0;
+	while (nPos < rStream.size ())
+	{
+		size_t nRead = rStream.size () - nPos;
+		if (nMaxRead)
+		{
+			nRead = std::min (nRead, (size_t) (1 + rand () % nMaxRead));
+		}
+
+		Parser.Parse (&rStream[nPos], nRead, 0);
+		nPos += nRead;
+	}
+
+	return Replay.Messages;
+}
+
+static TMessages Parse (const TBytes &rStream)
+{
+	TMessages Messages = Replay<CMIDIParser> (rStream);
+
+	// the reads do not matter
+	CHECK (Replay<CMIDIParser> (rStream, 1) == Messages);
+	CHECK (Replay<CMIDIParser> (rStream, 7) == Messages);
+
+	return Messages;
+}
+
+static TMessages ParseOld (const TBytes &rStream)
+{
+	return Replay<CMIDIParserRef> (rStream);
+}
+
+static void TestSysEx (void)
+{
+	TBytes SysEx = {0xF0, 0x43, 0x10, 0x01, 0x02, 0x03, 0xF7};
+	CHECK (Parse (SysEx) == TMessages ({SysEx}));
+	CHECK (ParseOld (SysEx) == TMessages ({SysEx}));
+
+	// two in a row, then a note
+	TBytes Stream = SysEx;
+	Stream.insert (Stream.end (), SysEx.begin (), SysEx.end ());
+	Stream.insert (Stream.end (), {0x90, 0x3C, 0x40});
+	CHECK (Parse (Stream) == TMessages ({SysEx, SysEx, {0x90, 0x3C, 0x40}}));
+
+	// the largest SysEx, which fits
+	TBytes Large = {0xF0};
+	Large.resize (MAX_MIDI_MESSAGE - 1, 0x55);
+	Large.push_back (0xF7);
+	CHECK (Parse (Large) == TMessages ({Large}));
+
+	// the end without a begin is ignored
+	CHECK (Parse ({0x01, 0xF7, 0x02}).empty ());
+}
+
+static void TestRunningStatus (void)
+{
+	CHECK (Parse ({0x90, 0x3C, 0x40, 0x3E, 0x41, 0x40, 0x00})
+	       == TMessages ({{0x90, 0x3C, 0x40}, {0x90, 0x3E, 0x41}, {0x90, 0x40, 0x00}}));
+
+	// one data byte
+	CHECK (Parse ({0xC1, 0x05, 0x06, 0xD2, 0x10, 0x11})
+	       == TMessages ({{0xC1, 0x05}, {0xC1, 0x06}, {0xD2, 0x10}, {0xD2, 0x11}}));
+
+	// data bytes without a status are ignored
+	CHECK (Parse ({0x3C, 0x40, 0xB0, 0x07, 0x64}) == TMessages ({{0xB0, 0x07, 0x64}}));
+
+	// an incomplete message is ended by the next status
+	CHECK (Parse ({0x90, 0x3C, 0x80, 0x3C, 0x00}) == TMessages ({{0x80, 0x3C, 0x00}}));
+
+	// running status continues after System Real Time bytes
+	CHECK (Parse ({0x90, 0x3C, 0x40, 0xF8, 0x3E, 0x40})
+	       == TMessages ({{0x90, 0x3C, 0x40}, {0xF8}, {0x90, 0x3E, 0x40}}));
+}
+
+static void TestRealTime (void)
+{
+	// inside of a message
+	CHECK (Parse ({0x90, 0xF8, 0x3C, 0xFE, 0x40})
+	       == TMessages ({{0xF8}, {0xFE}, {0x90, 0x3C, 0x40}}));
+
+	// inside of a SysEx
+	CHECK (Parse ({0xF0, 0x43, 0xFA, 0x01, 0xFC, 0xF7})
+	       == TMessages ({{0xFA}, {0xFC}, {0xF0, 0x43, 0x01, 0xF7}}));
+
+	// all System Real Time bytes
+	for (u8 uchStatus : {0xF8, 0xFA, 0xFB, 0xFC, 0xFE, 0xFF})
+	{
+		CHECK (Parse ({uchStatus}) == TMessages ({{uchStatus}}));
+	}
+}
+
+// the intended differences to the previous parser
+static void TestDifferences (void)
+{
+	// a status byte ends an incomplete SysEx and starts its own message
+	TBytes Stream = {0xF0, 0x43, 0x01, 0x90, 0x3C, 0x40};
+	CHECK (Parse (Stream) == TMessages ({{0x90, 0x3C, 0x40}}));
+	CHECK (ParseOld (Stream).empty ());
+
+	// System Common messages are passed on
+	CHECK (Parse ({0xF1, 0x20}) == TMessages ({{0xF1, 0x20}}));
+	CHECK (Parse ({0xF2, 0x01, 0x02}) == TMessages ({{0xF2, 0x01, 0x02}}));
+	CHECK (Parse ({0xF3, 0x05}) == TMessages ({{0xF3, 0x05}}));
+	CHECK (Parse ({0xF6}) == TMessages ({{0xF6}}));
+	CHECK (ParseOld ({0xF1, 0x20, 0xF2, 0x01, 0x02, 0xF3, 0x05, 0xF6}).empty ());
+
+	// and cancel the running status
+	Stream = {0x90, 0x3C, 0x40, 0xF3, 0x05, 0x3E, 0x40};
+	CHECK (Parse (Stream) == TMessages ({{0x90, 0x3C, 0x40}, {0xF3, 0x05}}));
+	CHECK (Parse ({0x90, 0x3C, 0x40, 0xF6, 0x3E, 0x40})
+	       == TMessages ({{0x90, 0x3C, 0x40}, {0xF6}}));
+
+	// a SysEx cancels the running status too
+	Stream = {0x90, 0x3C, 0x40, 0xF0, 0x01, 0xF7, 0x3E, 0x40};
+	CHECK (Parse (Stream) == TMessages ({{0x90, 0x3C, 0x40}, {0xF0, 0x01, 0xF7}}));
+	CHECK (ParseOld (Stream) != Parse (Stream));
+
+	// undefined status bytes are ignored and cancel the running status
+	CHECK (Parse ({0x90, 0x3C, 0x40, 0xF4, 0x3E, 0x40, 0xFD, 0xF5})
+	       == TMessages ({{0x90, 0x3C, 0x40}}));
+
+	// an overlong SysEx is discarded up to its end
+	Stream = {0xF0};
+	Stream.resize (MAX_MIDI_MESSAGE + 10, 0x55);
+	Stream.insert (Stream.end (), {0xF7, 0x90, 0x3C, 0x40});
+	CHECK (Parse (Stream) == TMessages ({{0x90, 0x3C, 0x40}}));
+}
+
+static void TestReset (void)
+{
+	TReplay Replay;
+	CMIDIParser Parser (MessageHandler, &Replay);
+
+	static const u8 Partial[] = {0x90, 0x3C};
+	Parser.Parse (Partial, sizeof Partial, 1000);
+	Parser.Reset ();
+
+	// no running status after a reset, the timestamp of the read is passed
+	static const u8 Rest[] = {0x40, 0x3E, 0x40, 0xB0, 0x07, 0x64};
+	Parser.Parse (Rest, sizeof Rest, 1234);
+	CHECK (Replay.Messages == TMessages ({{0xB0, 0x07, 0x64}}));
+	CHECK (Replay.Timestamps == std::vector<unsigned> ({1234}));
+}
+
+// Random streams, which the previous parser handles correctly: complete or
+// interrupted channel messages with and without running status, and SysEx
+// followed by a new status, with System Real Time bytes anywhere.
+static TBytes RandomStream (unsigned nMessages)
+{
+	static const u8 DataBytes[7] = {2, 2, 2, 2, 1, 1, 2};
+	static const u8 RealTime[] = {0xF8, 0xFA, 0xFB, 0xFC, 0xFE, 0xFF};
+
+	TBytes Stream;
+	auto Add = [&Stream] (u8 uchByte)
+	{
+		if (rand () % 10 == 0)
+		{
+			Stream.push_back (RealTime[rand () % sizeof RealTime]);
+		}
+
+		Stream.push_back (uchByte);
+	};
+
+	// garbage before the first status
+	for (unsigned i = rand () % 3; i > 0; i--)
+	{
+		Add (rand () % 0x80);
+	}
+
+	unsigned nRunningDataBytes = 0;
+	bool bStatus = false;
+	for (unsigned n = 0; n < nMessages; n++)
+	{
+		if (rand () % 8 == 0)
+		{
+			Add (0xF0);
+			for (unsigned i = rand () % 40; i > 0; i--)
+			{
+				Add (rand () % 0x80);
+			}
+			Add (0xF7);
+
+			bStatus = false;		// the previous parser needs a new one
+
+			continue;
+		}
+
+		if (!bStatus || rand () % 2 == 0)
+		{
+			u8 uchStatus = 0x80 | (rand () % 7) << 4 | rand () % 16;
+			Add (uchStatus);
+			bStatus = true;
+
+			nRunningDataBytes = DataBytes[(uchStatus >> 4) & 7];
+		}
+
+		// sometimes incomplete, a new status follows then
+		unsigned nDataBytes = nRunningDataBytes;
+		if (rand () % 10 == 0)
+		{
+			nDataBytes--;
+			bStatus = false;
+		}
+
+		for (unsigned i = 0; i < nDataBytes; i++)
+		{
+			Add (rand () % 0x80);
+		}
+	}
+
+	return Stream;
+}
+
+static void TestRandom (void)
+{
+	unsigned nMessages = 0;
+
+	for (unsigned nRun = 0; nRun < 2000; nRun++)
+	{
+		TBytes Stream = RandomStream (50);
+
+		TMessages Messages = Replay<CMIDIParser> (Stream);
+		CHECK (Replay<CMIDIParser> (Stream, 5) == Messages);
+		CHECK (ParseOld (Stream) == Messages);
+
+		nMessages += Messages.size ();
+	}
+
+	printf ("2000 random streams with %u messages compared\n", nMessages);
+}
+
+int main (void)
+{
+	srand (1);
+
+	TestSysEx ();
+	TestRunningStatus ();
+	TestRealTime ();
+	TestDifferences ();
+	TestReset ();
+	TestRandom ();
+
+	return TestResult ();
+}
@@ -0,0 +1,266 @@
+//
+// midiroutes.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// MIDI routes: The parser of MIDIThru and MIDIRoute1..8 in minidexed.ini,
+// including the warnings for invalid routes and filters, and the forwarding
+// of the messages, which are received by the host MIDI device, through the
+// channel and type filters to devices, which are added later.
+//
+#include "test.h"
+#include "testsdcard.h"
+#include <hostsystem.h>
+#include <config.h>
+#include <mididevice.h>
+#include <sdcard.h>
+#include <circle/synchronize.h>
+#include <circle/timer.h>
+#include <fatfs/ff.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+typedef std::vector<u8> TBytes;
+typedef std::vector<TBytes> TMessages;
+
+// loads the configuration with the given settings, returns the warnings
+static std::string LoadConfig (CConfig *pConfig, const char *pSettings)
+{
+	std::string SDCard = CreateTestSDCard (pSettings);
+	HostSetSDCard (SDCard.c_str ());
+
+	fflush (stderr);
+	int nStdErr = dup (STDERR_FILENO);
+	FILE *pLog = tmpfile ();
+	dup2 (fileno (pLog), STDERR_FILENO);
+
+	pConfig->Load ();
+
+	fflush (stderr);
+	dup2 (nStdErr, STDERR_FILENO);
+	close (nStdErr);
+
+	std::string Log;
+	rewind (pLog);
+	int nChar;
+	while ((nChar = fgetc (pLog)) != EOF)
+	{
+		Log += (char) nChar;
+	}
+	fclose (pLog);
+
+	RemoveTestSDCard (SDCard);
+
+	fputs (Log.c_str (), stderr);
+
+	return Log;
+}
+
+static bool Contains (const std::string &rLog, const char *pText)
+{
+	return rLog.find (pText) != std::string::npos;
+}
+
+static void TestParser (void)
+{
+	FATFS FileSystem;
+
+	// MIDIThru and all eight routes
+	{
+		CConfig Config (&FileSystem);
+		std::string Log = LoadConfig (&Config,
+			"MIDIThru=umidi1,ttyS1\n"
+			"MIDIRoute1=ttyS1,umidi1\n"
+			"MIDIRoute2=umidi1,umidi2,10\n"
+			"MIDIRoute3=umidi2,umidi1, 1-4 / 16 ,note/pb\n"
+			"MIDIRoute4=umidi3,udp,*,sysex/common/realtime\n"
+			"MIDIRoute5=udp,umidi3,,cc/pc/at\n"
+			"MIDIRoute6=umidi4,ttyS1,2/2-3\n"
+			"MIDIRoute7=ttyS1,umidi4\n"
+			"MIDIRoute8=umidi1,umidi4,16,realtime\n");
+		CHECK (!Contains (Log, "warning"));
+
+		CHECK (Config.GetMIDIRoutes () == CConfig::MaxMIDIRoutes);
+		CHECK (Config.GetMIDIRoutes () == 9);
+
+		CHECK (std::string (Config.GetMIDIRouteIn (0)) == "umidi1");
+		CHECK (std::string (Config.GetMIDIRouteOut (0)) == "ttyS1");
+		CHECK (Config.GetMIDIRouteChannels (0) == 0xFFFF);
+		CHECK (Config.GetMIDIRouteTypes (0) == CConfig::MIDIRouteAllTypes);
+
+		CHECK (Config.GetMIDIRouteChannels (1) == 0xFFFF);
+		CHECK (Config.GetMIDIRouteChannels (2) == 1U << 9);
+		CHECK (Config.GetMIDIRouteTypes (2) == CConfig::MIDIRouteAllTypes);
+		CHECK (Config.GetMIDIRouteChannels (3) == (0xFU | 1U << 15));
+		CHECK (Config.GetMIDIRouteTypes (3) == (CConfig::MIDIRouteNotes | CConfig::MIDIRoutePitchBend));
+		CHECK (Config.GetMIDIRouteChannels (4) == 0xFFFF);
+		CHECK (Config.GetMIDIRouteTypes (4) == (  CConfig::MIDIRouteSysEx
+							| CConfig::MIDIRouteSystemCommon
+							| CConfig::MIDIRouteRealTime));
+		CHECK (Config.GetMIDIRouteChannels (5) == 0xFFFF);
+		CHECK (Config.GetMIDIRouteTypes (5) == (  CConfig::MIDIRouteCC
+							| CConfig::MIDIRouteProgramChange
+							| CConfig::MIDIRouteAftertouch));
+		CHECK (Config.GetMIDIRouteChannels (6) == 0b110);
+
+		// the last one
+		CHECK (std::string (Config.GetMIDIRouteIn (8)) == "umidi1");
+		CHECK (std::string (Config.GetMIDIRouteOut (8)) == "umidi4");
+		CHECK (Config.GetMIDIRouteChannels (8) == 1U << 15);
+		CHECK (Config.GetMIDIRouteTypes (8) == CConfig::MIDIRouteRealTime);
+	}
+
+	// invalid routes are ignored, invalid filter items ignored or clamped
+	{
+		CConfig Config (&FileSystem);
+		std::string Log = LoadConfig (&Config,
+			"MIDIThru=umidi1,umidi1\n"
+			"MIDIRoute1=ttyS1,ttyS1\n"
+			"MIDIRoute2=ttyS1\n"
+			"MIDIRoute3=,umidi1\n"
+			"MIDIRoute4=umidi1,umidi2,0-3/x/5/7-/9-8/17,note/foo\n"
+			"MIDIRoute5=umidi1,umidi2,14-20\n"
+			"MIDIRoute6=umidi1,umidi2,0/17-20\n"
+			"MIDIRoute7=umidi1,umidi2,*,foo/bar\n"
+			"MIDIRoute8=umidi1,umidi2,3x\n");
+
+		CHECK (std::string (Config.GetMIDIThruIn ()).empty ());
+		CHECK (Contains (Log, "MIDIThru: Input and output are the same device (umidi1)"));
+		CHECK (Contains (Log, "MIDIRoute1: Input and output are the same device (ttyS1)"));
+		CHECK (Contains (Log, "MIDIRoute2: Input and output device required"));
+		CHECK (Contains (Log, "MIDIRoute3: Input and output device required"));
+
+		CHECK (Contains (Log, "MIDIRoute4: Channel \"0-3\" clamped to 1-16"));
+		CHECK (Contains (Log, "MIDIRoute4: Invalid channel \"x\" ignored"));
+		CHECK (Contains (Log, "MIDIRoute4: Invalid channel \"7-\" ignored"));
+		CHECK (Contains (Log, "MIDIRoute4: Invalid channel \"9-8\" ignored"));
+		CHECK (Contains (Log, "MIDIRoute4: Channel \"17\" out of range, ignored"));
+		CHECK (Contains (Log, "MIDIRoute4: Unknown message type \"foo\" ignored"));
+		CHECK (Contains (Log, "MIDIRoute5: Channel \"14-20\" clamped to 1-16"));
+		CHECK (Contains (Log, "MIDIRoute6: Channel \"0\" out of range, ignored"));
+		CHECK (Contains (Log, "MIDIRoute6: Channel \"17-20\" out of range, ignored"));
+		CHECK (Contains (Log, "MIDIRoute6: Route passes no channel, ignored"));
+		CHECK (Contains (Log, "MIDIRoute7: Unknown message type \"bar\" ignored"));
+		CHECK (Contains (Log, "MIDIRoute7: Route passes no message type, ignored"));
+		CHECK (Contains (Log, "MIDIRoute8: Invalid channel \"3x\" ignored"));
+		CHECK (Contains (Log, "MIDIRoute8: Route passes no channel, ignored"));
+
+		CHECK (Config.GetMIDIRoutes () == 2);
+		CHECK (std::string (Config.GetMIDIRouteIn (0)) == "umidi1");
+		CHECK (Config.GetMIDIRouteChannels (0) == (0b111U | 1U << 4));
+		CHECK (Config.GetMIDIRouteTypes (0) == CConfig::MIDIRouteNotes);
+		CHECK (Config.GetMIDIRouteChannels (1) == 0b111U << 13);
+	}
+}
+
+// an output device, which records the forwarded messages
+class CRecordingMIDIDevice : public CMIDIDevice
+{
+public:
+	CRecordingMIDIDevice (const char *pName, CHostSystem *pSystem)
+	:	CMIDIDevice (pSystem->GetMiniDexed (), pSystem->GetConfig (), nullptr)
+	{
+		AddDevice (pName);
+	}
+
+	void Send (const u8 *pMessage, size_t nLength, unsigned nCable) override
+	{
+		Messages.push_back (TBytes (pMessage, pMessage + nLength));
+	}
+
+	TMessages Messages;
+};
+
+static void TestForwarding (void)
+{
+	std::string SDCard = CreateTestSDCard (
+		"MIDIRoute1=host,all\n"
+		"MIDIRoute2=host,filtered,1-4/10,note/pb\n"
+		"MIDIRoute3=host,system,*,sysex/realtime\n"
+		"MIDIRoute4=host,missing\n");
+
+	CHostSystem System (SDCard.c_str ());
+	if (!System.Initialize ())
+	{
+		CHECK (false);
+
+		return;
+	}
+	CHECK (System.GetConfig ()->GetMIDIRoutes () == 4);
+
+	// added after the host MIDI device, the devices live until the exit
+	CRecordingMIDIDevice *pAll = new CRecordingMIDIDevice ("all", &System);
+	CRecordingMIDIDevice *pFiltered = new CRecordingMIDIDevice ("filtered", &System);
+	CRecordingMIDIDevice *pSystem = new CRecordingMIDIDevice ("system", &System);
+
+	std::vector<s32> Buffer (System.GetChunkFrames () * 2);
+	System.Tick (Buffer.data ());
+
+	static const TMessages Messages =
+	{
+		{0x90, 0x3C, 0x40},		// note on, channel 1
+		{0x94, 0x3C, 0x40},		// note on, channel 5
+		{0xB9, 0x07, 0x64},		// control change, channel 10
+		{0xE9, 0x00, 0x40},		// pitch bend, channel 10
+		{0xC0, 0x05},			// program change, channel 1
+		{0xD3, 0x20},			// channel aftertouch, channel 4
+		{0x83, 0x3C, 0x00},		// note off, channel 4
+		{0xF0, 0x7D, 0x01, 0xF7},	// SysEx
+		{0xF8},				// timing clock
+		{0xF3, 0x01}			// song select
+	};
+
+	for (unsigned nRoute = 0; nRoute < 4; nRoute++)
+	{
+		CMIDIDevice::TakeRouteMessages (nRoute);
+		CMIDIDevice::TakeRouteMaxLatencyTicks (nRoute);
+	}
+
+	// received 100 us before the current time
+	unsigned nTimestamp = CTimer::GetClockTicks () - 100;
+	HostSetExecutionLevel (IRQ_LEVEL);
+	for (const TBytes &rMessage : Messages)
+	{
+		System.GetMIDIDevice ()->Receive (rMessage.data (), rMessage.size (), nTimestamp);
+	}
+	HostSetExecutionLevel (TASK_LEVEL);
+	System.Tick (Buffer.data ());
+
+	CHECK (pAll->Messages == Messages);
+	CHECK (pFiltered->Messages == TMessages ({Messages[0], Messages[3], Messages[6]}));
+	CHECK (pSystem->Messages == TMessages ({Messages[7], Messages[8]}));
+
+	CHECK (CMIDIDevice::TakeRouteMessages (0) == Messages.size ());
+	CHECK (CMIDIDevice::TakeRouteMessages (1) == 3);
+	CHECK (CMIDIDevice::TakeRouteMessages (2) == 2);
+	CHECK (CMIDIDevice::TakeRouteMessages (3) == 0);		// not connected
+	CHECK (CMIDIDevice::TakeRouteMessages (0) == 0);
+	CHECK (CMIDIDevice::TakeRouteMaxLatencyTicks (0) == 100);
+	CHECK (CMIDIDevice::TakeRouteMaxLatencyTicks (3) == 0);
+
+	RemoveTestSDCard (SDCard);
+}
+
+int main (void)
+{
+	TestParser ();
+	TestForwarding ();
+
+	// the secondary cores of the host system do not return
+	TestExit ();
+}
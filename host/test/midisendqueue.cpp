@@ -0,0 +1,203 @@
+//
+// midisendqueue.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// CMIDISendQueue against a model queue: Random messages up to the maximum
+// size are put and got in random order, so that the ring wraps many times at
+// every offset. Each message must come out complete with its cable, and the
+// oldest messages must be dropped, only if the new one does not fit otherwise.
+// Two messages of the maximum size must fit without a drop.
+//
+#include "test.h"
+#include <midisendqueue.h>
+#include <circle/timer.h>
+#include <deque>
+#include <vector>
+#include <stdlib.h>
+
+typedef std::vector<u8> TBytes;
+
+struct TMessage
+{
+	TBytes		Data;
+	unsigned	nCable;
+};
+
+static unsigned s_nHeaderSize;
+
+static TBytes RandomMessage (void)
+{
+	size_t nLength;
+	switch (rand () % 4)
+	{
+	case 0:		nLength = 1 + rand () % 3;			break;
+	case 1:		nLength = 1 + rand () % 200;			break;
+	case 2:		nLength = 1 + rand () % MIDI_SEND_MAX_MESSAGE;	break;
+	default:	nLength = MIDI_SEND_MAX_MESSAGE - rand () % 2;	break;
+	}
+
+	TBytes Message (nLength);
+	for (u8 &rByte : Message)
+	{
+		rByte = rand () & 0xFF;
+	}
+
+	return Message;
+}
+
+static bool GetEqual (CMIDISendQueue *pQueue, const TMessage &rExpected)
+{
+	size_t nLength;
+	unsigned nCable;
+	const u8 *pMessage = pQueue->Get (&nLength, &nCable);
+
+	return    pMessage
+	       && nCable == rExpected.nCable
+	       && TBytes (pMessage, pMessage + nLength) == rExpected.Data;
+}
+
+// the size of the message header, derived from the queued bytes
+static void TestHeader (void)
+{
+	CMIDISendQueue Queue;
+	static const u8 Clock[] = {0xF8};
+	Queue.Put (Clock, sizeof Clock, 0);
+	s_nHeaderSize = Queue.GetQueuedBytes () - sizeof Clock;
+	CHECK (0 < s_nHeaderSize && s_nHeaderSize <= 16);
+
+	CHECK (GetEqual (&Queue, {{0xF8}, 0}));
+	CHECK (Queue.GetQueuedBytes () == 0);
+
+	size_t nLength;
+	unsigned nCable;
+	CHECK (Queue.Get (&nLength, &nCable) == nullptr);
+}
+
+static void TestLimits (void)
+{
+	CMIDISendQueue Queue;
+
+	// empty messages are ignored, too long ones are dropped
+	static const u8 Note[] = {0x90, 0x3C, 0x40};
+	Queue.Put (Note, 0, 0);
+	TBytes TooLong (MIDI_SEND_MAX_MESSAGE + 1, 0x55);
+	Queue.Put (TooLong.data (), TooLong.size (), 0);
+	CHECK (Queue.GetQueuedBytes () == 0);
+	CHECK (Queue.TakeDroppedMessages () == 1);
+	CHECK (Queue.TakeDroppedMessages () == 0);
+
+	// two dumps of the maximum size and some notes fit
+	TMessage Dump[2] = {{TBytes (MIDI_SEND_MAX_MESSAGE, 0x11), 1},
+			    {TBytes (MIDI_SEND_MAX_MESSAGE, 0x22), 2}};
+	for (const TMessage &rDump : Dump)
+	{
+		Queue.Put (rDump.Data.data (), rDump.Data.size (), rDump.nCable);
+		Queue.Put (Note, sizeof Note, 3);
+	}
+	CHECK (Queue.TakeDroppedMessages () == 0);
+	for (const TMessage &rDump : Dump)
+	{
+		CHECK (GetEqual (&Queue, rDump));
+		CHECK (GetEqual (&Queue, {TBytes (Note, Note + sizeof Note), 3}));
+	}
+
+	// the latency from Put() to Get()
+	CTimer::SetClockTicks (1000);
+	Queue.Put (Note, sizeof Note, 0);
+	CTimer::SetClockTicks (1250);
+	CHECK (GetEqual (&Queue, {TBytes (Note, Note + sizeof Note), 0}));
+	CHECK (Queue.TakeMaxLatencyTicks () == 250);
+	CHECK (Queue.TakeMaxLatencyTicks () == 0);
+}
+
+static void TestRandom (void)
+{
+	CMIDISendQueue Queue;
+	std::deque<TMessage> Model;
+	unsigned nModelBytes = 0;
+	unsigned nModelDropped = 0;
+
+	unsigned nPut = 0;
+	unsigned nGot = 0;
+	unsigned long long nBytesPut = 0;
+
+	for (unsigned nStep = 0; nStep < 200000; nStep++)
+	{
+		// more puts than gets, so that the queue runs full
+		if (rand () % 5 < 3)
+		{
+			TMessage Message = {RandomMessage (), (unsigned) rand () % 16};
+			unsigned nBytes = s_nHeaderSize + Message.Data.size ();
+
+			while (CMIDISendQueue::Size - nModelBytes < nBytes)
+			{
+				nModelBytes -= s_nHeaderSize + Model.front ().Data.size ();
+				Model.pop_front ();
+				nModelDropped++;
+			}
+
+			Queue.Put (Message.Data.data (), Message.Data.size (), Message.nCable);
+			Model.push_back (Message);
+			nModelBytes += nBytes;
+
+			nPut++;
+			nBytesPut += nBytes;
+		}
+		else if (!Model.empty ())
+		{
+			CHECK (GetEqual (&Queue, Model.front ()));
+			nModelBytes -= s_nHeaderSize + Model.front ().Data.size ();
+			Model.pop_front ();
+
+			nGot++;
+		}
+		else
+		{
+			size_t nLength;
+			unsigned nCable;
+			CHECK (Queue.Get (&nLength, &nCable) == nullptr);
+		}
+
+		CHECK (Queue.GetQueuedBytes () == nModelBytes);
+
+		if (rand () % 100 == 0)
+		{
+			CHECK (Queue.TakeDroppedMessages () == nModelDropped);
+			nModelDropped = 0;
+		}
+	}
+
+	CHECK (Queue.TakeDroppedMessages () == nModelDropped);
+
+	// the ring has wrapped often enough to hit the end at random offsets
+	CHECK (nBytesPut > 1000ULL * CMIDISendQueue::Size);
+
+	printf ("%u messages put, %u got, %llu ring wraps\n", nPut, nGot,
+		nBytesPut / CMIDISendQueue::Size);
+}
+
+int main (void)
+{
+	srand (1);
+
+	TestHeader ();
+	TestLimits ();
+	TestRandom ();
+
+	return TestResult ();
+}
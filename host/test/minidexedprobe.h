@@ -0,0 +1,88 @@
+//
+// minidexedprobe.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Access to the internal state of CMiniDexed for the host tests
+//
+#ifndef _minidexedprobe_h
+#define _minidexedprobe_h
+
+#include <minidexed.h>
+#include <dexedadapter.h>
+#include <assert.h>
+
+class CMiniDexedProbe		// friend of CMiniDexed
+{
+public:
+	// The order of the TG jobs of the last chunk, most expensive first.
+	// Only valid while the sound engine is idle (after CHostSystem::Tick()).
+	static unsigned GetTGJobs (CMiniDexed *pMiniDexed, unsigned *pTG)
+	{
+		for (unsigned i = 0; i < pMiniDexed->m_nTGJobs; i++)
+		{
+			pTG[i] = pMiniDexed->m_nTGJob[i];
+		}
+
+		return pMiniDexed->m_nTGJobs;
+	}
+
+	static unsigned GetNotesPlaying (CMiniDexed *pMiniDexed, unsigned nTG)
+	{
+		assert (pMiniDexed->m_pTG[nTG]);
+
+		return pMiniDexed->m_pTG[nTG]->getNumNotesPlaying ();
+	}
+
+	// the shadow copy of the voice data of the TG (156 bytes)
+	static void GetVoiceData (CMiniDexed *pMiniDexed, unsigned nTG, uint8_t *pData)
+	{
+		assert (pMiniDexed->m_pTG[nTG]);
+
+		pMiniDexed->m_pTG[nTG]->getVoiceData (pData);
+		pData[155] = pMiniDexed->m_pTG[nTG]->getVoiceDataElement (155);
+	}
+
+	// statistics of the last performance change
+	static unsigned GetPerformanceCommands (CMiniDexed *pMiniDexed)
+	{
+		return pMiniDexed->m_nPerformanceCommands;
+	}
+
+	static unsigned GetPerformanceChanges (CMiniDexed *pMiniDexed)
+	{
+		return pMiniDexed->m_nPerformanceChanges;
+	}
+
+	// statistics of the output ring, updated with ProfileEnabled=1 only
+	static const CPerformanceGauge *GetOutputLookaheadGauge (CMiniDexed *pMiniDexed)
+	{
+		return &pMiniDexed->m_OutputLookaheadGauge;
+	}
+
+	static const CPerformanceCounter *GetOutputUnderrunCounter (CMiniDexed *pMiniDexed)
+	{
+		return &pMiniDexed->m_OutputUnderrunCounter;
+	}
+
+	static AudioEffectPlateReverb *GetReverb (CMiniDexed *pMiniDexed)
+	{
+		return pMiniDexed->reverb;
+	}
+};
+
+#endif
@@ -0,0 +1,130 @@
+//
+// onsetjitter.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Onset jitter of timestamped notes: Note-on events are sent at different
+// positions inside the chunks on the simulated clock, and their onsets are
+// searched in the rendered output. The delay from the event to the onset must
+// be constant (one chunk period plus the output latency), except for the
+// rounding of the event position down to the Dexed block of 64 samples.
+//
+#include "test.h"
+#include "testsdcard.h"
+#include <hostsystem.h>
+#include <algorithm>
+#include <vector>
+#include <stdlib.h>
+
+#define NOTES		40
+#define NOTE_CHUNKS	16		// from one note-on to the next
+#define BLOCK		64		// _N_ of Dexed
+
+static const s32 OnsetThreshold = 1 << 8;	// of 2^23
+
+int main (void)
+{
+	std::string SDCard = CreateTestSDCard ("SoundDevice=i2s\nChunkSize=1024", "ReverbEnable=0");
+
+	CHostSystem System (SDCard.c_str ());
+	if (!System.Initialize ())
+	{
+		return 1;
+	}
+
+	unsigned nRate = System.GetSampleRate ();
+	unsigned nFrames = System.GetChunkFrames ();
+	CHECK (nFrames % BLOCK == 0);
+
+	// the note-on times in samples, at varying positions inside a chunk
+	std::vector<unsigned> EventTimes;
+	for (unsigned i = 0; i < NOTES; i++)
+	{
+		unsigned nPosition = (i * 397 + 11) % nFrames;
+		EventTimes.push_back ((i + 1) * NOTE_CHUNKS * nFrames + nPosition);
+	}
+
+	// render and send the note-on and a note-off one chunk later
+	std::vector<s32> Output;
+	std::vector<s32> Buffer (nFrames * 2);
+	unsigned nNextEvent = 0;
+	unsigned nChunks = (NOTES + 2) * NOTE_CHUNKS;
+	for (unsigned nChunk = 0; nChunk < nChunks; nChunk++)
+	{
+		for (; nNextEvent < 2 * NOTES; nNextEvent++)
+		{
+			unsigned nSample = EventTimes[nNextEvent / 2] + (nNextEvent & 1) * nFrames;
+			unsigned nMicros = (u64) nSample * 1000000 / nRate;
+			if (nMicros > System.GetClockTicks ())
+			{
+				break;
+			}
+
+			u8 Message[] = {(u8) (nNextEvent & 1 ? 0x80 : 0x90), 69, 127};
+			System.GetMIDIDevice ()->Receive (Message, sizeof Message, nMicros);
+		}
+
+		System.Tick (Buffer.data ());
+		Output.insert (Output.end (), Buffer.begin (), Buffer.end ());
+	}
+
+	// find the onsets, the output is silent before each note-on
+	std::vector<unsigned> Delays;
+	for (unsigned i = 0; i < NOTES; i++)
+	{
+		unsigned nSample = EventTimes[i] > nFrames ? EventTimes[i] - nFrames : 0;
+		CHECK (abs (Output[2 * nSample]) < OnsetThreshold);
+
+		for (; 2 * nSample < Output.size (); nSample++)
+		{
+			if (abs (Output[2 * nSample]) >= OnsetThreshold)
+			{
+				break;
+			}
+		}
+
+		CHECK (nSample >= EventTimes[i]);
+		Delays.push_back (nSample - EventTimes[i]);
+	}
+
+	unsigned nMin = *std::min_element (Delays.begin (), Delays.end ());
+	unsigned nMax = *std::max_element (Delays.begin (), Delays.end ());
+	printf ("chunk %u frames, delay %u .. %u samples (%.2f .. %.2f chunks)\n",
+		nFrames, nMin, nMax, (double) nMin / nFrames, (double) nMax / nFrames);
+
+	// the jitter is the rounding down to a block only
+	CHECK (nMax - nMin < BLOCK);
+
+	// the onset is rounded down, so that the delay falls as the event
+	// position inside its block rises
+	for (unsigned i = 0; i < NOTES; i++)
+	{
+		unsigned nInBlock = EventTimes[i] % BLOCK;
+		int nExpected = (int) nMax - (int) nInBlock;
+		CHECK (abs ((int) Delays[i] - nExpected) <= 2);
+	}
+
+	// The constant delay is one chunk period, because the events of a period
+	// are rendered in the next chunk, plus one chunk, which waits in the
+	// queue of the sound device. The onset is found a sample later, because
+	// the waveform starts at zero.
+	CHECK (nMax >= 2 * nFrames && nMax <= 2 * nFrames + 2);
+
+	RemoveTestSDCard (SDCard);
+
+	TestExit ();
+}
@@ -0,0 +1,135 @@
+//
+// outputlookahead.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// The output ring in real time: The sound device is drained at the fixed rate
+// of the sample clock. In steady state it must never run dry, and every write
+// must leave the configured number of chunks ready in the ring. A writer held
+// up for longer than the device queue lasts must show up as underruns, both
+// on the device and in the profiling statistics of CMiniDexed.
+//
+// Each lookahead depth is run in a child process, because the secondary cores
+// of a CHostSystem do not return.
+//
+#include "test.h"
+#include "testsdcard.h"
+#include "minidexedprobe.h"
+#include <hostsystem.h>
+#include <circle/timer.h>
+#include <chrono>
+#include <thread>
+#include <sys/wait.h>
+
+#define STEADY_PERIODS	40
+#define STALL_PERIODS	3		// longer than the device queue (2 chunks)
+#define AFTER_PERIODS	10
+
+static void Run (CHostSystem *pSystem, unsigned nPeriods)
+{
+	unsigned nPeriodMicros = (u64) pSystem->GetChunkFrames () * 1000000 / pSystem->GetSampleRate ();
+
+	auto End = std::chrono::steady_clock::now ()
+		 + std::chrono::microseconds (nPeriods * nPeriodMicros);
+	while (std::chrono::steady_clock::now () < End)
+	{
+		pSystem->GetMiniDexed ()->Process (false);
+
+		std::this_thread::sleep_for (std::chrono::milliseconds (1));
+	}
+}
+
+static void TestLookahead (unsigned nLookahead)
+{
+	char Config[100];
+	snprintf (Config, sizeof Config, "OutputLookahead=%u\nProfileEnabled=1", nLookahead);
+	std::string SDCard = CreateTestSDCard (Config);
+
+	CHostSystem System (SDCard.c_str ());
+	if (!System.Initialize ())
+	{
+		_exit (1);
+	}
+
+	CMiniDexed *pMiniDexed = System.GetMiniDexed ();
+	const CPerformanceGauge *pGauge = CMiniDexedProbe::GetOutputLookaheadGauge (pMiniDexed);
+	const CPerformanceCounter *pUnderruns = CMiniDexedProbe::GetOutputUnderrunCounter (pMiniDexed);
+
+	CSoundBaseDevice *pDevice = CSoundBaseDevice::Get ();
+	unsigned nFrames = System.GetChunkFrames ();
+	unsigned nPeriodMicros = (u64) nFrames * 1000000 / System.GetSampleRate ();
+
+	CTimer::SetRealTime (true);
+	pDevice->StartConsumer (nFrames);
+
+	unsigned nSamples = pGauge->GetSamples ();
+	Run (&System, STEADY_PERIODS);
+	unsigned nWrites = pGauge->GetSamples () - nSamples;
+
+	// chunks left in the ring after a write
+	unsigned nAhead = nLookahead > 0 ? nLookahead - 1 : 0;
+
+	printf ("Lookahead %u: %u writes in %u periods, up to %u chunks ahead, %u/%u underruns\n",
+		nLookahead, nWrites, STEADY_PERIODS, pGauge->GetMaximum (),
+		pDevice->GetUnderruns (), pUnderruns->GetCount ());
+	CHECK (nWrites + 2 >= STEADY_PERIODS && nWrites <= STEADY_PERIODS + 2);
+	CHECK (pGauge->GetMaximum () == nAhead);
+	CHECK (pDevice->GetUnderruns () == 0);
+	// the writer may find the queue drained, if the host delays it by a period
+	CHECK (pUnderruns->GetCount () <= 1);
+	unsigned nSteadyUnderruns = pUnderruns->GetCount ();
+
+	pDevice->DelayNextPoll (STALL_PERIODS * nPeriodMicros);
+	Run (&System, STALL_PERIODS + AFTER_PERIODS);
+
+	printf ("Lookahead %u: after a stall of %u periods %u/%u underruns\n",
+		nLookahead, STALL_PERIODS, pDevice->GetUnderruns (), pUnderruns->GetCount ());
+	CHECK (pDevice->GetUnderruns () >= 1);
+	CHECK (pDevice->GetUnderruns () <= STALL_PERIODS);
+	// counted by the writer, which finds the queue drained, up to once per
+	// period while it refills it with a single chunk
+	CHECK (pUnderruns->GetCount () - nSteadyUnderruns >= 1);
+	CHECK (pUnderruns->GetCount () - nSteadyUnderruns <= STALL_PERIODS);
+
+	pDevice->StopConsumer ();
+	RemoveTestSDCard (SDCard);
+
+	TestExit ();
+}
+
+int main (void)
+{
+	static const unsigned Lookahead[] = {0, 1, 2};
+
+	for (unsigned nLookahead : Lookahead)
+	{
+		fflush (stdout);
+
+		pid_t nPID = fork ();
+		if (nPID == 0)
+		{
+			TestLookahead (nLookahead);
+		}
+
+		int nStatus;
+		CHECK (   waitpid (nPID, &nStatus, 0) == nPID
+		       && WIFEXITED (nStatus)
+		       && WEXITSTATUS (nStatus) == 0);
+	}
+
+	return TestResult ();
+}
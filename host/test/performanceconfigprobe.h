@@ -0,0 +1,73 @@
+//
+// performanceconfigprobe.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Access to the voice data formats of CPerformanceConfig for the host tests
+// and benchmarks
+//
+#ifndef _performanceconfigprobe_h
+#define _performanceconfigprobe_h
+
+#include <performanceconfig.h>
+
+class CPerformanceConfigProbe		// friend of CPerformanceConfig
+{
+public:
+	static const unsigned HexLength = CPerformanceConfig::VoiceDataHexLength;
+	static const unsigned Base64Length = CPerformanceConfig::VoiceDataBase64Length;
+
+	static void EncodeHex (const uint8_t *pData, char *pBuffer)
+	{
+		CPerformanceConfig::EncodeVoiceDataHex (pData, pBuffer);
+	}
+
+	static bool DecodeHex (const char *pText, uint8_t *pData)
+	{
+		return CPerformanceConfig::DecodeVoiceDataHex (pText, pData);
+	}
+
+	static void EncodeBase64 (const uint8_t *pData, char *pBuffer)
+	{
+		CPerformanceConfig::EncodeVoiceDataBase64 (pData, pBuffer);
+	}
+
+	static bool DecodeBase64 (const char *pText, uint8_t *pData)
+	{
+		return CPerformanceConfig::DecodeVoiceDataBase64 (pText, pData);
+	}
+
+	static uint16_t GetChecksum (const uint8_t *pData)
+	{
+		return CPerformanceConfig::GetVoiceDataChecksum (pData);
+	}
+
+	// reads and parses the current performance file, bypassing the cache
+	static bool Reload (CPerformanceConfig *pConfig)
+	{
+		if (!pConfig->m_Properties.Load ())
+		{
+			return false;
+		}
+
+		pConfig->Parse (pConfig->m_Properties, &pConfig->m_Performance);
+
+		return pConfig->m_Performance.bValid;
+	}
+};
+
+#endif
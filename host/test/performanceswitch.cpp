@@ -0,0 +1,135 @@
+//
+// performanceswitch.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Switching performances applies only the changed parameters: Selecting the
+// current performance again must not post any TG command, but voices edited
+// since, from a bank or from the voice data of the performance, must be
+// restored.
+//
+#include "test.h"
+#include "testsdcard.h"
+#include "minidexedprobe.h"
+#include "performanceconfigprobe.h"
+#include <hostsystem.h>
+#include <sysexfileloader.h>
+#include <sdcard.h>
+#include <vector>
+#include <string.h>
+
+#define CHUNKS		4
+
+static CHostSystem *s_pSystem;
+
+// selects the performance again and renders, until it is applied
+static void Reselect (void)
+{
+	s_pSystem->GetMiniDexed ()->SetNewPerformance (0);
+
+	std::vector<s32> Buffer (s_pSystem->GetChunkFrames () * 2);
+	for (unsigned nChunk = 0; nChunk < CHUNKS; nChunk++)
+	{
+		s_pSystem->Tick (Buffer.data ());
+	}
+}
+
+static bool IsVoice (unsigned nTG, const uint8_t *pExpected)
+{
+	uint8_t Voice[NUM_VOICE_PARAM];
+	CMiniDexedProbe::GetVoiceData (s_pSystem->GetMiniDexed (), nTG, Voice);
+
+	return    memcmp (Voice, pExpected, NUM_VOICE_PARAM-1) == 0
+	       && Voice[NUM_VOICE_PARAM-1] == 0b111111;
+}
+
+int main (void)
+{
+	std::string SDCard = CreateTestSDCard ();
+	HostSetSDCard (SDCard.c_str ());
+
+	WriteTestBank (SDCard, 1, "FIRST");
+	WriteTestBank (SDCard, 2, "SECOND");
+
+	// TG1 plays a voice of a bank, TG2 the voice data of the performance,
+	// which is an edited voice of the second bank
+	uint8_t BankVoice[NUM_VOICE_PARAM];
+	uint8_t DataVoice[NUM_VOICE_PARAM];
+	{
+		CSysExFileLoader Loader;
+		Loader.Load (false, 0);
+		Loader.GetVoice (0, 2, BankVoice);
+		Loader.GetVoice (1, 7, DataVoice);
+	}
+	DataVoice[0] = 50;
+
+	char Hex[CPerformanceConfigProbe::HexLength+1];
+	CPerformanceConfigProbe::EncodeHex (DataVoice, Hex);
+
+	FILE *pFile = fopen ((SDCard + "/performance.ini").c_str (), "a");
+	CHECK (pFile != nullptr);
+	fprintf (pFile, "BankNumber1=0\nVoiceNumber1=3\n");
+	fprintf (pFile, "BankNumber2=1\nVoiceNumber2=8\nVoiceData2=%s\n", Hex);
+	fclose (pFile);
+
+	CHostSystem System (SDCard.c_str ());
+	if (!System.Initialize ())
+	{
+		return 1;
+	}
+	s_pSystem = &System;
+	CMiniDexed *pMiniDexed = System.GetMiniDexed ();
+
+	Reselect ();
+	CHECK (IsVoice (0, BankVoice));
+	CHECK (IsVoice (1, DataVoice));
+
+	// nothing has changed
+	Reselect ();
+	printf ("Unchanged: %u TG commands\n", CMiniDexedProbe::GetPerformanceCommands (pMiniDexed));
+	CHECK (CMiniDexedProbe::GetPerformanceCommands (pMiniDexed) == 0);
+	CHECK (CMiniDexedProbe::GetPerformanceChanges (pMiniDexed) == 0);
+
+	// edit both voices and switch an operator of TG2 off
+	pMiniDexed->setVoiceDataElement (0, 20, 0);
+	pMiniDexed->setVoiceDataElement (140, 3, 1);
+	pMiniDexed->setOPMask (0b111110, 1);
+	CHECK (!IsVoice (0, BankVoice));
+	CHECK (!IsVoice (1, DataVoice));
+
+	Reselect ();
+	printf ("Edited: %u TG commands\n", CMiniDexedProbe::GetPerformanceCommands (pMiniDexed));
+	CHECK (IsVoice (0, BankVoice));
+	CHECK (IsVoice (1, DataVoice));
+	CHECK (CMiniDexedProbe::GetPerformanceChanges (pMiniDexed) == 2);
+	// TG1: load voice, all operators on, TG2: the same and the voice data
+	CHECK (CMiniDexedProbe::GetPerformanceCommands (pMiniDexed) == 6);
+
+	// another program selected by MIDI
+	pMiniDexed->ProgramChange (5, 0);
+	CHECK (!IsVoice (0, BankVoice));
+	Reselect ();
+	CHECK (IsVoice (0, BankVoice));
+	CHECK (CMiniDexedProbe::GetPerformanceChanges (pMiniDexed) == 1);
+
+	Reselect ();
+	CHECK (CMiniDexedProbe::GetPerformanceCommands (pMiniDexed) == 0);
+
+	RemoveTestSDCard (SDCard);
+
+	return TestResult ();
+}
@@ -0,0 +1,59 @@
+//
+// test.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Minimal checks for the host tests, which are plain programs run by "make test"
+//
+#ifndef _test_h
+#define _test_h
+
+#include <stdio.h>
+#include <unistd.h>
+
+static unsigned s_nTestFailures = 0;
+
+#define CHECK(cond)	do { if (!(cond)) { fprintf (stderr, "%s:%d: CHECK failed: %s\n",	\
+						     __FILE__, __LINE__, #cond);		\
+					    s_nTestFailures++; } } while (0)
+
+// returns the exit code of the test program
+static inline int TestResult (void)
+{
+	if (s_nTestFailures)
+	{
+		fprintf (stderr, "%u check(s) failed\n", s_nTestFailures);
+
+		return 1;
+	}
+
+	printf ("passed\n");
+
+	return 0;
+}
+
+// for tests with a CHostSystem, whose secondary cores do not return
+static inline void TestExit (void)
+{
+	int nResult = TestResult ();
+
+	fflush (stdout);
+	fflush (stderr);
+	_exit (nResult);
+}
+
+#endif
@@ -0,0 +1,177 @@
+//
+// testsdcard.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Creates a temporary SD card directory for the host tests: minidexed.ini and
+// performance.ini from ../src, with optional settings appended, and
+// synthetic voice banks
+//
+#ifndef _testsdcard_h
+#define _testsdcard_h
+
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// the tests are run from the host directory
+#define TEST_SRC_DIR	"../src"
+
+static inline bool CopyTestFile (const char *pFrom, const std::string &To, const char *pAppend)
+{
+	FILE *pIn = fopen (pFrom, "rb");
+	FILE *pOut = fopen (To.c_str (), "wb");
+	if (!pIn || !pOut)
+	{
+		fprintf (stderr, "Cannot copy %s to %s\n", pFrom, To.c_str ());
+		exit (1);
+	}
+
+	int nChar;
+	while ((nChar = fgetc (pIn)) != EOF)
+	{
+		fputc (nChar, pOut);
+	}
+
+	// later settings override earlier ones
+	fprintf (pOut, "\n%s\n", pAppend);
+
+	fclose (pIn);
+	fclose (pOut);
+
+	return true;
+}
+
+// pConfig and pPerformance are appended to minidexed.ini and performance.ini
+static inline std::string CreateTestSDCard (const char *pConfig = "", const char *pPerformance = "")
+{
+	char Template[] = "/tmp/minidexed-test-XXXXXX";
+	if (!mkdtemp (Template))
+	{
+		perror ("mkdtemp");
+		exit (1);
+	}
+
+	std::string SDCard (Template);
+	mkdir ((SDCard + "/sysex").c_str (), 0755);
+	mkdir ((SDCard + "/sysex/voice").c_str (), 0755);
+	mkdir ((SDCard + "/performance").c_str (), 0755);
+
+	CopyTestFile (TEST_SRC_DIR "/minidexed.ini", SDCard + "/minidexed.ini", pConfig);
+	CopyTestFile (TEST_SRC_DIR "/performance.ini", SDCard + "/performance.ini", pPerformance);
+
+	return SDCard;
+}
+
+// Packs a single voice (156 bytes) into the 128 bytes format of a bank
+static inline void PackTestVoice (const unsigned char *pVoice, unsigned char *pPacked)
+{
+	for (unsigned nOP = 0; nOP < 6; nOP++)
+	{
+		const unsigned char *pIn = &pVoice[nOP * 21];
+		unsigned char *pOut = &pPacked[nOP * 17];
+
+		memcpy (pOut, pIn, 11);				// EG, breakpoint, depths
+		pOut[11] = (pIn[12] << 2) | pIn[11];		// curves
+		pOut[12] = (pIn[20] << 3) | pIn[13];		// detune, rate scaling
+		pOut[13] = (pIn[15] << 2) | pIn[14];		// velocity, AMS
+		pOut[14] = pIn[16];				// output level
+		pOut[15] = (pIn[18] << 1) | pIn[17];		// coarse, mode
+		pOut[16] = pIn[19];				// fine
+	}
+
+	memcpy (&pPacked[102], &pVoice[126], 9);		// pitch EG, algorithm
+	pPacked[111] = (pVoice[136] << 3) | pVoice[135];	// osc sync, feedback
+	memcpy (&pPacked[112], &pVoice[137], 4);		// LFO speed, delay, depths
+	pPacked[116] = (pVoice[143] << 4) | (pVoice[142] << 1) | pVoice[141];
+	pPacked[117] = pVoice[144];				// transpose
+	memcpy (&pPacked[118], &pVoice[145], 10);		// name
+}
+
+// Writes sysex/voice/<nBank>_<pName>.syx with 32 voices named "<pName>NN".
+// The voices are sine tones, which differ in the frequency of OP1.
+static inline std::string WriteTestBank (const std::string &SDCard, unsigned nBank, const char *pName)
+{
+	unsigned char Bank[32][128];
+	for (unsigned nVoice = 0; nVoice < 32; nVoice++)
+	{
+		unsigned char Voice[156] = {0};
+		for (unsigned nOP = 0; nOP < 6; nOP++)
+		{
+			unsigned char *pOP = &Voice[nOP * 21];
+			memset (pOP, 99, 4);			// EG rates
+			pOP[4] = 99;				// EG level 1-3
+			pOP[5] = 99;
+			pOP[6] = 99;
+			pOP[18] = 1;				// frequency coarse
+			pOP[20] = 7;				// detune
+		}
+		Voice[5 * 21 + 16] = 99;			// OP1 output level
+		Voice[5 * 21 + 19] = nVoice;			// OP1 frequency fine
+		memset (&Voice[126], 99, 4);			// pitch EG
+		memset (&Voice[130], 50, 4);
+		Voice[136] = 1;					// osc sync
+		Voice[137] = 35;				// LFO speed
+		Voice[141] = 1;					// LFO sync
+		Voice[143] = 3;					// pitch mod sensitivity
+		Voice[144] = 24;				// transpose
+
+		char Name[11];
+		snprintf (Name, sizeof Name, "%-8.8s%02u", pName, nVoice);
+		memcpy (&Voice[145], Name, 10);
+
+		PackTestVoice (Voice, Bank[nVoice]);
+	}
+
+	char FileName[300];
+	snprintf (FileName, sizeof FileName, "%s/sysex/voice/%06u_%s.syx", SDCard.c_str (), nBank, pName);
+
+	FILE *pFile = fopen (FileName, "wb");
+	if (!pFile)
+	{
+		perror (FileName);
+		exit (1);
+	}
+
+	static const unsigned char Header[] = {0xF0, 0x43, 0x00, 0x09, 0x20, 0x00};
+	fwrite (Header, 1, sizeof Header, pFile);
+	fwrite (Bank, 1, sizeof Bank, pFile);
+
+	unsigned nSum = 0;
+	for (unsigned i = 0; i < sizeof Bank; i++)
+	{
+		nSum += ((unsigned char *) Bank)[i];
+	}
+	fputc (-nSum & 0x7F, pFile);
+	fputc (0xF7, pFile);
+	fclose (pFile);
+
+	return FileName;
+}
+
+static inline void RemoveTestSDCard (const std::string &SDCard)
+{
+	std::string Command = "rm -rf '" + SDCard + "'";
+	if (system (Command.c_str ()) != 0)
+	{
+		fprintf (stderr, "Cannot remove %s\n", SDCard.c_str ());
+	}
+}
+
+#endif
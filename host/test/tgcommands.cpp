@@ -0,0 +1,148 @@
+//
+// tgcommands.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Command queue of a TG under overload: In interrupt context a full queue
+// drops commands at once, but never key or sustain releases. A producer in
+// task context, which waits for room, must not block one in interrupt
+// context, and loses no commands, once the audio core consumes them.
+//
+#include "test.h"
+#include <dexedadapter.h>
+#include <circle/synchronize.h>
+#include <circle/timer.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#define SAMPLE_RATE	48000
+#define VOICES		16
+#define FLOOD		1000		// more than the queue size
+
+static float32_t s_Buffer[_N_];
+
+// applies all queued commands
+static void Consume (CDexedAdapter *pTG)
+{
+	pTG->getSamples (s_Buffer, _N_, 0, 0);
+}
+
+static double Milliseconds (std::chrono::steady_clock::time_point Start)
+{
+	return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - Start).count ();
+}
+
+static void TestInterruptContext (void)
+{
+	CDexedAdapter TG (VOICES, SAMPLE_RATE);
+
+	HostSetExecutionLevel (IRQ_LEVEL);
+
+	for (unsigned i = 0; i < VOICES; i++)
+	{
+		TG.keydown (48 + i, 100, 0);
+	}
+	TG.setSustain (true, 0);
+	Consume (&TG);
+	CHECK (TG.getNumNotesPlaying () == VOICES);
+
+	// no consumer, the queue overflows
+	auto Start = std::chrono::steady_clock::now ();
+	for (unsigned i = 0; i < FLOOD; i++)
+	{
+		TG.setPitchbend (i % 8192);
+	}
+	TG.keydown (100, 100, 0);		// a new key needs room for its release
+	double fFloodMs = Milliseconds (Start);
+	unsigned nDropped = TG.TakeDroppedCommands ();
+	printf ("IRQ level: %u of %u commands dropped in %.2f ms\n", nDropped, FLOOD + 1, fFloodMs);
+	CHECK (nDropped > 0);
+	CHECK (TG.TakeWaitTicks () == 0);	// did not wait
+
+	for (unsigned i = 0; i < VOICES; i++)
+	{
+		TG.keyup (48 + i, 0);
+	}
+	TG.setSustain (false, 0);
+	CHECK (TG.TakeDroppedCommands () == 0);
+
+	Consume (&TG);
+	CHECK (TG.getNumNotesPlaying () == 0);
+
+	HostSetExecutionLevel (TASK_LEVEL);
+}
+
+static void TestTaskContext (void)
+{
+	CDexedAdapter TG (VOICES, SAMPLE_RATE);
+
+	CTimer::SetRealTime (true);
+
+	TG.keydown (60, 100, 0);
+
+	// waits for room, the queue is full after some commands
+	std::thread Flooder ([&TG] {
+		for (unsigned i = 0; i < FLOOD; i++)
+		{
+			TG.setPitchbend (i % 8192);
+		}
+	});
+
+	std::this_thread::sleep_for (std::chrono::milliseconds (10));
+
+	// the key release from interrupt context has a reserved entry and must
+	// not wait for the flooding producer
+	HostSetExecutionLevel (IRQ_LEVEL);
+	auto Start = std::chrono::steady_clock::now ();
+	TG.keyup (60, 0);
+	double fReleaseMs = Milliseconds (Start);
+	HostSetExecutionLevel (TASK_LEVEL);
+	printf ("Key release during a waiting producer took %.3f ms\n", fReleaseMs);
+	CHECK (fReleaseMs < 50.0);
+
+	std::atomic<bool> bRunning (true);
+	std::thread Consumer ([&TG, &bRunning] {
+		while (bRunning)
+		{
+			Consume (&TG);
+			std::this_thread::yield ();
+		}
+	});
+
+	Flooder.join ();
+	bRunning = false;
+	Consumer.join ();
+	Consume (&TG);
+
+	unsigned nWaitTicks = TG.TakeWaitTicks ();
+	unsigned nDropped = TG.TakeDroppedCommands ();
+	printf ("Task level: %u commands dropped, waited %u us\n", nDropped, nWaitTicks);
+	CHECK (nWaitTicks > 0);
+	CHECK (nDropped == 0);
+	CHECK (TG.getNumNotesPlaying () == 0);
+
+	CTimer::SetRealTime (false);
+}
+
+int main (void)
+{
+	TestInterruptContext ();
+	TestTaskContext ();
+
+	return TestResult ();
+}
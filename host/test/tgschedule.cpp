@@ -0,0 +1,200 @@
+//
+// tgschedule.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Compares the dynamic TG scheduling (ScheduleTGs(), ProcessTGJobs()) with the
+// static split of the TGs to the cores (2 TGs on core 1, 3 on cores 2 and 3)
+// under skewed loads. The chunk time is modelled by the number of voices to be
+// rendered plus a fixed cost per rendered TG, so that the result is
+// deterministic. The dynamic schedule uses the job order, which ScheduleTGs()
+// has computed for the running sound engine, and lets three cores claim the
+// jobs in this order as ProcessTGJobs() does.
+//
+#include "test.h"
+#include "testsdcard.h"
+#include "minidexedprobe.h"
+#include <hostsystem.h>
+#include <vector>
+
+#define RENDER_CORES	3		// cores 1-3
+
+// cost of a TG without voices (Dexed overhead, filter, silence check),
+// relative to one voice
+static const unsigned TGCost = 1;
+
+struct TLoad
+{
+	const char *pName;
+	unsigned nNotes[8];		// per TG
+};
+
+static const TLoad Loads[] =
+{
+	{"even",		{2, 2, 2, 2, 2, 2, 2, 2}},
+	{"one TG on core 1",	{16, 0, 0, 0, 0, 0, 0, 0}},
+	{"two TGs on core 1",	{8, 8, 0, 0, 0, 0, 0, 0}},
+	{"core 2 only",		{0, 0, 6, 6, 6, 0, 0, 0}},
+	{"core 3, one TG",	{0, 0, 0, 0, 0, 0, 0, 16}},
+	{"mixed",		{12, 1, 0, 4, 0, 1, 0, 6}}
+};
+
+static void SendNotes (CHostSystem *pSystem, const unsigned *pNotes, bool bOn)
+{
+	for (unsigned nTG = 0; nTG < 8; nTG++)
+	{
+		for (unsigned i = 0; i < pNotes[nTG]; i++)
+		{
+			u8 Message[3] = {(u8) ((bOn ? 0x90 : 0x80) | nTG), (u8) (48 + i), 100};
+			pSystem->GetMIDIDevice ()->Receive (Message, 3, pSystem->GetClockTicks ());
+		}
+	}
+}
+
+static unsigned StaticChunkTime (const unsigned *pCost)
+{
+	unsigned nMax = 0;
+	unsigned nTG = 0;
+	for (unsigned nCore = 1; nCore <= RENDER_CORES; nCore++)
+	{
+		unsigned nTGs = nCore == 1 ? CConfig::TGsCore1 : CConfig::TGsCore23;
+
+		unsigned nTime = 0;
+		for (unsigned i = 0; i < nTGs; i++, nTG++)
+		{
+			nTime += TGCost + pCost[nTG];		// all TGs are rendered
+		}
+
+		if (nTime > nMax)
+		{
+			nMax = nTime;
+		}
+	}
+
+	return nMax;
+}
+
+// the next job is claimed by the core, which gets free first
+static unsigned DynamicChunkTime (const unsigned *pJob, unsigned nJobs, const unsigned *pCost)
+{
+	unsigned nCoreTime[RENDER_CORES] = {0};
+	for (unsigned i = 0; i < nJobs; i++)
+	{
+		unsigned nCore = 0;
+		for (unsigned j = 1; j < RENDER_CORES; j++)
+		{
+			if (nCoreTime[j] < nCoreTime[nCore])
+			{
+				nCore = j;
+			}
+		}
+
+		nCoreTime[nCore] += TGCost + pCost[pJob[i]];
+	}
+
+	unsigned nMax = 0;
+	for (unsigned j = 0; j < RENDER_CORES; j++)
+	{
+		if (nCoreTime[j] > nMax)
+		{
+			nMax = nCoreTime[j];
+		}
+	}
+
+	return nMax;
+}
+
+int main (void)
+{
+	std::string SDCard = CreateTestSDCard ("ToneGenerators=8\nPolyphony=16");
+
+	CHostSystem System (SDCard.c_str ());
+	if (!System.Initialize ())
+	{
+		return 1;
+	}
+
+	CMiniDexed *pMiniDexed = System.GetMiniDexed ();
+	CHECK (System.GetConfig ()->GetToneGenerators () == CConfig::TGsCore1 + 2*CConfig::TGsCore23);
+
+	for (unsigned nTG = 0; nTG < 8; nTG++)
+	{
+		pMiniDexed->SetTGParameter (CMiniDexed::TGParameterMIDIChannel, nTG, nTG);
+	}
+
+	std::vector<s32> Buffer (System.GetChunkFrames () * 2);
+
+	unsigned nWorstStatic = 0;
+	unsigned nWorstDynamic = 0;
+
+	for (const TLoad &rLoad : Loads)
+	{
+		SendNotes (&System, rLoad.nNotes, true);
+		for (unsigned i = 0; i < 8; i++)
+		{
+			System.Tick (Buffer.data ());
+		}
+
+		unsigned nCost[8];
+		for (unsigned nTG = 0; nTG < 8; nTG++)
+		{
+			nCost[nTG] = CMiniDexedProbe::GetNotesPlaying (pMiniDexed, nTG);
+			CHECK (nCost[nTG] == rLoad.nNotes[nTG]);
+		}
+
+		unsigned Job[CConfig::AllToneGenerators];
+		unsigned nJobs = CMiniDexedProbe::GetTGJobs (pMiniDexed, Job);
+
+		// exactly the sounding TGs, most expensive first
+		unsigned nSounding = 0;
+		for (unsigned nTG = 0; nTG < 8; nTG++)
+		{
+			nSounding += rLoad.nNotes[nTG] ? 1 : 0;
+		}
+		CHECK (nJobs == nSounding);
+		for (unsigned i = 0; i < nJobs; i++)
+		{
+			CHECK (Job[i] < 8 && rLoad.nNotes[Job[i]] > 0);
+			CHECK (i == 0 || nCost[Job[i-1]] >= nCost[Job[i]]);
+		}
+
+		unsigned nStatic = StaticChunkTime (nCost);
+		unsigned nDynamic = DynamicChunkTime (Job, nJobs, nCost);
+		printf ("%-20s static %3u  dynamic %3u\n", rLoad.pName, nStatic, nDynamic);
+
+		CHECK (nDynamic <= nStatic);
+
+		nWorstStatic = nStatic > nWorstStatic ? nStatic : nWorstStatic;
+		nWorstDynamic = nDynamic > nWorstDynamic ? nDynamic : nWorstDynamic;
+
+		// let the voices release, the TGs get idle
+		SendNotes (&System, rLoad.nNotes, false);
+		for (unsigned i = 0; i < 200; i++)
+		{
+			System.Tick (Buffer.data ());
+		}
+
+		CHECK (CMiniDexedProbe::GetTGJobs (pMiniDexed, Job) == 0);
+	}
+
+	printf ("%-20s static %3u  dynamic %3u\n", "worst case", nWorstStatic, nWorstDynamic);
+	CHECK (nWorstDynamic < nWorstStatic);
+
+	RemoveTestSDCard (SDCard);
+
+	TestExit ();
+}
@@ -0,0 +1,292 @@
+//
+// voicedata.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Voice data formats of the performance files: Round trips of the hex and the
+// Base64 format, rejection of invalid padding, text and checksums, and loading
+// and saving of performances with both formats, including the fallback to the
+// hex format, if the Base64 data is invalid.
+//
+#include "test.h"
+#include "testsdcard.h"
+#include "performanceconfigprobe.h"
+#include <sdcard.h>
+#include <fatfs/ff.h>
+#include <string>
+#include <stdlib.h>
+#include <string.h>
+
+typedef CPerformanceConfigProbe Probe;
+
+static void RandomVoice (uint8_t *pData)
+{
+	for (unsigned i = 0; i < NUM_VOICE_PARAM; i++)
+	{
+		pData[i] = rand () & 0xFF;
+	}
+}
+
+static unsigned Base64Value (char chDigit)
+{
+	static const char Base64Digit[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	return strchr (Base64Digit, chDigit) - Base64Digit;
+}
+
+static char Base64Digit (unsigned nValue)
+{
+	return "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[nValue & 0x3F];
+}
+
+static void TestRoundTrip (void)
+{
+	for (unsigned nRun = 0; nRun < 1000; nRun++)
+	{
+		uint8_t Voice[NUM_VOICE_PARAM];
+		RandomVoice (Voice);
+
+		char Hex[Probe::HexLength+1];
+		Probe::EncodeHex (Voice, Hex);
+		CHECK (strlen (Hex) == Probe::HexLength);
+
+		uint8_t Decoded[NUM_VOICE_PARAM];
+		CHECK (Probe::DecodeHex (Hex, Decoded));
+		CHECK (memcmp (Voice, Decoded, sizeof Voice) == 0);
+
+		char Base64[Probe::Base64Length+1];
+		Probe::EncodeBase64 (Voice, Base64);
+		CHECK (strlen (Base64) == Probe::Base64Length);
+
+		memset (Decoded, 0, sizeof Decoded);
+		CHECK (Probe::DecodeBase64 (Base64, Decoded));
+		CHECK (memcmp (Voice, Decoded, sizeof Voice) == 0);
+	}
+
+	// lower case hex digits, as written by other tools
+	uint8_t Voice[NUM_VOICE_PARAM];
+	RandomVoice (Voice);
+	char Hex[Probe::HexLength+1];
+	Probe::EncodeHex (Voice, Hex);
+	for (char *p = Hex; *p; p++)
+	{
+		if ('A' <= *p && *p <= 'F')
+		{
+			*p += 'a' - 'A';
+		}
+	}
+	uint8_t Decoded[NUM_VOICE_PARAM];
+	CHECK (Probe::DecodeHex (Hex, Decoded));
+	CHECK (memcmp (Voice, Decoded, sizeof Voice) == 0);
+}
+
+static void TestPadding (void)
+{
+	uint8_t Voice[NUM_VOICE_PARAM];
+	RandomVoice (Voice);
+	char Base64[Probe::Base64Length+1];
+	Probe::EncodeBase64 (Voice, Base64);
+
+	// 158 bytes (voice data and checksum) are 52 groups of three and two
+	// bytes, which are encoded as three digits and one "="
+	unsigned nLast = Probe::Base64Length - 1;
+	CHECK (Base64[nLast] == '=');
+	CHECK (Base64[nLast-1] != '=');
+	CHECK (Base64Value (Base64[nLast-1]) % 4 == 0);		// padding bits
+
+	uint8_t Decoded[NUM_VOICE_PARAM];
+	std::string Text (Base64);
+
+	// padding bits set
+	std::string Invalid = Text;
+	Invalid[nLast-1] = Base64Digit (Base64Value (Text[nLast-1]) | 1);
+	CHECK (!Probe::DecodeBase64 (Invalid.c_str (), Decoded));
+
+	// no padding, too short or too long
+	CHECK (!Probe::DecodeBase64 (Text.substr (0, nLast).c_str (), Decoded));
+	CHECK (!Probe::DecodeBase64 (Text.substr (0, nLast-4).c_str (), Decoded));
+	CHECK (!Probe::DecodeBase64 ((Text + "=").c_str (), Decoded));
+	CHECK (!Probe::DecodeBase64 ((Text + "A").c_str (), Decoded));
+	CHECK (!Probe::DecodeBase64 ("", Decoded));
+
+	// padding in the middle
+	Invalid = Text;
+	Invalid[10] = '=';
+	CHECK (!Probe::DecodeBase64 (Invalid.c_str (), Decoded));
+
+	// invalid digits
+	Invalid = Text;
+	Invalid[20] = ' ';
+	CHECK (!Probe::DecodeBase64 (Invalid.c_str (), Decoded));
+	Invalid[20] = '-';
+	CHECK (!Probe::DecodeBase64 (Invalid.c_str (), Decoded));
+}
+
+static void TestChecksum (void)
+{
+	uint8_t Voice[NUM_VOICE_PARAM];
+	RandomVoice (Voice);
+
+	// every single changed digit is detected
+	char Base64[Probe::Base64Length+1];
+	Probe::EncodeBase64 (Voice, Base64);
+	for (unsigned i = 0; i < Probe::Base64Length - 1; i++)
+	{
+		std::string Invalid (Base64);
+		Invalid[i] = Base64Digit (Base64Value (Invalid[i]) ^ 0x10);
+
+		uint8_t Decoded[NUM_VOICE_PARAM];
+		CHECK (!Probe::DecodeBase64 (Invalid.c_str (), Decoded));
+	}
+
+	// swapped bytes are detected too (Fletcher-16)
+	Voice[0] = 1;
+	Voice[1] = 2;
+	uint16_t usChecksum = Probe::GetChecksum (Voice);
+	Voice[0] = 2;
+	Voice[1] = 1;
+	CHECK (Probe::GetChecksum (Voice) != usChecksum);
+
+	// the data is not touched, if the decoding fails
+	uint8_t Decoded[NUM_VOICE_PARAM];
+	memset (Decoded, 0x55, sizeof Decoded);
+	std::string Invalid (Base64);
+	Invalid[0] = Base64Digit (Base64Value (Invalid[0]) ^ 1);
+	CHECK (!Probe::DecodeBase64 (Invalid.c_str (), Decoded));
+	for (unsigned i = 0; i < NUM_VOICE_PARAM; i++)
+	{
+		CHECK (Decoded[i] == 0x55);
+	}
+}
+
+static void TestHexErrors (void)
+{
+	uint8_t Voice[NUM_VOICE_PARAM];
+	RandomVoice (Voice);
+	char Hex[Probe::HexLength+1];
+	Probe::EncodeHex (Voice, Hex);
+
+	uint8_t Decoded[NUM_VOICE_PARAM];
+	std::string Text (Hex);
+	CHECK (!Probe::DecodeHex (Text.substr (0, Text.length () - 1).c_str (), Decoded));
+	CHECK (!Probe::DecodeHex ("", Decoded));
+
+	std::string Invalid = Text;
+	Invalid[3] = 'G';
+	CHECK (!Probe::DecodeHex (Invalid.c_str (), Decoded));
+}
+
+// performance files with voice data in both formats
+static void TestPerformanceFile (void)
+{
+	uint8_t Voice[4][NUM_VOICE_PARAM];
+	char Hex[4][Probe::HexLength+1];
+	char Base64[4][Probe::Base64Length+1];
+	for (unsigned i = 0; i < 4; i++)
+	{
+		RandomVoice (Voice[i]);
+		Probe::EncodeHex (Voice[i], Hex[i]);
+		Probe::EncodeBase64 (Voice[i], Base64[i]);
+	}
+
+	// the Base64 data of TG3 is invalid, its hex data is used
+	std::string BadBase64 (Base64[2]);
+	BadBase64[5] = Base64Digit (Base64Value (BadBase64[5]) ^ 1);
+
+	std::string Performance;
+	Performance += std::string ("VoiceData1=") + Hex[0] + "\n";
+	Performance += std::string ("VoiceDataBase642=") + Base64[1] + "\n";
+	Performance += std::string ("VoiceData2=") + Hex[3] + "\n";			// not used
+	Performance += "VoiceDataBase643=" + BadBase64 + "\n";
+	Performance += std::string ("VoiceData3=") + Hex[2] + "\n";
+	Performance += "VoiceDataBase644=" + BadBase64 + "\n";
+	Performance += "VoiceData5=00 11 22\n";
+
+	std::string SDCard = CreateTestSDCard ("", Performance.c_str ());
+	HostSetSDCard (SDCard.c_str ());
+
+	FATFS FileSystem;
+	{
+		CPerformanceConfig Config (&FileSystem);
+		CHECK (Config.Init (8, false));
+		Config.Load ();
+
+		CHECK (Config.VoiceDataFilled (0));
+		CHECK (memcmp (Config.GetVoiceData (0), Voice[0], NUM_VOICE_PARAM) == 0);
+		CHECK (Config.VoiceDataFilled (1));
+		CHECK (memcmp (Config.GetVoiceData (1), Voice[1], NUM_VOICE_PARAM) == 0);
+		CHECK (Config.VoiceDataFilled (2));
+		CHECK (memcmp (Config.GetVoiceData (2), Voice[2], NUM_VOICE_PARAM) == 0);
+		CHECK (!Config.VoiceDataFilled (3));
+		CHECK (!Config.VoiceDataFilled (4));
+		CHECK (!Config.VoiceDataFilled (5));
+
+		// saved in hex, the invalid Base64 data of TG3 and TG4 is kept
+		Config.SetVoiceData (Voice[3], 3);
+		CHECK (Config.Save ());
+	}
+
+	for (unsigned nFormat = 0; nFormat < 2; nFormat++)
+	{
+		bool bBase64 = nFormat == 1;
+		if (bBase64)
+		{
+			CPerformanceConfig Config (&FileSystem);
+			CHECK (Config.Init (8, true));
+			Config.Load ();
+			CHECK (Config.Save ());
+		}
+
+		CPerformanceConfig Reloaded (&FileSystem);
+		CHECK (Reloaded.Init (8, false));
+		Reloaded.Load ();
+		for (unsigned nTG = 0; nTG < 4; nTG++)
+		{
+			CHECK (Reloaded.VoiceDataFilled (nTG));
+			CHECK (memcmp (Reloaded.GetVoiceData (nTG), Voice[nTG], NUM_VOICE_PARAM) == 0);
+		}
+		CHECK (!Reloaded.VoiceDataFilled (4));
+	}
+
+	// the saved file has the Base64 format
+	FILE *pFile = fopen ((SDCard + "/performance.ini").c_str (), "r");
+	CHECK (pFile != nullptr);
+	std::string File;
+	int nChar;
+	while ((nChar = fgetc (pFile)) != EOF)
+	{
+		File += (char) nChar;
+	}
+	fclose (pFile);
+	CHECK (File.find (std::string ("VoiceDataBase644=") + Base64[3]) != std::string::npos);
+
+	RemoveTestSDCard (SDCard);
+}
+
+int main (void)
+{
+	srand (1);
+
+	TestRoundTrip ();
+	TestPadding ();
+	TestChecksum ();
+	TestHexErrors ();
+	TestPerformanceFile ();
+
+	return TestResult ();
+}
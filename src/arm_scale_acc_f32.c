@@ -0,0 +1,216 @@
+#include "arm_scale_acc_f32.h"
+
+/**
+  Scale a vector with N ramped scalars and add it to N accumulator vectors in
+  one pass. For floating-point data, the algorithm used is:
+
+  <pre>
+      ppDst[k][n] += pSrc[n] * (pScale[k] + n * pStep[k])   0 <= n < blockSize, 0 <= k < N.
+  </pre>
+
+  The input is read only once, there are no temporary buffers. A step of 0
+  gives a constant scale.
+ */
+
+#if defined(ARM_MATH_NEON_EXPERIMENTAL)
+void arm_scale_acc2_f32(
+  const float32_t * pSrc,
+  const float32_t * pScale,
+  const float32_t * pStep,
+        float32_t * const * ppDst,
+        uint32_t blockSize)
+{
+    uint32_t blkCnt;                               /* Loop counter */
+    float32_t *pDst1 = ppDst[0];
+    float32_t *pDst2 = ppDst[1];
+    const float32x4_t ramp = { 0.0f, 1.0f, 2.0f, 3.0f };
+
+    float32x4_t in;
+    float32x4_t scale1 = vmlaq_n_f32(vdupq_n_f32(pScale[0]), ramp, pStep[0]);
+    float32x4_t scale2 = vmlaq_n_f32(vdupq_n_f32(pScale[1]), ramp, pStep[1]);
+    const float32x4_t step1 = vdupq_n_f32(pStep[0] * 4.0f);
+    const float32x4_t step2 = vdupq_n_f32(pStep[1] * 4.0f);
+
+    /* Compute 4 outputs per accumulator at a time */
+    blkCnt = blockSize >> 2U;
+
+    while (blkCnt > 0U)
+    {
+        in = vld1q_f32(pSrc);
+
+        vst1q_f32(pDst1, vmlaq_f32(vld1q_f32(pDst1), in, scale1));
+        vst1q_f32(pDst2, vmlaq_f32(vld1q_f32(pDst2), in, scale2));
+
+        scale1 = vaddq_f32(scale1, step1);
+        scale2 = vaddq_f32(scale2, step2);
+
+        /* Increment pointers */
+        pSrc += 4;
+        pDst1 += 4;
+        pDst2 += 4;
+
+        /* Decrement the loop counter */
+        blkCnt--;
+    }
+
+    /* If the blockSize is not a multiple of 4, compute any remaining output samples here.
+    ** No loop unrolling is used. */
+    blkCnt = blockSize & 3;
+
+    float32_t s1 = vgetq_lane_f32(scale1, 0);
+    float32_t s2 = vgetq_lane_f32(scale2, 0);
+
+    while (blkCnt > 0U)
+    {
+        *pDst1++ += *pSrc * s1;
+        *pDst2++ += *pSrc++ * s2;
+
+        s1 += pStep[0];
+        s2 += pStep[1];
+
+        /* Decrement the loop counter */
+        blkCnt--;
+    }
+}
+
+void arm_scale_acc4_f32(
+  const float32_t * pSrc,
+  const float32_t * pScale,
+  const float32_t * pStep,
+        float32_t * const * ppDst,
+        uint32_t blockSize)
+{
+    uint32_t blkCnt;                               /* Loop counter */
+    float32_t *pDst1 = ppDst[0];
+    float32_t *pDst2 = ppDst[1];
+    float32_t *pDst3 = ppDst[2];
+    float32_t *pDst4 = ppDst[3];
+    const float32x4_t ramp = { 0.0f, 1.0f, 2.0f, 3.0f };
+
+    float32x4_t in;
+    float32x4_t scale1 = vmlaq_n_f32(vdupq_n_f32(pScale[0]), ramp, pStep[0]);
+    float32x4_t scale2 = vmlaq_n_f32(vdupq_n_f32(pScale[1]), ramp, pStep[1]);
+    float32x4_t scale3 = vmlaq_n_f32(vdupq_n_f32(pScale[2]), ramp, pStep[2]);
+    float32x4_t scale4 = vmlaq_n_f32(vdupq_n_f32(pScale[3]), ramp, pStep[3]);
+    const float32x4_t step1 = vdupq_n_f32(pStep[0] * 4.0f);
+    const float32x4_t step2 = vdupq_n_f32(pStep[1] * 4.0f);
+    const float32x4_t step3 = vdupq_n_f32(pStep[2] * 4.0f);
+    const float32x4_t step4 = vdupq_n_f32(pStep[3] * 4.0f);
+
+    /* Compute 4 outputs per accumulator at a time */
+    blkCnt = blockSize >> 2U;
+
+    while (blkCnt > 0U)
+    {
+        in = vld1q_f32(pSrc);
+
+        vst1q_f32(pDst1, vmlaq_f32(vld1q_f32(pDst1), in, scale1));
+        vst1q_f32(pDst2, vmlaq_f32(vld1q_f32(pDst2), in, scale2));
+        vst1q_f32(pDst3, vmlaq_f32(vld1q_f32(pDst3), in, scale3));
+        vst1q_f32(pDst4, vmlaq_f32(vld1q_f32(pDst4), in, scale4));
+
+        scale1 = vaddq_f32(scale1, step1);
+        scale2 = vaddq_f32(scale2, step2);
+        scale3 = vaddq_f32(scale3, step3);
+        scale4 = vaddq_f32(scale4, step4);
+
+        /* Increment pointers */
+        pSrc += 4;
+        pDst1 += 4;
+        pDst2 += 4;
+        pDst3 += 4;
+        pDst4 += 4;
+
+        /* Decrement the loop counter */
+        blkCnt--;
+    }
+
+    /* If the blockSize is not a multiple of 4, compute any remaining output samples here.
+    ** No loop unrolling is used. */
+    blkCnt = blockSize & 3;
+
+    float32_t s1 = vgetq_lane_f32(scale1, 0);
+    float32_t s2 = vgetq_lane_f32(scale2, 0);
+    float32_t s3 = vgetq_lane_f32(scale3, 0);
+    float32_t s4 = vgetq_lane_f32(scale4, 0);
+
+    while (blkCnt > 0U)
+    {
+        *pDst1++ += *pSrc * s1;
+        *pDst2++ += *pSrc * s2;
+        *pDst3++ += *pSrc * s3;
+        *pDst4++ += *pSrc++ * s4;
+
+        s1 += pStep[0];
+        s2 += pStep[1];
+        s3 += pStep[2];
+        s4 += pStep[3];
+
+        /* Decrement the loop counter */
+        blkCnt--;
+    }
+}
+#else
+/* The scale is computed from the sample index, so that there is no serial
+   dependency between the samples, and the accumulators do not overlap the
+   input. This lets the compiler vectorize the loops. */
+void arm_scale_acc2_f32(
+  const float32_t * pSrc,
+  const float32_t * pScale,
+  const float32_t * pStep,
+        float32_t * const * ppDst,
+        uint32_t blockSize)
+{
+  uint32_t n;                                    /* Loop counter */
+  const float32_t * __restrict pIn = pSrc;
+  float32_t * __restrict pDst1 = ppDst[0];
+  float32_t * __restrict pDst2 = ppDst[1];
+  const float32_t scale1 = pScale[0];
+  const float32_t scale2 = pScale[1];
+  const float32_t step1 = pStep[0];
+  const float32_t step2 = pStep[1];
+
+  for (n = 0; n < blockSize; n++)
+  {
+      float32_t in = pIn[n];
+      float32_t pos = (float32_t) n;
+
+      pDst1[n] += in * (scale1 + pos * step1);
+      pDst2[n] += in * (scale2 + pos * step2);
+  }
+}
+
+void arm_scale_acc4_f32(
+  const float32_t * pSrc,
+  const float32_t * pScale,
+  const float32_t * pStep,
+        float32_t * const * ppDst,
+        uint32_t blockSize)
+{
+  uint32_t n;                                    /* Loop counter */
+  const float32_t * __restrict pIn = pSrc;
+  float32_t * __restrict pDst1 = ppDst[0];
+  float32_t * __restrict pDst2 = ppDst[1];
+  float32_t * __restrict pDst3 = ppDst[2];
+  float32_t * __restrict pDst4 = ppDst[3];
+  const float32_t scale1 = pScale[0];
+  const float32_t scale2 = pScale[1];
+  const float32_t scale3 = pScale[2];
+  const float32_t scale4 = pScale[3];
+  const float32_t step1 = pStep[0];
+  const float32_t step2 = pStep[1];
+  const float32_t step3 = pStep[2];
+  const float32_t step4 = pStep[3];
+
+  for (n = 0; n < blockSize; n++)
+  {
+      float32_t in = pIn[n];
+      float32_t pos = (float32_t) n;
+
+      pDst1[n] += in * (scale1 + pos * step1);
+      pDst2[n] += in * (scale2 + pos * step2);
+      pDst3[n] += in * (scale3 + pos * step3);
+      pDst4[n] += in * (scale4 + pos * step4);
+  }
+}
+#endif
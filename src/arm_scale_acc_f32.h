@@ -0,0 +1,32 @@
+#pragma once
+
+#include "arm_math_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+* @brief Scale a floating-point vector with two ramped scalars and add it to two vectors.
+* @param[in]     pSrc       points to the input vector
+* @param[in]     pScale     points to the two scale scalars (for the first sample)
+* @param[in]     pStep      points to the two scale increments per sample
+* @param[in,out] ppDst      points to the two accumulator vectors
+* @param[in]     blockSize  number of samples in the vector
+*/
+void arm_scale_acc2_f32(const float32_t * pSrc, const float32_t * pScale, const float32_t * pStep, float32_t * const * ppDst, uint32_t blockSize);
+
+/**
+* @brief Scale a floating-point vector with four ramped scalars and add it to four vectors.
+* @param[in]     pSrc       points to the input vector
+* @param[in]     pScale     points to the four scale scalars (for the first sample)
+* @param[in]     pStep      points to the four scale increments per sample
+* @param[in,out] ppDst      points to the four accumulator vectors
+* @param[in]     blockSize  number of samples in the vector
+*/
+void arm_scale_acc4_f32(const float32_t * pSrc, const float32_t * pScale, const float32_t * pStep, float32_t * const * ppDst, uint32_t blockSize);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,236 @@
+//
+// bankindex.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "bankindex.h"
+#include <fatfs/ff.h>
+#include <circle/logger.h>
+#include <circle/macros.h>
+#include <string.h>
+#include <assert.h>
+
+LOGMODULE ("bankindex");
+
+static const char IndexMagic[4] = {'M', 'D', 'B', 'I'};
+static const uint32_t IndexVersion = 1;
+
+// The index file consists of this header, followed by nBanks entries of
+// TIndexEntry, each followed by the directory name and the file name
+// (without terminating null). All numbers are little endian.
+struct TIndexHeader
+{
+	char		Magic[4];
+	uint32_t	nVersion;
+	uint32_t	nSignature;
+	uint32_t	nBanks;
+}
+PACKED;
+
+struct TIndexEntry
+{
+	uint16_t	nBankID;
+	uint16_t	nDirNameLength;
+	uint16_t	nFileNameLength;
+	char		VoiceName[CBankIndex::VoicesPerBank][CBankIndex::VoiceNameSize];
+}
+PACKED;
+
+CBankIndex::CBankIndex (const char *pDirName, const char *pIndexFileName)
+:	m_DirName (pDirName),
+	m_IndexFileName (pIndexFileName)
+{
+}
+
+uint32_t CBankIndex::GetSignature (unsigned nMaxSubDirs, unsigned nFlags)
+{
+	uint32_t nHash = 2166136261U;		// FNV-1a offset basis
+
+	Hash (&IndexVersion, sizeof IndexVersion, &nHash);
+	Hash (&nFlags, sizeof nFlags, &nHash);
+
+	AddDirectory (m_DirName, nMaxSubDirs, &nHash);
+
+	return nHash;
+}
+
+void CBankIndex::AddDirectory (const std::string &rDirName, unsigned nSubDirsLeft, uint32_t *pHash)
+{
+	DIR Directory;
+	if (f_opendir (&Directory, rDirName.c_str ()) != FR_OK)
+	{
+		return;
+	}
+
+	FILINFO FileInfo;
+	while (   f_readdir (&Directory, &FileInfo) == FR_OK
+	       && FileInfo.fname[0] != '\0')
+	{
+		Hash (FileInfo.fname, strlen (FileInfo.fname) + 1, pHash);
+		Hash (&FileInfo.fsize, sizeof FileInfo.fsize, pHash);
+		Hash (&FileInfo.fdate, sizeof FileInfo.fdate, pHash);
+		Hash (&FileInfo.ftime, sizeof FileInfo.ftime, pHash);
+		Hash (&FileInfo.fattrib, sizeof FileInfo.fattrib, pHash);
+
+		if (   (FileInfo.fattrib & AM_DIR)
+		    && nSubDirsLeft > 0)
+		{
+			AddDirectory (rDirName + "/" + FileInfo.fname, nSubDirsLeft-1, pHash);
+		}
+	}
+
+	f_closedir (&Directory);
+}
+
+void CBankIndex::Hash (const void *pData, size_t nLength, uint32_t *pHash)
+{
+	const uint8_t *p = (const uint8_t *) pData;
+	uint32_t nHash = *pHash;
+
+	while (nLength--)
+	{
+		nHash ^= *p++;
+		nHash *= 16777619U;			// FNV-1a prime
+	}
+
+	*pHash = nHash;
+}
+
+bool CBankIndex::Read (uint32_t nSignature, std::vector<TBank> *pBanks)
+{
+	assert (pBanks);
+	pBanks->clear ();
+
+	FIL File;
+	if (f_open (&File, m_IndexFileName.c_str (), FA_READ | FA_OPEN_EXISTING) != FR_OK)
+	{
+		return false;
+	}
+
+	// read the whole file at once
+	std::vector<uint8_t> Buffer (f_size (&File));
+	UINT nBytesRead;
+	FRESULT Result = f_read (&File, Buffer.data (), Buffer.size (), &nBytesRead);
+	f_close (&File);
+
+	if (   Result != FR_OK
+	    || nBytesRead != Buffer.size ()
+	    || Buffer.size () < sizeof (TIndexHeader))
+	{
+		LOGWARN ("%s: Cannot read file", m_IndexFileName.c_str ());
+
+		return false;
+	}
+
+	const TIndexHeader *pHeader = (const TIndexHeader *) Buffer.data ();
+	if (   memcmp (pHeader->Magic, IndexMagic, sizeof IndexMagic) != 0
+	    || pHeader->nVersion != IndexVersion
+	    || pHeader->nSignature != nSignature)
+	{
+		LOGNOTE ("Bank index is outdated");
+
+		return false;
+	}
+
+	pBanks->resize (pHeader->nBanks);
+
+	size_t nOffset = sizeof (TIndexHeader);
+	for (TBank &rBank : *pBanks)
+	{
+		if (nOffset + sizeof (TIndexEntry) > Buffer.size ())
+		{
+			break;
+		}
+
+		const TIndexEntry *pEntry = (const TIndexEntry *) &Buffer[nOffset];
+		nOffset += sizeof (TIndexEntry);
+
+		if (nOffset + pEntry->nDirNameLength + pEntry->nFileNameLength > Buffer.size ())
+		{
+			break;
+		}
+
+		rBank.nBankID = pEntry->nBankID;
+		memcpy (rBank.VoiceName, pEntry->VoiceName, sizeof rBank.VoiceName);
+
+		rBank.DirName.assign ((const char *) &Buffer[nOffset], pEntry->nDirNameLength);
+		nOffset += pEntry->nDirNameLength;
+
+		rBank.FileName.assign ((const char *) &Buffer[nOffset], pEntry->nFileNameLength);
+		nOffset += pEntry->nFileNameLength;
+	}
+
+	if (nOffset != Buffer.size ())
+	{
+		LOGWARN ("%s: Invalid format", m_IndexFileName.c_str ());
+
+		pBanks->clear ();
+
+		return false;
+	}
+
+	return true;
+}
+
+bool CBankIndex::Write (uint32_t nSignature, const std::vector<TBank> &rBanks)
+{
+	std::vector<uint8_t> Buffer (sizeof (TIndexHeader));
+
+	TIndexHeader *pHeader = (TIndexHeader *) Buffer.data ();
+	memcpy (pHeader->Magic, IndexMagic, sizeof IndexMagic);
+	pHeader->nVersion = IndexVersion;
+	pHeader->nSignature = nSignature;
+	pHeader->nBanks = rBanks.size ();
+
+	for (const TBank &rBank : rBanks)
+	{
+		TIndexEntry Entry;
+		Entry.nBankID = rBank.nBankID;
+		Entry.nDirNameLength = rBank.DirName.length ();
+		Entry.nFileNameLength = rBank.FileName.length ();
+		memcpy (Entry.VoiceName, rBank.VoiceName, sizeof Entry.VoiceName);
+
+		const uint8_t *pEntry = (const uint8_t *) &Entry;
+		Buffer.insert (Buffer.end (), pEntry, pEntry + sizeof Entry);
+		Buffer.insert (Buffer.end (), rBank.DirName.begin (), rBank.DirName.end ());
+		Buffer.insert (Buffer.end (), rBank.FileName.begin (), rBank.FileName.end ());
+	}
+
+	FIL File;
+	if (f_open (&File, m_IndexFileName.c_str (), FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)
+	{
+		LOGWARN ("%s: Cannot create file", m_IndexFileName.c_str ());
+
+		return false;
+	}
+
+	UINT nBytesWritten;
+	FRESULT Result = f_write (&File, Buffer.data (), Buffer.size (), &nBytesWritten);
+
+	if (   f_close (&File) != FR_OK
+	    || Result != FR_OK
+	    || nBytesWritten != Buffer.size ())
+	{
+		LOGWARN ("%s: Cannot write file", m_IndexFileName.c_str ());
+
+		f_unlink (m_IndexFileName.c_str ());
+
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,69 @@
+//
+// bankindex.h
+//
+// See: https://github.com/asb2m10/dexed/blob/master/Documentation/sysex-format.txt
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+#ifndef _bankindex_h
+#define _bankindex_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Persistent index of the voice bank directory tree, which is written after
+// a full scan and allows to skip opening each bank file on later startups.
+// The index is only used, if the signature of the directory tree (names,
+// sizes and timestamps of all entries, read with f_readdir() only) has not
+// changed since it was written.
+
+class CBankIndex
+{
+public:
+	static const unsigned VoicesPerBank = 32;
+	static const unsigned VoiceNameSize = 10;
+
+	struct TBank
+	{
+		unsigned	nBankID;		// 0 .. MaxVoiceBankID
+		std::string	DirName;		// relative to the voice directory
+		std::string	FileName;
+		char		VoiceName[VoicesPerBank][VoiceNameSize];
+	};
+
+public:
+	// FatFs paths (e.g. "SD:/sysex/voice")
+	CBankIndex (const char *pDirName, const char *pIndexFileName);
+
+	// walks the directory tree, nFlags are included into the signature
+	uint32_t GetSignature (unsigned nMaxSubDirs, unsigned nFlags);
+
+	// returns false, if the index does not exist, is invalid or outdated
+	bool Read (uint32_t nSignature, std::vector<TBank> *pBanks);
+
+	bool Write (uint32_t nSignature, const std::vector<TBank> &rBanks);
+
+private:
+	void AddDirectory (const std::string &rDirName, unsigned nSubDirsLeft, uint32_t *pHash);
+
+	static void Hash (const void *pData, size_t nLength, uint32_t *pHash);
+
+private:
+	std::string m_DirName;
+	std::string m_IndexFileName;
+};
+
+#endif
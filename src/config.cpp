@@ -22,6 +22,13 @@
 //
 #include "config.h"
 #include "../Synth_Dexed/src/dexed.h"
+#include <circle/logger.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+LOGMODULE ("config");
 
 CConfig::CConfig (FATFS *pFileSystem)
 :	m_Properties ("minidexed.ini", pFileSystem)
@@ -69,6 +76,16 @@ void CConfig::Load (void)
 		m_nChunkSize = m_Properties.GetNumber ("ChunkSize", 1024);
 #endif
 	}
+	m_nMixerRampTime = m_Properties.GetNumber ("MixerRampTime", 10);
+	if (m_nMixerRampTime > MaxMixerRampTime)
+	{
+		m_nMixerRampTime = MaxMixerRampTime;
+	}
+	m_nOutputLookahead = m_Properties.GetNumber ("OutputLookahead", 0);
+	if (m_nOutputLookahead > MaxOutputLookahead)
+	{
+		m_nOutputLookahead = MaxOutputLookahead;
+	}
 	m_nDACI2CAddress = m_Properties.GetNumber ("DACI2CAddress", 0);
 	m_bChannelsSwapped = m_Properties.GetNumber ("ChannelsSwapped", 0) != 0;
 
@@ -100,6 +117,37 @@ void CConfig::Load (void)
 				m_MIDIThruIn.clear ();
 				m_MIDIThruOut.clear ();
 			}
+			else if (m_MIDIThruIn == m_MIDIThruOut)
+			{
+				LOGWARN ("MIDIThru: Input and output are the same device (%s), ignored",
+					 m_MIDIThruIn.c_str ());
+
+				m_MIDIThruIn.clear ();
+				m_MIDIThruOut.clear ();
+			}
+		}
+	}
+
+	// MIDIThru is the first route, without filters
+	m_nMIDIRoutes = 0;
+	if (!m_MIDIThruIn.empty ())
+	{
+		TMIDIRoute &rRoute = m_MIDIRoute[m_nMIDIRoutes++];
+		rRoute.In = m_MIDIThruIn;
+		rRoute.Out = m_MIDIThruOut;
+		rRoute.nChannelMask = 0xFFFF;
+		rRoute.nTypeMask = MIDIRouteAllTypes;
+	}
+
+	for (unsigned nRoute = 1; nRoute < MaxMIDIRoutes; nRoute++)
+	{
+		char Key[20];
+		snprintf (Key, sizeof Key, "MIDIRoute%u", nRoute);
+
+		const char *pRoute = m_Properties.GetString (Key);
+		if (pRoute)
+		{
+			AddMIDIRoute (Key, pRoute);
 		}
 	}
 	
@@ -107,6 +155,8 @@ void CConfig::Load (void)
 	m_bIgnoreAllNotesOff = m_Properties.GetNumber ("IgnoreAllNotesOff", 0) != 0;
 	m_bMIDIAutoVoiceDumpOnPC = m_Properties.GetNumber ("MIDIAutoVoiceDumpOnPC", 0) != 0;
 	m_bHeaderlessSysExVoices = m_Properties.GetNumber ("HeaderlessSysExVoices", 0) != 0;
+	m_nVoiceBankCacheSize = m_Properties.GetNumber ("VoiceBankCacheSize", 0);
+	m_nVoicePrefetchDepth = m_Properties.GetNumber ("VoicePrefetchDepth", 0);
 	m_bExpandPCAcrossBanks = m_Properties.GetNumber ("ExpandPCAcrossBanks", 1) != 0;
 	
 	m_nMIDISystemCCVol = m_Properties.GetNumber ("MIDISystemCCVol", 0);
@@ -200,6 +250,9 @@ void CConfig::Load (void)
 	m_bProfileEnabled = m_Properties.GetNumber ("ProfileEnabled", 0) != 0;
 	m_bPerformanceSelectToLoad = m_Properties.GetNumber ("PerformanceSelectToLoad", 0) != 0;
 	m_bPerformanceSelectChannel = m_Properties.GetNumber ("PerformanceSelectChannel", 0);
+	m_bPerformanceVoiceDataBase64 = m_Properties.GetNumber ("PerformanceVoiceDataBase64", 0) != 0;
+	m_nPerformanceCrossfadeTime = m_Properties.GetNumber ("PerformanceCrossfadeTime", 0);
+	m_nPerformanceSpareTGs = m_Properties.GetNumber ("PerformanceSpareTGs", 2);
 	
 	// Network
 	m_bNetworkEnabled  = m_Properties.GetNumber ("NetworkEnabled", 0) != 0;
@@ -227,38 +280,6 @@ unsigned CConfig::GetPolyphony (void) const
 	return m_nPolyphony;
 }
 
-unsigned CConfig::GetTGsCore1 (void) const
-{
-#ifndef ARM_ALLOW_MULTI_CORE
-	return 0;
-#else
-	if (m_nToneGenerators > MinToneGenerators)
-	{
-		return TGsCore1 + TGsCore1Opt;
-	}
-	else
-	{
-		return TGsCore1;
-	}
-#endif
-}
-
-unsigned CConfig::GetTGsCore23 (void) const
-{
-#ifndef ARM_ALLOW_MULTI_CORE
-	return 0;
-#else
-	if (m_nToneGenerators > MinToneGenerators)
-	{
-		return TGsCore23 + TGsCore23Opt;
-	}
-	else
-	{
-		return TGsCore23;
-	}
-#endif
-}
-
 bool CConfig::GetUSBGadget (void) const
 {
 	return m_bUSBGadget;
@@ -314,6 +335,16 @@ bool CConfig::GetQuadDAC8Chan (void) const
 	return m_bQuadDAC8Chan;
 }
 
+unsigned CConfig::GetMixerRampTime (void) const
+{
+	return m_nMixerRampTime;
+}
+
+unsigned CConfig::GetOutputLookahead (void) const
+{
+	return m_nOutputLookahead;
+}
+
 unsigned CConfig::GetMIDIBaudRate (void) const
 {
 	return m_nMIDIBaudRate;
@@ -329,6 +360,35 @@ const char *CConfig::GetMIDIThruOut (void) const
 	return m_MIDIThruOut.c_str ();
 }
 
+unsigned CConfig::GetMIDIRoutes (void) const
+{
+	return m_nMIDIRoutes;
+}
+
+const char *CConfig::GetMIDIRouteIn (unsigned nRoute) const
+{
+	assert (nRoute < m_nMIDIRoutes);
+	return m_MIDIRoute[nRoute].In.c_str ();
+}
+
+const char *CConfig::GetMIDIRouteOut (unsigned nRoute) const
+{
+	assert (nRoute < m_nMIDIRoutes);
+	return m_MIDIRoute[nRoute].Out.c_str ();
+}
+
+unsigned CConfig::GetMIDIRouteChannels (unsigned nRoute) const
+{
+	assert (nRoute < m_nMIDIRoutes);
+	return m_MIDIRoute[nRoute].nChannelMask;
+}
+
+unsigned CConfig::GetMIDIRouteTypes (unsigned nRoute) const
+{
+	assert (nRoute < m_nMIDIRoutes);
+	return m_MIDIRoute[nRoute].nTypeMask;
+}
+
 bool CConfig::GetMIDIRXProgramChange (void) const
 {
 	return m_bMIDIRXProgramChange;
@@ -349,6 +409,16 @@ bool CConfig::GetHeaderlessSysExVoices (void) const
 	return m_bHeaderlessSysExVoices;
 }
 
+unsigned CConfig::GetVoiceBankCacheSize (void) const
+{
+	return m_nVoiceBankCacheSize;
+}
+
+unsigned CConfig::GetVoicePrefetchDepth (void) const
+{
+	return m_nVoicePrefetchDepth;
+}
+
 bool CConfig::GetExpandPCAcrossBanks (void) const
 {
 	return m_bExpandPCAcrossBanks;
@@ -738,6 +808,21 @@ unsigned CConfig::GetPerformanceSelectChannel (void) const
 	return m_bPerformanceSelectChannel;
 }
 
+bool CConfig::GetPerformanceVoiceDataBase64 (void) const
+{
+	return m_bPerformanceVoiceDataBase64;
+}
+
+unsigned CConfig::GetPerformanceCrossfadeTime (void) const
+{
+	return m_nPerformanceCrossfadeTime;
+}
+
+unsigned CConfig::GetPerformanceSpareTGs (void) const
+{
+	return m_nPerformanceSpareTGs;
+}
+
 // Network
 bool CConfig::GetNetworkEnabled (void) const
 {
@@ -793,3 +878,168 @@ bool CConfig::GetNetworkFTPEnabled (void) const
 {
 	return m_bNetworkFTPEnabled;
 }
+
+// Parses a route of the form <in>,<out>[,<channels>[,<types>]]. <channels> is
+// a list of channels (1-16) or ranges (e.g. 1-4), <types> a list of message
+// types (note, cc, pc, at, pb, sysex, common, realtime), both separated by
+// '/'. A missing or empty filter or "*" passes everything. Invalid items are
+// ignored and channels out of range are clamped, with a warning each. Routes
+// without devices, with the same device for input and output or which would
+// not pass any message are ignored.
+void CConfig::AddMIDIRoute (const char *pKey, const char *pRoute)
+{
+	assert (pKey);
+	assert (pRoute);
+
+	std::string Field[4];
+	unsigned nFields = 0;
+	for (const char *p = pRoute; nFields < 4; p++)
+	{
+		if (*p == ',' || *p == '\0')
+		{
+			nFields++;
+			if (*p == '\0')
+			{
+				break;
+			}
+		}
+		else if (*p != ' ')
+		{
+			Field[nFields] += *p;
+		}
+	}
+
+	if (   nFields < 2
+	    || Field[0].empty ()
+	    || Field[1].empty ())
+	{
+		LOGWARN ("%s: Input and output device required, ignored", pKey);
+
+		return;
+	}
+
+	if (Field[0] == Field[1])
+	{
+		LOGWARN ("%s: Input and output are the same device (%s), ignored",
+			 pKey, Field[0].c_str ());
+
+		return;
+	}
+
+	assert (m_nMIDIRoutes < MaxMIDIRoutes);
+	TMIDIRoute &rRoute = m_MIDIRoute[m_nMIDIRoutes];
+	rRoute.In = Field[0];
+	rRoute.Out = Field[1];
+	rRoute.nChannelMask = 0xFFFF;
+	rRoute.nTypeMask = MIDIRouteAllTypes;
+
+	if (!Field[2].empty () && Field[2] != "*")
+	{
+		rRoute.nChannelMask = 0;
+
+		std::string Channels (Field[2]);
+
+		char *pSavePtr;
+		for (char *pItem = strtok_r (&Channels[0], "/", &pSavePtr); pItem;
+		     pItem = strtok_r (nullptr, "/", &pSavePtr))
+		{
+			char *pEnd;
+			unsigned nFirst = strtoul (pItem, &pEnd, 10);
+			unsigned nLast = nFirst;
+			if (pEnd != pItem && *pEnd == '-')
+			{
+				char *pLast = pEnd+1;
+				nLast = strtoul (pLast, &pEnd, 10);
+				if (pEnd == pLast)
+				{
+					pEnd = pItem;		// no number after '-'
+				}
+			}
+
+			if (   pEnd == pItem
+			    || *pEnd != '\0'
+			    || nFirst > nLast)
+			{
+				LOGWARN ("%s: Invalid channel \"%s\" ignored", pKey, pItem);
+
+				continue;
+			}
+
+			if (nFirst > 16 || nLast < 1)
+			{
+				LOGWARN ("%s: Channel \"%s\" out of range, ignored", pKey, pItem);
+
+				continue;
+			}
+
+			if (nFirst < 1 || nLast > 16)
+			{
+				LOGWARN ("%s: Channel \"%s\" clamped to 1-16", pKey, pItem);
+
+				nFirst = nFirst < 1 ? 1 : nFirst;
+				nLast = nLast > 16 ? 16 : nLast;
+			}
+
+			for (unsigned nChannel = nFirst; nChannel <= nLast; nChannel++)
+			{
+				rRoute.nChannelMask |= 1U << (nChannel-1);
+			}
+		}
+	}
+
+	if (!Field[3].empty () && Field[3] != "*")
+	{
+		static const struct
+		{
+			const char *pName;
+			unsigned nMask;
+		}
+		Types[] =
+		{
+			{"note",	MIDIRouteNotes},
+			{"cc",		MIDIRouteCC},
+			{"pc",		MIDIRouteProgramChange},
+			{"at",		MIDIRouteAftertouch},
+			{"pb",		MIDIRoutePitchBend},
+			{"sysex",	MIDIRouteSysEx},
+			{"common",	MIDIRouteSystemCommon},
+			{"realtime",	MIDIRouteRealTime}
+		};
+
+		rRoute.nTypeMask = 0;
+
+		std::string TypeList (Field[3]);
+
+		char *pSavePtr;
+		for (char *pItem = strtok_r (&TypeList[0], "/", &pSavePtr); pItem;
+		     pItem = strtok_r (nullptr, "/", &pSavePtr))
+		{
+			unsigned i;
+			for (i = 0; i < sizeof Types / sizeof Types[0]; i++)
+			{
+				if (strcmp (pItem, Types[i].pName) == 0)
+				{
+					rRoute.nTypeMask |= Types[i].nMask;
+
+					break;
+				}
+			}
+
+			if (i == sizeof Types / sizeof Types[0])
+			{
+				LOGWARN ("%s: Unknown message type \"%s\" ignored", pKey, pItem);
+			}
+		}
+	}
+
+	if (   rRoute.nChannelMask == 0
+	    || rRoute.nTypeMask == 0)
+	{
+		LOGWARN ("%s: Route passes no %s, ignored", pKey,
+			 rRoute.nChannelMask == 0 ? "channel" : "message type");
+
+		return;
+	}
+
+	m_nMIDIRoutes++;
+}
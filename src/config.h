@@ -44,6 +44,9 @@ public:
 	static const unsigned AllToneGenerators = 1;
 	static const unsigned DefToneGenerators = AllToneGenerators;
 #else
+	// The per core numbers only determine the number of available TGs.
+	// The TGs are not bound to a core, but are rendered by cores 1-3
+	// together (see CMiniDexed::ScheduleTGs()).
 #if (RASPPI==4 || RASPPI==5)
 	// Pi 4 and 5 quad core
 	// These are max values, default is to support 8 in total with optional 16 TGs
@@ -82,6 +85,24 @@ public:
 #endif
 
 	static const unsigned MaxChunkSize = 4096;
+	static const unsigned MaxOutputLookahead = 4;	// chunks
+	static const unsigned MaxMixerRampTime = 1000;	// milliseconds
+
+	static const unsigned MaxMIDIRoutes = 8 + 1;	// MIDIRoute1..8 and MIDIThru
+
+	// message types, which can be selected for a MIDI route
+	enum TMIDIRouteType
+	{
+		MIDIRouteNotes		= 1 << 0,	// note on/off, polyphonic aftertouch
+		MIDIRouteCC		= 1 << 1,
+		MIDIRouteProgramChange	= 1 << 2,
+		MIDIRouteAftertouch	= 1 << 3,	// channel aftertouch
+		MIDIRoutePitchBend	= 1 << 4,
+		MIDIRouteSysEx		= 1 << 5,
+		MIDIRouteSystemCommon	= 1 << 6,
+		MIDIRouteRealTime	= 1 << 7,
+		MIDIRouteAllTypes	= 0xFF
+	};
 
 #if RASPPI <= 3
 	static const unsigned MaxUSBMIDIDevices = 2;
@@ -102,8 +123,6 @@ public:
 	// TGs and Polyphony
 	unsigned GetToneGenerators (void) const;
 	unsigned GetPolyphony (void) const;
-	unsigned GetTGsCore1 (void) const;
-	unsigned GetTGsCore23 (void) const;
 	
 	// USB Mode
 	bool GetUSBGadget (void) const;
@@ -119,15 +138,25 @@ public:
 	bool GetChannelsSwapped (void) const;
 	unsigned GetEngineType (void) const;
 	bool GetQuadDAC8Chan (void) const; // false if not specified
+	unsigned GetMixerRampTime (void) const;		// milliseconds, 0 to disable
+	unsigned GetOutputLookahead (void) const;	// chunks rendered in advance, 0 to disable
 
 	// MIDI
 	unsigned GetMIDIBaudRate (void) const;
 	const char *GetMIDIThruIn (void) const;	// "" if not specified
 	const char *GetMIDIThruOut (void) const;	// "" if not specified
+	// MIDIThru (if given, the first) and MIDIRoute1..MIDIRoute8 together
+	unsigned GetMIDIRoutes (void) const;
+	const char *GetMIDIRouteIn (unsigned nRoute) const;
+	const char *GetMIDIRouteOut (unsigned nRoute) const;
+	unsigned GetMIDIRouteChannels (unsigned nRoute) const;	// bit mask of channels 0..15
+	unsigned GetMIDIRouteTypes (unsigned nRoute) const;	// bit mask of TMIDIRouteType
 	bool GetMIDIRXProgramChange (void) const;	// true if not specified
 	bool GetIgnoreAllNotesOff (void) const;
 	bool GetMIDIAutoVoiceDumpOnPC (void) const; // false if not specified
 	bool GetHeaderlessSysExVoices (void) const; // false if not specified
+	unsigned GetVoiceBankCacheSize (void) const; // 0 (load all banks) if not specified
+	unsigned GetVoicePrefetchDepth (void) const; // 0 (disabled) if not specified
 	bool GetExpandPCAcrossBanks (void) const; // true if not specified
 	unsigned GetMIDISystemCCVol (void) const;
 	unsigned GetMIDISystemCCPan (void) const;
@@ -239,6 +268,9 @@ public:
 	// Load performance mode. 0 for load just rotating encoder, 1 load just when Select is pushed
 	bool GetPerformanceSelectToLoad (void) const;
 	unsigned GetPerformanceSelectChannel (void) const;
+	bool GetPerformanceVoiceDataBase64 (void) const; // false (hex text) if not specified
+	unsigned GetPerformanceCrossfadeTime (void) const; // milliseconds, 0 (disabled) if not specified
+	unsigned GetPerformanceSpareTGs (void) const;
 
 	unsigned GetMasterVolume() const { return m_nMasterVolume; }
 
@@ -255,6 +287,17 @@ public:
 	const CIPAddress& GetNetworkSyslogServerIPAddress (void) const;
 	bool GetNetworkFTPEnabled (void) const;
 
+private:
+	struct TMIDIRoute
+	{
+		std::string In;
+		std::string Out;
+		unsigned nChannelMask;
+		unsigned nTypeMask;
+	};
+
+	void AddMIDIRoute (const char *pKey, const char *pRoute);
+
 private:
 	CPropertiesFatFsFile m_Properties;
 	
@@ -272,14 +315,20 @@ private:
 	bool m_bChannelsSwapped;
 	unsigned m_EngineType;
 	bool m_bQuadDAC8Chan;
+	unsigned m_nMixerRampTime;
+	unsigned m_nOutputLookahead;
 
 	unsigned m_nMIDIBaudRate;
 	std::string m_MIDIThruIn;
 	std::string m_MIDIThruOut;
+	TMIDIRoute m_MIDIRoute[MaxMIDIRoutes];
+	unsigned m_nMIDIRoutes;
 	bool m_bMIDIRXProgramChange;
 	bool m_bIgnoreAllNotesOff;
 	bool m_bMIDIAutoVoiceDumpOnPC;
 	bool m_bHeaderlessSysExVoices;
+	unsigned m_nVoiceBankCacheSize;
+	unsigned m_nVoicePrefetchDepth;
 	bool m_bExpandPCAcrossBanks;
 	unsigned m_nMIDISystemCCVol;
 	unsigned m_nMIDISystemCCPan;
@@ -369,6 +418,9 @@ private:
 	bool m_bProfileEnabled;
 	bool m_bPerformanceSelectToLoad;
 	unsigned m_bPerformanceSelectChannel;
+	bool m_bPerformanceVoiceDataBase64;
+	unsigned m_nPerformanceCrossfadeTime;
+	unsigned m_nPerformanceSpareTGs;
 
 	unsigned m_nMasterVolume; // Master volume 0-127
 
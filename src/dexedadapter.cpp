@@ -0,0 +1,648 @@
+//
+// dexedadapter.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "dexedadapter.h"
+#include <circle/timer.h>
+#include <circle/synchronize.h>
+#include <circle/sched/scheduler.h>
+#include <string.h>
+#include <assert.h>
+
+CDexedAdapter::CDexedAdapter (uint8_t maxnotes, int rate)
+:	Dexed (maxnotes, rate),
+	m_nControllersPending (0),
+	m_nKeysDown (0),
+	m_bSustainDown (false),
+	m_nWaitTicks (0),
+	m_nDroppedCommands (0),
+	m_nCoalescedUpdates (0),
+	m_nPostedCommands (0)
+{
+	memset (m_KeysDown, 0, sizeof m_KeysDown);
+	memset (m_uchController, 0, sizeof m_uchController);
+	memset (m_VoiceData, 0, sizeof m_VoiceData);
+	Dexed::getVoiceData (m_VoiceData);
+	m_VoiceData[155] = 0x3F;		// all operators on
+}
+
+void CDexedAdapter::loadVoiceParameters (uint8_t* data)
+{
+	assert (data);
+	memcpy (m_VoiceData, data, sizeof (TVoiceData));
+
+	PostVoiceData (CommandLoadVoice, data, sizeof (TVoiceData));
+}
+
+void CDexedAdapter::setVoiceDataElement (uint8_t address, uint8_t value)
+{
+	if (address < sizeof m_VoiceData)
+	{
+		m_VoiceData[address] = value;
+	}
+
+	Post (CommandSetVoiceDataElement, address, value);
+}
+
+void CDexedAdapter::setName (char* name)
+{
+	assert (name);
+	strncpy ((char *) &m_VoiceData[145], name, 10);
+
+	PostVoiceData (CommandSetName, &m_VoiceData[145], 10);
+}
+
+void CDexedAdapter::setOPAll (uint8_t ops)
+{
+	m_VoiceData[155] = ops;
+
+	Post (CommandSetOPAll, ops);
+}
+
+void CDexedAdapter::doRefreshVoice (void)
+{
+	Post (CommandRefreshVoice);
+}
+
+void CDexedAdapter::keyup (int16_t pitch, unsigned nTimestamp)
+{
+	PostEvent (CommandKeyUp, pitch, 0, nTimestamp);
+}
+
+void CDexedAdapter::keydown (int16_t pitch, uint8_t velo, unsigned nTimestamp)
+{
+	PostEvent (CommandKeyDown, pitch, velo, nTimestamp);
+}
+
+void CDexedAdapter::setSustain (bool sustain, unsigned nTimestamp)
+{
+	PostEvent (CommandSetSustain, 0, sustain, nTimestamp);
+}
+
+void CDexedAdapter::setSostenuto (bool sostenuto)
+{
+	Post (CommandSetSostenuto, sostenuto);
+}
+
+void CDexedAdapter::setHold (bool hold)
+{
+	Post (CommandSetHold, hold);
+}
+
+void CDexedAdapter::panic (void)
+{
+	Post (CommandPanic);
+}
+
+void CDexedAdapter::notesOff (void)
+{
+	Post (CommandNotesOff);
+}
+
+void CDexedAdapter::setModWheel (uint8_t value)
+{
+	Latch (ControllerModWheel, value);
+}
+
+void CDexedAdapter::setFootController (uint8_t value)
+{
+	Latch (ControllerFoot, value);
+}
+
+void CDexedAdapter::setBreathController (uint8_t value)
+{
+	Latch (ControllerBreath, value);
+}
+
+void CDexedAdapter::setAftertouch (uint8_t value)
+{
+	Latch (ControllerAftertouch, value);
+}
+
+void CDexedAdapter::setPitchbend (int16_t value)
+{
+	PostValue (CommandSetPitchbend, value);
+}
+
+void CDexedAdapter::ControllersRefresh (void)
+{
+	Post (CommandControllersRefresh);
+}
+
+void CDexedAdapter::setGain (float32_t gain)
+{
+	PostValue (CommandSetGain, gain);
+}
+
+void CDexedAdapter::setCompressor (bool enable)
+{
+	Post (CommandSetCompressor, enable);
+}
+
+void CDexedAdapter::setFilterCutoff (float32_t cutoff)
+{
+	PostValue (CommandSetFilterCutoff, cutoff);
+}
+
+void CDexedAdapter::setFilterResonance (float32_t resonance)
+{
+	PostValue (CommandSetFilterResonance, resonance);
+}
+
+void CDexedAdapter::setMasterTune (int8_t mastertune)
+{
+	PostValue (CommandSetMasterTune, (int16_t) mastertune);
+}
+
+void CDexedAdapter::setTranspose (uint8_t transpose)
+{
+	Post (CommandSetTranspose, transpose);
+}
+
+void CDexedAdapter::setMonoMode (bool mono)
+{
+	Post (CommandSetMonoMode, mono);
+}
+
+void CDexedAdapter::setPBController (uint8_t range, uint8_t step)
+{
+	Post (CommandSetPBController, range, step);
+}
+
+void CDexedAdapter::setPitchbendRange (uint8_t range)
+{
+	Post (CommandSetPitchbendRange, range);
+}
+
+void CDexedAdapter::setPitchbendStep (uint8_t step)
+{
+	Post (CommandSetPitchbendStep, step);
+}
+
+void CDexedAdapter::setPortamentoMode (uint8_t mode)
+{
+	Post (CommandSetPortamentoMode, mode);
+}
+
+void CDexedAdapter::setPortamentoGlissando (uint8_t glissando)
+{
+	Post (CommandSetPortamentoGlissando, glissando);
+}
+
+void CDexedAdapter::setPortamentoTime (uint8_t time)
+{
+	Post (CommandSetPortamentoTime, time);
+}
+
+void CDexedAdapter::setMWController (uint8_t range, uint8_t target, uint8_t mode)
+{
+	Post (CommandSetMWController, range, target, mode);
+}
+
+void CDexedAdapter::setFCController (uint8_t range, uint8_t target, uint8_t mode)
+{
+	Post (CommandSetFCController, range, target, mode);
+}
+
+void CDexedAdapter::setBCController (uint8_t range, uint8_t target, uint8_t mode)
+{
+	Post (CommandSetBCController, range, target, mode);
+}
+
+void CDexedAdapter::setATController (uint8_t range, uint8_t target, uint8_t mode)
+{
+	Post (CommandSetATController, range, target, mode);
+}
+
+void CDexedAdapter::setModWheelTarget (uint8_t target)
+{
+	Post (CommandSetModWheelTarget, target);
+}
+
+void CDexedAdapter::setFootControllerTarget (uint8_t target)
+{
+	Post (CommandSetFootControllerTarget, target);
+}
+
+void CDexedAdapter::setBreathControllerTarget (uint8_t target)
+{
+	Post (CommandSetBreathControllerTarget, target);
+}
+
+void CDexedAdapter::setAftertouchTarget (uint8_t target)
+{
+	Post (CommandSetAftertouchTarget, target);
+}
+
+void CDexedAdapter::getVoiceData (uint8_t* data_copy)
+{
+	assert (data_copy);
+	memcpy (data_copy, m_VoiceData, sizeof (TVoiceData));
+}
+
+uint8_t CDexedAdapter::getVoiceDataElement (uint8_t address)
+{
+	assert (address < sizeof m_VoiceData);
+	return m_VoiceData[address];
+}
+
+void CDexedAdapter::getName (char* buffer)
+{
+	assert (buffer);
+	memcpy (buffer, &m_VoiceData[145], 10);
+	buffer[10] = '\0';
+}
+
+bool CDexedAdapter::hasPendingCommands (void) const
+{
+	return    !m_CommandQueue.IsEmpty ()
+	       || __atomic_load_n (&m_nControllersPending, __ATOMIC_RELAXED) != 0;
+}
+
+void CDexedAdapter::getSamples (float32_t* buffer, uint16_t n_samples,
+				unsigned nStartTicks, unsigned nEndTicks)
+{
+	unsigned nWindowTicks = nEndTicks - nStartTicks;
+	uint16_t nDone = 0;
+
+	ApplyControllers ();
+
+	const TCommand *pCommand;
+	while ((pCommand = m_CommandQueue.Peek ()) != nullptr)
+	{
+		uint16_t nOffset = 0;
+
+		int nDelta = (int) (pCommand->nTimestamp - nStartTicks);
+		if (nDelta > 0 && nWindowTicks > 0)
+		{
+			if ((unsigned) nDelta >= nWindowTicks)
+			{
+				break;			// belongs to the next chunk
+			}
+
+			// Dexed renders in blocks of _N_ samples
+			nOffset = (uint64_t) nDelta * n_samples / nWindowTicks;
+			nOffset -= nOffset % _N_;
+		}
+
+		if (nOffset > nDone)
+		{
+			Dexed::getSamples (buffer + nDone, nOffset - nDone);
+			nDone = nOffset;
+		}
+
+		Apply (*pCommand);
+
+		m_CommandQueue.Remove ();
+	}
+
+	if (nDone < n_samples)
+	{
+		Dexed::getSamples (buffer + nDone, n_samples - nDone);
+	}
+}
+
+unsigned CDexedAdapter::TakeWaitTicks (void)
+{
+	return __atomic_exchange_n (&m_nWaitTicks, 0, __ATOMIC_RELAXED);
+}
+
+unsigned CDexedAdapter::TakeDroppedCommands (void)
+{
+	return __atomic_exchange_n (&m_nDroppedCommands, 0, __ATOMIC_RELAXED);
+}
+
+unsigned CDexedAdapter::TakeCoalescedUpdates (void)
+{
+	return __atomic_exchange_n (&m_nCoalescedUpdates, 0, __ATOMIC_RELAXED);
+}
+
+unsigned CDexedAdapter::TakePostedCommands (void)
+{
+	return __atomic_exchange_n (&m_nPostedCommands, 0, __ATOMIC_RELAXED);
+}
+
+void CDexedAdapter::Post (TCommandType Type, uint8_t uchParam0, uint8_t uchParam1,
+			  uint8_t uchParam2)
+{
+	TCommand Command;
+	Command.Type = Type;
+	Command.uchParam[0] = uchParam0;
+	Command.uchParam[1] = uchParam1;
+	Command.uchParam[2] = uchParam2;
+
+	Put (Command, CTimer::GetClockTicks ());
+}
+
+void CDexedAdapter::PostValue (TCommandType Type, int16_t nValue)
+{
+	TCommand Command;
+	Command.Type = Type;
+	Command.nValue = nValue;
+
+	Put (Command, CTimer::GetClockTicks ());
+}
+
+void CDexedAdapter::PostValue (TCommandType Type, float32_t fValue)
+{
+	TCommand Command;
+	Command.Type = Type;
+	Command.fValue = fValue;
+
+	Put (Command, CTimer::GetClockTicks ());
+}
+
+void CDexedAdapter::PostEvent (TCommandType Type, int16_t nPitch, uint8_t uchValue,
+			       unsigned nTimestamp)
+{
+	TCommand Command;
+	Command.Type = Type;
+	Command.uchParam[0] = uchValue;
+	Command.nValue = nPitch;
+
+	Put (Command, nTimestamp);
+}
+
+void CDexedAdapter::PostVoiceData (TCommandType Type, const uint8_t *pData, size_t nLength)
+{
+	assert (pData);
+	assert (nLength <= sizeof (TVoiceData));
+
+	TVoiceData VoiceData;
+	memcpy (VoiceData.Data, pData, nLength);
+
+	TCommand Command;
+	Command.Type = Type;
+
+	Put (Command, CTimer::GetClockTicks (), &VoiceData);
+}
+
+// The spin lock is never held while waiting for the audio core. A waiting
+// producer in task context yields, so that interrupt handlers can post in the
+// meantime. In interrupt context (and on a single core, where the audio core
+// cannot run meanwhile) the command is dropped at once, if there is no room.
+// The wait is given up after MaxWaitTicks, so that a stalled audio core cannot
+// block the system.
+void CDexedAdapter::Put (TCommand &rCommand, unsigned nTimestamp, const TVoiceData *pVoiceData)
+{
+	rCommand.nTimestamp = nTimestamp;
+
+	unsigned nStartTicks = 0;
+	unsigned nTicks = 0;
+	bool bWaiting = false;
+
+	while (1)
+	{
+		m_PostSpinLock.Acquire ();
+
+		bool bPut = TryPut (rCommand, pVoiceData);
+
+		m_PostSpinLock.Release ();
+
+		if (bWaiting)
+		{
+			nTicks = CTimer::GetClockTicks () - nStartTicks;
+		}
+
+		if (bPut)
+		{
+			__atomic_fetch_add (&m_nPostedCommands, 1, __ATOMIC_RELAXED);
+
+			break;
+		}
+
+#ifdef ARM_ALLOW_MULTI_CORE
+		if (   CurrentExecutionLevel () == TASK_LEVEL
+		    && nTicks < MaxWaitTicks)
+		{
+			if (!bWaiting)
+			{
+				nStartTicks = CTimer::GetClockTicks ();
+				bWaiting = true;
+			}
+
+			CScheduler::Get ()->Yield ();
+
+			continue;
+		}
+#endif
+
+		__atomic_fetch_add (&m_nDroppedCommands, 1, __ATOMIC_RELAXED);
+
+		break;
+	}
+
+	if (nTicks)
+	{
+		__atomic_fetch_add (&m_nWaitTicks, nTicks, __ATOMIC_RELAXED);
+	}
+}
+
+// Key and sustain releases must never be dropped, or notes would hang. So one
+// queue entry is kept free for every key, which is down, and for the pressed
+// sustain pedal. A release takes the entry of its key or pedal, the other
+// commands use the remaining entries only. m_PostSpinLock must be held.
+bool CDexedAdapter::TryPut (const TCommand &rCommand, const TVoiceData *pVoiceData)
+{
+	unsigned nFree = CommandQueueSize - m_CommandQueue.GetCount ();
+	unsigned nReserved = m_nKeysDown + (m_bSustainDown ? 1 : 0);
+	assert (nFree >= nReserved);
+
+	int nKey = -1;
+	if (   (rCommand.Type == CommandKeyDown || rCommand.Type == CommandKeyUp)
+	    && rCommand.nValue >= 0
+	    && rCommand.nValue < MaxKeys)
+	{
+		nKey = rCommand.nValue;
+	}
+
+	bool bKeyDown = nKey >= 0 && (m_KeysDown[nKey / 32] & (1U << (nKey % 32)));
+	bool bSustain = rCommand.Type == CommandSetSustain && rCommand.uchParam[0];
+
+	unsigned nNeeded = 1;
+	if (   (rCommand.Type == CommandKeyUp && bKeyDown)
+	    || (rCommand.Type == CommandSetSustain && !bSustain && m_bSustainDown))
+	{
+		nNeeded = 0;				// uses its reserved entry
+	}
+	else if (   (rCommand.Type == CommandKeyDown && nKey >= 0 && !bKeyDown)
+		 || (bSustain && !m_bSustainDown))
+	{
+		nNeeded = 2;				// reserves an entry for the release
+	}
+
+	if (   nFree < nReserved + nNeeded
+	    || (   pVoiceData
+		&& m_VoiceDataQueue.GetCount () >= VoiceDataQueueSize))
+	{
+		return false;
+	}
+
+	if (pVoiceData)
+	{
+		m_VoiceDataQueue.Put (*pVoiceData);
+	}
+
+	m_CommandQueue.Put (rCommand);
+
+	switch (rCommand.Type)
+	{
+	case CommandKeyDown:
+		if (nKey >= 0 && !bKeyDown)
+		{
+			m_KeysDown[nKey / 32] |= 1U << (nKey % 32);
+			m_nKeysDown++;
+		}
+		break;
+
+	case CommandKeyUp:
+		if (bKeyDown)
+		{
+			m_KeysDown[nKey / 32] &= ~(1U << (nKey % 32));
+			m_nKeysDown--;
+		}
+		break;
+
+	case CommandSetSustain:
+		m_bSustainDown = bSustain;
+		break;
+
+	case CommandPanic:
+	case CommandNotesOff:
+		memset (m_KeysDown, 0, sizeof m_KeysDown);
+		m_nKeysDown = 0;
+		break;
+
+	default:
+		break;
+	}
+
+	return true;
+}
+
+void CDexedAdapter::Apply (const TCommand &rCommand)
+{
+	const uint8_t *pParam = rCommand.uchParam;
+
+	switch (rCommand.Type)
+	{
+	case CommandLoadVoice:
+	case CommandSetName: {
+		TVoiceData VoiceData;
+		if (!m_VoiceDataQueue.Get (&VoiceData))
+		{
+			assert (0);
+			break;
+		}
+
+		if (rCommand.Type == CommandLoadVoice)
+		{
+			Dexed::loadVoiceParameters (VoiceData.Data);
+		}
+		else
+		{
+			Dexed::setName ((char *) VoiceData.Data);
+		}
+		} break;
+
+	case CommandSetVoiceDataElement:	Dexed::setVoiceDataElement (pParam[0], pParam[1]);	break;
+	case CommandSetOPAll:			Dexed::setOPAll (pParam[0]);				break;
+	case CommandRefreshVoice:		Dexed::doRefreshVoice ();				break;
+
+	case CommandKeyUp:			Dexed::keyup (rCommand.nValue);				break;
+	case CommandKeyDown:			Dexed::keydown (rCommand.nValue, pParam[0]);		break;
+	case CommandSetSustain:			Dexed::setSustain (pParam[0] != 0);			break;
+	case CommandSetSostenuto:		Dexed::setSostenuto (pParam[0] != 0);			break;
+	case CommandSetHold:			Dexed::setHold (pParam[0] != 0);			break;
+	case CommandPanic:			Dexed::panic ();					break;
+	case CommandNotesOff:			Dexed::notesOff ();					break;
+
+	case CommandSetPitchbend:		Dexed::setPitchbend (rCommand.nValue);			break;
+	case CommandControllersRefresh:		Dexed::ControllersRefresh ();				break;
+
+	case CommandSetGain:			Dexed::setGain (rCommand.fValue);			break;
+	case CommandSetCompressor:		Dexed::setCompressor (pParam[0] != 0);			break;
+	case CommandSetFilterCutoff:		Dexed::setFilterCutoff (rCommand.fValue);		break;
+	case CommandSetFilterResonance:		Dexed::setFilterResonance (rCommand.fValue);		break;
+	case CommandSetMasterTune:		Dexed::setMasterTune ((int8_t) rCommand.nValue);	break;
+	case CommandSetTranspose:		Dexed::setTranspose (pParam[0]);			break;
+	case CommandSetMonoMode:		Dexed::setMonoMode (pParam[0] != 0);			break;
+
+	case CommandSetPBController:		Dexed::setPBController (pParam[0], pParam[1]);		break;
+	case CommandSetPitchbendRange:		Dexed::setPitchbendRange (pParam[0]);			break;
+	case CommandSetPitchbendStep:		Dexed::setPitchbendStep (pParam[0]);			break;
+	case CommandSetPortamentoMode:		Dexed::setPortamentoMode (pParam[0]);			break;
+	case CommandSetPortamentoGlissando:	Dexed::setPortamentoGlissando (pParam[0]);		break;
+	case CommandSetPortamentoTime:		Dexed::setPortamentoTime (pParam[0]);			break;
+
+	case CommandSetMWController:	Dexed::setMWController (pParam[0], pParam[1], pParam[2]);	break;
+	case CommandSetFCController:	Dexed::setFCController (pParam[0], pParam[1], pParam[2]);	break;
+	case CommandSetBCController:	Dexed::setBCController (pParam[0], pParam[1], pParam[2]);	break;
+	case CommandSetATController:	Dexed::setATController (pParam[0], pParam[1], pParam[2]);	break;
+	case CommandSetModWheelTarget:		Dexed::setModWheelTarget (pParam[0]);			break;
+	case CommandSetFootControllerTarget:	Dexed::setFootControllerTarget (pParam[0]);		break;
+	case CommandSetBreathControllerTarget:	Dexed::setBreathControllerTarget (pParam[0]);		break;
+	case CommandSetAftertouchTarget:	Dexed::setAftertouchTarget (pParam[0]);			break;
+	}
+}
+
+void CDexedAdapter::Latch (TController Controller, uint8_t uchValue)
+{
+	assert (Controller < ControllerCount);
+	__atomic_store_n (&m_uchController[Controller], uchValue, __ATOMIC_RELAXED);
+
+	unsigned nMask = 1U << Controller;
+	if (__atomic_fetch_or (&m_nControllersPending, nMask, __ATOMIC_RELEASE) & nMask)
+	{
+		// the previous value has not been applied yet
+		__atomic_fetch_add (&m_nCoalescedUpdates, 1, __ATOMIC_RELAXED);
+	}
+}
+
+// Called on the audio core at the start of a chunk. A value may be newer than
+// its pending bit, it is applied again with the next chunk then.
+void CDexedAdapter::ApplyControllers (void)
+{
+	unsigned nPending = __atomic_exchange_n (&m_nControllersPending, 0, __ATOMIC_ACQUIRE);
+	if (!nPending)
+	{
+		return;
+	}
+
+	if (nPending & (1U << ControllerModWheel))
+	{
+		Dexed::setModWheel (__atomic_load_n (&m_uchController[ControllerModWheel], __ATOMIC_RELAXED));
+	}
+
+	if (nPending & (1U << ControllerFoot))
+	{
+		Dexed::setFootController (__atomic_load_n (&m_uchController[ControllerFoot], __ATOMIC_RELAXED));
+	}
+
+	if (nPending & (1U << ControllerBreath))
+	{
+		Dexed::setBreathController (__atomic_load_n (&m_uchController[ControllerBreath], __ATOMIC_RELAXED));
+	}
+
+	if (nPending & (1U << ControllerAftertouch))
+	{
+		Dexed::setAftertouch (__atomic_load_n (&m_uchController[ControllerAftertouch], __ATOMIC_RELAXED));
+	}
+
+	Dexed::ControllersRefresh ();
+}
@@ -24,64 +24,212 @@
 #include <synth_dexed.h>
 #include <circle/spinlock.h>
 #include <stdint.h>
+#include "spscqueue.h"
 
 #define DEXED_OP_ENABLE (DEXED_OP_OSC_DETUNE + 1)
 
-// Some Dexed methods require to be guarded from being interrupted
-// by other Dexed calls. This is done herein.
+// The Dexed instance is owned by the audio core, which calls getSamples().
+// All methods, which modify the Dexed state at runtime, are posted as commands
+// to a bounded queue instead, which is applied at the start of getSamples().
+// Commands are time-stamped (in CTimer clock ticks), so that notes are applied
+// at their position inside the rendered chunk, which is mapped to the time
+// window given by the caller.
+//
+// Commands are posted on core 0 from task and interrupt context, which is
+// serialized by a spin lock on the producer side only. The audio core never
+// waits for it. If the queue is full, a producer in task context yields until
+// the audio core has made room (multi-core only). Otherwise the command is
+// dropped, but key and sustain releases never are, because queue entries are
+// reserved for them. The voice data getters return a shadow copy, which is
+// updated when posting.
+//
+// Configuration methods, which are only called before the audio starts (e.g.
+// setEngineType()), are not wrapped.
+//
+// The values of the mod wheel, foot and breath controller and aftertouch are
+// not queued, but latched. Their last values are applied once per chunk,
+// followed by a single controller refresh, so that a dense controller stream
+// does not fill the queue with updates, which would be overwritten anyway.
 
 class CDexedAdapter : public Dexed
 {
 public:
-	CDexedAdapter (uint8_t maxnotes, int rate)
-	: Dexed (maxnotes, rate)
-	{
-	}
+	CDexedAdapter (uint8_t maxnotes, int rate);
 
-	void loadVoiceParameters (uint8_t* data)
-	{
-		m_SpinLock.Acquire ();
-		Dexed::loadVoiceParameters (data);
-		m_SpinLock.Release ();
-	}
+	void loadVoiceParameters (uint8_t* data);
+	void setVoiceDataElement (uint8_t address, uint8_t value);
+	void setName (char* name);
+	void setOPAll (uint8_t ops);
+	void doRefreshVoice (void);
 
-	void keyup (int16_t pitch)
-	{
-		m_SpinLock.Acquire ();
-		Dexed::keyup (pitch);
-		m_SpinLock.Release ();
-	}
+	// nTimestamp is the arrival time of the MIDI event
+	void keyup (int16_t pitch, unsigned nTimestamp);
+	void keydown (int16_t pitch, uint8_t velo, unsigned nTimestamp);
+	void setSustain (bool sustain, unsigned nTimestamp);
+
+	void setSostenuto (bool sostenuto);
+	void setHold (bool hold);
+	void panic (void);
+	void notesOff (void);
+
+	void setModWheel (uint8_t value);
+	void setFootController (uint8_t value);
+	void setBreathController (uint8_t value);
+	void setAftertouch (uint8_t value);
+	void setPitchbend (int16_t value);
+	void ControllersRefresh (void);
+
+	void setGain (float32_t gain);
+	void setCompressor (bool enable);
+	void setFilterCutoff (float32_t cutoff);
+	void setFilterResonance (float32_t resonance);
+	void setMasterTune (int8_t mastertune);
+	void setTranspose (uint8_t transpose);
+	void setMonoMode (bool mono);
+
+	void setPBController (uint8_t range, uint8_t step);
+	void setPitchbendRange (uint8_t range);
+	void setPitchbendStep (uint8_t step);
+	void setPortamentoMode (uint8_t mode);
+	void setPortamentoGlissando (uint8_t glissando);
+	void setPortamentoTime (uint8_t time);
+
+	void setMWController (uint8_t range, uint8_t target, uint8_t mode);
+	void setFCController (uint8_t range, uint8_t target, uint8_t mode);
+	void setBCController (uint8_t range, uint8_t target, uint8_t mode);
+	void setATController (uint8_t range, uint8_t target, uint8_t mode);
+	void setModWheelTarget (uint8_t target);
+	void setFootControllerTarget (uint8_t target);
+	void setBreathControllerTarget (uint8_t target);
+	void setAftertouchTarget (uint8_t target);
+
+	// return the shadow copy of the voice data
+	void getVoiceData (uint8_t* data_copy);
+	uint8_t getVoiceDataElement (uint8_t address);
+	void getName (char* buffer);
+
+	// called on the audio core only
+	bool hasPendingCommands (void) const;
 
-	void keydown (int16_t pitch, uint8_t velo)
+	// render n_samples, which will be output for the time window
+	// [nStartTicks, nEndTicks) and apply queued commands falling into it
+	void getSamples (float32_t* buffer, uint16_t n_samples,
+			 unsigned nStartTicks, unsigned nEndTicks);
+
+	// statistics of the producer side, reset on read
+	unsigned TakeWaitTicks (void);
+	unsigned TakeDroppedCommands (void);
+	unsigned TakeCoalescedUpdates (void);	// overwritten controller values
+	unsigned TakePostedCommands (void);
+
+private:
+	enum TCommandType : uint8_t
 	{
-		m_SpinLock.Acquire ();
-		Dexed::keydown (pitch, velo);
-		m_SpinLock.Release ();
-	}
+		CommandLoadVoice,
+		CommandSetVoiceDataElement,
+		CommandSetName,
+		CommandSetOPAll,
+		CommandRefreshVoice,
+		CommandKeyUp,
+		CommandKeyDown,
+		CommandSetSustain,
+		CommandSetSostenuto,
+		CommandSetHold,
+		CommandPanic,
+		CommandNotesOff,
+		CommandSetPitchbend,
+		CommandControllersRefresh,
+		CommandSetGain,
+		CommandSetCompressor,
+		CommandSetFilterCutoff,
+		CommandSetFilterResonance,
+		CommandSetMasterTune,
+		CommandSetTranspose,
+		CommandSetMonoMode,
+		CommandSetPBController,
+		CommandSetPitchbendRange,
+		CommandSetPitchbendStep,
+		CommandSetPortamentoMode,
+		CommandSetPortamentoGlissando,
+		CommandSetPortamentoTime,
+		CommandSetMWController,
+		CommandSetFCController,
+		CommandSetBCController,
+		CommandSetATController,
+		CommandSetModWheelTarget,
+		CommandSetFootControllerTarget,
+		CommandSetBreathControllerTarget,
+		CommandSetAftertouchTarget
+	};
 
-	void getSamples (float32_t* buffer, uint16_t n_samples)
+	struct TCommand
 	{
-		m_SpinLock.Acquire ();
-		Dexed::getSamples (buffer, n_samples);
-		m_SpinLock.Release ();
-	}
+		unsigned	nTimestamp;
+		TCommandType	Type;
+		uint8_t		uchParam[3];
+		union
+		{
+			int16_t		nValue;
+			float32_t	fValue;
+		};
+	};
 
-	void ControllersRefresh (void)
+	// the payload of CommandLoadVoice and CommandSetName
+	struct TVoiceData
 	{
-		m_SpinLock.Acquire ();
-		Dexed::ControllersRefresh ();
-		m_SpinLock.Release ();
-	}
+		uint8_t		Data[155];
+	};
 
-	void setSustain (bool sustain)
+	enum TController
 	{
-		m_SpinLock.Acquire ();
-		Dexed::setSustain (sustain);
-		m_SpinLock.Release ();
-	}
+		ControllerModWheel,
+		ControllerFoot,
+		ControllerBreath,
+		ControllerAftertouch,
+		ControllerCount
+	};
+
+	void Post (TCommandType Type, uint8_t uchParam0 = 0, uint8_t uchParam1 = 0,
+		   uint8_t uchParam2 = 0);
+	void PostValue (TCommandType Type, int16_t nValue);
+	void PostValue (TCommandType Type, float32_t fValue);
+	void PostEvent (TCommandType Type, int16_t nPitch, uint8_t uchValue, unsigned nTimestamp);
+	void PostVoiceData (TCommandType Type, const uint8_t *pData, size_t nLength);
+
+	void Put (TCommand &rCommand, unsigned nTimestamp, const TVoiceData *pVoiceData = 0);
+	bool TryPut (const TCommand &rCommand, const TVoiceData *pVoiceData);
+
+	void Apply (const TCommand &rCommand);
+
+	void Latch (TController Controller, uint8_t uchValue);
+	void ApplyControllers (void);
 
 private:
-	CSpinLock m_SpinLock;
+	static const unsigned CommandQueueSize = 256;
+	// loading a performance posts the program and the voice data of the
+	// performance into each TG, there is room for four loads in a row
+	static const unsigned VoiceDataQueueSize = 8;
+	static const unsigned MaxWaitTicks = 100000;	// 100 ms
+	static const int MaxKeys = 128;
+
+	CSPSCQueue<TCommand, CommandQueueSize> m_CommandQueue;
+	CSPSCQueue<TVoiceData, VoiceDataQueueSize> m_VoiceDataQueue;
+	CSpinLock m_PostSpinLock;
+
+	uint8_t m_VoiceData[156];			// shadow copy
+
+	uint8_t m_uchController[ControllerCount];	// latched values
+	unsigned m_nControllersPending;			// bit mask of TController
+
+	// producer side, protected by m_PostSpinLock
+	uint32_t m_KeysDown[MaxKeys / 32];		// keys with a queued release
+	unsigned m_nKeysDown;
+	bool m_bSustainDown;
+
+	unsigned m_nWaitTicks;
+	unsigned m_nDroppedCommands;
+	unsigned m_nCoalescedUpdates;
+	unsigned m_nPostedCommands;
 };
 
 #endif
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <assert.h>
 #include "arm_math.h"
+#include "arm_scale_acc_f32.h"
 
 #define UNITY_GAIN 1.0f
 #define MAX_GAIN 1.0f
@@ -14,6 +15,7 @@
 #define UNITY_PANORAMA 1.0f
 #define MAX_PANORAMA 1.0f
 #define MIN_PANORAMA 0.0f
+#define MIXER_BLOCK_SIZE 256	// samples per bus, mixed for all channels at once
 
 template <int NN> class AudioMixer
 {
@@ -22,7 +24,10 @@ public:
 	{
 		buffer_length=len;
 		for (uint8_t i=0; i<NN; i++)
+		{
 			multiplier[i] = UNITY_GAIN;
+			vol[i] = UNITY_GAIN;
+		}
 
 		sumbufL=new float32_t[buffer_length];
 		arm_fill_f32(0.0f, sumbufL, len);
@@ -35,13 +40,10 @@ public:
 
         void doAddMix(uint8_t channel, float32_t* in)
 	{
-		float32_t tmp[buffer_length];
-
 		assert(in);
 
-		if(multiplier[channel]!=UNITY_GAIN)
-			arm_scale_f32(in,multiplier[channel],tmp,buffer_length);
-		arm_add_f32(sumbufL, tmp, sumbufL, buffer_length);
+		for (uint16_t i = 0; i < buffer_length; i++)
+			sumbufL[i] += in[i] * multiplier[channel] * vol[channel];
 	}
 
 	void gain(uint8_t channel, float32_t gain)
@@ -67,6 +69,18 @@ public:
 		} 
 	}
 
+	// linear volume, applied on top of gain()
+	void volume(uint8_t channel, float32_t volume)
+	{
+		if (channel >= NN) return;
+
+		if (volume > MAX_GAIN)
+			volume = MAX_GAIN;
+		else if (volume < MIN_GAIN)
+			volume = MIN_GAIN;
+		vol[channel] = volume;
+	}
+
 	void getMix(float32_t* buffer)
 	{
 		assert(buffer);
@@ -79,6 +93,7 @@ public:
 
 protected:
 	float32_t multiplier[NN];
+	float32_t vol[NN];
 	float32_t* sumbufL;
 	uint16_t buffer_length;
 };
@@ -92,7 +107,15 @@ public:
 		{
 			panorama[i][0] = UNITY_PANORAMA;
 			panorama[i][1] = UNITY_PANORAMA;
+
+			for (uint8_t k=0; k<2; k++)
+			{
+				current[i][k] = 0.0f;
+				ramp_target[i][k] = 0.0f;
+				ramp_left[i][k] = 0;
+			}
 		}
+		ramp_buffers = 0;
 
 		sumbufR=new float32_t[buffer_length];
 		arm_fill_f32(0.0f, sumbufR, buffer_length);
@@ -117,18 +140,81 @@ public:
 		panorama[channel][1]=arm_cos_f32(mapfloat(pan, MIN_PANORAMA, MAX_PANORAMA, 0.0, M_PI/2.0));
 	}
 
+	// Changes of gain, volume and panorama are ramped linearly over the
+	// given number of samples (rounded up to whole buffers), 0 disables it.
+	// The ramps are limited to 65535 buffers.
+	void rampLength(uint32_t samples)
+	{
+		uint32_t buffers = samples / buffer_length + (samples % buffer_length != 0);
+		ramp_buffers = buffers < UINT16_MAX ? buffers : UINT16_MAX;
+	}
+
 	void doAddMix(uint8_t channel, float32_t* in)
 	{
-		float32_t tmp[buffer_length];
+		float32_t scale[2];
+		float32_t step[2];
+		float32_t* dst[2] = { sumbufL, sumbufR };
 
 		assert(in);
 
-		// left
-		arm_scale_f32(in, panorama[channel][0] * multiplier[channel], tmp, buffer_length);
-		arm_add_f32(sumbufL, tmp, sumbufL, buffer_length);
-		// right
-		arm_scale_f32(in, panorama[channel][1] * multiplier[channel], tmp, buffer_length);
-		arm_add_f32(sumbufR, tmp, sumbufR, buffer_length);
+		rampGains(channel, scale, step);
+		arm_scale_acc2_f32(in, scale, step, dst, buffer_length);
+	}
+
+	// Mix channels 0..channels-1 (nullptr inputs are skipped) into this mixer
+	// and, if given, into the send mixer with its own gain and panorama.
+	// Each input is read once for all four buses. The buses are processed in
+	// blocks of MIXER_BLOCK_SIZE samples, so that they stay in the cache
+	// while all channels are added.
+	void doAddMix(const float32_t* const* in, uint8_t channels, AudioStereoMixer<NN>* send = nullptr)
+	{
+		float32_t scale[NN][4];
+		float32_t step[NN][4];
+		float32_t block_scale[4];
+		float32_t* dst[4];
+
+		assert(in);
+		assert(channels <= NN);
+		assert(!send || send->buffer_length == buffer_length);
+
+		// advance the ramps of all channels, even if skipped
+		for (uint8_t i = 0; i < channels; i++)
+		{
+			rampGains(i, &scale[i][0], &step[i][0]);
+
+			if (send)
+				send->rampGains(i, &scale[i][2], &step[i][2]);
+		}
+
+		for (uint16_t offset = 0; offset < buffer_length; offset += MIXER_BLOCK_SIZE)
+		{
+			uint16_t len = buffer_length - offset;
+			if (len > MIXER_BLOCK_SIZE)
+				len = MIXER_BLOCK_SIZE;
+
+			dst[0] = sumbufL + offset;
+			dst[1] = sumbufR + offset;
+
+			if (send)
+			{
+				dst[2] = send->sumbufL + offset;
+				dst[3] = send->sumbufR + offset;
+			}
+
+			for (uint8_t i = 0; i < channels; i++)
+			{
+				if (!in[i])
+					continue;
+
+				for (uint8_t k = 0; k < 4; k++)
+					block_scale[k] = scale[i][k] + step[i][k] * offset;
+
+				if (send)
+					arm_scale_acc4_f32(in[i] + offset, block_scale, step[i], dst, len);
+				else
+					arm_scale_acc2_f32(in[i] + offset, block_scale, step[i], dst, len);
+			}
+		}
 	}
 
 	void getMix(float32_t* bufferL, float32_t* bufferR)
@@ -147,6 +233,24 @@ public:
 			arm_fill_f32(0.0f, sumbufR, buffer_length);
 	}
 
+	// Copy gain, volume, panorama and ramp state of channel src to dst, so
+	// that a signal moved to dst continues with the same gains.
+	void copyChannel(uint8_t dst, uint8_t src)
+	{
+		if (dst >= NN || src >= NN) return;
+
+		multiplier[dst] = multiplier[src];
+		vol[dst] = vol[src];
+
+		for (uint8_t k = 0; k < 2; k++)
+		{
+			panorama[dst][k] = panorama[src][k];
+			current[dst][k] = current[src][k];
+			ramp_target[dst][k] = ramp_target[src][k];
+			ramp_left[dst][k] = ramp_left[src][k];
+		}
+	}
+
 	void getBuffers(float32_t (*buffers[2]))
 	{
 		buffers[0] = sumbufL;
@@ -162,11 +266,52 @@ public:
 	}
 
 protected:
+	// Returns the left and right gain of a channel at the start of the
+	// buffer and their increments per sample, and advances the ramp by one
+	// buffer. Runs in the audio path only, the parameter setters do not touch
+	// the ramp state.
+	void rampGains(uint8_t channel, float32_t* scale, float32_t* step)
+	{
+		for (uint8_t k = 0; k < 2; k++)
+		{
+			float32_t target = panorama[channel][k] * multiplier[channel] * vol[channel];
+
+			if (target != ramp_target[channel][k])
+			{
+				ramp_target[channel][k] = target;
+				ramp_left[channel][k] = ramp_buffers;
+			}
+
+			scale[k] = current[channel][k];
+
+			if (ramp_left[channel][k] > 0)
+			{
+				float32_t end = ramp_left[channel][k] == 1 ? target :
+					current[channel][k] + (target - current[channel][k]) / ramp_left[channel][k];
+				ramp_left[channel][k]--;
+
+				step[k] = (end - current[channel][k]) / buffer_length;
+				current[channel][k] = end;
+			}
+			else
+			{
+				scale[k] = current[channel][k] = target;
+				step[k] = 0.0f;
+			}
+		}
+	}
+
 	using AudioMixer<NN>::sumbufL;
 	using AudioMixer<NN>::multiplier;
+	using AudioMixer<NN>::vol;
 	using AudioMixer<NN>::buffer_length;
 	float32_t panorama[NN][2];
 	float32_t* sumbufR;
+
+	float32_t current[NN][2];	// gains at the start of the next buffer
+	float32_t ramp_target[NN][2];
+	uint16_t ramp_left[NN][2];	// buffers until ramp_target is reached
+	uint16_t ramp_buffers;
 };
 
 #endif
@@ -88,23 +88,17 @@ AudioEffectPlateReverb::AudioEffectPlateReverb(float32_t samplerate)
     input_attn = 0.5f;
     in_allp_k = INP_ALLP_COEFF;
 
+    rv_pos = 0;
+
     memset(in_allp1_bufL, 0, sizeof(in_allp1_bufL));
     memset(in_allp2_bufL, 0, sizeof(in_allp2_bufL));
     memset(in_allp3_bufL, 0, sizeof(in_allp3_bufL));
     memset(in_allp4_bufL, 0, sizeof(in_allp4_bufL));
-    in_allp1_idxL = 0;
-    in_allp2_idxL = 0;
-    in_allp3_idxL = 0;
-    in_allp4_idxL = 0;
 
     memset(in_allp1_bufR, 0, sizeof(in_allp1_bufR));
     memset(in_allp2_bufR, 0, sizeof(in_allp2_bufR));
     memset(in_allp3_bufR, 0, sizeof(in_allp3_bufR));
     memset(in_allp4_bufR, 0, sizeof(in_allp4_bufR));
-    in_allp1_idxR = 0;
-    in_allp2_idxR = 0;
-    in_allp3_idxR = 0;
-    in_allp4_idxR = 0;
 
     in_allp_out_R = 0.0f;
 
@@ -112,10 +106,6 @@ AudioEffectPlateReverb::AudioEffectPlateReverb(float32_t samplerate)
     memset(lp_allp2_buf, 0, sizeof(lp_allp2_buf));
     memset(lp_allp3_buf, 0, sizeof(lp_allp3_buf));
     memset(lp_allp4_buf, 0, sizeof(lp_allp4_buf));
-    lp_allp1_idx = 0;
-    lp_allp2_idx = 0;
-    lp_allp3_idx = 0;
-    lp_allp4_idx = 0;
     loop_allp_k = LOOP_ALLOP_COEFF;
     lp_allp_out = 0.0f;
 
@@ -123,10 +113,6 @@ AudioEffectPlateReverb::AudioEffectPlateReverb(float32_t samplerate)
     memset(lp_dly2_buf, 0, sizeof(lp_dly2_buf));
     memset(lp_dly3_buf, 0, sizeof(lp_dly3_buf));
     memset(lp_dly4_buf, 0, sizeof(lp_dly4_buf));
-    lp_dly1_idx = 0;
-    lp_dly2_idx = 0;
-    lp_dly3_idx = 0;
-    lp_dly4_idx = 0;
 
     lp_hidamp_k = 1.0f;
     lp_lodamp_k = 0.0f;
@@ -153,22 +139,68 @@ AudioEffectPlateReverb::AudioEffectPlateReverb(float32_t samplerate)
     lfo2_phase_acc = 0;
     lfo2_adder = (UINT32_MAX + 1)/(samplerate * LFO2_FREQ_HZ);  
 
+    // the cosine outputs are taken from the table without interpolation
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t idx = (i + 64) & 0xFF;
+        int64_t y = (int64_t)AudioWaveformSine[idx] * (0x00FFFFFF - idx);
+        y += (int64_t)AudioWaveformSine[idx + 1] * idx;
+        lfo_cos_table[i] = (int32_t) (y >> (32-8)); // 16bit output
+    }
+
     reverb_level = 0.0f;
 }
 
 // #define sat16(n, rshift) signed_saturate_rshift((n), 16, (rshift))
 
-void AudioEffectPlateReverb::doReverb(const float32_t* inblockL, const float32_t* inblockR, float32_t* rvbblockL, float32_t* rvbblockR, uint16_t len)
-{
-    float32_t input, acc, temp1, temp2;
-    uint16_t temp16;
-    float32_t rv_time;
+// Power-of-two ring buffer access: sample written "delay" samples before the
+// current write position
+#define RV_READ(buf, delay)     ((buf)[(rv_pos - (delay)) & (sizeof(buf)/sizeof(float32_t) - 1)])
+#define RV_WRITE(buf)           ((buf)[rv_pos & (sizeof(buf)/sizeof(float32_t) - 1)])
 
-    // for LFOs:
-    int16_t lfo1_out_sin, lfo1_out_cos, lfo2_out_sin, lfo2_out_cos;
+// Modulated tap, read "offset" samples after the oldest sample of the delay
+// line and interpolated with the LFO fractional part
+#define RV_TAP(buf, len, offset, lfo) \
+    (RV_READ(buf, (len) - 1 - (offset) - ((lfo)>>LFO_FRAC_BITS)) * (1.0f - RV_TAP_K(lfo)) \
+   + RV_READ(buf, (len) - 2 - (offset) - ((lfo)>>LFO_FRAC_BITS)) * RV_TAP_K(lfo))
+#define RV_TAP_K(lfo)           ((float32_t)((lfo) & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK)) // interp. k
+
+void AudioEffectPlateReverb::doLFOs(uint16_t len)
+{
     int32_t y0, y1;
     int64_t y;
     uint32_t idx;
+
+    assert(len <= RV_BLOCK_SIZE);
+
+    for (uint16_t i=0; i < len; i++)
+    {
+        lfo1_phase_acc += lfo1_adder;
+        idx = lfo1_phase_acc >> 24;     // 8bit lookup table address
+        y0 =  AudioWaveformSine[idx];
+        y1 = AudioWaveformSine[idx+1];
+        lfo1_out_cos[i] = lfo_cos_table[idx];
+        idx = lfo1_phase_acc & 0x00FFFFFF;   // lower 24 bit = fractional part
+        y = (int64_t)y0 * (0x00FFFFFF - idx);
+        y += (int64_t)y1 * idx;
+        lfo1_out_sin[i] = (int32_t) (y >> (32-8)); // 16bit output
+
+        lfo2_phase_acc += lfo2_adder;
+        idx = lfo2_phase_acc >> 24;     // 8bit lookup table address
+        y0 =  AudioWaveformSine[idx];
+        y1 = AudioWaveformSine[idx+1];
+        lfo2_out_cos[i] = lfo_cos_table[idx];
+        idx = lfo2_phase_acc & 0x00FFFFFF;   // lower 24 bit = fractional part
+        y = (int64_t)y0 * (0x00FFFFFF - idx);
+        y += (int64_t)y1 * idx;
+        lfo2_out_sin[i] = (int32_t) (y >> (32-8)); //32-8->output 16bit,
+    }
+}
+
+void AudioEffectPlateReverb::doReverb(const float32_t* inblockL, const float32_t* inblockR, float32_t* rvbblockL, float32_t* rvbblockR, uint16_t len)
+{
+    float32_t input, acc, temp1, temp2;
+    float32_t rv_time;
     static bool cleanup_done = false;
 
     // handle bypass, 1st call will clean the buffers to avoid continuing the previous reverb tail
@@ -202,96 +234,98 @@ void AudioEffectPlateReverb::doReverb(const float32_t* inblockL, const float32_t
 
     rv_time = rv_time_k;
 
-    for (uint16_t i=0; i < len; i++) 
+    for (uint16_t i=0; i < len; i++, rv_pos++) 
     {
-        // do the LFOs
-        lfo1_phase_acc += lfo1_adder;
-        idx = lfo1_phase_acc >> 24;     // 8bit lookup table address
-        y0 =  AudioWaveformSine[idx];
-        y1 = AudioWaveformSine[idx+1];
-        idx = lfo1_phase_acc & 0x00FFFFFF;   // lower 24 bit = fractional part
-        y = (int64_t)y0 * (0x00FFFFFF - idx);
-        y += (int64_t)y1 * idx;
-        lfo1_out_sin = (int32_t) (y >> (32-8)); // 16bit output
-        idx = ((lfo1_phase_acc >> 24)+64) & 0xFF;
-        y0 = AudioWaveformSine[idx];
-        y1 = AudioWaveformSine[idx + 1];
-        y = (int64_t)y0 * (0x00FFFFFF - idx);
-        y += (int64_t)y1 * idx;
-        lfo1_out_cos = (int32_t) (y >> (32-8)); // 16bit output        
+        uint16_t j = i % RV_BLOCK_SIZE;
 
-        lfo2_phase_acc += lfo2_adder;
-        idx = lfo2_phase_acc >> 24;     // 8bit lookup table address
-        y0 =  AudioWaveformSine[idx];
-        y1 = AudioWaveformSine[idx+1];
-        idx = lfo2_phase_acc & 0x00FFFFFF;   // lower 24 bit = fractional part
-        y = (int64_t)y0 * (0x00FFFFFF - idx);
-        y += (int64_t)y1 * idx;
-        lfo2_out_sin = (int32_t) (y >> (32-8)); //32-8->output 16bit,
-        idx = ((lfo2_phase_acc >> 24)+64) & 0xFF;
-        y0 = AudioWaveformSine[idx];
-        y1 = AudioWaveformSine[idx + 1];
-        y = (int64_t)y0 * (0x00FFFFFF - idx);
-        y += (int64_t)y1 * idx;
-        lfo2_out_cos = (int32_t) (y >> (32-8)); // 16bit output   
+        // do the LFOs for a block of samples at once
+        if (j == 0)
+        {
+            doLFOs(len - i < RV_BLOCK_SIZE ? len - i : RV_BLOCK_SIZE);
+        }
 
-	input = inblockL[i] * input_attn;
+#if defined(ARM_MATH_NEON)
+        // chained input allpasses, channel L and R in the two lanes
+        float32x2_t inputLR = vmul_n_f32(vset_lane_f32(inblockR[i], vdup_n_f32(inblockL[i]), 1), input_attn);
+        float32x2_t accLR, bufLR;
+
+        bufLR = vld1_lane_f32(&RV_READ(in_allp1_bufR, in_allp1_lenR), vld1_dup_f32(&RV_READ(in_allp1_bufL, in_allp1_lenL)), 1);
+        accLR = vmla_n_f32(bufLR, inputLR, in_allp_k);
+        bufLR = vmls_n_f32(inputLR, accLR, in_allp_k);
+        vst1_lane_f32(&RV_WRITE(in_allp1_bufL), bufLR, 0);
+        vst1_lane_f32(&RV_WRITE(in_allp1_bufR), bufLR, 1);
+        inputLR = accLR;
+
+        bufLR = vld1_lane_f32(&RV_READ(in_allp2_bufR, in_allp2_lenR), vld1_dup_f32(&RV_READ(in_allp2_bufL, in_allp2_lenL)), 1);
+        accLR = vmla_n_f32(bufLR, inputLR, in_allp_k);
+        bufLR = vmls_n_f32(inputLR, accLR, in_allp_k);
+        vst1_lane_f32(&RV_WRITE(in_allp2_bufL), bufLR, 0);
+        vst1_lane_f32(&RV_WRITE(in_allp2_bufR), bufLR, 1);
+        inputLR = accLR;
+
+        bufLR = vld1_lane_f32(&RV_READ(in_allp3_bufR, in_allp3_lenR), vld1_dup_f32(&RV_READ(in_allp3_bufL, in_allp3_lenL)), 1);
+        accLR = vmla_n_f32(bufLR, inputLR, in_allp_k);
+        bufLR = vmls_n_f32(inputLR, accLR, in_allp_k);
+        vst1_lane_f32(&RV_WRITE(in_allp3_bufL), bufLR, 0);
+        vst1_lane_f32(&RV_WRITE(in_allp3_bufR), bufLR, 1);
+        inputLR = accLR;
+
+        bufLR = vld1_lane_f32(&RV_READ(in_allp4_bufR, in_allp4_lenR), vld1_dup_f32(&RV_READ(in_allp4_bufL, in_allp4_lenL)), 1);
+        accLR = vmla_n_f32(bufLR, inputLR, in_allp_k);
+        bufLR = vmls_n_f32(inputLR, accLR, in_allp_k);
+        vst1_lane_f32(&RV_WRITE(in_allp4_bufL), bufLR, 0);
+        vst1_lane_f32(&RV_WRITE(in_allp4_bufR), bufLR, 1);
+        in_allp_out_L = vget_lane_f32(accLR, 0);
+        in_allp_out_R = vget_lane_f32(accLR, 1);
+#else
+        input = inblockL[i] * input_attn;
 
         // chained input allpasses, channel L
-        acc = in_allp1_bufL[in_allp1_idxL]  + input * in_allp_k;  
-        in_allp1_bufL[in_allp1_idxL] = input - in_allp_k * acc;
+        acc = RV_READ(in_allp1_bufL, in_allp1_lenL)  + input * in_allp_k;  
+        RV_WRITE(in_allp1_bufL) = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp1_idxL >= sizeof(in_allp1_bufL)/sizeof(float32_t)) in_allp1_idxL = 0;
 
-        acc = in_allp2_bufL[in_allp2_idxL]  + input * in_allp_k;  
-        in_allp2_bufL[in_allp2_idxL] = input - in_allp_k * acc;
+        acc = RV_READ(in_allp2_bufL, in_allp2_lenL)  + input * in_allp_k;  
+        RV_WRITE(in_allp2_bufL) = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp2_idxL >= sizeof(in_allp2_bufL)/sizeof(float32_t)) in_allp2_idxL = 0;
 
-        acc = in_allp3_bufL[in_allp3_idxL]  + input * in_allp_k;  
-        in_allp3_bufL[in_allp3_idxL] = input - in_allp_k * acc;
+        acc = RV_READ(in_allp3_bufL, in_allp3_lenL)  + input * in_allp_k;  
+        RV_WRITE(in_allp3_bufL) = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp3_idxL >= sizeof(in_allp3_bufL)/sizeof(float32_t)) in_allp3_idxL = 0;
 
-        acc = in_allp4_bufL[in_allp4_idxL]  + input * in_allp_k;  
-        in_allp4_bufL[in_allp4_idxL] = input - in_allp_k * acc;
+        acc = RV_READ(in_allp4_bufL, in_allp4_lenL)  + input * in_allp_k;  
+        RV_WRITE(in_allp4_bufL) = input - in_allp_k * acc;
         in_allp_out_L = acc;
-        if (++in_allp4_idxL >= sizeof(in_allp4_bufL)/sizeof(float32_t)) in_allp4_idxL = 0;
 
         input = inblockR[i] * input_attn;
 
         // chained input allpasses, channel R
-        acc = in_allp1_bufR[in_allp1_idxR]  + input * in_allp_k;  
-        in_allp1_bufR[in_allp1_idxR] = input - in_allp_k * acc;
+        acc = RV_READ(in_allp1_bufR, in_allp1_lenR)  + input * in_allp_k;  
+        RV_WRITE(in_allp1_bufR) = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp1_idxR >= sizeof(in_allp1_bufR)/sizeof(float32_t)) in_allp1_idxR = 0;
 
-        acc = in_allp2_bufR[in_allp2_idxR]  + input * in_allp_k;  
-        in_allp2_bufR[in_allp2_idxR] = input - in_allp_k * acc;
+        acc = RV_READ(in_allp2_bufR, in_allp2_lenR)  + input * in_allp_k;  
+        RV_WRITE(in_allp2_bufR) = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp2_idxR >= sizeof(in_allp2_bufR)/sizeof(float32_t)) in_allp2_idxR = 0;
 
-        acc = in_allp3_bufR[in_allp3_idxR]  + input * in_allp_k;  
-        in_allp3_bufR[in_allp3_idxR] = input - in_allp_k * acc;
+        acc = RV_READ(in_allp3_bufR, in_allp3_lenR)  + input * in_allp_k;  
+        RV_WRITE(in_allp3_bufR) = input - in_allp_k * acc;
         input = acc;
-        if (++in_allp3_idxR >= sizeof(in_allp3_bufR)/sizeof(float32_t)) in_allp3_idxR = 0;
 
-        acc = in_allp4_bufR[in_allp4_idxR]  + input * in_allp_k;  
-        in_allp4_bufR[in_allp4_idxR] = input - in_allp_k * acc;
+        acc = RV_READ(in_allp4_bufR, in_allp4_lenR)  + input * in_allp_k;  
+        RV_WRITE(in_allp4_bufR) = input - in_allp_k * acc;
         in_allp_out_R = acc;
-        if (++in_allp4_idxR >= sizeof(in_allp4_bufR)/sizeof(float32_t)) in_allp4_idxR = 0;
+#endif
 
         // input allpases done, start loop allpases
         input = lp_allp_out + in_allp_out_R; 
-        acc = lp_allp1_buf[lp_allp1_idx] + input * loop_allp_k;                  // input is the lp allpass chain output
-        lp_allp1_buf[lp_allp1_idx] = input - loop_allp_k * acc;
+        acc = RV_READ(lp_allp1_buf, lp_allp1_len) + input * loop_allp_k;            // input is the lp allpass chain output
+        RV_WRITE(lp_allp1_buf) = input - loop_allp_k * acc;
         input = acc;
-        if (++lp_allp1_idx >= sizeof(lp_allp1_buf)/sizeof(float32_t)) lp_allp1_idx = 0;
         
-        acc = lp_dly1_buf[lp_dly1_idx];                                                   // read the end of the delay
-        lp_dly1_buf[lp_dly1_idx] = input;                                                 // write new sample
+        acc = RV_READ(lp_dly1_buf, lp_dly1_len);                                     // read the end of the delay
+        RV_WRITE(lp_dly1_buf) = input;                                               // write new sample
         input = acc;
-        if (++lp_dly1_idx >= sizeof(lp_dly1_buf)/sizeof(float32_t)) lp_dly1_idx = 0;     // update index
 
         // hi/lo shelving filter
         temp1 = input - lpf1;
@@ -304,14 +338,12 @@ void AudioEffectPlateReverb::doReverb(const float32_t* inblockL, const float32_t
         
         input = acc + in_allp_out_L;
 
-        acc = lp_allp2_buf[lp_allp2_idx] + input * loop_allp_k;                  
-        lp_allp2_buf[lp_allp2_idx] = input - loop_allp_k * acc;
+        acc = RV_READ(lp_allp2_buf, lp_allp2_len) + input * loop_allp_k;                  
+        RV_WRITE(lp_allp2_buf) = input - loop_allp_k * acc;
         input = acc;
-        if (++lp_allp2_idx >= sizeof(lp_allp2_buf)/sizeof(float32_t)) lp_allp2_idx = 0;
-        acc = lp_dly2_buf[lp_dly2_idx];                                                   // read the end of the delay
-        lp_dly2_buf[lp_dly2_idx] = input;                                                 // write new sample
+        acc = RV_READ(lp_dly2_buf, lp_dly2_len);                                     // read the end of the delay
+        RV_WRITE(lp_dly2_buf) = input;                                               // write new sample
         input = acc;
-        if (++lp_dly2_idx >= sizeof(lp_dly2_buf)/sizeof(float32_t)) lp_dly2_idx = 0;     // update index
         // hi/lo shelving filter
         temp1 = input - lpf2;
         lpf2 += temp1 * lp_lowpass_f;
@@ -323,14 +355,12 @@ void AudioEffectPlateReverb::doReverb(const float32_t* inblockL, const float32_t
 
         input = acc + in_allp_out_R;
 
-        acc = lp_allp3_buf[lp_allp3_idx] + input * loop_allp_k;                  
-        lp_allp3_buf[lp_allp3_idx] = input - loop_allp_k * acc;
+        acc = RV_READ(lp_allp3_buf, lp_allp3_len) + input * loop_allp_k;                  
+        RV_WRITE(lp_allp3_buf) = input - loop_allp_k * acc;
         input = acc;
-        if (++lp_allp3_idx >= sizeof(lp_allp3_buf)/sizeof(float32_t)) lp_allp3_idx = 0;
-        acc = lp_dly3_buf[lp_dly3_idx];                                                   // read the end of the delay
-        lp_dly3_buf[lp_dly3_idx] = input;                                                 // write new sample
+        acc = RV_READ(lp_dly3_buf, lp_dly3_len);                                     // read the end of the delay
+        RV_WRITE(lp_dly3_buf) = input;                                               // write new sample
         input = acc;
-        if (++lp_dly3_idx >= sizeof(lp_dly3_buf)/sizeof(float32_t)) lp_dly3_idx = 0;     // update index
         // hi/lo shelving filter
         temp1 = input - lpf3;
         lpf3 += temp1 * lp_lowpass_f;
@@ -342,14 +372,12 @@ void AudioEffectPlateReverb::doReverb(const float32_t* inblockL, const float32_t
 
         input = acc + in_allp_out_L;       
 
-        acc = lp_allp4_buf[lp_allp4_idx] + input * loop_allp_k;                  
-        lp_allp4_buf[lp_allp4_idx] = input - loop_allp_k * acc;
+        acc = RV_READ(lp_allp4_buf, lp_allp4_len) + input * loop_allp_k;                  
+        RV_WRITE(lp_allp4_buf) = input - loop_allp_k * acc;
         input = acc;
-        if (++lp_allp4_idx >= sizeof(lp_allp4_buf)/sizeof(float32_t)) lp_allp4_idx = 0;
-        acc = lp_dly4_buf[lp_dly4_idx];                                                   // read the end of the delay
-        lp_dly4_buf[lp_dly4_idx] = input;                                                 // write new sample
+        acc = RV_READ(lp_dly4_buf, lp_dly4_len);                                     // read the end of the delay
+        RV_WRITE(lp_dly4_buf) = input;                                               // write new sample
         input = acc;
-        if (++lp_dly4_idx >= sizeof(lp_dly4_buf)/sizeof(float32_t)) lp_dly4_idx= 0;     // update index
         // hi/lo shelving filter
         temp1 = input - lpf4;
         lpf4 += temp1 * lp_lowpass_f;
@@ -363,43 +391,20 @@ void AudioEffectPlateReverb::doReverb(const float32_t* inblockL, const float32_t
 
         // channel L:
 #ifdef TAP1_MODULATED
-        temp16 = (lp_dly1_idx + lp_dly1_offset_L + (lfo1_out_cos>>LFO_FRAC_BITS)) %  (sizeof(lp_dly1_buf)/sizeof(float32_t));
-        temp1 = lp_dly1_buf[temp16++];    // sample now
-        if (temp16  >= sizeof(lp_dly1_buf)/sizeof(float32_t)) temp16 = 0;
-        temp2 = lp_dly1_buf[temp16];    // sample next
-        input = (float32_t)(lfo1_out_cos & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
-        acc = (temp1*(1.0f-input) + temp2*input)* 0.8f;
+        acc = RV_TAP(lp_dly1_buf, lp_dly1_len, lp_dly1_offset_L, lfo1_out_cos[j]) * 0.8f;
 #else
-        temp16 = (lp_dly1_idx + lp_dly1_offset_L) %  (sizeof(lp_dly1_buf)/sizeof(float32_t));
-        acc = lp_dly1_buf[temp16]* 0.8f;
+        acc = RV_READ(lp_dly1_buf, lp_dly1_len - 1 - lp_dly1_offset_L) * 0.8f;
 #endif
 
-
 #ifdef TAP2_MODULATED
-        temp16 = (lp_dly2_idx + lp_dly2_offset_L + (lfo1_out_sin>>LFO_FRAC_BITS)) % (sizeof(lp_dly2_buf)/sizeof(float32_t));
-        temp1 = lp_dly2_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly2_buf)/sizeof(float32_t)) temp16 = 0;
-        temp2 = lp_dly2_buf[temp16]; 
-        input = (float32_t)(lfo1_out_sin & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
-        acc += (temp1*(1.0f-input) + temp2*input)* 0.7f;
+        acc += RV_TAP(lp_dly2_buf, lp_dly2_len, lp_dly2_offset_L, lfo1_out_sin[j]) * 0.7f;
 #else
-        temp16 = (lp_dly2_idx + lp_dly2_offset_L) % (sizeof(lp_dly2_buf)/sizeof(float32_t));
-        acc += (temp1*(1.0f-input) + temp2*input)* 0.6f;
+        acc += RV_READ(lp_dly2_buf, lp_dly2_len - 1 - lp_dly2_offset_L) * 0.6f;
 #endif
 
-        temp16 = (lp_dly3_idx + lp_dly3_offset_L + (lfo2_out_cos>>LFO_FRAC_BITS)) % (sizeof(lp_dly3_buf)/sizeof(float32_t));
-        temp1 = lp_dly3_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly3_buf)/sizeof(float32_t)) temp16 = 0;
-        temp2 = lp_dly3_buf[temp16]; 
-        input = (float32_t)(lfo2_out_cos & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
-        acc += (temp1*(1.0f-input) + temp2*input)* 0.6f;
-
-        temp16 = (lp_dly4_idx + lp_dly4_offset_L + (lfo2_out_sin>>LFO_FRAC_BITS)) % (sizeof(lp_dly4_buf)/sizeof(float32_t));
-        temp1 = lp_dly4_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly4_buf)/sizeof(float32_t)) temp16 = 0;
-        temp2 = lp_dly4_buf[temp16]; 
-        input = (float32_t)(lfo2_out_sin & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
-        acc += (temp1*(1.0f-input) + temp2*input)* 0.5f;
+        acc += RV_TAP(lp_dly3_buf, lp_dly3_len, lp_dly3_offset_L, lfo2_out_cos[j]) * 0.6f;
+
+        acc += RV_TAP(lp_dly4_buf, lp_dly4_len, lp_dly4_offset_L, lfo2_out_sin[j]) * 0.5f;
 
         // Master lowpass filter
         temp1 = acc - master_lowpass_l;
@@ -409,40 +414,21 @@ void AudioEffectPlateReverb::doReverb(const float32_t* inblockL, const float32_t
 
         // Channel R
         #ifdef TAP1_MODULATED
-        temp16 = (lp_dly1_idx + lp_dly1_offset_R + (lfo2_out_cos>>LFO_FRAC_BITS)) %  (sizeof(lp_dly1_buf)/sizeof(float32_t));
-        temp1 = lp_dly1_buf[temp16++];    // sample now
-        if (temp16  >= sizeof(lp_dly1_buf)/sizeof(float32_t)) temp16 = 0;
-        temp2 = lp_dly1_buf[temp16];    // sample next
-        input = (float32_t)(lfo2_out_cos & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
-
-        acc = (temp1*(1.0f-input) + temp2*input)* 0.8f;
+        acc = RV_TAP(lp_dly1_buf, lp_dly1_len, lp_dly1_offset_R, lfo2_out_cos[j]) * 0.8f;
         #else
-        temp16 = (lp_dly1_idx + lp_dly1_offset_R) %  (sizeof(lp_dly1_buf)/sizeof(float32_t));
-        acc = lp_dly1_buf[temp16] * 0.8f;
+        acc = RV_READ(lp_dly1_buf, lp_dly1_len - 1 - lp_dly1_offset_R) * 0.8f;
         #endif
 #ifdef TAP2_MODULATED
-        temp16 = (lp_dly2_idx + lp_dly2_offset_R + (lfo1_out_cos>>LFO_FRAC_BITS)) % (sizeof(lp_dly2_buf)/sizeof(float32_t));
-        temp1 = lp_dly2_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly2_buf)/sizeof(float32_t)) temp16 = 0;
-        temp2 = lp_dly2_buf[temp16]; 
-        input = (float32_t)(lfo1_out_cos & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
-        acc += (temp1*(1.0f-input) + temp2*input)* 0.7f;
+        acc += RV_TAP(lp_dly2_buf, lp_dly2_len, lp_dly2_offset_R, lfo1_out_cos[j]) * 0.7f;
 #else
-        temp16 = (lp_dly2_idx + lp_dly2_offset_R) % (sizeof(lp_dly2_buf)/sizeof(float32_t));
-        acc += (temp1*(1.0f-input) + temp2*input)* 0.7f;
+        acc += RV_READ(lp_dly2_buf, lp_dly2_len - 1 - lp_dly2_offset_R) * 0.7f;
 #endif
-        temp16 = (lp_dly3_idx + lp_dly3_offset_R + (lfo2_out_sin>>LFO_FRAC_BITS)) % (sizeof(lp_dly3_buf)/sizeof(float32_t));
-        temp1 = lp_dly3_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly3_buf)/sizeof(float32_t)) temp16 = 0;
-        temp2 = lp_dly3_buf[temp16]; 
-        input = (float32_t)(lfo2_out_sin & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
-        acc += (temp1*(1.0f-input) + temp2*input)* 0.6f;
-
-        temp16 = (lp_dly4_idx + lp_dly4_offset_R + (lfo1_out_sin>>LFO_FRAC_BITS)) % (sizeof(lp_dly4_buf)/sizeof(float32_t));
-        temp1 = lp_dly4_buf[temp16++];
-        if (temp16  >= sizeof(lp_dly4_buf)/sizeof(float32_t)) temp16 = 0;
-        temp2 = lp_dly4_buf[temp16]; 
-        input = (float32_t)(lfo2_out_cos & LFO_FRAC_MASK) / ((float32_t)LFO_FRAC_MASK); // interp. k
+        acc += RV_TAP(lp_dly3_buf, lp_dly3_len, lp_dly3_offset_R, lfo2_out_sin[j]) * 0.6f;
+
+        // the tap position follows LFO1, the interpolation LFO2
+        temp1 = RV_READ(lp_dly4_buf, lp_dly4_len - 1 - lp_dly4_offset_R - (lfo1_out_sin[j]>>LFO_FRAC_BITS));
+        temp2 = RV_READ(lp_dly4_buf, lp_dly4_len - 2 - lp_dly4_offset_R - (lfo1_out_sin[j]>>LFO_FRAC_BITS));
+        input = RV_TAP_K(lfo2_out_cos[j]);
         acc += (temp1*(1.0f-input) + temp2*input)* 0.5f;
 
         // Master lowpass filter
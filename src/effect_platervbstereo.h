@@ -56,6 +56,8 @@
 //#define TAP1_MODULATED
 #define TAP2_MODULATED
 
+#define RV_BLOCK_SIZE   32      // samples per LFO block
+
 class AudioEffectPlateReverb
 {
 public:
@@ -114,43 +116,51 @@ private:
     float32_t reverb_level;
     float32_t input_attn;
 
+    // All delay lines share one write position (rv_pos). The buffers are
+    // rounded up to a power of two, so that wrapping is a simple mask. The
+    // delay time is given by the read offset below, not by the buffer size.
+    enum
+    {
+        in_allp1_lenL = 224,        // input allpass delays
+        in_allp2_lenL = 420,
+        in_allp3_lenL = 856,
+        in_allp4_lenL = 1089,
+        in_allp1_lenR = 156,
+        in_allp2_lenR = 520,
+        in_allp3_lenR = 956,
+        in_allp4_lenR = 1289,
+        lp_allp1_len = 2303,        // loop allpass delays
+        lp_allp2_len = 2905,
+        lp_allp3_len = 3175,
+        lp_allp4_len = 2398,
+        lp_dly1_len = 3423,         // loop delays
+        lp_dly2_len = 4589,
+        lp_dly3_len = 4365,
+        lp_dly4_len = 3698
+    };
+    uint32_t rv_pos;
+
     float32_t in_allp_k;            // input allpass coeff 
-    float32_t in_allp1_bufL[224];   // input allpass buffers
-    float32_t in_allp2_bufL[420];
-    float32_t in_allp3_bufL[856];
-    float32_t in_allp4_bufL[1089];
-    uint16_t in_allp1_idxL;
-    uint16_t in_allp2_idxL;
-    uint16_t in_allp3_idxL;
-    uint16_t in_allp4_idxL;
+    float32_t in_allp1_bufL[256];   // input allpass buffers
+    float32_t in_allp2_bufL[512];
+    float32_t in_allp3_bufL[1024];
+    float32_t in_allp4_bufL[2048];
     float32_t in_allp_out_L;    // L allpass chain output
-    float32_t in_allp1_bufR[156]; // input allpass buffers
-    float32_t in_allp2_bufR[520];
-    float32_t in_allp3_bufR[956];
-    float32_t in_allp4_bufR[1289];
-    uint16_t in_allp1_idxR;
-    uint16_t in_allp2_idxR;
-    uint16_t in_allp3_idxR;
-    uint16_t in_allp4_idxR;
+    float32_t in_allp1_bufR[256]; // input allpass buffers
+    float32_t in_allp2_bufR[1024];
+    float32_t in_allp3_bufR[1024];
+    float32_t in_allp4_bufR[2048];
     float32_t in_allp_out_R;    // R allpass chain output
-    float32_t lp_allp1_buf[2303]; // loop allpass buffers
-    float32_t lp_allp2_buf[2905];
-    float32_t lp_allp3_buf[3175];
-    float32_t lp_allp4_buf[2398];
-    uint16_t lp_allp1_idx;
-    uint16_t lp_allp2_idx;
-    uint16_t lp_allp3_idx;
-    uint16_t lp_allp4_idx;
+    float32_t lp_allp1_buf[4096]; // loop allpass buffers
+    float32_t lp_allp2_buf[4096];
+    float32_t lp_allp3_buf[4096];
+    float32_t lp_allp4_buf[4096];
     float32_t loop_allp_k;         // loop allpass coeff
     float32_t lp_allp_out;
-    float32_t lp_dly1_buf[3423];
-    float32_t lp_dly2_buf[4589];
-    float32_t lp_dly3_buf[4365];
-    float32_t lp_dly4_buf[3698];
-    uint16_t lp_dly1_idx;
-    uint16_t lp_dly2_idx;
-    uint16_t lp_dly3_idx;
-    uint16_t lp_dly4_idx;
+    float32_t lp_dly1_buf[4096];
+    float32_t lp_dly2_buf[8192];
+    float32_t lp_dly3_buf[8192];
+    float32_t lp_dly4_buf[4096];
 
     const uint16_t lp_dly1_offset_L = 201;      // delay line tap offets
     const uint16_t lp_dly2_offset_L = 145;
@@ -191,6 +201,17 @@ private:
 
     uint32_t lfo2_phase_acc;    // LFO 2
     uint32_t lfo2_adder;
+
+    void doLFOs(uint16_t len);
+
+    // LFO outputs for the current block
+    int16_t lfo1_out_sin[RV_BLOCK_SIZE];
+    int16_t lfo1_out_cos[RV_BLOCK_SIZE];
+    int16_t lfo2_out_sin[RV_BLOCK_SIZE];
+    int16_t lfo2_out_cos[RV_BLOCK_SIZE];
+
+    // The cosine outputs depend on the table address only
+    int16_t lfo_cos_table[256];
 };
 
 #endif // _EFFECT_PLATEREV_H
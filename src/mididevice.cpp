@@ -22,6 +22,7 @@
 //
 
 #include <circle/logger.h>
+#include <circle/timer.h>
 #include "mididevice.h"
 #include "minidexed.h"
 #include "config.h"
@@ -54,10 +55,46 @@ const unsigned MIDISystemCCMap[NUM_MIDI_CC_MAPS][8] = {
 
 CMIDIDevice::TDeviceMap CMIDIDevice::s_DeviceMap;
 
+unsigned CMIDIDevice::s_nRouteMessages[CConfig::MaxMIDIRoutes];
+unsigned CMIDIDevice::s_nRouteMaxLatencyTicks[CConfig::MaxMIDIRoutes];
+
+const u8 CMIDIDevice::s_ChannelMessageType[8] =
+{
+	CConfig::MIDIRouteNotes,		// 0x80 Note Off
+	CConfig::MIDIRouteNotes,		// 0x90 Note On
+	CConfig::MIDIRouteNotes,		// 0xA0 Polyphonic Aftertouch
+	CConfig::MIDIRouteCC,			// 0xB0 Control Change
+	CConfig::MIDIRouteProgramChange,	// 0xC0 Program Change
+	CConfig::MIDIRouteAftertouch,		// 0xD0 Channel Aftertouch
+	CConfig::MIDIRoutePitchBend,		// 0xE0 Pitch Bend
+	0					// 0xF0 System, see below
+};
+
+const u8 CMIDIDevice::s_SystemMessageType[16] =
+{
+	CConfig::MIDIRouteSysEx,		// 0xF0
+	CConfig::MIDIRouteSystemCommon,		// 0xF1
+	CConfig::MIDIRouteSystemCommon,		// 0xF2
+	CConfig::MIDIRouteSystemCommon,		// 0xF3
+	CConfig::MIDIRouteSystemCommon,		// 0xF4
+	CConfig::MIDIRouteSystemCommon,		// 0xF5
+	CConfig::MIDIRouteSystemCommon,		// 0xF6
+	CConfig::MIDIRouteSysEx,		// 0xF7
+	CConfig::MIDIRouteRealTime,		// 0xF8
+	CConfig::MIDIRouteRealTime,		// 0xF9
+	CConfig::MIDIRouteRealTime,		// 0xFA
+	CConfig::MIDIRouteRealTime,		// 0xFB
+	CConfig::MIDIRouteRealTime,		// 0xFC
+	CConfig::MIDIRouteRealTime,		// 0xFD
+	CConfig::MIDIRouteRealTime,		// 0xFE
+	CConfig::MIDIRouteRealTime		// 0xFF
+};
+
 CMIDIDevice::CMIDIDevice (CMiniDexed *pSynthesizer, CConfig *pConfig, CUserInterface *pUI)
 :	m_pSynthesizer (pSynthesizer),
 	m_pConfig (pConfig),
-	m_pUI (pUI)
+	m_pUI (pUI),
+	m_nRoutes (0)
 {
 	for (unsigned nTG = 0; nTG < CConfig::AllToneGenerators; nTG++)
 	{
@@ -65,14 +102,10 @@ CMIDIDevice::CMIDIDevice (CMiniDexed *pSynthesizer, CConfig *pConfig, CUserInter
 		m_PreviousChannelMap[nTG] = Disabled; // Initialize previous channel map
 	}
 
-	m_nMIDISystemCCVol = m_pConfig->GetMIDISystemCCVol();
-	m_nMIDISystemCCPan = m_pConfig->GetMIDISystemCCPan();
-	m_nMIDISystemCCDetune = m_pConfig->GetMIDISystemCCDetune();
-
-	m_MIDISystemCCBitmap[0] = 0;
-	m_MIDISystemCCBitmap[1] = 0;
-	m_MIDISystemCCBitmap[2] = 0;
-	m_MIDISystemCCBitmap[3] = 0;
+	for (unsigned nChannel = 0; nChannel < Channels; nChannel++)
+	{
+		m_ChannelTGs[nChannel] = 0;
+	}
 
 	m_nMIDIGlobalExpression = m_pConfig->GetMIDIGlobalExpression();
 	// convert from config channels 1..16 to internal channels
@@ -83,23 +116,48 @@ CMIDIDevice::CMIDIDevice (CMiniDexed *pSynthesizer, CConfig *pConfig, CUserInter
 		m_nMIDIGlobalExpression = Disabled;
 	}
 
-	for (int tg=0; tg<8; tg++)
+	// Build the CC lookup table of the system CC maps. If a CC is used more
+	// than once, the first entry in the order TG, volume, pan, detune wins.
+	// This only makes sense when there are at least 8 TGs.
+	// Note: If more than 8 TGs then only 8 TGs are controllable this way.
+	for (unsigned nCC = 0; nCC < 128; nCC++)
 	{
-		if (m_nMIDISystemCCVol != 0) {
-			u8 cc = MIDISystemCCMap[m_nMIDISystemCCVol][tg];
-			m_MIDISystemCCBitmap[cc>>5] |= (1<<(cc%32));
-		}
-		if (m_nMIDISystemCCPan != 0) {
-			u8 cc = MIDISystemCCMap[m_nMIDISystemCCPan][tg];
-			m_MIDISystemCCBitmap[cc>>5] |= (1<<(cc%32));
-		}
-		if (m_nMIDISystemCCDetune != 0) {
-			u8 cc = MIDISystemCCMap[m_nMIDISystemCCDetune][tg];
-			m_MIDISystemCCBitmap[cc>>5] |= (1<<(cc%32));
+		m_SystemCC[nCC].Action = SystemCCNone;
+		m_SystemCC[nCC].nTG = 0;
+	}
+
+	if (m_pConfig->GetToneGenerators() >= 8)
+	{
+		const unsigned nMap[3] = {m_pConfig->GetMIDISystemCCVol(),
+					  m_pConfig->GetMIDISystemCCPan(),
+					  m_pConfig->GetMIDISystemCCDetune()};
+		const TSystemCCAction Action[3] = {SystemCCVolume, SystemCCPan, SystemCCDetune};
+
+		for (unsigned tg=0; tg<8; tg++)
+		{
+			for (unsigned i=0; i<3; i++)
+			{
+				if (nMap[i] == 0 || nMap[i] >= NUM_MIDI_CC_MAPS) {
+					continue;
+				}
+
+				u8 cc = MIDISystemCCMap[nMap[i]][tg];
+				if (m_SystemCC[cc].Action == SystemCCNone) {
+					m_SystemCC[cc].Action = Action[i];
+					m_SystemCC[cc].nTG = tg;
+				}
+			}
 		}
 	}
+
 	if (m_pConfig->GetMIDIDumpEnabled ()) {
-		LOGNOTE("MIDI System CC Map: %08X %08X %08X %08X", m_MIDISystemCCBitmap[3],m_MIDISystemCCBitmap[2],m_MIDISystemCCBitmap[1],m_MIDISystemCCBitmap[0]);
+		u32 Bitmap[4] = {0, 0, 0, 0};
+		for (unsigned nCC = 0; nCC < 128; nCC++) {
+			if (m_SystemCC[nCC].Action != SystemCCNone) {
+				Bitmap[nCC>>5] |= 1U << (nCC%32);
+			}
+		}
+		LOGNOTE("MIDI System CC Map: %08X %08X %08X %08X", Bitmap[3],Bitmap[2],Bitmap[1],Bitmap[0]);
 	}
 }
 
@@ -118,6 +176,22 @@ void CMIDIDevice::SetChannel (u8 ucChannel, unsigned nTG)
 	}
 	
 	m_ChannelMap[nTG] = ucChannel;
+
+	// Update the TG masks of the channels, which are used for dispatching.
+	// This may be called from a MIDI handler too, so use atomic operations.
+	u32 nMask = 1U << nTG;
+	for (unsigned nChannel = 0; nChannel < Channels; nChannel++)
+	{
+		if (   nTG < m_pConfig->GetToneGenerators ()
+		    && (ucChannel == nChannel || ucChannel == OmniMode))
+		{
+			__atomic_fetch_or (&m_ChannelTGs[nChannel], nMask, __ATOMIC_RELAXED);
+		}
+		else
+		{
+			__atomic_fetch_and (&m_ChannelTGs[nChannel], ~nMask, __ATOMIC_RELAXED);
+		}
+	}
 }
 
 u8 CMIDIDevice::GetChannel (unsigned nTG) const
@@ -126,7 +200,7 @@ u8 CMIDIDevice::GetChannel (unsigned nTG) const
 	return m_ChannelMap[nTG];
 }
 
-void CMIDIDevice::MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsigned nCable)
+void CMIDIDevice::MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsigned nCable, unsigned nTimestamp)
 {
 	// The packet contents are just normal MIDI data - see
 	// https://www.midi.org/specifications/item/table-1-summary-of-midi-message
@@ -189,16 +263,10 @@ void CMIDIDevice::MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsign
 	}
 */
 
-	// Handle MIDI Thru
-	if (m_DeviceName.compare (m_pConfig->GetMIDIThruIn ()) == 0)
+	// Handle MIDI Thru and the other MIDI routes
+	if (m_nRoutes > 0)
 	{
-		TDeviceMap::const_iterator Iterator;
-
-		Iterator = s_DeviceMap.find (m_pConfig->GetMIDIThruOut ());
-		if (Iterator != s_DeviceMap.end ())
-		{
-			Iterator->second->Send (pMessage, nLength, nCable);
-		}
+		ForwardMessage (pMessage, nLength, nCable, nTimestamp);
 	}
 
 	if (nLength < 2)
@@ -337,8 +405,8 @@ void CMIDIDevice::MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsign
 		bool bSystemCCChecked = false;
 		if (ucStatus == MIDI_SYSTEM_EXCLUSIVE_BEGIN) {
 			uint8_t ucSysExChannel = (pMessage[2] & 0x0F);
-			for (unsigned nTG = 0; nTG < m_pConfig->GetToneGenerators(); nTG++) {
-				if (m_ChannelMap[nTG] == ucSysExChannel || m_ChannelMap[nTG] == OmniMode) {
+			for (unsigned nTG = 0, nTGs = m_ChannelTGs[ucSysExChannel]; nTGs; nTG++, nTGs >>= 1) {
+				if (nTGs & 1) {
 					LOGNOTE("MIDI-SYSEX: channel: %u, len: %u, TG: %u",m_ChannelMap[nTG],nLength,nTG);
 
 					// Check for TX216/TX816 style performance sysex messages
@@ -458,9 +526,8 @@ void CMIDIDevice::MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsign
 				}
 			}
 		} else {
-			for (unsigned nTG = 0; nTG < m_pConfig->GetToneGenerators() && !bSystemCCHandled; nTG++) {
-				if (   m_ChannelMap[nTG] == ucChannel
-				    || m_ChannelMap[nTG] == OmniMode) {
+			for (unsigned nTG = 0, nTGs = m_ChannelTGs[ucChannel]; nTGs && !bSystemCCHandled; nTG++, nTGs >>= 1) {
+				if (nTGs & 1) {
 					switch (ucType)
 					{
 					case MIDI_NOTE_ON:
@@ -474,12 +541,12 @@ void CMIDIDevice::MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsign
 							if (pMessage[2] <= 127)
 							{
 								m_pSynthesizer->keydown (pMessage[1],
-											 pMessage[2], nTG);
+											 pMessage[2], nTG, nTimestamp);
 							}
 						}
 						else
 						{
-							m_pSynthesizer->keyup (pMessage[1], nTG);
+							m_pSynthesizer->keyup (pMessage[1], nTG, nTimestamp);
 						}
 						break;
 		
@@ -489,13 +556,13 @@ void CMIDIDevice::MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsign
 							break;
 						}
 		
-						m_pSynthesizer->keyup (pMessage[1], nTG);
+						m_pSynthesizer->keyup (pMessage[1], nTG, nTimestamp);
 						break;
 		
 					case MIDI_CHANNEL_AFTERTOUCH:
-						
+						// The controller values are latched by the TG and
+						// refreshed once per audio chunk.
 						m_pSynthesizer->setAftertouch (pMessage[1], nTG);
-						m_pSynthesizer->ControllersRefresh (nTG);
 						break;
 							
 					case MIDI_CONTROL_CHANGE:
@@ -508,12 +575,10 @@ void CMIDIDevice::MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsign
 						{
 						case MIDI_CC_MODULATION:
 							m_pSynthesizer->setModWheel (pMessage[2], nTG);
-							m_pSynthesizer->ControllersRefresh (nTG);
 							break;
 								
 						case MIDI_CC_FOOT_PEDAL:
 							m_pSynthesizer->setFootController (pMessage[2], nTG);
-							m_pSynthesizer->ControllersRefresh (nTG);
 							break;
 
 						case MIDI_CC_PORTAMENTO_TIME:
@@ -522,7 +587,6 @@ void CMIDIDevice::MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsign
 
 						case MIDI_CC_BREATH_CONTROLLER:
 							m_pSynthesizer->setBreathController (pMessage[2], nTG);
-							m_pSynthesizer->ControllersRefresh (nTG);
 							break;
 								
 						case MIDI_CC_VOLUME:
@@ -549,7 +613,7 @@ void CMIDIDevice::MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsign
 							break;
 		
 						case MIDI_CC_SUSTAIN:
-							m_pSynthesizer->setSustain (pMessage[2] >= 64, nTG);
+							m_pSynthesizer->setSustain (pMessage[2] >= 64, nTG, nTimestamp);
 							break;
 
 						case MIDI_CC_SOSTENUTO:
@@ -685,54 +749,133 @@ void CMIDIDevice::AddDevice (const char *pDeviceName)
 	assert (!m_DeviceName.empty ());
 
 	s_DeviceMap.insert (std::pair<std::string, CMIDIDevice *> (pDeviceName, this));
+
+	// compile the MIDI routes from this device
+	for (unsigned nRoute = 0; nRoute < m_pConfig->GetMIDIRoutes (); nRoute++)
+	{
+		if (m_DeviceName.compare (m_pConfig->GetMIDIRouteIn (nRoute)) == 0)
+		{
+			assert (m_nRoutes < CConfig::MaxMIDIRoutes);
+			TRoute &rRoute = m_Route[m_nRoutes++];
+
+			rRoute.pDestination = nullptr;
+			rRoute.nChannelMask = m_pConfig->GetMIDIRouteChannels (nRoute);
+			rRoute.nTypeMask = m_pConfig->GetMIDIRouteTypes (nRoute);
+			rRoute.nRoute = nRoute;
+		}
+	}
+
+	// Devices may be added later (e.g. UDP MIDI), so connect the routes of
+	// all devices, which lead to this one, too.
+	for (TDeviceMap::const_iterator Iterator = s_DeviceMap.begin ();
+	     Iterator != s_DeviceMap.end (); ++Iterator)
+	{
+		Iterator->second->ConnectRoutes ();
+	}
 }
 
-bool CMIDIDevice::HandleMIDISystemCC(const u8 ucCC, const u8 ucCCval)
+void CMIDIDevice::ConnectRoutes (void)
 {
-	// This only makes sense when there are at least 8 TGs.
-	// Note: If more than 8 TGs then only 8 TGs are controllable this way.
-	if (m_pConfig->GetToneGenerators() < 8) {
-		return false;
+	for (unsigned i = 0; i < m_nRoutes; i++)
+	{
+		if (m_Route[i].pDestination)
+		{
+			continue;
+		}
+
+		TDeviceMap::const_iterator Iterator =
+			s_DeviceMap.find (m_pConfig->GetMIDIRouteOut (m_Route[i].nRoute));
+		if (Iterator != s_DeviceMap.end ())
+		{
+			// the MIDI handler may run on interrupt
+			__atomic_store_n (&m_Route[i].pDestination, Iterator->second, __ATOMIC_RELEASE);
+		}
 	}
+}
 
-	// Quickly reject any CCs not in the configured maps
-	if ((m_MIDISystemCCBitmap[ucCC>>5] & (1<<(ucCC%32))) == 0) {
-		// Not in the map
-		return false;
+void CMIDIDevice::ForwardMessage (const u8 *pMessage, size_t nLength, unsigned nCable, unsigned nTimestamp)
+{
+	assert (nLength > 0);
+	u8 ucStatus = pMessage[0];
+
+	unsigned nType;
+	unsigned nChannelMask;
+	if (ucStatus < 0xF0)
+	{
+		nType = ucStatus & 0x80 ? s_ChannelMessageType[(ucStatus >> 4) & 7] : 0;
+		nChannelMask = 1U << (ucStatus & 0x0F);
+	}
+	else
+	{
+		nType = s_SystemMessageType[ucStatus & 0x0F];
+		nChannelMask = 0xFFFF;		// no channel
 	}
 
-	// Not looking for duplicate CCs so return once handled
-	for (unsigned tg=0; tg<8; tg++) {
-		if (m_nMIDISystemCCVol != 0) {
-			if (ucCC == MIDISystemCCMap[m_nMIDISystemCCVol][tg]) {
-				m_pSynthesizer->SetVolume (ucCCval, tg);
-				return true;
+	for (unsigned i = 0; i < m_nRoutes; i++)
+	{
+		const TRoute &rRoute = m_Route[i];
+
+		CMIDIDevice *pDestination = __atomic_load_n (&rRoute.pDestination, __ATOMIC_ACQUIRE);
+		if (   pDestination
+		    && (rRoute.nTypeMask & nType)
+		    && (rRoute.nChannelMask & nChannelMask))
+		{
+			pDestination->Send (pMessage, nLength, nCable);
+
+			unsigned nLatency = CTimer::GetClockTicks () - nTimestamp;
+			unsigned nRoute = rRoute.nRoute;
+			__atomic_fetch_add (&s_nRouteMessages[nRoute], 1, __ATOMIC_RELAXED);
+			if (nLatency > __atomic_load_n (&s_nRouteMaxLatencyTicks[nRoute], __ATOMIC_RELAXED))
+			{
+				__atomic_store_n (&s_nRouteMaxLatencyTicks[nRoute], nLatency, __ATOMIC_RELAXED);
 			}
 		}
-		if (m_nMIDISystemCCPan != 0) {
-			if (ucCC == MIDISystemCCMap[m_nMIDISystemCCPan][tg]) {
-				m_pSynthesizer->SetPan (ucCCval, tg);
-				return true;
-			}
+	}
+}
+
+unsigned CMIDIDevice::TakeRouteMessages (unsigned nRoute)
+{
+	assert (nRoute < CConfig::MaxMIDIRoutes);
+	return __atomic_exchange_n (&s_nRouteMessages[nRoute], 0, __ATOMIC_RELAXED);
+}
+
+unsigned CMIDIDevice::TakeRouteMaxLatencyTicks (unsigned nRoute)
+{
+	assert (nRoute < CConfig::MaxMIDIRoutes);
+	return __atomic_exchange_n (&s_nRouteMaxLatencyTicks[nRoute], 0, __ATOMIC_RELAXED);
+}
+
+bool CMIDIDevice::HandleMIDISystemCC(const u8 ucCC, const u8 ucCCval)
+{
+	// CCs not in the configured maps have no action
+	const TSystemCC &rCC = m_SystemCC[ucCC & 0x7F];
+
+	switch (rCC.Action)
+	{
+	case SystemCCVolume:
+		m_pSynthesizer->SetVolume (ucCCval, rCC.nTG);
+		return true;
+
+	case SystemCCPan:
+		m_pSynthesizer->SetPan (ucCCval, rCC.nTG);
+		return true;
+
+	case SystemCCDetune:
+		if (ucCCval == 0)
+		{
+			// 0 to 127, with 0 being no detune effect applied at all
+			m_pSynthesizer->SetMasterTune (0, rCC.nTG);
 		}
-		if (m_nMIDISystemCCDetune != 0) {
-			if (ucCC == MIDISystemCCMap[m_nMIDISystemCCDetune][tg]) {
-				if (ucCCval == 0)
-				{
-					// 0 to 127, with 0 being no detune effect applied at all
-					m_pSynthesizer->SetMasterTune (0, tg);
-				}
-				else
-				{
-					// Scale to -99 to +99 cents
-					m_pSynthesizer->SetMasterTune (maplong (ucCCval, 1, 127, -99, 99), tg);
-				}
-				return true;
-			}
+		else
+		{
+			// Scale to -99 to +99 cents
+			m_pSynthesizer->SetMasterTune (maplong (ucCCval, 1, 127, -99, 99), rCC.nTG);
 		}
+		return true;
+
+	default:
+		return false;
 	}
-	
-	return false;
 }
 
 void CMIDIDevice::HandleSystemExclusive(const uint8_t* pMessage, const size_t nLength, const unsigned nCable, const uint8_t nTG)
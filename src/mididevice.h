@@ -58,14 +58,22 @@ public:
 	void SendSystemExclusiveVoice(uint8_t nVoice, const std::string& deviceName, unsigned nCable, uint8_t nTG);
 	const std::string& GetDeviceName() const { return m_DeviceName; }
 
+	// statistics of the MIDI routes (index as in CConfig), reset on read
+	static unsigned TakeRouteMessages (unsigned nRoute);
+	static unsigned TakeRouteMaxLatencyTicks (unsigned nRoute);	// from arrival to Send()
+
 protected:
-	void MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsigned nCable = 0);
+	// nTimestamp is the arrival time of the message in CTimer clock ticks
+	void MIDIMessageHandler (const u8 *pMessage, size_t nLength, unsigned nCable, unsigned nTimestamp);
 	void AddDevice (const char *pDeviceName);
 	void HandleSystemExclusive(const uint8_t* pMessage, const size_t nLength, const unsigned nCable, const uint8_t nTG);
 
 private:
 	bool HandleMIDISystemCC(const u8 ucCC, const u8 ucCCval);
 
+	void ForwardMessage (const u8 *pMessage, size_t nLength, unsigned nCable, unsigned nTimestamp);
+	void ConnectRoutes (void);
+
 private:
 	CMiniDexed *m_pSynthesizer;
 	CConfig *m_pConfig;
@@ -73,15 +81,49 @@ private:
 
 	u8 m_ChannelMap[CConfig::AllToneGenerators];
 	u8 m_PreviousChannelMap[CConfig::AllToneGenerators]; // Store previous channels for OMNI OFF restore
-	
-	unsigned m_nMIDISystemCCVol;
-	unsigned m_nMIDISystemCCPan;
-	unsigned m_nMIDISystemCCDetune;
-	u32	 m_MIDISystemCCBitmap[4]; // to allow for 128 bit entries
+
+	// bit mask of the TGs, which receive a channel (including OMNI mode),
+	// updated by SetChannel()
+	u32 m_ChannelTGs[Channels];
+	static_assert (CConfig::AllToneGenerators <= 32, "Too many TGs for u32 mask");
+
+	enum TSystemCCAction : u8
+	{
+		SystemCCNone,
+		SystemCCVolume,
+		SystemCCPan,
+		SystemCCDetune
+	};
+
+	struct TSystemCC
+	{
+		TSystemCCAction Action;
+		u8 nTG;
+	};
+
+	TSystemCC m_SystemCC[128];	// system CC maps, indexed by CC number
 	unsigned m_nMIDIGlobalExpression;
 
 	std::string m_DeviceName;
 
+	// the MIDI routes from this device, compiled from the config in AddDevice()
+	struct TRoute
+	{
+		CMIDIDevice *pDestination;	// nullptr until the device has been added
+		u16 nChannelMask;
+		u8 nTypeMask;
+		u8 nRoute;			// index in CConfig
+	};
+
+	TRoute m_Route[CConfig::MaxMIDIRoutes];
+	unsigned m_nRoutes;
+
+	static unsigned s_nRouteMessages[CConfig::MaxMIDIRoutes];
+	static unsigned s_nRouteMaxLatencyTicks[CConfig::MaxMIDIRoutes];
+
+	static const u8 s_ChannelMessageType[8];	// by upper nibble of 0x80..0xF0
+	static const u8 s_SystemMessageType[16];	// by lower nibble of 0xF0..0xFF
+
 	typedef std::unordered_map<std::string, CMIDIDevice *> TDeviceMap;
 	static TDeviceMap s_DeviceMap;
 
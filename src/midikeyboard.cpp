@@ -22,6 +22,7 @@
 //
 #include "midikeyboard.h"
 #include <circle/devicenameservice.h>
+#include <circle/timer.h>
 #include <cstring>
 #include <assert.h>
 
@@ -42,17 +43,15 @@ CMIDIKeyboard::~CMIDIKeyboard (void)
 
 void CMIDIKeyboard::Process (boolean bPlugAndPlayUpdated)
 {
-	while (!m_SendQueue.empty ())
+	const u8 *pMessage;
+	size_t nLength;
+	unsigned nCable;
+	while ((pMessage = m_SendQueue.Get (&nLength, &nCable)) != nullptr)
 	{
-		TSendQueueEntry Entry = m_SendQueue.front ();
-		m_SendQueue.pop ();
-
 		if (m_pMIDIDevice)
 		{
-			m_pMIDIDevice->SendPlainMIDI (Entry.nCable, Entry.pMessage, Entry.nLength);
+			m_pMIDIDevice->SendPlainMIDI (nCable, pMessage, nLength);
 		}
-
-		delete [] Entry.pMessage;
 	}
 
 	if (!bPlugAndPlayUpdated)
@@ -75,14 +74,7 @@ void CMIDIKeyboard::Process (boolean bPlugAndPlayUpdated)
 
 void CMIDIKeyboard::Send (const u8 *pMessage, size_t nLength, unsigned nCable)
 {
-	TSendQueueEntry Entry;
-	Entry.pMessage = new u8[nLength];
-	Entry.nLength = nLength;
-	Entry.nCable = nCable;
-
-	memcpy (Entry.pMessage, pMessage, nLength);
-
-	m_SendQueue.push (Entry);
+	m_SendQueue.Put (pMessage, nLength, nCable);
 }
 
 // Most packets will be passed straight onto the main MIDI message handler
@@ -92,6 +84,8 @@ void CMIDIKeyboard::USBMIDIMessageHandler (u8 *pPacket, unsigned nLength, unsign
 {
 	assert (nDevice == m_nInstance + 1);
 
+	unsigned nTimestamp = CTimer::GetClockTicks ();
+
 	if ((pPacket[0] == 0xF0) && (m_nSysExIdx == 0))
 	{
 		// Start of SysEx message
@@ -110,7 +104,7 @@ void CMIDIKeyboard::USBMIDIMessageHandler (u8 *pPacket, unsigned nLength, unsign
 		for (unsigned i=0; i<nLength; i++) {
 			if (pPacket[i] == 0xF8 || pPacket[i] == 0xFA || pPacket[i] == 0xFB || pPacket[i] == 0xFC || pPacket[i] == 0xFE || pPacket[i] == 0xFF) {
 				// Singe-byte System Realtime Messages can happen at any time!
-				MIDIMessageHandler (&pPacket[i], 1, nCable);
+				MIDIMessageHandler (&pPacket[i], 1, nCable, nTimestamp);
 			}
 			else if (m_nSysExIdx >= USB_SYSEX_BUFFER_SIZE) {
 				// Run out of space, so reset and ignore rest of the message
@@ -121,7 +115,7 @@ void CMIDIKeyboard::USBMIDIMessageHandler (u8 *pPacket, unsigned nLength, unsign
 				// End of SysEx message
 				m_SysEx[m_nSysExIdx++] = pPacket[i];
 				//printf ("SysEx End    Idx=%d\n", m_nSysExIdx);
-				MIDIMessageHandler (m_SysEx, m_nSysExIdx, nCable);
+				MIDIMessageHandler (m_SysEx, m_nSysExIdx, nCable, nTimestamp);
 				// Reset ready for next time
 				m_nSysExIdx = 0;
 			}
@@ -141,7 +135,7 @@ void CMIDIKeyboard::USBMIDIMessageHandler (u8 *pPacket, unsigned nLength, unsign
 	else
 	{
 		// Assume it is a standard message
-		MIDIMessageHandler (pPacket, nLength, nCable);
+		MIDIMessageHandler (pPacket, nLength, nCable, nTimestamp);
 	}
 }
 
@@ -24,12 +24,12 @@
 #define _midikeyboard_h
 
 #include "mididevice.h"
+#include "midisendqueue.h"
 #include "config.h"
 #include <circle/usb/usbmidi.h>
 #include <circle/device.h>
 #include <circle/string.h>
 #include <circle/types.h>
-#include <queue>
 
 #define USB_SYSEX_BUFFER_SIZE (MAX_DX7_SYSEX_LENGTH+128) // Allow a bit spare to handle unexpected SysEx messages
 
@@ -45,6 +45,8 @@ public:
 
 	void Send (const u8 *pMessage, size_t nLength, unsigned nCable = 0) override;
 
+	CMIDISendQueue *GetSendQueue (void)	{ return &m_SendQueue; }
+
 private:
 	static void MIDIPacketHandler (unsigned nCable, u8 *pPacket, unsigned nLength, unsigned nDevice, void *pParam);
 	static void DeviceRemovedHandler (CDevice *pDevice, void *pContext);
@@ -52,12 +54,6 @@ private:
 	void USBMIDIMessageHandler (u8 *pPacket, unsigned nLength, unsigned nCable, unsigned nDevice);
 
 private:
-	struct TSendQueueEntry
-	{
-		u8	*pMessage;
-		size_t	 nLength;
-		unsigned nCable;
-	};
 	uint8_t m_SysEx[USB_SYSEX_BUFFER_SIZE];
 	unsigned m_nSysExIdx;
 
@@ -67,7 +63,7 @@ private:
 
 	CUSBMIDIDevice * volatile m_pMIDIDevice;
 
-	std::queue<TSendQueueEntry> m_SendQueue;
+	CMIDISendQueue m_SendQueue;
 };
 
 #endif
@@ -0,0 +1,191 @@
+//
+// midiparser.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "midiparser.h"
+#include <assert.h>
+
+// See: https://www.midi.org/specifications/item/table-1-summary-of-midi-message
+
+const CMIDIParser::TStatusType CMIDIParser::s_ChannelStatus[8] =
+{
+	StatusData2,		// 0x80 Note Off
+	StatusData2,		// 0x90 Note On
+	StatusData2,		// 0xA0 Polyphonic Aftertouch
+	StatusData2,		// 0xB0 Control Change
+	StatusData1,		// 0xC0 Program Change
+	StatusData1,		// 0xD0 Channel Aftertouch
+	StatusData2,		// 0xE0 Pitch Bend
+	StatusIgnore		// 0xF0 System, see below
+};
+
+const CMIDIParser::TStatusType CMIDIParser::s_SystemStatus[16] =
+{
+	StatusSysExBegin,	// 0xF0
+	StatusData1,		// 0xF1 MIDI Time Code Quarter Frame
+	StatusData2,		// 0xF2 Song Position Pointer
+	StatusData1,		// 0xF3 Song Select
+	StatusIgnore,		// 0xF4
+	StatusIgnore,		// 0xF5
+	StatusData0,		// 0xF6 Tune Request
+	StatusSysExEnd,		// 0xF7
+	StatusRealTime,		// 0xF8 Timing Clock
+	StatusIgnore,		// 0xF9
+	StatusRealTime,		// 0xFA Start
+	StatusRealTime,		// 0xFB Continue
+	StatusRealTime,		// 0xFC Stop
+	StatusIgnore,		// 0xFD
+	StatusRealTime,		// 0xFE Active Sensing
+	StatusRealTime		// 0xFF System Reset
+};
+
+CMIDIParser::CMIDIParser (TMessageHandler *pHandler, void *pParam)
+:	m_pHandler (pHandler),
+	m_pParam (pParam)
+{
+	assert (m_pHandler);
+
+	Reset ();
+}
+
+void CMIDIParser::Reset (void)
+{
+	m_uchRunningStatus = 0;
+	m_nDataBytes = 0;
+	m_nLength = 0;
+	m_bSysEx = false;
+	m_bSysExOverflow = false;
+}
+
+void CMIDIParser::Parse (const u8 *pData, size_t nLength, unsigned nTimestamp)
+{
+	assert (pData);
+
+	for (size_t i = 0; i < nLength; i++)
+	{
+		u8 uchData = pData[i];
+
+		if (!(uchData & 0x80))
+		{
+			// data byte
+			if (m_bSysEx)
+			{
+				if (m_nLength < MAX_MIDI_MESSAGE - 1)	// keep room for 0xF7
+				{
+					m_Message[m_nLength++] = uchData;
+				}
+				else
+				{
+					m_bSysExOverflow = true;
+				}
+
+				continue;
+			}
+
+			if (m_nLength == 0)
+			{
+				if (!m_uchRunningStatus)
+				{
+					continue;		// no status known, ignore
+				}
+
+				m_Message[m_nLength++] = m_uchRunningStatus;
+			}
+
+			m_Message[m_nLength++] = uchData;
+
+			if (m_nLength > m_nDataBytes)
+			{
+				(*m_pHandler) (m_Message, m_nLength, nTimestamp, m_pParam);
+
+				m_nLength = 0;
+			}
+
+			continue;
+		}
+
+		TStatusType Type =   uchData < 0xF0
+				   ? s_ChannelStatus[(uchData >> 4) & 7]
+				   : s_SystemStatus[uchData & 0x0F];
+
+		if (Type == StatusRealTime)
+		{
+			// does not affect the current message
+			(*m_pHandler) (&uchData, 1, nTimestamp, m_pParam);
+
+			continue;
+		}
+
+		// any other status byte ends a SysEx or an incomplete message
+		if (m_bSysEx)
+		{
+			m_bSysEx = false;
+
+			if (Type == StatusSysExEnd)
+			{
+				if (!m_bSysExOverflow)
+				{
+					m_Message[m_nLength++] = uchData;
+					(*m_pHandler) (m_Message, m_nLength, nTimestamp, m_pParam);
+				}
+
+				m_nLength = 0;
+
+				continue;
+			}
+		}
+
+		m_nLength = 0;
+
+		if (uchData < 0xF0)
+		{
+			m_uchRunningStatus = uchData;
+		}
+		else
+		{
+			// System Common messages cancel the running status
+			m_uchRunningStatus = 0;
+		}
+
+		switch (Type)
+		{
+		case StatusData0:
+		case StatusData1:
+		case StatusData2:
+			m_nDataBytes = Type - StatusData0;
+			m_Message[m_nLength++] = uchData;
+
+			if (m_nDataBytes == 0)
+			{
+				(*m_pHandler) (m_Message, m_nLength, nTimestamp, m_pParam);
+
+				m_nLength = 0;
+			}
+			break;
+
+		case StatusSysExBegin:
+			m_bSysEx = true;
+			m_bSysExOverflow = false;
+			m_Message[m_nLength++] = uchData;
+			break;
+
+		default:
+			break;
+		}
+	}
+}
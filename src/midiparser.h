@@ -0,0 +1,77 @@
+//
+// midiparser.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _midiparser_h
+#define _midiparser_h
+
+#include "mididevice.h"
+#include <circle/types.h>
+
+// Splits a MIDI byte stream into complete messages. The number of data bytes
+// of each status byte is taken from a table. Handles running status, SysEx
+// and System Real Time messages, which may appear anywhere in the stream
+// (also inside of SysEx and other messages) and are passed on immediately.
+// Other status bytes end an incomplete message or SysEx. All state is kept
+// in the instance, so that several streams can be parsed independently.
+
+class CMIDIParser
+{
+public:
+	// nTimestamp is passed through from Parse()
+	typedef void TMessageHandler (const u8 *pMessage, size_t nLength,
+				      unsigned nTimestamp, void *pParam);
+
+public:
+	CMIDIParser (TMessageHandler *pHandler, void *pParam);
+
+	// resynchronize the stream, e.g. after data has been lost
+	void Reset (void);
+
+	// calls the message handler for each completed message
+	void Parse (const u8 *pData, size_t nLength, unsigned nTimestamp);
+
+private:
+	enum TStatusType : u8
+	{
+		StatusIgnore,		// undefined status
+		StatusData0,		// message with 0..2 data bytes
+		StatusData1,
+		StatusData2,
+		StatusSysExBegin,
+		StatusSysExEnd,
+		StatusRealTime
+	};
+
+	static const TStatusType s_ChannelStatus[8];	// 0x80..0xF0, by upper nibble
+	static const TStatusType s_SystemStatus[16];	// 0xF0..0xFF, by lower nibble
+
+private:
+	TMessageHandler *m_pHandler;
+	void *m_pParam;
+
+	u8 m_uchRunningStatus;		// 0 if none
+	unsigned m_nDataBytes;		// of the current message
+	unsigned m_nLength;		// of the current message, 0 if none
+	bool m_bSysEx;
+	bool m_bSysExOverflow;		// discard until the end of the SysEx
+
+	u8 m_Message[MAX_MIDI_MESSAGE];
+};
+
+#endif
@@ -0,0 +1,158 @@
+//
+// midisendqueue.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "midisendqueue.h"
+#include <circle/timer.h>
+#include <string.h>
+#include <assert.h>
+
+CMIDISendQueue::CMIDISendQueue (void)
+:	m_nIn (0),
+	m_nOut (0),
+	m_nDroppedMessages (0),
+	m_nMaxLatencyTicks (0)
+{
+}
+
+void CMIDISendQueue::Put (const u8 *pMessage, size_t nLength, unsigned nCable)
+{
+	assert (pMessage);
+
+	if (nLength == 0)
+	{
+		return;
+	}
+
+	if (nLength > MIDI_SEND_MAX_MESSAGE)
+	{
+		__atomic_fetch_add (&m_nDroppedMessages, 1, __ATOMIC_RELAXED);
+
+		return;
+	}
+
+	THeader Header;
+	Header.nTimestamp = CTimer::GetClockTicks ();
+	Header.nLength = nLength;
+	Header.nCable = nCable;
+	Header.Reserved = 0;
+
+	m_SpinLock.Acquire ();
+
+	while (Size - (m_nIn - m_nOut) < sizeof Header + nLength)
+	{
+		DropOldest ();
+	}
+
+	CopyIn (&Header, sizeof Header);
+	CopyIn (pMessage, nLength);
+
+	m_SpinLock.Release ();
+}
+
+// The message is copied out with the spin lock held, because Put() may drop
+// it meanwhile otherwise.
+const u8 *CMIDISendQueue::Get (size_t *pLength, unsigned *pCable)
+{
+	assert (pLength);
+	assert (pCable);
+
+	m_SpinLock.Acquire ();
+
+	if (m_nIn == m_nOut)
+	{
+		m_SpinLock.Release ();
+
+		return nullptr;
+	}
+
+	THeader Header;
+	CopyOut (&Header, sizeof Header);
+	assert (Header.nLength <= sizeof m_Message);
+	CopyOut (m_Message, Header.nLength);
+
+	m_SpinLock.Release ();
+
+	unsigned nLatency = CTimer::GetClockTicks () - Header.nTimestamp;
+	if (nLatency > m_nMaxLatencyTicks)
+	{
+		m_nMaxLatencyTicks = nLatency;
+	}
+
+	*pLength = Header.nLength;
+	*pCable = Header.nCable;
+
+	return m_Message;
+}
+
+unsigned CMIDISendQueue::GetQueuedBytes (void) const
+{
+	return   __atomic_load_n (&m_nIn, __ATOMIC_RELAXED)
+	       - __atomic_load_n (&m_nOut, __ATOMIC_RELAXED);
+}
+
+unsigned CMIDISendQueue::TakeDroppedMessages (void)
+{
+	return __atomic_exchange_n (&m_nDroppedMessages, 0, __ATOMIC_RELAXED);
+}
+
+unsigned CMIDISendQueue::TakeMaxLatencyTicks (void)
+{
+	return __atomic_exchange_n (&m_nMaxLatencyTicks, 0, __ATOMIC_RELAXED);
+}
+
+void CMIDISendQueue::CopyIn (const void *pData, size_t nLength)
+{
+	unsigned nOffset = m_nIn & (Size - 1);
+	size_t nFirst = Size - nOffset;
+	if (nFirst > nLength)
+	{
+		nFirst = nLength;
+	}
+
+	memcpy (&m_Buffer[nOffset], pData, nFirst);
+	memcpy (m_Buffer, (const u8 *) pData + nFirst, nLength - nFirst);
+
+	m_nIn += nLength;
+}
+
+void CMIDISendQueue::CopyOut (void *pData, size_t nLength)
+{
+	unsigned nOffset = m_nOut & (Size - 1);
+	size_t nFirst = Size - nOffset;
+	if (nFirst > nLength)
+	{
+		nFirst = nLength;
+	}
+
+	memcpy (pData, &m_Buffer[nOffset], nFirst);
+	memcpy ((u8 *) pData + nFirst, m_Buffer, nLength - nFirst);
+
+	m_nOut += nLength;
+}
+
+void CMIDISendQueue::DropOldest (void)
+{
+	assert (m_nIn != m_nOut);
+
+	THeader Header;
+	CopyOut (&Header, sizeof Header);
+	m_nOut += Header.nLength;
+
+	__atomic_fetch_add (&m_nDroppedMessages, 1, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,85 @@
+//
+// midisendqueue.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _midisendqueue_h
+#define _midisendqueue_h
+
+#include "mididevice.h"
+#include <circle/spinlock.h>
+#include <circle/types.h>
+
+// the largest message, which can be queued (a USB SysEx buffer)
+#define MIDI_SEND_MAX_MESSAGE	(MAX_MIDI_MESSAGE + 128)
+
+// Queue of outgoing MIDI messages of a MIDI device, which is stored in a
+// fixed byte ring. Put() may be called from task and interrupt context (e.g.
+// MIDI Thru from a USB MIDI packet handler). The messages are sent from the
+// Process() method of the device, which calls Get(). If there is not enough
+// space for a new message, the oldest messages are dropped. The ring holds two
+// messages of the maximum size (e.g. a voice dump, which is sent in reply to a
+// request, while the previous one is still being sent).
+
+class CMIDISendQueue
+{
+public:
+	CMIDISendQueue (void);
+
+	void Put (const u8 *pMessage, size_t nLength, unsigned nCable);
+
+	// returns the next message (valid until the next call) or nullptr
+	const u8 *Get (size_t *pLength, unsigned *pCable);
+
+	unsigned GetQueuedBytes (void) const;
+
+	// statistics, reset on read
+	unsigned TakeDroppedMessages (void);
+	unsigned TakeMaxLatencyTicks (void);	// from Put() to Get()
+
+	static const unsigned Size = 16384;	// bytes, must be a power of 2
+
+private:
+	struct THeader
+	{
+		unsigned nTimestamp;
+		u16	 nLength;
+		u8	 nCable;
+		u8	 Reserved;
+	};
+
+	void CopyIn (const void *pData, size_t nLength);
+	void CopyOut (void *pData, size_t nLength);
+	void DropOldest (void);
+
+private:
+	static_assert ((Size & (Size - 1)) == 0, "Queue size must be a power of 2");
+	static_assert (2 * (sizeof (THeader) + MIDI_SEND_MAX_MESSAGE) <= Size, "Queue too small");
+
+	u8 m_Buffer[Size];
+	unsigned m_nIn;				// free-running byte indices
+	unsigned m_nOut;
+
+	CSpinLock m_SpinLock;
+
+	u8 m_Message[MIDI_SEND_MAX_MESSAGE];	// returned by Get()
+
+	unsigned m_nDroppedMessages;
+	unsigned m_nMaxLatencyTicks;
+};
+
+#endif
@@ -26,6 +26,7 @@
 #include <circle/net/syslogdaemon.h>
 #include <circle/net/ipaddress.h>
 #include <circle/gpiopin.h>
+#include <circle/synchronize.h>
 #include <string.h>
 #include <stdio.h>
 #include <assert.h>
@@ -47,6 +48,7 @@ CMiniDexed::CMiniDexed (CConfig *pConfig, CInterruptSystem *pInterrupt,
 #endif
 	m_pConfig (pConfig),
 	m_UI (this, pGPIOManager, pI2CMaster, pSPIMaster, pConfig),
+	m_pVoicePrefetcher (nullptr),
 	m_PerformanceConfig (pFileSystem),
 	m_PCKeyboard (this, pConfig, &m_UI),
 	m_SerialMIDI (this, pInterrupt, pConfig, &m_UI),
@@ -54,11 +56,39 @@ CMiniDexed::CMiniDexed (CConfig *pConfig, CInterruptSystem *pInterrupt,
 	m_bQuadDAC8Chan (false),
 	m_pSoundDevice (0),
 	m_bChannelsSwapped (pConfig->GetChannelsSwapped ()),
+	m_nChunkStartTicks (0),
+	m_nChunkEndTicks (0),
 #ifdef ARM_ALLOW_MULTI_CORE
 //	m_nActiveTGsLog2 (0),
 #endif
 	m_GetChunkTimer ("GetChunk",
 			 1000000U * pConfig->GetChunkSize ()/2 / pConfig->GetSampleRate ()),
+	m_MixTimer ("Mix",
+		    1000000U * pConfig->GetChunkSize ()/2 / pConfig->GetSampleRate ()),
+	m_LoadPerformanceTimer ("LoadPerformance",
+				1000000U * pConfig->GetChunkSize ()/2 / pConfig->GetSampleRate ()),
+	m_LoadPerformanceBankTimer ("LoadPerformanceBank",
+				    1000000U * pConfig->GetChunkSize ()/2 / pConfig->GetSampleRate ()),
+	m_CommandWaitCounter ("TG command queue wait (us)"),
+	m_DroppedCommandsCounter ("Dropped TG commands"),
+	m_CoalescedControllersCounter ("Coalesced TG controller updates"),
+	m_BankCacheMissCounter ("Voice bank cache misses"),
+	m_DecodedVoiceHitCounter ("Decoded voice cache hits"),
+	m_DecodedVoiceMissCounter ("Decoded voice cache misses"),
+	m_PrefetchedBanksCounter ("Prefetched voice banks"),
+	m_SerialBacklogGauge ("Serial MIDI bytes per pass"),
+	m_SerialOverrunCounter ("Serial MIDI overruns"),
+	m_MIDISendQueueGauge ("MIDI send queue bytes"),
+	m_MIDISendLatencyGauge ("MIDI send queue max. latency (us)"),
+#ifdef ARM_ALLOW_MULTI_CORE
+	m_SkippedTGsCounter ("Skipped idle TG chunks"),
+	m_OutputLookaheadGauge ("Output chunks ahead"),
+	m_OutputUnderrunCounter ("Output underruns"),
+	m_CrossfadeChunkTimer ("GetChunk while crossfading",
+			       1000000U * pConfig->GetChunkSize ()/2 / pConfig->GetSampleRate ()),
+	m_HandoverCounter ("Crossfaded TG handovers"),
+	m_HandoverFallbackCounter ("TG changes without spare TG"),
+#endif
 	m_bProfileEnabled (m_pConfig->GetProfileEnabled ()),
 	m_pNet(nullptr),
 	m_pNetDevice(nullptr),
@@ -68,6 +98,11 @@ CMiniDexed::CMiniDexed (CConfig *pConfig, CInterruptSystem *pInterrupt,
 	m_bNetworkInit(false),
 	m_UDPMIDI(nullptr),
 	m_pmDNSPublisher (nullptr),
+	m_bPerformanceApplied (false),
+	m_bApplyAllParameters (true),
+	m_nPerformanceChanges (0),
+	m_nPerformanceUnchanged (0),
+	m_nPerformanceCommands (0),
 	m_bSavePerformance (false),
 	m_bSavePerformanceNewFile (false),
 	m_bSetNewPerformance (false),
@@ -88,6 +123,7 @@ CMiniDexed::CMiniDexed (CConfig *pConfig, CInterruptSystem *pInterrupt,
 		m_nVoiceBankID[i] = 0;
 		m_nVoiceBankIDMSB[i] = 0;
 		m_nProgram[i] = 0;
+		m_nDeferredProgram[i] = -1;
 		m_nVolume[i] = 100;
 		m_nExpression[i] = 127;
 		m_nPan[i] = 64;
@@ -127,6 +163,10 @@ CMiniDexed::CMiniDexed (CConfig *pConfig, CInterruptSystem *pInterrupt,
 			m_pTG[i]->setEngineType(pConfig->GetEngineType ());
 			m_pTG[i]->activate ();
 		}
+		else
+		{
+			m_pTG[i] = nullptr;
+		}
 	}
 
 	unsigned nUSBGadgetPin = pConfig->GetUSBGadgetPin();
@@ -174,6 +214,43 @@ CMiniDexed::CMiniDexed (CConfig *pConfig, CInterruptSystem *pInterrupt,
 		assert (m_pMIDIKeyboard[i]);
 	}
 
+	// one drop counter per MIDI output device
+	for (unsigned i = 0; i < MIDISendQueues; i++)
+	{
+		m_pMIDISendDropCounter[i] = nullptr;
+
+		if (m_bProfileEnabled)
+		{
+			const char *pDeviceName =   i < CConfig::MaxUSBMIDIDevices
+						  ? m_pMIDIKeyboard[i]->GetDeviceName ().c_str ()
+						  : i == CConfig::MaxUSBMIDIDevices
+						  ? m_SerialMIDI.GetDeviceName ().c_str ()
+						  : "udp";
+
+			CString Name;
+			Name.Format ("Dropped MIDI send messages (%s)", pDeviceName);
+			m_pMIDISendDropCounter[i] = new CPerformanceCounter (Name);
+		}
+	}
+
+	for (unsigned nRoute = 0; nRoute < CConfig::MaxMIDIRoutes; nRoute++)
+	{
+		m_pMIDIRouteCounter[nRoute] = nullptr;
+		m_pMIDIRouteLatencyGauge[nRoute] = nullptr;
+
+		if (m_bProfileEnabled && nRoute < pConfig->GetMIDIRoutes ())
+		{
+			CString Name;
+			Name.Format ("MIDI route %s>%s messages",
+				     pConfig->GetMIDIRouteIn (nRoute), pConfig->GetMIDIRouteOut (nRoute));
+			m_pMIDIRouteCounter[nRoute] = new CPerformanceCounter (Name);
+
+			Name.Format ("MIDI route %s>%s max. latency (us)",
+				     pConfig->GetMIDIRouteIn (nRoute), pConfig->GetMIDIRouteOut (nRoute));
+			m_pMIDIRouteLatencyGauge[nRoute] = new CPerformanceGauge (Name);
+		}
+	}
+
 	// select the sound device
 	const char *pDeviceName = pConfig->GetSoundDevice ();
 	if (strcmp (pDeviceName, "i2s") == 0)
@@ -233,18 +310,85 @@ CMiniDexed::CMiniDexed (CConfig *pConfig, CInterruptSystem *pInterrupt,
 	{
 		m_CoreStatus[nCore] = CoreStatusInit;
 	}
+
+	for (unsigned nTG = 0; nTG < CConfig::AllToneGenerators; nTG++)
+	{
+		m_bTGSilent[nTG] = false;
+		m_bTGIdle[nTG] = false;
+	}
+
+	m_nTGJobs = 0;
+	m_nNextTGJob = 0;
+
+	m_pOutputRing = nullptr;
+	m_nOutputChunkSize = 0;
+	m_nOutputLookahead = pConfig->GetOutputLookahead ();
+	m_nOutputIn = 0;
+	m_nOutputOut = 0;
+
+	// The spare TGs take the TG slots not used by the active TGs, so that the
+	// memory needed never exceeds that of CConfig::AllToneGenerators TGs.
+	m_nSpareTGs = 0;
+	m_nFreeSpareTGs = 0;
+	m_nFadeChunks = 0;
+	m_nHandoverRequest = 0;
+	m_nFadingTGs = 0;
+	m_nRetiredTGs = 0;
+
+	unsigned nCrossfadeTime = pConfig->GetPerformanceCrossfadeTime ();
+	if (nCrossfadeTime && !m_bQuadDAC8Chan)
+	{
+		m_nSpareTGs = pConfig->GetPerformanceSpareTGs ();
+		if (m_nSpareTGs > CConfig::AllToneGenerators - m_nToneGenerators)
+		{
+			m_nSpareTGs = CConfig::AllToneGenerators - m_nToneGenerators;
+		}
+
+		for (unsigned i = 0; i < m_nSpareTGs; i++)
+		{
+			CDexedAdapter *pTG = new CDexedAdapter (m_nPolyphony, pConfig->GetSampleRate ());
+			assert (pTG);
+
+			pTG->setEngineType (pConfig->GetEngineType ());
+			pTG->activate ();
+
+			m_pSpareTG[m_nFreeSpareTGs++] = pTG;
+		}
+
+		if (m_nSpareTGs > 0)
+		{
+			unsigned nChunkFrames = pConfig->GetChunkSize () / 2;
+			m_nFadeChunks = (  nCrossfadeTime * pConfig->GetSampleRate () / 1000
+					 + nChunkFrames - 1) / nChunkFrames;
+			if (m_nFadeChunks == 0)
+			{
+				m_nFadeChunks = 1;
+			}
+
+			LOGNOTE ("Performance crossfade %u ms with %u spare TGs",
+				 nCrossfadeTime, m_nSpareTGs);
+		}
+		else
+		{
+			LOGNOTE ("No TG slots left for performance crossfade");
+		}
+	}
 #endif
 
 	float masterVolNorm = (float)(pConfig->GetMasterVolume()) / 127.0f;
 	setMasterVolume(masterVolNorm);
 
 	// BEGIN setup tg_mixer
+	unsigned nRampSamples = pConfig->GetMixerRampTime () * pConfig->GetSampleRate () / 1000;
 	tg_mixer = new AudioStereoMixer<CConfig::AllToneGenerators>(pConfig->GetChunkSize()/2);
+	tg_mixer->rampLength(nRampSamples);
 	// END setup tgmixer
 
 	// BEGIN setup reverb
 	reverb_send_mixer = new AudioStereoMixer<CConfig::AllToneGenerators>(pConfig->GetChunkSize()/2);
+	reverb_send_mixer->rampLength(nRampSamples);
 	reverb = new AudioEffectPlateReverb(pConfig->GetSampleRate());
+	m_nFXParameterPending = 0;
 	SetParameter (ParameterReverbEnable, 1);
 	SetParameter (ParameterReverbSize, 70);
 	SetParameter (ParameterReverbHighDamp, 50);
@@ -268,6 +412,18 @@ CMiniDexed::~CMiniDexed (void)
 	delete m_UDPMIDI;
 	delete m_pFTPDaemon;
 	delete m_pmDNSPublisher;
+	delete m_pVoicePrefetcher;
+
+	for (unsigned i = 0; i < MIDISendQueues; i++)
+	{
+		delete m_pMIDISendDropCounter[i];
+	}
+
+	for (unsigned nRoute = 0; nRoute < CConfig::MaxMIDIRoutes; nRoute++)
+	{
+		delete m_pMIDIRouteCounter[nRoute];
+		delete m_pMIDIRouteLatencyGauge[nRoute];
+	}
 }
 
 bool CMiniDexed::Initialize (void)
@@ -281,7 +437,15 @@ bool CMiniDexed::Initialize (void)
 		return false;
 	}
 
-	m_SysExFileLoader.Load (m_pConfig->GetHeaderlessSysExVoices ());
+	m_SysExFileLoader.Load (m_pConfig->GetHeaderlessSysExVoices (),
+				m_pConfig->GetVoiceBankCacheSize ());
+
+	if (m_pConfig->GetVoicePrefetchDepth ())
+	{
+		m_pVoicePrefetcher = new CVoicePrefetcher (&m_SysExFileLoader,
+							   m_pConfig->GetVoicePrefetchDepth ());
+		assert (m_pVoicePrefetcher);
+	}
 
 	if (m_SerialMIDI.Initialize ())
 	{
@@ -327,7 +491,25 @@ bool CMiniDexed::Initialize (void)
 		reverb_send_mixer->gain(i,mapfloat(m_nReverbSend[i],0,99,0.0f,1.0f));
 	}
 
-	m_PerformanceConfig.Init(m_nToneGenerators);
+#ifdef ARM_ALLOW_MULTI_CORE
+	// the spare TGs get the remaining parameters, when they are handed over
+	for (unsigned i = 0; i < m_nFreeSpareTGs; i++)
+	{
+		assert (m_pSpareTG[i]);
+
+		m_pSpareTG[i]->setGain (1.0f);
+		m_pSpareTG[i]->setTranspose (24);
+
+		m_pSpareTG[i]->setPBController (2, 0);
+		m_pSpareTG[i]->setMWController (99, 1, 0);
+
+		m_pSpareTG[i]->setFCController (99, 1, 0);
+		m_pSpareTG[i]->setBCController (99, 1, 0);
+		m_pSpareTG[i]->setATController (99, 1, 0);
+	}
+#endif
+
+	m_PerformanceConfig.Init(m_nToneGenerators, m_pConfig->GetPerformanceVoiceDataBase64 ());
 	if (m_PerformanceConfig.Load ())
 	{
 		LoadPerformanceParameters(); 
@@ -365,6 +547,12 @@ bool CMiniDexed::Initialize (void)
 
 	m_nQueueSizeFrames = m_pSoundDevice->GetQueueSizeFrames ();
 
+#ifdef ARM_ALLOW_MULTI_CORE
+	m_nOutputChunkSize = m_nQueueSizeFrames / 2 * Channels;
+	m_pOutputRing = new int32_t[(m_nOutputLookahead + 1) * m_nOutputChunkSize];
+	assert (m_pOutputRing);
+#endif
+
 	m_pSoundDevice->Start ();
 
 #ifdef ARM_ALLOW_MULTI_CORE
@@ -404,8 +592,27 @@ void CMiniDexed::Process (bool bPlugAndPlayUpdated)
 		pScheduler->Yield();
 	}
 
+	if (m_UDPMIDI)
+	{
+		m_UDPMIDI->Process ();
+	}
+
 	m_UI.Process ();
 
+#ifdef ARM_ALLOW_MULTI_CORE
+	RetireTGs ();
+#endif
+
+	// complete program changes, which need a voice bank to be read from disk
+	for (unsigned nTG = 0; nTG < m_nToneGenerators; nTG++)
+	{
+		int nProgram = __atomic_exchange_n (&m_nDeferredProgram[nTG], -1, __ATOMIC_ACQ_REL);
+		if (nProgram >= 0)
+		{
+			ProgramChange (nProgram, nTG);
+		}
+	}
+
 	if (m_bSavePerformance)
 	{
 		DoSavePerformance ();
@@ -455,10 +662,123 @@ void CMiniDexed::Process (bool bPlugAndPlayUpdated)
 		m_bDeletePerformance = false;
 		pScheduler->Yield();
 	}
+
+	// the FTP server may have modified the performance directory
+	if (m_PerformanceConfig.UpdateListings ())
+	{
+		m_UI.DisplayChanged ();
+		pScheduler->Yield();
+	}
+	else if (!m_bSetNewPerformance && !m_bSetNewPerformanceBank)
+	{
+		// parse the performances of the current bank one by one
+		if (m_PerformanceConfig.CacheNextPerformance ())
+		{
+			pScheduler->Yield();
+		}
+	}
 		
 	if (m_bProfileEnabled)
 	{
 		m_GetChunkTimer.Dump ();
+		m_MixTimer.Dump ();
+		m_LoadPerformanceTimer.Dump ();
+		m_LoadPerformanceBankTimer.Dump ();
+
+		for (unsigned nTG = 0; nTG < m_nToneGenerators; nTG++)
+		{
+			assert (m_pTG[nTG]);
+			m_CommandWaitCounter.Add (m_pTG[nTG]->TakeWaitTicks () / (CLOCKHZ / 1000000));
+			m_DroppedCommandsCounter.Add (m_pTG[nTG]->TakeDroppedCommands ());
+			m_CoalescedControllersCounter.Add (m_pTG[nTG]->TakeCoalescedUpdates ());
+		}
+		m_CommandWaitCounter.Dump ();
+		m_DroppedCommandsCounter.Dump ();
+		m_CoalescedControllersCounter.Dump ();
+
+		m_BankCacheMissCounter.Add (m_SysExFileLoader.TakeCacheMisses ());
+		m_BankCacheMissCounter.Dump ();
+		m_DecodedVoiceHitCounter.Add (m_SysExFileLoader.TakeDecodedVoiceHits ());
+		m_DecodedVoiceHitCounter.Dump ();
+		m_DecodedVoiceMissCounter.Add (m_SysExFileLoader.TakeDecodedVoiceMisses ());
+		m_DecodedVoiceMissCounter.Dump ();
+		if (m_pVoicePrefetcher)
+		{
+			m_PrefetchedBanksCounter.Add (m_pVoicePrefetcher->TakePrefetchedBanks ());
+			m_PrefetchedBanksCounter.Dump ();
+		}
+		if (m_bUseSerial)
+		{
+			m_SerialBacklogGauge.Sample (m_SerialMIDI.TakeMaxBacklog ());
+			m_SerialBacklogGauge.Dump ();
+			m_SerialOverrunCounter.Add (m_SerialMIDI.TakeOverruns ());
+			m_SerialOverrunCounter.Dump ();
+		}
+
+		// the send queues of all MIDI output devices, in the order of the
+		// drop counters
+		CMIDISendQueue *pSendQueue[MIDISendQueues];
+		for (unsigned i = 0; i < CConfig::MaxUSBMIDIDevices; i++)
+		{
+			assert (m_pMIDIKeyboard[i]);
+			pSendQueue[i] = m_pMIDIKeyboard[i]->GetSendQueue ();
+		}
+		pSendQueue[CConfig::MaxUSBMIDIDevices] = m_bUseSerial ? m_SerialMIDI.GetSendQueue () : nullptr;
+		pSendQueue[CConfig::MaxUSBMIDIDevices+1] = m_UDPMIDI ? m_UDPMIDI->GetSendQueue () : nullptr;
+
+		unsigned nQueuedBytes = 0;
+		unsigned nMaxLatencyTicks = 0;
+		for (unsigned i = 0; i < MIDISendQueues; i++)
+		{
+			if (!pSendQueue[i])
+			{
+				continue;
+			}
+
+			nQueuedBytes += pSendQueue[i]->GetQueuedBytes ();
+			unsigned nLatencyTicks = pSendQueue[i]->TakeMaxLatencyTicks ();
+			if (nLatencyTicks > nMaxLatencyTicks)
+			{
+				nMaxLatencyTicks = nLatencyTicks;
+			}
+		}
+		m_MIDISendQueueGauge.Sample (nQueuedBytes);
+		m_MIDISendQueueGauge.Dump ();
+		m_MIDISendLatencyGauge.Sample (nMaxLatencyTicks / (CLOCKHZ / 1000000));
+		m_MIDISendLatencyGauge.Dump ();
+
+		for (unsigned i = 0; i < MIDISendQueues; i++)
+		{
+			if (pSendQueue[i])
+			{
+				assert (m_pMIDISendDropCounter[i]);
+				m_pMIDISendDropCounter[i]->Add (pSendQueue[i]->TakeDroppedMessages ());
+				m_pMIDISendDropCounter[i]->Dump ();
+			}
+		}
+
+		for (unsigned nRoute = 0; nRoute < m_pConfig->GetMIDIRoutes (); nRoute++)
+		{
+			assert (m_pMIDIRouteCounter[nRoute]);
+			m_pMIDIRouteCounter[nRoute]->Add (CMIDIDevice::TakeRouteMessages (nRoute));
+			m_pMIDIRouteCounter[nRoute]->Dump ();
+
+			assert (m_pMIDIRouteLatencyGauge[nRoute]);
+			m_pMIDIRouteLatencyGauge[nRoute]->Sample (
+				CMIDIDevice::TakeRouteMaxLatencyTicks (nRoute) / (CLOCKHZ / 1000000));
+			m_pMIDIRouteLatencyGauge[nRoute]->Dump ();
+		}
+#ifdef ARM_ALLOW_MULTI_CORE
+		m_SkippedTGsCounter.Dump ();
+		m_OutputLookaheadGauge.Dump ();
+		m_OutputUnderrunCounter.Dump ();
+		if (m_nFadeChunks)
+		{
+			m_CrossfadeChunkTimer.Dump ();
+			m_HandoverCounter.Dump ();
+			m_HandoverFallbackCounter.Dump ();
+		}
+#endif
 		pScheduler->Yield();
 	}
 	if (m_pNet) {
@@ -496,6 +816,7 @@ void CMiniDexed::Run (unsigned nCore)
 	{
 		while (1)
 		{
+			DataMemBarrier ();
 			m_CoreStatus[nCore] = CoreStatusIdle;		// ready to be kicked
 			while (m_CoreStatus[nCore] == CoreStatusIdle)
 			{
@@ -512,21 +833,295 @@ void CMiniDexed::Run (unsigned nCore)
 			}
 
 			assert (m_CoreStatus[nCore] == CoreStatusBusy);
+			DataMemBarrier ();
+
+			// help core 1 to process the TG jobs of this chunk
+			ProcessTGJobs ();
+		}
+	}
+}
 
-			// process the TGs, assigned to this core (2 or 3)
+// Queue one render job per TG for the next chunk, sorted by descending cost
+// (number of sounding voices). The cores 1-3 claim the jobs in this order, so
+// the expensive TGs are started first and the cheap ones fill up the remaining
+// time on the other cores, regardless of which TGs are busy.
+// TGs without sounding voices, whose last output was silent, are not rendered
+// at all. Their Dexed state is left untouched, until a note wakes them up.
+// The fade slots are rendered while they are crossfading only.
+void CMiniDexed::ScheduleTGs (void)
+{
+	unsigned nCost[CConfig::AllToneGenerators];
+	unsigned nSkipped = 0;
 
-			assert (m_nFramesToProcess <= m_pConfig->MaxChunkSize);
-			unsigned nTG = m_pConfig->GetTGsCore1() + (nCore-2)*m_pConfig->GetTGsCore23();
-			for (unsigned i = 0; i < m_pConfig->GetTGsCore23(); i++, nTG++)
+	m_nTGJobs = 0;
+	for (unsigned nTG = 0; nTG < m_nToneGenerators + m_nSpareTGs; nTG++)
+	{
+		if (   nTG >= m_nToneGenerators
+		    && !(m_nFadingTGs & (1U << nTG)))
+		{
+			m_bTGIdle[nTG] = true;
+
+			continue;
+		}
+
+		assert (m_pTG[nTG]);
+		unsigned nTGCost = m_pTG[nTG]->getNumNotesPlaying ();
+
+		if (   nTGCost == 0
+		    && m_bTGSilent[nTG]
+		    && !m_pTG[nTG]->hasPendingCommands ())
+		{
+			if (!m_bTGIdle[nTG])
 			{
-				assert (nTG < CConfig::AllToneGenerators);
-				if (nTG < m_pConfig->GetToneGenerators())
-				{
-					assert (m_pTG[nTG]);
-					m_pTG[nTG]->getSamples (m_OutputLevel[nTG],m_nFramesToProcess);
-				}
+				m_bTGIdle[nTG] = true;
+
+				// for the QuadDAC8Chan output, which is not mixed
+				arm_fill_f32 (0.0f, m_OutputLevel[nTG], CConfig::MaxChunkSize);
+			}
+
+			nSkipped++;
+
+			continue;
+		}
+
+		m_bTGIdle[nTG] = false;
+
+		// insertion sort, the list is short
+		unsigned i = m_nTGJobs++;
+		for (; i > 0 && nCost[i-1] < nTGCost; i--)
+		{
+			m_nTGJob[i] = m_nTGJob[i-1];
+			nCost[i] = nCost[i-1];
+		}
+
+		m_nTGJob[i] = nTG;
+		nCost[i] = nTGCost;
+	}
+
+	m_nNextTGJob = 0;
+
+	if (m_bProfileEnabled)
+	{
+		m_SkippedTGsCounter.Add (nSkipped);
+	}
+}
+
+// Called on cores 1-3 concurrently. Each job is claimed by exactly one core.
+void CMiniDexed::ProcessTGJobs (void)
+{
+	unsigned nFrames = m_nFramesToProcess;
+	assert (nFrames <= CConfig::MaxChunkSize);
+
+	unsigned nJob;
+	while ((nJob = __atomic_fetch_add (&m_nNextTGJob, 1, __ATOMIC_ACQUIRE)) < m_nTGJobs)
+	{
+		unsigned nTG = m_nTGJob[nJob];
+		assert (nTG < m_nToneGenerators + m_nSpareTGs);
+		assert (m_pTG[nTG]);
+		m_pTG[nTG]->getSamples (m_OutputLevel[nTG], nFrames,
+					m_nChunkStartTicks, m_nChunkEndTicks);
+
+		// check, if the TG output is silent for the idle detection
+		float32_t fPeak = 0.0f;
+		for (unsigned i = 0; i < nFrames; i++)
+		{
+			float32_t fLevel = fabsf (m_OutputLevel[nTG][i]);
+			if (fLevel > fPeak)
+			{
+				fPeak = fLevel;
+			}
+		}
+
+		m_bTGSilent[nTG] = fPeak < SilenceThreshold;
+	}
+}
+
+// A TG, which is sounding and gets another voice on a performance change, is
+// not reloaded in place: Its Dexed instance moves to a free fade slot, where
+// the releasing notes are faded out, and a spare instance takes its place. The
+// swap is done by core 1 at the start of the next chunk. Returns the mask of
+// the TGs handed over, which need all their parameters to be applied.
+unsigned CMiniDexed::HandOverTGs (void)
+{
+	if (   !m_nFadeChunks
+	    || !m_bPerformanceApplied)
+	{
+		return 0;
+	}
+
+	RetireTGs ();
+
+	unsigned nRequest = 0;
+	unsigned nSlot = m_nToneGenerators;
+	for (unsigned nTG = 0; nTG < m_nToneGenerators; nTG++)
+	{
+		if (   m_bTGIdle[nTG]
+		    || !IsVoiceChange (nTG))
+		{
+			continue;
+		}
+
+		while (   nSlot < m_nToneGenerators + m_nSpareTGs
+		       && m_pTG[nSlot])
+		{
+			nSlot++;
+		}
+
+		if (nSlot >= m_nToneGenerators + m_nSpareTGs)
+		{
+			if (m_bProfileEnabled)
+			{
+				m_HandoverFallbackCounter.Add ();
 			}
+
+			continue;		// all slots are fading, reload in place
+		}
+
+		// each fade slot in use holds one spare TG
+		assert (m_nFreeSpareTGs > 0);
+		CDexedAdapter *pTG = m_pSpareTG[--m_nFreeSpareTGs];
+		assert (pTG);
+
+		// the controller state is not known, start from neutral
+		unsigned nTimestamp = CTimer::GetClockTicks ();
+		pTG->setSustain (false, nTimestamp);
+		pTG->setSostenuto (false);
+		pTG->setHold (false);
+		pTG->setModWheel (0);
+		pTG->setFootController (0);
+		pTG->setBreathController (0);
+		pTG->setAftertouch (0);
+		pTG->setPitchbend (0);
+		pTG->ControllersRefresh ();
+		pTG->setCompressor (!!m_nParameter[ParameterCompressorEnable]);
+		pTG->setGain (IsGainInMixer () ? 1.0f : GetGain (nTG));
+
+		m_nHandoverSlot[nTG] = nSlot++;
+		m_pHandoverTG[nTG] = pTG;
+		nRequest |= 1U << nTG;
+	}
+
+	if (!nRequest)
+	{
+		return 0;
+	}
+
+	__atomic_fetch_or (&m_nHandoverRequest, nRequest, __ATOMIC_RELEASE);
+
+	// wait for core 1 to swap the instances, this takes one chunk at most
+	while (__atomic_load_n (&m_nHandoverRequest, __ATOMIC_ACQUIRE) & nRequest)
+	{
+		CScheduler::Get ()->Yield ();
+	}
+
+	for (unsigned nTG = 0; nTG < m_nToneGenerators; nTG++)
+	{
+		if (!(nRequest & (1U << nTG)))
+		{
+			continue;
+		}
+
+		CDexedAdapter *pTG = m_pTG[m_nHandoverSlot[nTG]];
+		assert (pTG);
+
+		// the held notes start releasing, the performance has changed
+		pTG->setSustain (false, CTimer::GetClockTicks ());
+		pTG->notesOff ();
+
+		if (m_bProfileEnabled)
+		{
+			m_HandoverCounter.Add ();
+		}
+	}
+
+	return nRequest;
+}
+
+// Called on core 1 before the TGs are scheduled
+void CMiniDexed::ApplyTGHandovers (void)
+{
+	unsigned nRequest = __atomic_load_n (&m_nHandoverRequest, __ATOMIC_ACQUIRE);
+	if (nRequest)
+	{
+		for (unsigned nTG = 0; nTG < m_nToneGenerators; nTG++)
+		{
+			if (!(nRequest & (1U << nTG)))
+			{
+				continue;
+			}
+
+			unsigned nSlot = m_nHandoverSlot[nTG];
+			assert (m_nToneGenerators <= nSlot && nSlot < m_nToneGenerators + m_nSpareTGs);
+			assert (!(m_nFadingTGs & (1U << nSlot)));
+
+			m_pTG[nSlot] = m_pTG[nTG];
+			__atomic_store_n (&m_pTG[nTG], m_pHandoverTG[nTG], __ATOMIC_RELEASE);
+
+			// the outgoing TG continues with the same gains on its slot
+			tg_mixer->copyChannel (nSlot, nTG);
+			reverb_send_mixer->copyChannel (nSlot, nTG);
+			m_bTGSilent[nSlot] = m_bTGSilent[nTG];
+			m_bTGIdle[nSlot] = m_bTGIdle[nTG];
+
+			m_fFadeVolume[nSlot] = IsGainInMixer () ? GetGain (nTG) : 1.0f;
+			m_nFadeLeft[nSlot] = m_nFadeChunks;
+			m_nFadingTGs |= 1U << nSlot;
+		}
+
+		__atomic_fetch_and (&m_nHandoverRequest, ~nRequest, __ATOMIC_RELEASE);
+	}
+
+	// lower the volume of the fading slots linearly, the mixer ramps it
+	// smoothly inside the chunks
+	for (unsigned nSlot = m_nToneGenerators; nSlot < m_nToneGenerators + m_nSpareTGs; nSlot++)
+	{
+		if (!(m_nFadingTGs & (1U << nSlot)))
+		{
+			continue;
+		}
+
+		assert (m_pTG[nSlot]);
+		if (   m_nFadeLeft[nSlot] == 0
+		    || (   m_bTGSilent[nSlot]
+			&& m_pTG[nSlot]->getNumNotesPlaying () == 0
+			&& !m_pTG[nSlot]->hasPendingCommands ()))
+		{
+			m_nFadingTGs &= ~(1U << nSlot);
+			m_bTGIdle[nSlot] = true;
+
+			__atomic_fetch_or (&m_nRetiredTGs, 1U << nSlot, __ATOMIC_RELEASE);
+
+			continue;
+		}
+
+		m_nFadeLeft[nSlot]--;
+
+		float32_t fVolume = m_fFadeVolume[nSlot] * m_nFadeLeft[nSlot] / m_nFadeChunks;
+		tg_mixer->volume (nSlot, fVolume);
+		reverb_send_mixer->volume (nSlot, fVolume);
+	}
+}
+
+// Returns the TGs of the fade slots, which have been faded out, to the pool
+void CMiniDexed::RetireTGs (void)
+{
+	unsigned nRetired = __atomic_exchange_n (&m_nRetiredTGs, 0, __ATOMIC_ACQUIRE);
+
+	for (unsigned nSlot = 0; nRetired != 0; nSlot++, nRetired >>= 1)
+	{
+		if (!(nRetired & 1))
+		{
+			continue;
 		}
+
+		CDexedAdapter *pTG = m_pTG[nSlot];
+		assert (pTG);
+		m_pTG[nSlot] = nullptr;
+
+		pTG->panic ();		// cut the tails, if the fade time is over
+
+		assert (m_nFreeSpareTGs < m_nSpareTGs);
+		m_pSpareTG[m_nFreeSpareTGs++] = pTG;
 	}
 }
 
@@ -554,6 +1149,11 @@ void CMiniDexed::BankSelect (unsigned nBank, unsigned nTG)
 		// Only change if we have the bank loaded
 		m_nVoiceBankID[nTG] = nBank;
 
+		if (m_pVoicePrefetcher)
+		{
+			m_pVoicePrefetcher->BankSelected (nBank);
+		}
+
 		m_UI.ParameterChanged ();
 	}
 }
@@ -652,6 +1252,22 @@ void CMiniDexed::ProgramChange (unsigned nProgram, unsigned nTG)
 	assert (nTG < CConfig::AllToneGenerators);
 	if (nTG >= m_nToneGenerators) return;  // Not an active TG
 
+	if (m_pVoicePrefetcher)
+	{
+		m_pVoicePrefetcher->BankSelected (m_nVoiceBankID[nTG]+nBankOffset);
+	}
+
+	// The voice bank cannot be read from disk, while handling a MIDI message.
+	// The program change is completed in Process() then.
+	if (   CurrentExecutionLevel () != TASK_LEVEL
+	    && !m_SysExFileLoader.IsVoiceCached (m_nVoiceBankID[nTG]+nBankOffset, nProgram))
+	{
+		__atomic_store_n (&m_nDeferredProgram[nTG], (int) (nBankOffset * 32 + nProgram),
+				  __ATOMIC_RELEASE);
+
+		return;
+	}
+
 	m_nProgram[nTG] = nProgram;
 
 	uint8_t Buffer[156];
@@ -696,8 +1312,7 @@ void CMiniDexed::SetVolume (unsigned nVolume, unsigned nTG)
 
 	m_nVolume[nTG] = nVolume;
 
-	assert (m_pTG[nTG]);
-	m_pTG[nTG]->setGain ((m_nVolume[nTG] * m_nExpression[nTG]) / (127.0f * 127.0f));
+	UpdateGain (nTG);
 
 	m_UI.ParameterChanged ();
 }
@@ -711,14 +1326,52 @@ void CMiniDexed::SetExpression (unsigned nExpression, unsigned nTG)
 
 	m_nExpression[nTG] = nExpression;
 
-	assert (m_pTG[nTG]);
-	m_pTG[nTG]->setGain ((m_nVolume[nTG] * m_nExpression[nTG]) / (127.0f * 127.0f));
+	UpdateGain (nTG);
 
 	// Expression is a "live performance" parameter only set
 	// via MIDI and not via the UI.
 	//m_UI.ParameterChanged ();
 }
 
+void CMiniDexed::UpdateGain (unsigned nTG)
+{
+	assert (nTG < m_nToneGenerators);
+	assert (m_pTG[nTG]);
+
+	float32_t fGain = GetGain (nTG);
+	bool bInMixer = IsGainInMixer ();
+
+	m_pTG[nTG]->setGain (bInMixer ? 1.0f : fGain);
+
+#ifdef ARM_ALLOW_MULTI_CORE
+	if (!m_bQuadDAC8Chan)
+	{
+		tg_mixer->volume (nTG, bInMixer ? fGain : 1.0f);
+		reverb_send_mixer->volume (nTG, bInMixer ? fGain : 1.0f);
+	}
+#endif
+}
+
+// Volume and expression are applied in the mixer, where their changes are
+// ramped. With the compressor Dexed applies them before it, because they set
+// how hard it works. Without the mixer (single core, QuadDAC8Chan) Dexed
+// applies them too.
+bool CMiniDexed::IsGainInMixer (void) const
+{
+#ifdef ARM_ALLOW_MULTI_CORE
+	return !m_bQuadDAC8Chan && !m_nParameter[ParameterCompressorEnable];
+#else
+	return false;
+#endif
+}
+
+float32_t CMiniDexed::GetGain (unsigned nTG) const
+{
+	assert (nTG < CConfig::AllToneGenerators);
+
+	return (m_nVolume[nTG] * m_nExpression[nTG]) / (127.0f * 127.0f);
+}
+
 void CMiniDexed::SetPan (unsigned nPan, unsigned nTG)
 {
 	nPan=constrain((int)nPan,0,127);
@@ -841,7 +1494,7 @@ void CMiniDexed::SetMIDIChannel (uint8_t uchChannel, unsigned nTG)
 	m_UI.ParameterChanged ();
 }
 
-void CMiniDexed::keyup (int16_t pitch, unsigned nTG)
+void CMiniDexed::keyup (int16_t pitch, unsigned nTG, unsigned nTimestamp)
 {
 	assert (nTG < CConfig::AllToneGenerators);
 	if (nTG >= m_nToneGenerators) return;  // Not an active TG
@@ -851,11 +1504,11 @@ void CMiniDexed::keyup (int16_t pitch, unsigned nTG)
 	pitch = ApplyNoteLimits (pitch, nTG);
 	if (pitch >= 0)
 	{
-		m_pTG[nTG]->keyup (pitch);
+		m_pTG[nTG]->keyup (pitch, nTimestamp);
 	}
 }
 
-void CMiniDexed::keydown (int16_t pitch, uint8_t velocity, unsigned nTG)
+void CMiniDexed::keydown (int16_t pitch, uint8_t velocity, unsigned nTG, unsigned nTimestamp)
 {
 	assert (nTG < CConfig::AllToneGenerators);
 	if (nTG >= m_nToneGenerators) return;  // Not an active TG
@@ -865,7 +1518,7 @@ void CMiniDexed::keydown (int16_t pitch, uint8_t velocity, unsigned nTG)
 	pitch = ApplyNoteLimits (pitch, nTG);
 	if (pitch >= 0)
 	{
-		m_pTG[nTG]->keydown (pitch, velocity);
+		m_pTG[nTG]->keydown (pitch, velocity, nTimestamp);
 	}
 }
 
@@ -891,13 +1544,14 @@ int16_t CMiniDexed::ApplyNoteLimits (int16_t pitch, unsigned nTG)
 	return pitch;
 }
 
-void CMiniDexed::setSustain(bool sustain, unsigned nTG)
+void CMiniDexed::setSustain(bool sustain, unsigned nTG, unsigned nTimestamp)
 {
 	assert (nTG < CConfig::AllToneGenerators);
 	if (nTG >= m_nToneGenerators) return;  // Not an active TG
 
 	assert (m_pTG[nTG]);
-	m_pTG[nTG]->setSustain (sustain);
+
+	m_pTG[nTG]->setSustain (sustain, nTimestamp);
 }
 
 void CMiniDexed::setSostenuto(bool sostenuto, unsigned nTG)
@@ -1005,60 +1659,15 @@ void CMiniDexed::SetParameter (TParameter Parameter, int nValue)
 	switch (Parameter)
 	{
 	case ParameterCompressorEnable:
-		for (unsigned nTG = 0; nTG < m_nToneGenerators; nTG++)
-		{
-			assert (m_pTG[nTG]);
-			m_pTG[nTG]->setCompressor (!!nValue);
-		}
-		break;
-
 	case ParameterReverbEnable:
-		nValue=constrain((int)nValue,0,1);
-		m_ReverbSpinLock.Acquire ();
-		reverb->set_bypass (!nValue);
-		m_ReverbSpinLock.Release ();
-		break;
-
 	case ParameterReverbSize:
-		nValue=constrain((int)nValue,0,99);
-		m_ReverbSpinLock.Acquire ();
-		reverb->size (nValue / 99.0f);
-		m_ReverbSpinLock.Release ();
-		break;
-
 	case ParameterReverbHighDamp:
-		nValue=constrain((int)nValue,0,99);
-		m_ReverbSpinLock.Acquire ();
-		reverb->hidamp (nValue / 99.0f);
-		m_ReverbSpinLock.Release ();
-		break;
-
 	case ParameterReverbLowDamp:
-		nValue=constrain((int)nValue,0,99);
-		m_ReverbSpinLock.Acquire ();
-		reverb->lodamp (nValue / 99.0f);
-		m_ReverbSpinLock.Release ();
-		break;
-
 	case ParameterReverbLowPass:
-		nValue=constrain((int)nValue,0,99);
-		m_ReverbSpinLock.Acquire ();
-		reverb->lowpass (nValue / 99.0f);
-		m_ReverbSpinLock.Release ();
-		break;
-
 	case ParameterReverbDiffusion:
-		nValue=constrain((int)nValue,0,99);
-		m_ReverbSpinLock.Acquire ();
-		reverb->diffusion (nValue / 99.0f);
-		m_ReverbSpinLock.Release ();
-		break;
-
 	case ParameterReverbLevel:
-		nValue=constrain((int)nValue,0,99);
-		m_ReverbSpinLock.Acquire ();
-		reverb->level (nValue / 99.0f);
-		m_ReverbSpinLock.Release ();
+		// applied by the audio core before the next chunk
+		__atomic_fetch_or (&m_nFXParameterPending, 1U << Parameter, __ATOMIC_RELEASE);
 		break;
 
 	case ParameterPerformanceSelectChannel:
@@ -1075,6 +1684,95 @@ void CMiniDexed::SetParameter (TParameter Parameter, int nValue)
 	}
 }
 
+// Applies the global effect parameters, which have been set since the last
+// chunk. This runs on the audio core between two chunks, so the effects are
+// never modified while they are processing and no lock is needed. If a
+// parameter has been set several times meanwhile, only the last value counts.
+void CMiniDexed::ApplyFXParameters (void)
+{
+	unsigned nPending = __atomic_exchange_n (&m_nFXParameterPending, 0, __ATOMIC_ACQUIRE);
+
+	for (unsigned i = 0; nPending != 0; i++, nPending >>= 1)
+	{
+		if (!(nPending & 1))
+		{
+			continue;
+		}
+
+		int nValue = m_nParameter[i];
+
+		switch ((TParameter) i)
+		{
+		case ParameterCompressorEnable:
+			for (unsigned nTG = 0; nTG < m_nToneGenerators; nTG++)
+			{
+				assert (m_pTG[nTG]);
+				m_pTG[nTG]->setCompressor (!!nValue);
+
+				// volume and expression move between Dexed and the mixer
+				UpdateGain (nTG);
+			}
+			break;
+
+		case ParameterReverbEnable:
+			nValue=constrain((int)nValue,0,1);
+			reverb->set_bypass (!nValue);
+			break;
+
+		case ParameterReverbSize:
+			nValue=constrain((int)nValue,0,99);
+			reverb->size (nValue / 99.0f);
+			break;
+
+		case ParameterReverbHighDamp:
+			nValue=constrain((int)nValue,0,99);
+			reverb->hidamp (nValue / 99.0f);
+			break;
+
+		case ParameterReverbLowDamp:
+			nValue=constrain((int)nValue,0,99);
+			reverb->lodamp (nValue / 99.0f);
+			break;
+
+		case ParameterReverbLowPass:
+			nValue=constrain((int)nValue,0,99);
+			reverb->lowpass (nValue / 99.0f);
+			break;
+
+		case ParameterReverbDiffusion:
+			nValue=constrain((int)nValue,0,99);
+			reverb->diffusion (nValue / 99.0f);
+			break;
+
+		case ParameterReverbLevel:
+			nValue=constrain((int)nValue,0,99);
+			reverb->level (nValue / 99.0f);
+			break;
+
+		default:
+			assert (0);
+			break;
+		}
+	}
+}
+
+// MIDI events are rendered with a constant delay of one chunk period: The
+// events, which arrived while the previous chunk was computed, are spread over
+// the current chunk in proportion to their timestamps.
+void CMiniDexed::UpdateChunkWindow (unsigned nFrames)
+{
+	unsigned nChunkTicks = (u64) nFrames * CLOCKHZ / m_pConfig->GetSampleRate ();
+
+	m_nChunkStartTicks = m_nChunkEndTicks;
+	m_nChunkEndTicks = CTimer::GetClockTicks ();
+
+	// after a gap (e.g. on start-up) play pending events immediately
+	if (m_nChunkEndTicks - m_nChunkStartTicks > 2*nChunkTicks)
+	{
+		m_nChunkStartTicks = m_nChunkEndTicks - nChunkTicks;
+	}
+}
+
 int CMiniDexed::GetParameter (TParameter Parameter)
 {
 	assert (Parameter < ParameterUnknown);
@@ -1277,8 +1975,12 @@ void CMiniDexed::ProcessSound (void)
 			m_GetChunkTimer.Start ();
 		}
 
+		ApplyFXParameters ();
+		UpdateChunkWindow (nFrames);
+
 		float32_t SampleBuffer[nFrames];
-		m_pTG[0]->getSamples (SampleBuffer, nFrames);
+		m_pTG[0]->getSamples (SampleBuffer, nFrames,
+				      m_nChunkStartTicks, m_nChunkEndTicks);
 
 		// Convert single float array (mono) to int16 array
 		int32_t tmp_int[nFrames];
@@ -1298,25 +2000,51 @@ void CMiniDexed::ProcessSound (void)
 
 #else	// #ifdef ARM_ALLOW_MULTI_CORE
 
+// Chunks are rendered up to m_nOutputLookahead chunks in advance into a ring of
+// converted output data. Whenever the sound device has room, the oldest chunk is
+// written at once, so that the rendering time of the next chunk does not delay
+// the device write. With a lookahead of 0 a chunk is rendered only, when the
+// device has room for it, and written directly afterwards.
 void CMiniDexed::ProcessSound (void)
 {
 	assert (m_pSoundDevice);
 	assert (m_pConfig);
+	assert (m_pOutputRing);
 
-	unsigned nFrames = m_nQueueSizeFrames - m_pSoundDevice->GetQueueFramesAvail ();
-	if (nFrames >= m_nQueueSizeFrames/2)
+	// only process the minimum number of frames (== chunksize / 2)
+	// as the tg_mixer cannot process more
+	unsigned nFrames = m_nQueueSizeFrames / 2;
+
+	WriteOutputChunks (nFrames);
+
+	unsigned nChunks = m_nOutputIn - m_nOutputOut;
+	if (   nChunks < m_nOutputLookahead
+	    || (   nChunks == 0
+		&& m_nQueueSizeFrames - m_pSoundDevice->GetQueueFramesAvail () >= nFrames))
 	{
-		// only process the minimum number of frames (== chunksize / 2)
-		// as the tg_mixer cannot process more
-		nFrames = m_nQueueSizeFrames / 2;
+		int32_t *pOutput = &m_pOutputRing[  (m_nOutputIn % (m_nOutputLookahead + 1))
+						  * m_nOutputChunkSize];
 
 		if (m_bProfileEnabled)
 		{
 			m_GetChunkTimer.Start ();
 		}
 
+		ApplyFXParameters ();
+		ApplyTGHandovers ();
+		UpdateChunkWindow (nFrames);
+
+		bool bCrossfading = m_nFadingTGs != 0;
+		if (m_bProfileEnabled && bCrossfading)
+		{
+			m_CrossfadeChunkTimer.Start ();
+		}
+
 		m_nFramesToProcess = nFrames;
 
+		ScheduleTGs ();
+		DataMemBarrier ();
+
 		// kick secondary cores
 		for (unsigned nCore = 2; nCore < CORES; nCore++)
 		{
@@ -1324,13 +2052,8 @@ void CMiniDexed::ProcessSound (void)
 			m_CoreStatus[nCore] = CoreStatusBusy;
 		}
 
-		// process the TGs assigned to core 1
-		assert (nFrames <= CConfig::MaxChunkSize);
-		for (unsigned i = 0; i < m_pConfig->GetTGsCore1(); i++)
-		{
-			assert (m_pTG[i]);
-			m_pTG[i]->getSamples (m_OutputLevel[i], nFrames);
-		}
+		// process TG jobs on core 1 too, until all are claimed
+		ProcessTGJobs ();
 
 		// wait for cores 2 and 3 to complete their work
 		for (unsigned nCore = 2; nCore < CORES; nCore++)
@@ -1340,6 +2063,7 @@ void CMiniDexed::ProcessSound (void)
 				// just wait
 			}
 		}
+		DataMemBarrier ();
 
 		//
 		// Audio signal path after tone generators starts here
@@ -1353,7 +2077,8 @@ void CMiniDexed::ProcessSound (void)
 			// Note: one TG per audio channel; output=mono; no processing.
 			const int Channels = 8;  // One TG per channel
 			float32_t tmp_float[nFrames*Channels];
-			int32_t tmp_int[nFrames*Channels];
+			int32_t *tmp_int = pOutput;
+			assert (nFrames*Channels == m_nOutputChunkSize);
 
 			// Convert dual float array (8 chan) to single int16 array (8 chan)
 			for(uint16_t i=0; i<nFrames;i++)
@@ -1377,11 +2102,6 @@ void CMiniDexed::ProcessSound (void)
 					tmp_int[(nFrames - 1) * Channels + tg]++;
 				}
 			}
-			
-			if (m_pSoundDevice->Write (tmp_int, sizeof(tmp_int)) != (int) sizeof(tmp_int))
-			{
-				LOGERR ("Sound data dropped");
-			}
 		}
 		else
 		{
@@ -1390,7 +2110,13 @@ void CMiniDexed::ProcessSound (void)
 
 			// BEGIN TG mixing
 			float32_t tmp_float[nFrames*2];
-			int32_t tmp_int[nFrames*2];
+			int32_t *tmp_int = pOutput;
+			assert (nFrames*2 == m_nOutputChunkSize);
+
+			if (m_bProfileEnabled)
+			{
+				m_MixTimer.Start ();
+			}
 
 			// get the mix buffer of all TGs
 			float32_t *SampleBuffer[2];
@@ -1398,9 +2124,28 @@ void CMiniDexed::ProcessSound (void)
 
 			tg_mixer->zeroFill();
 
-			for (uint8_t i = 0; i < m_nToneGenerators; i++)
+			// including the fade slots
+			unsigned nChannels = m_nToneGenerators + m_nSpareTGs;
+
+			const float32_t *TGBuffer[CConfig::AllToneGenerators];
+			for (uint8_t i = 0; i < nChannels; i++)
 			{
-				tg_mixer->doAddMix(i,m_OutputLevel[i]);
+				TGBuffer[i] = m_bTGIdle[i] ? nullptr : m_OutputLevel[i];
+			}
+
+			// mix the dry signal and the reverb send signal in one pass
+			AudioStereoMixer<CConfig::AllToneGenerators> *pSendMixer = nullptr;
+			if (m_nParameter[ParameterReverbEnable])
+			{
+				pSendMixer = reverb_send_mixer;
+				pSendMixer->zeroFill();
+			}
+
+			tg_mixer->doAddMix(TGBuffer, nChannels, pSendMixer);
+
+			if (m_bProfileEnabled)
+			{
+				m_MixTimer.Stop ();
 			}
 			// END TG mixing
 
@@ -1412,15 +2157,6 @@ void CMiniDexed::ProcessSound (void)
 				float32_t *ReverbSendBuffer[2];
 				reverb_send_mixer->getBuffers(ReverbSendBuffer);
 
-				reverb_send_mixer->zeroFill();
-
-				for (uint8_t i = 0; i < m_nToneGenerators; i++)
-				{
-					reverb_send_mixer->doAddMix(i,m_OutputLevel[i]);
-				}
-
-				m_ReverbSpinLock.Acquire ();
-
 				reverb->doReverb(ReverbSendBuffer[indexL],ReverbSendBuffer[indexR],ReverbBuffer[indexL], ReverbBuffer[indexR],nFrames);
 
 				// scale down and add left reverb buffer by reverb level 
@@ -1429,8 +2165,6 @@ void CMiniDexed::ProcessSound (void)
 				// scale down and add right reverb buffer by reverb level 
 				arm_scale_f32(ReverbBuffer[indexR], reverb->get_level(), ReverbBuffer[indexR], nFrames);
 				arm_add_f32(SampleBuffer[indexR], ReverbBuffer[indexR], SampleBuffer[indexR], nFrames);
-
-				m_ReverbSpinLock.Release ();
 			}
 			// END adding reverb
 
@@ -1451,17 +2185,56 @@ void CMiniDexed::ProcessSound (void)
 			{
 				tmp_int[nFrames * 2 - 1]++;
 			}
-			
-			if (m_pSoundDevice->Write (tmp_int, sizeof(tmp_int)) != (int) sizeof(tmp_int))
-			{
-				LOGERR ("Sound data dropped");
-			}
 		} // End of Stereo mixing
 
 		if (m_bProfileEnabled)
 		{
 			m_GetChunkTimer.Stop ();
+
+			if (bCrossfading)
+			{
+				m_CrossfadeChunkTimer.Stop ();
+			}
 		}
+
+		m_nOutputIn++;
+
+		WriteOutputChunks (nFrames);
+	}
+}
+
+// Writes the rendered chunks to the sound device, as long as it has room for them
+void CMiniDexed::WriteOutputChunks (unsigned nFrames)
+{
+	while (m_nOutputIn != m_nOutputOut)
+	{
+		unsigned nQueuedFrames = m_pSoundDevice->GetQueueFramesAvail ();
+		if (m_nQueueSizeFrames - nQueuedFrames < nFrames)
+		{
+			break;
+		}
+
+		if (m_bProfileEnabled)
+		{
+			// the device has run dry, if it is already started
+			if (nQueuedFrames == 0 && m_nOutputOut != 0)
+			{
+				m_OutputUnderrunCounter.Add ();
+			}
+
+			m_OutputLookaheadGauge.Sample (m_nOutputIn - m_nOutputOut - 1);
+		}
+
+		const int32_t *pOutput = &m_pOutputRing[  (m_nOutputOut % (m_nOutputLookahead + 1))
+							* m_nOutputChunkSize];
+		int nBytes = m_nOutputChunkSize * sizeof (int32_t);
+
+		if (m_pSoundDevice->Write (pOutput, nBytes) != nBytes)
+		{
+			LOGERR ("Sound data dropped");
+		}
+
+		m_nOutputOut++;
 	}
 }
 
@@ -1534,7 +2307,7 @@ bool CMiniDexed::DoSavePerformance (void)
 			// Not an active TG so provide default voice by asking for an invalid voice ID.
 			m_SysExFileLoader.GetVoice(CSysExFileLoader::MaxVoiceBankID, CSysExFileLoader::VoicesPerBank+1, m_nRawVoiceData);
 		}
-		m_PerformanceConfig.SetVoiceDataToTxt (m_nRawVoiceData, nTG); 
+		m_PerformanceConfig.SetVoiceData (m_nRawVoiceData, nTG);
 		m_PerformanceConfig.SetMonoMode (m_bMonoMode[nTG], nTG); 
 				
 		m_PerformanceConfig.SetModulationWheelRange (m_nModulationWheelRange[nTG], nTG);
@@ -1658,7 +2431,7 @@ void CMiniDexed::setModWheelRange(uint8_t range, uint8_t nTG)
 	assert (m_pTG[nTG]);
 
 	m_nModulationWheelRange[nTG] = range;
-	m_pTG[nTG]->setMWController(range, m_pTG[nTG]->getModWheelTarget(), 0);
+	m_pTG[nTG]->setMWController(range, constrain((int) m_nModulationWheelTarget[nTG], 0, 7), 0);
 //	m_pTG[nTG]->setModWheelRange(constrain(range, 0, 99));  replaces with the above due to wrong constrain on dexed_synth module. 
 
 	m_pTG[nTG]->ControllersRefresh();
@@ -1687,7 +2460,7 @@ void CMiniDexed::setFootControllerRange(uint8_t range, uint8_t nTG)
 	assert (m_pTG[nTG]);
 
 	m_nFootControlRange[nTG]=range;
-	m_pTG[nTG]->setFCController(range, m_pTG[nTG]->getFootControllerTarget(), 0);
+	m_pTG[nTG]->setFCController(range, constrain((int) m_nFootControlTarget[nTG], 0, 7), 0);
 //	m_pTG[nTG]->setFootControllerRange(constrain(range, 0, 99));  replaces with the above due to wrong constrain on dexed_synth module. 
 
 	m_pTG[nTG]->ControllersRefresh();
@@ -1716,7 +2489,7 @@ void CMiniDexed::setBreathControllerRange(uint8_t range, uint8_t nTG)
 	assert (m_pTG[nTG]);
 
 	m_nBreathControlRange[nTG]=range;
-	m_pTG[nTG]->setBCController(range, m_pTG[nTG]->getBreathControllerTarget(), 0);
+	m_pTG[nTG]->setBCController(range, constrain((int) m_nBreathControlTarget[nTG], 0, 7), 0);
 	//m_pTG[nTG]->setBreathControllerRange(constrain(range, 0, 99));
 
 	m_pTG[nTG]->ControllersRefresh();
@@ -1745,7 +2518,7 @@ void CMiniDexed::setAftertouchRange(uint8_t range, uint8_t nTG)
 	assert (m_pTG[nTG]);
 
 	m_nAftertouchRange[nTG]=range;
-	m_pTG[nTG]->setATController(range, m_pTG[nTG]->getAftertouchTarget(), 0);
+	m_pTG[nTG]->setATController(range, constrain((int) m_nAftertouchTarget[nTG], 0, 7), 0);
 //	m_pTG[nTG]->setAftertouchRange(constrain(range, 0, 99));
 
 	m_pTG[nTG]->ControllersRefresh();
@@ -1934,29 +2707,49 @@ bool CMiniDexed::DoSetNewPerformance (void)
 {
 	m_bLoadPerformanceBusy = true;
 	
+	if (m_bProfileEnabled)
+	{
+		m_LoadPerformanceTimer.Start ();
+	}
+
 	unsigned nID = m_nSetNewPerformanceID;
 	m_PerformanceConfig.SetNewPerformance(nID);
 	
-	if (m_PerformanceConfig.Load ())
+	bool bResult = m_PerformanceConfig.Load ();
+	if (bResult)
 	{
 		LoadPerformanceParameters();
-		m_bLoadPerformanceBusy = false;
-		return true;
 	}
 	else
 	{
 		SetMIDIChannel (CMIDIDevice::OmniMode, 0);
-		m_bLoadPerformanceBusy = false;
-		return false;
 	}
+
+	if (m_bProfileEnabled)
+	{
+		m_LoadPerformanceTimer.Stop ();
+	}
+
+	m_bLoadPerformanceBusy = false;
+	return bResult;
 }
 
 bool CMiniDexed::DoSetNewPerformanceBank (void)
 {
 	m_bLoadPerformanceBankBusy = true;
+
+	if (m_bProfileEnabled)
+	{
+		m_LoadPerformanceBankTimer.Start ();
+	}
 	
 	unsigned nBankID = m_nSetNewPerformanceBankID;
 	m_PerformanceConfig.SetNewPerformanceBank(nBankID);
+
+	if (m_bProfileEnabled)
+	{
+		m_LoadPerformanceBankTimer.Stop ();
+	}
 	
 	m_bLoadPerformanceBankBusy = false;
 	return true;
@@ -1997,63 +2790,202 @@ bool CMiniDexed::DoSavePerformanceNewFile (void)
 }
 
 
+// Only the parameters, which differ from the current state, are applied, so
+// that switching between similar performances issues few TG commands and does
+// not reload identical voices. The first performance is applied completely.
 void CMiniDexed::LoadPerformanceParameters(void)
 {
+	m_nPerformanceChanges = 0;
+	m_nPerformanceUnchanged = 0;
+
+	unsigned nHandedOver = 0;
+#ifdef ARM_ALLOW_MULTI_CORE
+	nHandedOver = HandOverTGs ();
+#endif
+
+	for (unsigned nTG = 0; nTG < m_nToneGenerators; nTG++)
+	{
+		assert (m_pTG[nTG]);
+		m_pTG[nTG]->TakePostedCommands ();
+	}
+
 	for (unsigned nTG = 0; nTG < CConfig::AllToneGenerators; nTG++)
 		{
-			
-			BankSelect (m_PerformanceConfig.GetBankNumber (nTG), nTG);
-			ProgramChange (m_PerformanceConfig.GetVoiceNumber (nTG), nTG);
-			SetMIDIChannel (m_PerformanceConfig.GetMIDIChannel (nTG), nTG);
-			SetVolume (m_PerformanceConfig.GetVolume (nTG), nTG);
-			SetPan (m_PerformanceConfig.GetPan (nTG), nTG);
-			SetMasterTune (m_PerformanceConfig.GetDetune (nTG), nTG);
-			SetCutoff (m_PerformanceConfig.GetCutoff (nTG), nTG);
-			SetResonance (m_PerformanceConfig.GetResonance (nTG), nTG);
-			setPitchbendRange (m_PerformanceConfig.GetPitchBendRange (nTG), nTG);
-			setPitchbendStep (m_PerformanceConfig.GetPitchBendStep (nTG), nTG);
-			setPortamentoMode (m_PerformanceConfig.GetPortamentoMode (nTG), nTG);
-			setPortamentoGlissando (m_PerformanceConfig.GetPortamentoGlissando  (nTG), nTG);
-			setPortamentoTime (m_PerformanceConfig.GetPortamentoTime (nTG), nTG);
-
 			m_nNoteLimitLow[nTG] = m_PerformanceConfig.GetNoteLimitLow (nTG);
 			m_nNoteLimitHigh[nTG] = m_PerformanceConfig.GetNoteLimitHigh (nTG);
 			m_nNoteShift[nTG] = m_PerformanceConfig.GetNoteShift (nTG);
-			
-			if(m_PerformanceConfig.VoiceDataFilled(nTG)) 
+
+			if (nTG >= m_nToneGenerators)
 			{
-			uint8_t* tVoiceData = m_PerformanceConfig.GetVoiceDataFromTxt(nTG);
-			m_pTG[nTG]->loadVoiceParameters(tVoiceData); 
-			setOPMask(0b111111, nTG);
+				continue;	// Not an active TG
 			}
-			setMonoMode(m_PerformanceConfig.GetMonoMode(nTG) ? 1 : 0, nTG); 
-			SetReverbSend (m_PerformanceConfig.GetReverbSend (nTG), nTG);
-					
-			setModWheelRange (m_PerformanceConfig.GetModulationWheelRange (nTG),  nTG);
-			setModWheelTarget (m_PerformanceConfig.GetModulationWheelTarget (nTG),  nTG);
-			setFootControllerRange (m_PerformanceConfig.GetFootControlRange (nTG),  nTG);
-			setFootControllerTarget (m_PerformanceConfig.GetFootControlTarget (nTG),  nTG);
-			setBreathControllerRange (m_PerformanceConfig.GetBreathControlRange (nTG),  nTG);
-			setBreathControllerTarget (m_PerformanceConfig.GetBreathControlTarget (nTG),  nTG);
-			setAftertouchRange (m_PerformanceConfig.GetAftertouchRange (nTG),  nTG);
-			setAftertouchTarget (m_PerformanceConfig.GetAftertouchTarget (nTG),  nTG);
-			
-		
+
+			// a TG handed over to a spare instance needs all parameters
+			m_bApplyAllParameters = !m_bPerformanceApplied || (nHandedOver & (1U << nTG));
+
+			// the voice is compared by its data, so that edits are undone
+			if (IsPerformanceChange (IsVoiceChange (nTG), false))
+			{
+				BankSelect (m_PerformanceConfig.GetBankNumber (nTG), nTG);
+				ProgramChange (m_PerformanceConfig.GetVoiceNumber (nTG), nTG);
+
+				if (m_PerformanceConfig.VoiceDataFilled (nTG))
+				{
+					m_pTG[nTG]->loadVoiceParameters (m_PerformanceConfig.GetVoiceData (nTG));
+					setOPMask (0b111111, nTG);
+				}
+			}
+			else
+			{
+				// the same voice, which may be at another bank or program
+				BankSelect (m_PerformanceConfig.GetBankNumber (nTG), nTG);
+				m_nProgram[nTG] = constrain ((int) m_PerformanceConfig.GetVoiceNumber (nTG), 0, 31);
+			}
+
+			if (IsPerformanceChange (m_nMIDIChannel[nTG], m_PerformanceConfig.GetMIDIChannel (nTG)))
+				SetMIDIChannel (m_PerformanceConfig.GetMIDIChannel (nTG), nTG);
+			if (IsPerformanceChange (m_nVolume[nTG], m_PerformanceConfig.GetVolume (nTG)))
+				SetVolume (m_PerformanceConfig.GetVolume (nTG), nTG);
+			if (IsPerformanceChange (m_nPan[nTG], m_PerformanceConfig.GetPan (nTG)))
+				SetPan (m_PerformanceConfig.GetPan (nTG), nTG);
+			if (IsPerformanceChange (m_nMasterTune[nTG], m_PerformanceConfig.GetDetune (nTG)))
+				SetMasterTune (m_PerformanceConfig.GetDetune (nTG), nTG);
+			if (IsPerformanceChange (m_nCutoff[nTG], m_PerformanceConfig.GetCutoff (nTG)))
+				SetCutoff (m_PerformanceConfig.GetCutoff (nTG), nTG);
+			if (IsPerformanceChange (m_nResonance[nTG], m_PerformanceConfig.GetResonance (nTG)))
+				SetResonance (m_PerformanceConfig.GetResonance (nTG), nTG);
+			if (IsPerformanceChange (m_nPitchBendRange[nTG], m_PerformanceConfig.GetPitchBendRange (nTG)))
+				setPitchbendRange (m_PerformanceConfig.GetPitchBendRange (nTG), nTG);
+			if (IsPerformanceChange (m_nPitchBendStep[nTG], m_PerformanceConfig.GetPitchBendStep (nTG)))
+				setPitchbendStep (m_PerformanceConfig.GetPitchBendStep (nTG), nTG);
+			if (IsPerformanceChange (m_nPortamentoMode[nTG], m_PerformanceConfig.GetPortamentoMode (nTG)))
+				setPortamentoMode (m_PerformanceConfig.GetPortamentoMode (nTG), nTG);
+			if (IsPerformanceChange (m_nPortamentoGlissando[nTG], m_PerformanceConfig.GetPortamentoGlissando (nTG)))
+				setPortamentoGlissando (m_PerformanceConfig.GetPortamentoGlissando  (nTG), nTG);
+			if (IsPerformanceChange (m_nPortamentoTime[nTG], m_PerformanceConfig.GetPortamentoTime (nTG)))
+				setPortamentoTime (m_PerformanceConfig.GetPortamentoTime (nTG), nTG);
+
+			if (IsPerformanceChange (m_bMonoMode[nTG], m_PerformanceConfig.GetMonoMode(nTG)))
+				setMonoMode(m_PerformanceConfig.GetMonoMode(nTG) ? 1 : 0, nTG); 
+			if (IsPerformanceChange (m_nReverbSend[nTG], m_PerformanceConfig.GetReverbSend (nTG)))
+				SetReverbSend (m_PerformanceConfig.GetReverbSend (nTG), nTG);
+
+			if (IsPerformanceChange (m_nModulationWheelRange[nTG], m_PerformanceConfig.GetModulationWheelRange (nTG)))
+				setModWheelRange (m_PerformanceConfig.GetModulationWheelRange (nTG),  nTG);
+			if (IsPerformanceChange (m_nModulationWheelTarget[nTG], m_PerformanceConfig.GetModulationWheelTarget (nTG)))
+				setModWheelTarget (m_PerformanceConfig.GetModulationWheelTarget (nTG),  nTG);
+			if (IsPerformanceChange (m_nFootControlRange[nTG], m_PerformanceConfig.GetFootControlRange (nTG)))
+				setFootControllerRange (m_PerformanceConfig.GetFootControlRange (nTG),  nTG);
+			if (IsPerformanceChange (m_nFootControlTarget[nTG], m_PerformanceConfig.GetFootControlTarget (nTG)))
+				setFootControllerTarget (m_PerformanceConfig.GetFootControlTarget (nTG),  nTG);
+			if (IsPerformanceChange (m_nBreathControlRange[nTG], m_PerformanceConfig.GetBreathControlRange (nTG)))
+				setBreathControllerRange (m_PerformanceConfig.GetBreathControlRange (nTG),  nTG);
+			if (IsPerformanceChange (m_nBreathControlTarget[nTG], m_PerformanceConfig.GetBreathControlTarget (nTG)))
+				setBreathControllerTarget (m_PerformanceConfig.GetBreathControlTarget (nTG),  nTG);
+			if (IsPerformanceChange (m_nAftertouchRange[nTG], m_PerformanceConfig.GetAftertouchRange (nTG)))
+				setAftertouchRange (m_PerformanceConfig.GetAftertouchRange (nTG),  nTG);
+			if (IsPerformanceChange (m_nAftertouchTarget[nTG], m_PerformanceConfig.GetAftertouchTarget (nTG)))
+				setAftertouchTarget (m_PerformanceConfig.GetAftertouchTarget (nTG),  nTG);
 		}
 
 		// Effects
-		SetParameter (ParameterCompressorEnable, m_PerformanceConfig.GetCompressorEnable () ? 1 : 0);
-		SetParameter (ParameterReverbEnable, m_PerformanceConfig.GetReverbEnable () ? 1 : 0);
-		SetParameter (ParameterReverbSize, m_PerformanceConfig.GetReverbSize ());
-		SetParameter (ParameterReverbHighDamp, m_PerformanceConfig.GetReverbHighDamp ());
-		SetParameter (ParameterReverbLowDamp, m_PerformanceConfig.GetReverbLowDamp ());
-		SetParameter (ParameterReverbLowPass, m_PerformanceConfig.GetReverbLowPass ());
-		SetParameter (ParameterReverbDiffusion, m_PerformanceConfig.GetReverbDiffusion ());
-		SetParameter (ParameterReverbLevel, m_PerformanceConfig.GetReverbLevel ());
+		m_bApplyAllParameters = !m_bPerformanceApplied;
+
+		if (IsPerformanceChange (m_nParameter[ParameterCompressorEnable], m_PerformanceConfig.GetCompressorEnable () ? 1 : 0))
+			SetParameter (ParameterCompressorEnable, m_PerformanceConfig.GetCompressorEnable () ? 1 : 0);
+		if (IsPerformanceChange (m_nParameter[ParameterReverbEnable], m_PerformanceConfig.GetReverbEnable () ? 1 : 0))
+			SetParameter (ParameterReverbEnable, m_PerformanceConfig.GetReverbEnable () ? 1 : 0);
+		if (IsPerformanceChange (m_nParameter[ParameterReverbSize], m_PerformanceConfig.GetReverbSize ()))
+			SetParameter (ParameterReverbSize, m_PerformanceConfig.GetReverbSize ());
+		if (IsPerformanceChange (m_nParameter[ParameterReverbHighDamp], m_PerformanceConfig.GetReverbHighDamp ()))
+			SetParameter (ParameterReverbHighDamp, m_PerformanceConfig.GetReverbHighDamp ());
+		if (IsPerformanceChange (m_nParameter[ParameterReverbLowDamp], m_PerformanceConfig.GetReverbLowDamp ()))
+			SetParameter (ParameterReverbLowDamp, m_PerformanceConfig.GetReverbLowDamp ());
+		if (IsPerformanceChange (m_nParameter[ParameterReverbLowPass], m_PerformanceConfig.GetReverbLowPass ()))
+			SetParameter (ParameterReverbLowPass, m_PerformanceConfig.GetReverbLowPass ());
+		if (IsPerformanceChange (m_nParameter[ParameterReverbDiffusion], m_PerformanceConfig.GetReverbDiffusion ()))
+			SetParameter (ParameterReverbDiffusion, m_PerformanceConfig.GetReverbDiffusion ());
+		if (IsPerformanceChange (m_nParameter[ParameterReverbLevel], m_PerformanceConfig.GetReverbLevel ()))
+			SetParameter (ParameterReverbLevel, m_PerformanceConfig.GetReverbLevel ());
+
+		m_bPerformanceApplied = true;
+
+		// includes the commands of MIDI events received meanwhile
+		m_nPerformanceCommands = 0;
+		for (unsigned nTG = 0; nTG < m_nToneGenerators; nTG++)
+		{
+			m_nPerformanceCommands += m_pTG[nTG]->TakePostedCommands ();
+		}
+
+		LOGDBG ("Performance applied: %u TG commands posted, %u parameters changed, %u unchanged",
+			m_nPerformanceCommands, m_nPerformanceChanges, m_nPerformanceUnchanged);
 
 		m_UI.DisplayChanged ();
 }
 
+bool CMiniDexed::IsPerformanceChange (int nCurrent, int nNew)
+{
+	if (   m_bApplyAllParameters
+	    || nCurrent != nNew)
+	{
+		m_nPerformanceChanges++;
+
+		return true;
+	}
+
+	m_nPerformanceUnchanged++;
+
+	return false;
+}
+
+// Does the loaded performance give the TG another voice? The voice, which it
+// would load, is compared with the voice of the TG, including edits.
+bool CMiniDexed::IsVoiceChange (unsigned nTG)
+{
+	uint8_t VoiceData[NUM_VOICE_PARAM];
+	GetPerformanceVoice (VoiceData, nTG);
+
+	return !IsCurrentVoice (VoiceData, nTG);
+}
+
+// the voice data of the loaded performance or else the voice of its bank and
+// program, as selected by BankSelect() and ProgramChange()
+void CMiniDexed::GetPerformanceVoice (uint8_t *pVoiceData, unsigned nTG)
+{
+	assert (pVoiceData);
+
+	if (m_PerformanceConfig.VoiceDataFilled (nTG))
+	{
+		memcpy (pVoiceData, m_PerformanceConfig.GetVoiceData (nTG), NUM_VOICE_PARAM);
+
+		return;
+	}
+
+	unsigned nBank = m_PerformanceConfig.GetBankNumber (nTG);
+	if (!m_SysExFileLoader.IsValidBank (nBank))
+	{
+		nBank = m_nVoiceBankID[nTG];
+	}
+
+	unsigned nProgram = constrain ((int) m_PerformanceConfig.GetVoiceNumber (nTG), 0, 31);
+
+	m_SysExFileLoader.GetVoice (nBank, nProgram, pVoiceData);
+}
+
+// compare with the shadow copy of the TG, all operators must be on
+bool CMiniDexed::IsCurrentVoice (const uint8_t *pVoiceData, unsigned nTG)
+{
+	assert (pVoiceData);
+	assert (m_pTG[nTG]);
+
+	// the operator mask is not part of the copy
+	uint8_t CurrentVoiceData[NUM_VOICE_PARAM-1];
+	m_pTG[nTG]->getVoiceData (CurrentVoiceData);
+
+	return    memcmp (CurrentVoiceData, pVoiceData, NUM_VOICE_PARAM-1) == 0
+	       && m_pTG[nTG]->getVoiceDataElement (NUM_VOICE_PARAM-1) == 0b111111;
+}
+
 std::string CMiniDexed::GetNewPerformanceDefaultName(void)	
 {
 	return m_PerformanceConfig.GetNewPerformanceDefaultName();
@@ -29,6 +29,7 @@
 #include "pckeyboard.h"
 #include "serialmididevice.h"
 #include "perftimer.h"
+#include "voiceprefetcher.h"
 #include <fatfs/ff.h>
 #include <stdint.h>
 #include <string>
@@ -44,7 +45,6 @@
 #include <wlan/bcm4343.h>
 #include <wlan/hostap/wpa_supplicant/wpasupplicant.h>
 #include "net/mdnspublisher.h"
-#include <circle/spinlock.h>
 #include "common.h"
 #include "effect_mixer.hpp"
 #include "effect_platervbstereo.h"
@@ -88,10 +88,11 @@ public:
 	void SetResonance (int nResonance, unsigned nTG);		// 0 .. 99
 	void SetMIDIChannel (uint8_t uchChannel, unsigned nTG);
 
-	void keyup (int16_t pitch, unsigned nTG);
-	void keydown (int16_t pitch, uint8_t velocity, unsigned nTG);
+	// nTimestamp is the arrival time of the MIDI event in CTimer clock ticks
+	void keyup (int16_t pitch, unsigned nTG, unsigned nTimestamp);
+	void keydown (int16_t pitch, uint8_t velocity, unsigned nTG, unsigned nTimestamp);
 
-	void setSustain (bool sustain, unsigned nTG);
+	void setSustain (bool sustain, unsigned nTG, unsigned nTimestamp);
 	void setSostenuto (bool sostenuto, unsigned nTG);
 	void setHoldMode(bool holdmode, unsigned nTG);
 	void panic (uint8_t value, unsigned nTG);
@@ -244,13 +245,34 @@ public:
 	void UpdateNetwork();
 
 private:
+	friend class CMiniDexedProbe;		// inspects the internal state in the host tests
+
 	int16_t ApplyNoteLimits (int16_t pitch, unsigned nTG);	// returns < 0 to ignore note
+	void UpdateGain (unsigned nTG);
+	bool IsGainInMixer (void) const;
+	float32_t GetGain (unsigned nTG) const;		// of volume and expression
+	void ApplyFXParameters (void);
+	void UpdateChunkWindow (unsigned nFrames);
 	uint8_t m_uchOPMask[CConfig::AllToneGenerators];
 	void LoadPerformanceParameters(void); 
+	bool IsPerformanceChange (int nCurrent, int nNew);	// counts the result
+	bool IsVoiceChange (unsigned nTG);
+	void GetPerformanceVoice (uint8_t *pVoiceData, unsigned nTG);
+	bool IsCurrentVoice (const uint8_t *pVoiceData, unsigned nTG);
 	void ProcessSound (void);
 	const char* GetNetworkDeviceShortName() const;
 
 #ifdef ARM_ALLOW_MULTI_CORE
+	void ScheduleTGs (void);
+	void ProcessTGJobs (void);
+	void WriteOutputChunks (unsigned nFrames);
+
+	unsigned HandOverTGs (void);		// returns the mask of the TGs handed over
+	void ApplyTGHandovers (void);		// on core 1
+	void RetireTGs (void);
+
+	static constexpr float32_t SilenceThreshold = 1.0f / (1 << 23);	// 1 LSB of the 24-bit output
+
 	enum TCoreStatus
 	{
 		CoreStatusInit,
@@ -276,6 +298,7 @@ private:
 	unsigned m_nVoiceBankIDPerformance;
 	unsigned m_nVoiceBankIDMSBPerformance;
 	unsigned m_nProgram[CConfig::AllToneGenerators];
+	int m_nDeferredProgram[CConfig::AllToneGenerators];	// -1 if none
 	unsigned m_nVolume[CConfig::AllToneGenerators];
 	unsigned m_nExpression[CConfig::AllToneGenerators];
 	unsigned m_nPan[CConfig::AllToneGenerators];
@@ -312,6 +335,7 @@ private:
 
 	CUserInterface m_UI;
 	CSysExFileLoader m_SysExFileLoader;
+	CVoicePrefetcher *m_pVoicePrefetcher;
 	CPerformanceConfig m_PerformanceConfig;
 
 	CMIDIKeyboard *m_pMIDIKeyboard[CConfig::MaxUSBMIDIDevices];
@@ -324,21 +348,77 @@ private:
 	bool m_bChannelsSwapped;
 	unsigned m_nQueueSizeFrames;
 
+	// time window of the MIDI events, which are rendered in the current chunk
+	unsigned m_nChunkStartTicks;
+	unsigned m_nChunkEndTicks;
+
 #ifdef ARM_ALLOW_MULTI_CORE
 //	unsigned m_nActiveTGsLog2;
 	volatile TCoreStatus m_CoreStatus[CORES];
 	volatile unsigned m_nFramesToProcess;
+	unsigned m_nTGJob[CConfig::AllToneGenerators];		// TGs to render, most expensive first
+	unsigned m_nTGJobs;
+	volatile unsigned m_nNextTGJob;				// next job to be claimed
+	bool m_bTGSilent[CConfig::AllToneGenerators];		// last output below SilenceThreshold
+	bool m_bTGIdle[CConfig::AllToneGenerators];		// not rendered in this chunk
 	float32_t m_OutputLevel[CConfig::AllToneGenerators][CConfig::MaxChunkSize];
+
+	// ring of rendered and converted chunks, which wait for the sound device
+	int32_t *m_pOutputRing;
+	unsigned m_nOutputChunkSize;				// samples (frames * channels)
+	unsigned m_nOutputLookahead;				// ring has one slot more
+	unsigned m_nOutputIn;					// free-running, core 1 only
+	unsigned m_nOutputOut;
+
+	// crossfading of performance changes, the fade slots follow the active TGs
+	unsigned m_nSpareTGs;					// number of fade slots
+	CDexedAdapter *m_pSpareTG[CConfig::AllToneGenerators];	// pool of unused spare TGs
+	unsigned m_nFreeSpareTGs;
+	unsigned m_nFadeChunks;					// 0 if crossfading is disabled
+	volatile unsigned m_nHandoverRequest;			// mask of TGs to be swapped
+	unsigned m_nHandoverSlot[CConfig::AllToneGenerators];
+	CDexedAdapter *m_pHandoverTG[CConfig::AllToneGenerators];
+	unsigned m_nFadingTGs;					// mask of slots, core 1 only
+	unsigned m_nFadeLeft[CConfig::AllToneGenerators];	// chunks
+	float32_t m_fFadeVolume[CConfig::AllToneGenerators];
+	volatile unsigned m_nRetiredTGs;			// mask of slots to be returned to the pool
 #endif
 
 	CPerformanceTimer m_GetChunkTimer;
+	CPerformanceTimer m_MixTimer;
+	CPerformanceTimer m_LoadPerformanceTimer;
+	CPerformanceTimer m_LoadPerformanceBankTimer;
+	CPerformanceCounter m_CommandWaitCounter;
+	CPerformanceCounter m_DroppedCommandsCounter;
+	CPerformanceCounter m_CoalescedControllersCounter;
+	CPerformanceCounter m_BankCacheMissCounter;
+	CPerformanceCounter m_DecodedVoiceHitCounter;
+	CPerformanceCounter m_DecodedVoiceMissCounter;
+	CPerformanceCounter m_PrefetchedBanksCounter;
+	CPerformanceGauge m_SerialBacklogGauge;
+	CPerformanceCounter m_SerialOverrunCounter;
+	CPerformanceGauge m_MIDISendQueueGauge;
+	CPerformanceGauge m_MIDISendLatencyGauge;
+	// USB MIDI devices, serial MIDI and UDP MIDI
+	static const unsigned MIDISendQueues = CConfig::MaxUSBMIDIDevices + 2;
+	CPerformanceCounter *m_pMIDISendDropCounter[MIDISendQueues];
+	CPerformanceCounter *m_pMIDIRouteCounter[CConfig::MaxMIDIRoutes];
+	CPerformanceGauge *m_pMIDIRouteLatencyGauge[CConfig::MaxMIDIRoutes];
+#ifdef ARM_ALLOW_MULTI_CORE
+	CPerformanceCounter m_SkippedTGsCounter;
+	CPerformanceGauge m_OutputLookaheadGauge;
+	CPerformanceCounter m_OutputUnderrunCounter;
+	CPerformanceTimer m_CrossfadeChunkTimer;
+	CPerformanceCounter m_HandoverCounter;
+	CPerformanceCounter m_HandoverFallbackCounter;
+#endif
 	bool m_bProfileEnabled;
 
 	AudioEffectPlateReverb* reverb;
 	AudioStereoMixer<CConfig::AllToneGenerators>* tg_mixer;
 	AudioStereoMixer<CConfig::AllToneGenerators>* reverb_send_mixer;
 
-	CSpinLock m_ReverbSpinLock;
+	volatile unsigned m_nFXParameterPending;		// mask of TParameter, set but not applied yet
 
 	// Network
 	CNetSubSystem* m_pNet;
@@ -351,6 +431,12 @@ private:
 	CFTPDaemon* m_pFTPDaemon;
 	CmDNSPublisher *m_pmDNSPublisher;
 
+	bool m_bPerformanceApplied;		// LoadPerformanceParameters() was called
+	bool m_bApplyAllParameters;		// IsPerformanceChange() returns true
+	unsigned m_nPerformanceChanges;		// statistics of the last call
+	unsigned m_nPerformanceUnchanged;
+	unsigned m_nPerformanceCommands;	// posted to the TGs
+
 	bool m_bSavePerformance;
 	bool m_bSavePerformanceNewFile;
 	bool m_bSetNewPerformance;
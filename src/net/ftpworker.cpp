@@ -34,6 +34,7 @@
 
 #include "ftpworker.h"
 #include "utility.h"
+#include "../performanceconfig.h"
 
 // Use a per-instance name for the log macros
 #define From m_LogName
@@ -758,6 +759,8 @@ bool CFTPWorker::Store(const char* pArgs)
 	delete pDataSocket;
 	f_close(&File);
 
+	CPerformanceConfig::FileChanged(Path);
+
 	return true;
 }
 
@@ -771,7 +774,10 @@ bool CFTPWorker::Delete(const char* pArgs)
 	if (f_unlink(Path) != FR_OK)
 		SendStatus(TFTPStatus::FileActionNotTaken, "File was not deleted.");
 	else
+	{
+		CPerformanceConfig::FileChanged(Path);
 		SendStatus(TFTPStatus::FileActionOk, "File deleted.");
+	}
 
 	return true;
 }
@@ -787,6 +793,8 @@ bool CFTPWorker::MakeDirectory(const char* pArgs)
 		SendStatus(TFTPStatus::FileActionNotTaken, "Directory creation failed.");
 	else
 	{
+		CPerformanceConfig::FileChanged(Path);
+
 		char Buffer[TextBufferSize];
 		FatFsPathToFTPPath(Path, Buffer, sizeof(Buffer));
 		strcat(Buffer, " directory created.");
@@ -1048,7 +1056,11 @@ bool CFTPWorker::RenameTo(const char* pArgs)
 	if (f_rename(SourcePath, DestPath) != FR_OK)
 		SendStatus(TFTPStatus::FileNameNotAllowed, "File name not allowed.");
 	else
+	{
+		CPerformanceConfig::FileChanged(SourcePath);
+		CPerformanceConfig::FileChanged(DestPath);
 		SendStatus(TFTPStatus::FileActionOk, "File renamed.");
+	}
 
 	m_RenameFrom = "";
 
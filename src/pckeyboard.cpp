@@ -19,6 +19,7 @@
 //
 #include "pckeyboard.h"
 #include <circle/devicenameservice.h>
+#include <circle/timer.h>
 #include <circle/util.h>
 #include <assert.h>
 
@@ -100,6 +101,8 @@ void CPCKeyboard::KeyStatusHandlerRaw (unsigned char ucModifiers, const unsigned
 {
 	assert (s_pThis != 0);
 
+	unsigned nTimestamp = CTimer::GetClockTicks ();
+
 	// report released keys
 	for (unsigned i = 0; i < 6; i++)
 	{
@@ -111,7 +114,7 @@ void CPCKeyboard::KeyStatusHandlerRaw (unsigned char ucModifiers, const unsigned
 			if (ucKeyNumber != 0)
 			{
 				u8 NoteOff[] = {0x80, ucKeyNumber, 0};
-				s_pThis->MIDIMessageHandler (NoteOff, sizeof NoteOff);
+				s_pThis->MIDIMessageHandler (NoteOff, sizeof NoteOff, 0, nTimestamp);
 			}
 		}
 	}
@@ -127,7 +130,7 @@ void CPCKeyboard::KeyStatusHandlerRaw (unsigned char ucModifiers, const unsigned
 			if (ucKeyNumber != 0)
 			{
 				u8 NoteOn[] = {0x90, ucKeyNumber, 100};
-				s_pThis->MIDIMessageHandler (NoteOn, sizeof NoteOn);
+				s_pThis->MIDIMessageHandler (NoteOn, sizeof NoteOn, 0, nTimestamp);
 			}
 		}
 	}
@@ -34,17 +34,34 @@ LOGMODULE ("Performance");
 #define DEFAULT_PERFORMANCE_FILENAME "performance.ini"
 #define DEFAULT_PERFORMANCE_NAME "Default"
 
+unsigned CPerformanceConfig::s_nFileChanges = 0;
+
 CPerformanceConfig::CPerformanceConfig (FATFS *pFileSystem)
-:	m_Properties (DEFAULT_PERFORMANCE_FILENAME, pFileSystem)
+:	m_Properties (DEFAULT_PERFORMANCE_FILENAME, pFileSystem),
+	m_pPerformanceCache (nullptr),
+	m_nPropertiesID (0),
+	m_nListingChanges (0),
+	m_nNextCacheID (0)
 {
 	m_pFileSystem = pFileSystem; 
+
+	for (unsigned nID = 0; nID < NUM_PERFORMANCES; nID++)
+	{
+		m_bPerformanceCached[nID] = false;
+	}
+
+	for (unsigned nBankID = 0; nBankID < NUM_PERFORMANCE_BANKS; nBankID++)
+	{
+		m_bListed[nBankID] = false;
+	}
 }
 
 CPerformanceConfig::~CPerformanceConfig (void)
 {
+	delete [] m_pPerformanceCache;
 }
 
-bool CPerformanceConfig::Init (unsigned nToneGenerators)
+bool CPerformanceConfig::Init (unsigned nToneGenerators, bool bVoiceDataBase64)
 {
 	// Different versions of Pi allow different TG configurations.
 	// On loading, performances will load up to the number of
@@ -57,6 +74,15 @@ bool CPerformanceConfig::Init (unsigned nToneGenerators)
 	// will include all 16 TG configurations.
 	//
 	m_nToneGenerators = nToneGenerators;
+	m_bVoiceDataBase64 = bVoiceDataBase64;
+
+	m_pPerformanceCache = new TPerformance[NUM_PERFORMANCES];
+	assert (m_pPerformanceCache);
+
+	for (unsigned nTG = 0; nTG < CConfig::AllToneGenerators; nTG++)
+	{
+		m_Performance.bVoiceDataFilled[nTG] = false;
+	}
 
 	// Check intermal performance directory exists
 	DIR Directory;
@@ -76,6 +102,9 @@ bool CPerformanceConfig::Init (unsigned nToneGenerators)
 	// List banks if present
 	ListPerformanceBanks();
 
+	m_nListingChanges = __atomic_load_n (&s_nFileChanges, __ATOMIC_RELAXED);
+	ListAllPerformances ();
+
 #ifdef VERBOSE_DEBUG
 #warning "PerformanceConfig in verbose debug printing mode"
 	LOGNOTE("Testing loading of banks");
@@ -99,129 +128,165 @@ bool CPerformanceConfig::Init (unsigned nToneGenerators)
 
 bool CPerformanceConfig::Load (void)
 {
+	assert (m_nPropertiesID < NUM_PERFORMANCES);
+	assert (m_pPerformanceCache);
+	if (m_bPerformanceCached[m_nPropertiesID])
+	{
+		m_Performance = m_pPerformanceCache[m_nPropertiesID];
+
+		return m_Performance.bValid;
+	}
+
 	if (!m_Properties.Load ())
 	{
 		return false;
 	}
 
-	bool bResult = false;
+	Parse (m_Properties, &m_Performance);
+
+	m_pPerformanceCache[m_nPropertiesID] = m_Performance;
+	m_bPerformanceCached[m_nPropertiesID] = true;
+
+	return m_Performance.bValid;
+}
+
+void CPerformanceConfig::Parse (CPropertiesFatFsFile &rProperties, TPerformance *pPerformance)
+{
+	assert (pPerformance);
+	pPerformance->bValid = false;
 
 	for (unsigned nTG = 0; nTG < CConfig::AllToneGenerators; nTG++)
 	{
 		CString PropertyName;
 
 		PropertyName.Format ("BankNumber%u", nTG+1);
-		m_nBankNumber[nTG] = m_Properties.GetNumber (PropertyName, 0);
+		pPerformance->nBankNumber[nTG] = rProperties.GetNumber (PropertyName, 0);
 
 		PropertyName.Format ("VoiceNumber%u", nTG+1);
-		m_nVoiceNumber[nTG] = m_Properties.GetNumber (PropertyName, 1);
-		if (m_nVoiceNumber[nTG] > 0)
+		pPerformance->nVoiceNumber[nTG] = rProperties.GetNumber (PropertyName, 1);
+		if (pPerformance->nVoiceNumber[nTG] > 0)
 		{
-			m_nVoiceNumber[nTG]--;
+			pPerformance->nVoiceNumber[nTG]--;
 		}
 
 		PropertyName.Format ("MIDIChannel%u", nTG+1);
-		unsigned nMIDIChannel = m_Properties.GetNumber (PropertyName, 0);
+		unsigned nMIDIChannel = rProperties.GetNumber (PropertyName, 0);
 		if (nMIDIChannel == 0)
 		{
-			m_nMIDIChannel[nTG] = CMIDIDevice::Disabled;
+			pPerformance->nMIDIChannel[nTG] = CMIDIDevice::Disabled;
 		}
 		else if (nMIDIChannel <= CMIDIDevice::Channels)
 		{
-			m_nMIDIChannel[nTG] = nMIDIChannel-1;
-			bResult = true;
+			pPerformance->nMIDIChannel[nTG] = nMIDIChannel-1;
+			pPerformance->bValid = true;
 		}
 		else
 		{
-			m_nMIDIChannel[nTG] = CMIDIDevice::OmniMode;
-			bResult = true;
+			pPerformance->nMIDIChannel[nTG] = CMIDIDevice::OmniMode;
+			pPerformance->bValid = true;
 		}
 
 		PropertyName.Format ("Volume%u", nTG+1);
-		m_nVolume[nTG] = m_Properties.GetNumber (PropertyName, 100);
+		pPerformance->nVolume[nTG] = rProperties.GetNumber (PropertyName, 100);
 
 		PropertyName.Format ("Pan%u", nTG+1);
-		m_nPan[nTG] = m_Properties.GetNumber (PropertyName, 64);
+		pPerformance->nPan[nTG] = rProperties.GetNumber (PropertyName, 64);
 
 		PropertyName.Format ("Detune%u", nTG+1);
-		m_nDetune[nTG] = m_Properties.GetSignedNumber (PropertyName, 0);
+		pPerformance->nDetune[nTG] = rProperties.GetSignedNumber (PropertyName, 0);
 
 		PropertyName.Format ("Cutoff%u", nTG+1);
-		m_nCutoff[nTG] = m_Properties.GetNumber (PropertyName, 99);
+		pPerformance->nCutoff[nTG] = rProperties.GetNumber (PropertyName, 99);
 
 		PropertyName.Format ("Resonance%u", nTG+1);
-		m_nResonance[nTG] = m_Properties.GetNumber (PropertyName, 0);
+		pPerformance->nResonance[nTG] = rProperties.GetNumber (PropertyName, 0);
 
 		PropertyName.Format ("NoteLimitLow%u", nTG+1);
-		m_nNoteLimitLow[nTG] = m_Properties.GetNumber (PropertyName, 0);
+		pPerformance->nNoteLimitLow[nTG] = rProperties.GetNumber (PropertyName, 0);
 
 		PropertyName.Format ("NoteLimitHigh%u", nTG+1);
-		m_nNoteLimitHigh[nTG] = m_Properties.GetNumber (PropertyName, 127);
+		pPerformance->nNoteLimitHigh[nTG] = rProperties.GetNumber (PropertyName, 127);
 
 		PropertyName.Format ("NoteShift%u", nTG+1);
-		m_nNoteShift[nTG] = m_Properties.GetSignedNumber (PropertyName, 0);
+		pPerformance->nNoteShift[nTG] = rProperties.GetSignedNumber (PropertyName, 0);
 
 		PropertyName.Format ("ReverbSend%u", nTG+1);
-		m_nReverbSend[nTG] = m_Properties.GetNumber (PropertyName, 50);
+		pPerformance->nReverbSend[nTG] = rProperties.GetNumber (PropertyName, 50);
 		
 		PropertyName.Format ("PitchBendRange%u", nTG+1);
-		m_nPitchBendRange[nTG] = m_Properties.GetNumber (PropertyName, 2);
+		pPerformance->nPitchBendRange[nTG] = rProperties.GetNumber (PropertyName, 2);
 
 		PropertyName.Format ("PitchBendStep%u", nTG+1);
-		m_nPitchBendStep[nTG] = m_Properties.GetNumber (PropertyName, 0);
+		pPerformance->nPitchBendStep[nTG] = rProperties.GetNumber (PropertyName, 0);
 
 		PropertyName.Format ("PortamentoMode%u", nTG+1);
-		m_nPortamentoMode[nTG] = m_Properties.GetNumber (PropertyName, 0);
+		pPerformance->nPortamentoMode[nTG] = rProperties.GetNumber (PropertyName, 0);
 
 		PropertyName.Format ("PortamentoGlissando%u", nTG+1);
-		m_nPortamentoGlissando[nTG] = m_Properties.GetNumber (PropertyName, 0);
+		pPerformance->nPortamentoGlissando[nTG] = rProperties.GetNumber (PropertyName, 0);
 
 		PropertyName.Format ("PortamentoTime%u", nTG+1);
-		m_nPortamentoTime[nTG] = m_Properties.GetNumber (PropertyName, 0);
+		pPerformance->nPortamentoTime[nTG] = rProperties.GetNumber (PropertyName, 0);
 		
-		PropertyName.Format ("VoiceData%u", nTG+1); 
-		m_nVoiceDataTxt[nTG] = m_Properties.GetString (PropertyName, "");
+		// prefer the Base64 format, if both are present
+		PropertyName.Format ("VoiceDataBase64%u", nTG+1);
+		const char *pVoiceData = rProperties.GetString (PropertyName, "");
+		pPerformance->bVoiceDataFilled[nTG] = DecodeVoiceDataBase64 (pVoiceData, pPerformance->VoiceData[nTG]);
+		if (!pPerformance->bVoiceDataFilled[nTG])
+		{
+			if (*pVoiceData)
+			{
+				LOGWARN ("%s: Invalid checksum or format", (const char *) PropertyName);
+			}
+
+			PropertyName.Format ("VoiceData%u", nTG+1);
+			pVoiceData = rProperties.GetString (PropertyName, "");
+			pPerformance->bVoiceDataFilled[nTG] = DecodeVoiceDataHex (pVoiceData, pPerformance->VoiceData[nTG]);
+			if (!pPerformance->bVoiceDataFilled[nTG] && *pVoiceData)
+			{
+				LOGWARN ("%s: Invalid format", (const char *) PropertyName);
+			}
+		}
 		
 		PropertyName.Format ("MonoMode%u", nTG+1);
-		m_bMonoMode[nTG] = m_Properties.GetNumber (PropertyName, 0) != 0;
+		pPerformance->bMonoMode[nTG] = rProperties.GetNumber (PropertyName, 0) != 0;
 				
 		PropertyName.Format ("ModulationWheelRange%u", nTG+1);
-		m_nModulationWheelRange[nTG] = m_Properties.GetNumber (PropertyName, 99); 
+		pPerformance->nModulationWheelRange[nTG] = rProperties.GetNumber (PropertyName, 99); 
 		
 		PropertyName.Format ("ModulationWheelTarget%u", nTG+1);
-		m_nModulationWheelTarget[nTG] = m_Properties.GetNumber (PropertyName, 1);
+		pPerformance->nModulationWheelTarget[nTG] = rProperties.GetNumber (PropertyName, 1);
 		
 		PropertyName.Format ("FootControlRange%u", nTG+1);
-		m_nFootControlRange[nTG] = m_Properties.GetNumber (PropertyName, 99); 
+		pPerformance->nFootControlRange[nTG] = rProperties.GetNumber (PropertyName, 99); 
 		
 		PropertyName.Format ("FootControlTarget%u", nTG+1);
-		m_nFootControlTarget[nTG] = m_Properties.GetNumber (PropertyName, 0);
+		pPerformance->nFootControlTarget[nTG] = rProperties.GetNumber (PropertyName, 0);
 		
 		PropertyName.Format ("BreathControlRange%u", nTG+1);
-		m_nBreathControlRange[nTG] = m_Properties.GetNumber (PropertyName, 99); 
+		pPerformance->nBreathControlRange[nTG] = rProperties.GetNumber (PropertyName, 99); 
 		
 		PropertyName.Format ("BreathControlTarget%u", nTG+1);
-		m_nBreathControlTarget[nTG] = m_Properties.GetNumber (PropertyName, 0);
+		pPerformance->nBreathControlTarget[nTG] = rProperties.GetNumber (PropertyName, 0);
 		
 		PropertyName.Format ("AftertouchRange%u", nTG+1);
-		m_nAftertouchRange[nTG] = m_Properties.GetNumber (PropertyName, 99); 
+		pPerformance->nAftertouchRange[nTG] = rProperties.GetNumber (PropertyName, 99); 
 		
 		PropertyName.Format ("AftertouchTarget%u", nTG+1);
-		m_nAftertouchTarget[nTG] = m_Properties.GetNumber (PropertyName, 0);
+		pPerformance->nAftertouchTarget[nTG] = rProperties.GetNumber (PropertyName, 0);
 		
 		}
 
-	m_bCompressorEnable = m_Properties.GetNumber ("CompressorEnable", 1) != 0;
+	pPerformance->bCompressorEnable = rProperties.GetNumber ("CompressorEnable", 1) != 0;
 
-	m_bReverbEnable = m_Properties.GetNumber ("ReverbEnable", 1) != 0;
-	m_nReverbSize = m_Properties.GetNumber ("ReverbSize", 70);
-	m_nReverbHighDamp = m_Properties.GetNumber ("ReverbHighDamp", 50);
-	m_nReverbLowDamp = m_Properties.GetNumber ("ReverbLowDamp", 50);
-	m_nReverbLowPass = m_Properties.GetNumber ("ReverbLowPass", 30);
-	m_nReverbDiffusion = m_Properties.GetNumber ("ReverbDiffusion", 65);
-	m_nReverbLevel = m_Properties.GetNumber ("ReverbLevel", 99);
+	pPerformance->bReverbEnable = rProperties.GetNumber ("ReverbEnable", 1) != 0;
+	pPerformance->nReverbSize = rProperties.GetNumber ("ReverbSize", 70);
+	pPerformance->nReverbHighDamp = rProperties.GetNumber ("ReverbHighDamp", 50);
+	pPerformance->nReverbLowDamp = rProperties.GetNumber ("ReverbLowDamp", 50);
+	pPerformance->nReverbLowPass = rProperties.GetNumber ("ReverbLowPass", 30);
+	pPerformance->nReverbDiffusion = rProperties.GetNumber ("ReverbDiffusion", 65);
+	pPerformance->nReverbLevel = rProperties.GetNumber ("ReverbLevel", 99);
 
-	return bResult;
 }
 
 bool CPerformanceConfig::Save (void)
@@ -233,13 +298,13 @@ bool CPerformanceConfig::Save (void)
 		CString PropertyName;
 
 		PropertyName.Format ("BankNumber%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nBankNumber[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nBankNumber[nTG]);
 
 		PropertyName.Format ("VoiceNumber%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nVoiceNumber[nTG]+1);
+		m_Properties.SetNumber (PropertyName, m_Performance.nVoiceNumber[nTG]+1);
 
 		PropertyName.Format ("MIDIChannel%u", nTG+1);
-		unsigned nMIDIChannel = m_nMIDIChannel[nTG];
+		unsigned nMIDIChannel = m_Performance.nMIDIChannel[nTG];
 		if (nMIDIChannel < CMIDIDevice::Channels)
 		{
 			nMIDIChannel++;
@@ -255,521 +320,690 @@ bool CPerformanceConfig::Save (void)
 		m_Properties.SetNumber (PropertyName, nMIDIChannel);
 
 		PropertyName.Format ("Volume%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nVolume[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nVolume[nTG]);
 
 		PropertyName.Format ("Pan%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nPan[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nPan[nTG]);
 
 		PropertyName.Format ("Detune%u", nTG+1);
-		m_Properties.SetSignedNumber (PropertyName, m_nDetune[nTG]);
+		m_Properties.SetSignedNumber (PropertyName, m_Performance.nDetune[nTG]);
 
 		PropertyName.Format ("Cutoff%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nCutoff[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nCutoff[nTG]);
 
 		PropertyName.Format ("Resonance%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nResonance[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nResonance[nTG]);
 
 		PropertyName.Format ("NoteLimitLow%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nNoteLimitLow[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nNoteLimitLow[nTG]);
 
 		PropertyName.Format ("NoteLimitHigh%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nNoteLimitHigh[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nNoteLimitHigh[nTG]);
 
 		PropertyName.Format ("NoteShift%u", nTG+1);
-		m_Properties.SetSignedNumber (PropertyName, m_nNoteShift[nTG]);
+		m_Properties.SetSignedNumber (PropertyName, m_Performance.nNoteShift[nTG]);
 
 		PropertyName.Format ("ReverbSend%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nReverbSend[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nReverbSend[nTG]);
 		
 		PropertyName.Format ("PitchBendRange%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nPitchBendRange[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nPitchBendRange[nTG]);
 
 		PropertyName.Format ("PitchBendStep%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nPitchBendStep[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nPitchBendStep[nTG]);
 
 		PropertyName.Format ("PortamentoMode%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nPortamentoMode[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nPortamentoMode[nTG]);
 
 		PropertyName.Format ("PortamentoGlissando%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nPortamentoGlissando[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nPortamentoGlissando[nTG]);
 
 		PropertyName.Format ("PortamentoTime%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nPortamentoTime[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nPortamentoTime[nTG]);
 		
-		PropertyName.Format ("VoiceData%u", nTG+1);
-		char *cstr = &m_nVoiceDataTxt[nTG][0];
-		m_Properties.SetString (PropertyName, cstr);
+		if (m_bVoiceDataBase64)
+		{
+			char Buffer[VoiceDataBase64Length+1] = "";
+			if (m_Performance.bVoiceDataFilled[nTG])
+			{
+				EncodeVoiceDataBase64 (m_Performance.VoiceData[nTG], Buffer);
+			}
+
+			PropertyName.Format ("VoiceDataBase64%u", nTG+1);
+			m_Properties.SetString (PropertyName, Buffer);
+		}
+		else
+		{
+			char Buffer[VoiceDataHexLength+1] = "";
+			if (m_Performance.bVoiceDataFilled[nTG])
+			{
+				EncodeVoiceDataHex (m_Performance.VoiceData[nTG], Buffer);
+			}
+
+			PropertyName.Format ("VoiceData%u", nTG+1);
+			m_Properties.SetString (PropertyName, Buffer);
+		}
 		
 		PropertyName.Format ("MonoMode%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_bMonoMode[nTG] ? 1 : 0);
+		m_Properties.SetNumber (PropertyName, m_Performance.bMonoMode[nTG] ? 1 : 0);
 				
 		PropertyName.Format ("ModulationWheelRange%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nModulationWheelRange[nTG]);
+		m_Properties.SetNumber (PropertyName, m_Performance.nModulationWheelRange[nTG]);
 	
 		PropertyName.Format ("ModulationWheelTarget%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nModulationWheelTarget[nTG]);	
+		m_Properties.SetNumber (PropertyName, m_Performance.nModulationWheelTarget[nTG]);	
 			
 		PropertyName.Format ("FootControlRange%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nFootControlRange[nTG]);	
+		m_Properties.SetNumber (PropertyName, m_Performance.nFootControlRange[nTG]);	
 		
 		PropertyName.Format ("FootControlTarget%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nFootControlTarget[nTG]);	
+		m_Properties.SetNumber (PropertyName, m_Performance.nFootControlTarget[nTG]);	
 		
 		PropertyName.Format ("BreathControlRange%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nBreathControlRange[nTG]);	
+		m_Properties.SetNumber (PropertyName, m_Performance.nBreathControlRange[nTG]);	
 		
 		PropertyName.Format ("BreathControlTarget%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nBreathControlTarget[nTG]);	
+		m_Properties.SetNumber (PropertyName, m_Performance.nBreathControlTarget[nTG]);	
 		
 		PropertyName.Format ("AftertouchRange%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nAftertouchRange[nTG]);	
+		m_Properties.SetNumber (PropertyName, m_Performance.nAftertouchRange[nTG]);	
 		
 		PropertyName.Format ("AftertouchTarget%u", nTG+1);
-		m_Properties.SetNumber (PropertyName, m_nAftertouchTarget[nTG]);			
+		m_Properties.SetNumber (PropertyName, m_Performance.nAftertouchTarget[nTG]);			
 
 		}
 
-	m_Properties.SetNumber ("CompressorEnable", m_bCompressorEnable ? 1 : 0);
+	m_Properties.SetNumber ("CompressorEnable", m_Performance.bCompressorEnable ? 1 : 0);
 
-	m_Properties.SetNumber ("ReverbEnable", m_bReverbEnable ? 1 : 0);
-	m_Properties.SetNumber ("ReverbSize", m_nReverbSize);
-	m_Properties.SetNumber ("ReverbHighDamp", m_nReverbHighDamp);
-	m_Properties.SetNumber ("ReverbLowDamp", m_nReverbLowDamp);
-	m_Properties.SetNumber ("ReverbLowPass", m_nReverbLowPass);
-	m_Properties.SetNumber ("ReverbDiffusion", m_nReverbDiffusion);
-	m_Properties.SetNumber ("ReverbLevel", m_nReverbLevel);
+	m_Properties.SetNumber ("ReverbEnable", m_Performance.bReverbEnable ? 1 : 0);
+	m_Properties.SetNumber ("ReverbSize", m_Performance.nReverbSize);
+	m_Properties.SetNumber ("ReverbHighDamp", m_Performance.nReverbHighDamp);
+	m_Properties.SetNumber ("ReverbLowDamp", m_Performance.nReverbLowDamp);
+	m_Properties.SetNumber ("ReverbLowPass", m_Performance.nReverbLowPass);
+	m_Properties.SetNumber ("ReverbDiffusion", m_Performance.nReverbDiffusion);
+	m_Properties.SetNumber ("ReverbLevel", m_Performance.nReverbLevel);
 
-	return m_Properties.Save ();
+	if (!m_Properties.Save ())
+	{
+		return false;
+	}
+
+	// refresh the cached copy from the properties just written
+	assert (m_nPropertiesID < NUM_PERFORMANCES);
+	Parse (m_Properties, &m_pPerformanceCache[m_nPropertiesID]);
+	m_bPerformanceCached[m_nPropertiesID] = true;
+
+	return true;
+}
+
+void CPerformanceConfig::CachePerformance (unsigned nID)
+{
+	assert (nID < NUM_PERFORMANCES);
+	assert (m_pPerformanceCache);
+
+	std::string FileName = GetPerformanceFullFilePath (nID);
+	CPropertiesFatFsFile Properties (FileName.c_str (), m_pFileSystem);
+	if (Properties.Load ())
+	{
+		Parse (Properties, &m_pPerformanceCache[nID]);
+		m_bPerformanceCached[nID] = true;
+	}
 }
 
 unsigned CPerformanceConfig::GetBankNumber (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nBankNumber[nTG];
+	return m_Performance.nBankNumber[nTG];
 }
 
 unsigned CPerformanceConfig::GetVoiceNumber (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nVoiceNumber[nTG];
+	return m_Performance.nVoiceNumber[nTG];
 }
 
 unsigned CPerformanceConfig::GetMIDIChannel (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nMIDIChannel[nTG];
+	return m_Performance.nMIDIChannel[nTG];
 }
 
 unsigned CPerformanceConfig::GetVolume (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nVolume[nTG];
+	return m_Performance.nVolume[nTG];
 }
 
 unsigned CPerformanceConfig::GetPan (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nPan[nTG];
+	return m_Performance.nPan[nTG];
 }
 
 int CPerformanceConfig::GetDetune (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nDetune[nTG];
+	return m_Performance.nDetune[nTG];
 }
 
 unsigned CPerformanceConfig::GetCutoff (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nCutoff[nTG];
+	return m_Performance.nCutoff[nTG];
 }
 
 unsigned CPerformanceConfig::GetResonance (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nResonance[nTG];
+	return m_Performance.nResonance[nTG];
 }
 
 unsigned CPerformanceConfig::GetNoteLimitLow (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nNoteLimitLow[nTG];
+	return m_Performance.nNoteLimitLow[nTG];
 }
 
 unsigned CPerformanceConfig::GetNoteLimitHigh (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nNoteLimitHigh[nTG];
+	return m_Performance.nNoteLimitHigh[nTG];
 }
 
 int CPerformanceConfig::GetNoteShift (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nNoteShift[nTG];
+	return m_Performance.nNoteShift[nTG];
 }
 
 unsigned CPerformanceConfig::GetReverbSend (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nReverbSend[nTG];
+	return m_Performance.nReverbSend[nTG];
 }
 
 void CPerformanceConfig::SetBankNumber (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nBankNumber[nTG] = nValue;
+	m_Performance.nBankNumber[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetVoiceNumber (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nVoiceNumber[nTG] = nValue;
+	m_Performance.nVoiceNumber[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetMIDIChannel (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nMIDIChannel[nTG] = nValue;
+	m_Performance.nMIDIChannel[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetVolume (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nVolume[nTG] = nValue;
+	m_Performance.nVolume[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetPan (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nPan[nTG] = nValue;
+	m_Performance.nPan[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetDetune (int nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nDetune[nTG] = nValue;
+	m_Performance.nDetune[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetCutoff (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nCutoff[nTG] = nValue;
+	m_Performance.nCutoff[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetResonance (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nResonance[nTG] = nValue;
+	m_Performance.nResonance[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetNoteLimitLow (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nNoteLimitLow[nTG] = nValue;
+	m_Performance.nNoteLimitLow[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetNoteLimitHigh (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nNoteLimitHigh[nTG] = nValue;
+	m_Performance.nNoteLimitHigh[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetNoteShift (int nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nNoteShift[nTG] = nValue;
+	m_Performance.nNoteShift[nTG] = nValue;
 }
 
 void CPerformanceConfig::SetReverbSend (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nReverbSend[nTG] = nValue;
+	m_Performance.nReverbSend[nTG] = nValue;
 }
 
 bool CPerformanceConfig::GetCompressorEnable (void) const
 {
-	return m_bCompressorEnable;
+	return m_Performance.bCompressorEnable;
 }
 
 bool CPerformanceConfig::GetReverbEnable (void) const
 {
-	return m_bReverbEnable;
+	return m_Performance.bReverbEnable;
 }
 
 unsigned CPerformanceConfig::GetReverbSize (void) const
 {
-	return m_nReverbSize;
+	return m_Performance.nReverbSize;
 }
 
 unsigned CPerformanceConfig::GetReverbHighDamp (void) const
 {
-	return m_nReverbHighDamp;
+	return m_Performance.nReverbHighDamp;
 }
 
 unsigned CPerformanceConfig::GetReverbLowDamp (void) const
 {
-	return m_nReverbLowDamp;
+	return m_Performance.nReverbLowDamp;
 }
 
 unsigned CPerformanceConfig::GetReverbLowPass (void) const
 {
-	return m_nReverbLowPass;
+	return m_Performance.nReverbLowPass;
 }
 
 unsigned CPerformanceConfig::GetReverbDiffusion (void) const
 {
-	return m_nReverbDiffusion;
+	return m_Performance.nReverbDiffusion;
 }
 
 unsigned CPerformanceConfig::GetReverbLevel (void) const
 {
-	return m_nReverbLevel;
+	return m_Performance.nReverbLevel;
 }
 
 void CPerformanceConfig::SetCompressorEnable (bool bValue)
 {
-	m_bCompressorEnable = bValue;
+	m_Performance.bCompressorEnable = bValue;
 }
 
 void CPerformanceConfig::SetReverbEnable (bool bValue)
 {
-	m_bReverbEnable = bValue;
+	m_Performance.bReverbEnable = bValue;
 }
 
 void CPerformanceConfig::SetReverbSize (unsigned nValue)
 {
-	m_nReverbSize = nValue;
+	m_Performance.nReverbSize = nValue;
 }
 
 void CPerformanceConfig::SetReverbHighDamp (unsigned nValue)
 {
-	m_nReverbHighDamp = nValue;
+	m_Performance.nReverbHighDamp = nValue;
 }
 
 void CPerformanceConfig::SetReverbLowDamp (unsigned nValue)
 {
-	m_nReverbLowDamp = nValue;
+	m_Performance.nReverbLowDamp = nValue;
 }
 
 void CPerformanceConfig::SetReverbLowPass (unsigned nValue)
 {
-	m_nReverbLowPass = nValue;
+	m_Performance.nReverbLowPass = nValue;
 }
 
 void CPerformanceConfig::SetReverbDiffusion (unsigned nValue)
 {
-	m_nReverbDiffusion = nValue;
+	m_Performance.nReverbDiffusion = nValue;
 }
 
 void CPerformanceConfig::SetReverbLevel (unsigned nValue)
 {
-	m_nReverbLevel = nValue;
+	m_Performance.nReverbLevel = nValue;
 }
 // Pitch bender and portamento:
 void CPerformanceConfig::SetPitchBendRange (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nPitchBendRange[nTG] = nValue;
+	m_Performance.nPitchBendRange[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetPitchBendRange (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nPitchBendRange[nTG];
+	return m_Performance.nPitchBendRange[nTG];
 }
 
 
 void CPerformanceConfig::SetPitchBendStep (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nPitchBendStep[nTG] = nValue;
+	m_Performance.nPitchBendStep[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetPitchBendStep (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nPitchBendStep[nTG];
+	return m_Performance.nPitchBendStep[nTG];
 }
 
 
 void CPerformanceConfig::SetPortamentoMode (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nPortamentoMode[nTG] = nValue;
+	m_Performance.nPortamentoMode[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetPortamentoMode (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nPortamentoMode[nTG];
+	return m_Performance.nPortamentoMode[nTG];
 }
 
 
 void CPerformanceConfig::SetPortamentoGlissando (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nPortamentoGlissando[nTG] = nValue;
+	m_Performance.nPortamentoGlissando[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetPortamentoGlissando (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nPortamentoGlissando[nTG];
+	return m_Performance.nPortamentoGlissando[nTG];
 }
 
 
 void CPerformanceConfig::SetPortamentoTime (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nPortamentoTime[nTG] = nValue;
+	m_Performance.nPortamentoTime[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetPortamentoTime (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nPortamentoTime[nTG];
+	return m_Performance.nPortamentoTime[nTG];
 }
 
 void CPerformanceConfig::SetMonoMode (bool bValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_bMonoMode[nTG] = bValue;
+	m_Performance.bMonoMode[nTG] = bValue;
 }
 
 bool CPerformanceConfig::GetMonoMode (unsigned nTG) const
 {
-	return m_bMonoMode[nTG];
+	return m_Performance.bMonoMode[nTG];
 }
 
 void CPerformanceConfig::SetModulationWheelRange (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nModulationWheelRange[nTG] = nValue;
+	m_Performance.nModulationWheelRange[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetModulationWheelRange (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nModulationWheelRange[nTG];
+	return m_Performance.nModulationWheelRange[nTG];
 }
 
 void CPerformanceConfig::SetModulationWheelTarget (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nModulationWheelTarget[nTG] = nValue;
+	m_Performance.nModulationWheelTarget[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetModulationWheelTarget (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nModulationWheelTarget[nTG];
+	return m_Performance.nModulationWheelTarget[nTG];
 }
 
 void CPerformanceConfig::SetFootControlRange (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nFootControlRange[nTG] = nValue;
+	m_Performance.nFootControlRange[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetFootControlRange (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nFootControlRange[nTG];
+	return m_Performance.nFootControlRange[nTG];
 }
 
 void CPerformanceConfig::SetFootControlTarget (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nFootControlTarget[nTG] = nValue;
+	m_Performance.nFootControlTarget[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetFootControlTarget (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nFootControlTarget[nTG];
+	return m_Performance.nFootControlTarget[nTG];
 }
 
 void CPerformanceConfig::SetBreathControlRange (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nBreathControlRange[nTG] = nValue;
+	m_Performance.nBreathControlRange[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetBreathControlRange (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nBreathControlRange[nTG];
+	return m_Performance.nBreathControlRange[nTG];
 }
 
 void CPerformanceConfig::SetBreathControlTarget (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nBreathControlTarget[nTG] = nValue;
+	m_Performance.nBreathControlTarget[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetBreathControlTarget (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nBreathControlTarget[nTG];
+	return m_Performance.nBreathControlTarget[nTG];
 }
 
 void CPerformanceConfig::SetAftertouchRange (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nAftertouchRange[nTG] = nValue;
+	m_Performance.nAftertouchRange[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetAftertouchRange (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nAftertouchRange[nTG];
+	return m_Performance.nAftertouchRange[nTG];
 }
 
 void CPerformanceConfig::SetAftertouchTarget (unsigned nValue, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nAftertouchTarget[nTG] = nValue;
+	m_Performance.nAftertouchTarget[nTG] = nValue;
 }
 
 unsigned CPerformanceConfig::GetAftertouchTarget (unsigned nTG) const
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	return m_nAftertouchTarget[nTG];
+	return m_Performance.nAftertouchTarget[nTG];
 }
 
-void CPerformanceConfig::SetVoiceDataToTxt (const uint8_t *pData, unsigned nTG)  
+void CPerformanceConfig::SetVoiceData (const uint8_t *pData, unsigned nTG)
 {
 	assert (nTG < CConfig::AllToneGenerators);
-	m_nVoiceDataTxt[nTG] = "";
-	char nDtoH[]="0123456789ABCDEF";
-	for (int i = 0; i < NUM_VOICE_PARAM; i++)
+	assert (pData);
+	memcpy (m_Performance.VoiceData[nTG], pData, NUM_VOICE_PARAM);
+	m_Performance.bVoiceDataFilled[nTG] = true;
+}
+
+uint8_t *CPerformanceConfig::GetVoiceData (unsigned nTG)
+{
+	assert (nTG < CConfig::AllToneGenerators);
+	return m_Performance.VoiceData[nTG];
+}
+
+bool CPerformanceConfig::VoiceDataFilled(unsigned nTG) 
+{
+	assert (nTG < CConfig::AllToneGenerators);
+	return m_Performance.bVoiceDataFilled[nTG];
+}
+
+void CPerformanceConfig::EncodeVoiceDataHex (const uint8_t *pData, char *pBuffer)
+{
+	static const char HexDigit[] = "0123456789ABCDEF";
+
+	for (unsigned i = 0; i < NUM_VOICE_PARAM; i++)
 	{
-	m_nVoiceDataTxt[nTG]  += nDtoH[(pData[i] & 0xF0)/16];
-	m_nVoiceDataTxt[nTG]  += nDtoH[pData[i] & 0x0F]  ;
-	if ( i < (NUM_VOICE_PARAM-1)  ) 
-    	{
-     	 m_nVoiceDataTxt[nTG] += " ";
-    	}
+		if (i > 0)
+		{
+			*pBuffer++ = ' ';
+		}
+
+		*pBuffer++ = HexDigit[pData[i] >> 4];
+		*pBuffer++ = HexDigit[pData[i] & 0x0F];
 	}
+
+	*pBuffer = '\0';
 }
 
-uint8_t *CPerformanceConfig::GetVoiceDataFromTxt (unsigned nTG) 
+bool CPerformanceConfig::DecodeVoiceDataHex (const char *pText, uint8_t *pData)
 {
-	assert (nTG < CConfig::AllToneGenerators);
-	static uint8_t pData[NUM_VOICE_PARAM];
-	std::string nHtoD="0123456789ABCDEF";
-	 
- 	for (int i=0; i<NUM_VOICE_PARAM * 3; i=i+3)
+	for (unsigned i = 0; i < NUM_VOICE_PARAM; i++)
 	{
-  	pData[i/3] = ((nHtoD.find(toupper(m_nVoiceDataTxt[nTG][i]),0) * 16 + nHtoD.find(toupper(m_nVoiceDataTxt[nTG][i+1]),0))) & 0xFF ;
-	} 
-  
-	return pData;
+		while (*pText == ' ')
+		{
+			pText++;
+		}
+
+		uint8_t uchValue = 0;
+		for (unsigned j = 0; j < 2; j++)
+		{
+			char chDigit = *pText++;
+			if ('0' <= chDigit && chDigit <= '9')
+			{
+				uchValue = uchValue << 4 | (chDigit - '0');
+			}
+			else if ('A' <= (chDigit & ~0x20) && (chDigit & ~0x20) <= 'F')
+			{
+				uchValue = uchValue << 4 | ((chDigit & ~0x20) - 'A' + 10);
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		pData[i] = uchValue;
+	}
+
+	return true;
 }
 
-bool CPerformanceConfig::VoiceDataFilled(unsigned nTG) 
+void CPerformanceConfig::EncodeVoiceDataBase64 (const uint8_t *pData, char *pBuffer)
+{
+	static const char Base64Digit[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	uint8_t Binary[VoiceDataBase64Length/4 * 3] = {0};
+	memcpy (Binary, pData, NUM_VOICE_PARAM);
+	uint16_t usChecksum = GetVoiceDataChecksum (pData);
+	Binary[NUM_VOICE_PARAM] = usChecksum >> 8;
+	Binary[NUM_VOICE_PARAM+1] = usChecksum & 0xFF;
+
+	for (unsigned i = 0; i < VoiceDataBinaryLength; i += 3)
+	{
+		uint32_t nTriple = Binary[i] << 16 | Binary[i+1] << 8 | Binary[i+2];
+
+		*pBuffer++ = Base64Digit[nTriple >> 18];
+		*pBuffer++ = Base64Digit[(nTriple >> 12) & 0x3F];
+		*pBuffer++ = i+1 < VoiceDataBinaryLength ? Base64Digit[(nTriple >> 6) & 0x3F] : '=';
+		*pBuffer++ = i+2 < VoiceDataBinaryLength ? Base64Digit[nTriple & 0x3F] : '=';
+	}
+
+	*pBuffer = '\0';
+}
+
+bool CPerformanceConfig::DecodeVoiceDataBase64 (const char *pText, uint8_t *pData)
 {
-	return (strcmp(m_nVoiceDataTxt[nTG].c_str(),"") != 0) ;
+	uint8_t Binary[VoiceDataBase64Length/4 * 3];
+
+	for (unsigned i = 0; i < VoiceDataBinaryLength; i += 3)
+	{
+		uint32_t nTriple = 0;
+		for (unsigned j = 0; j < 4; j++)
+		{
+			char chDigit = *pText++;
+
+			unsigned nValue;
+			if ('A' <= chDigit && chDigit <= 'Z')		nValue = chDigit - 'A';
+			else if ('a' <= chDigit && chDigit <= 'z')	nValue = chDigit - 'a' + 26;
+			else if ('0' <= chDigit && chDigit <= '9')	nValue = chDigit - '0' + 52;
+			else if (chDigit == '+')			nValue = 62;
+			else if (chDigit == '/')			nValue = 63;
+			else if (chDigit == '=' && i+j > VoiceDataBinaryLength) nValue = 0;
+			else						return false;
+
+			nTriple = nTriple << 6 | nValue;
+		}
+
+		Binary[i] = nTriple >> 16;
+		Binary[i+1] = (nTriple >> 8) & 0xFF;
+		Binary[i+2] = nTriple & 0xFF;
+	}
+
+	if (*pText != '\0')
+	{
+		return false;
+	}
+
+	// the padding bits must be zero, or the checksum would not cover them
+	for (unsigned i = VoiceDataBinaryLength; i < sizeof Binary; i++)
+	{
+		if (Binary[i])
+		{
+			return false;
+		}
+	}
+
+	uint16_t usChecksum = Binary[NUM_VOICE_PARAM] << 8 | Binary[NUM_VOICE_PARAM+1];
+	if (usChecksum != GetVoiceDataChecksum (Binary))
+	{
+		return false;
+	}
+
+	memcpy (pData, Binary, NUM_VOICE_PARAM);
+
+	return true;
+}
+
+uint16_t CPerformanceConfig::GetVoiceDataChecksum (const uint8_t *pData)
+{
+	unsigned nSum1 = 0;
+	unsigned nSum2 = 0;
+	for (unsigned i = 0; i < NUM_VOICE_PARAM; i++)
+	{
+		nSum1 = (nSum1 + pData[i]) % 255;
+		nSum2 = (nSum2 + nSum1) % 255;
+	}
+
+	return nSum2 << 8 | nSum1;
 }
 
 std::string CPerformanceConfig::GetPerformanceFileName(unsigned nID)
@@ -940,8 +1174,8 @@ bool CPerformanceConfig::CreateNewPerformanceFile(void)
 	{
 		nFileName +=sPerformanceName.substr(0,14);
 	}
+	m_PerformanceFileName[nNewPerformance] = nFileName.substr(7);
 	nFileName += ".ini";
-	m_PerformanceFileName[nNewPerformance]= sPerformanceName;
 	
 	nPath = "SD:/" ;
 	nPath += PERFORMANCE_DIR;
@@ -966,6 +1200,9 @@ bool CPerformanceConfig::CreateNewPerformanceFile(void)
 	m_nLastPerformance = nNewPerformance;
 	m_nActualPerformance = nNewPerformance;
 	new (&m_Properties) CPropertiesFatFsFile(nFileName.c_str(), m_pFileSystem);
+	m_nPropertiesID = nNewPerformance;
+	m_bPerformanceCached[nNewPerformance] = false;	// empty until saved
+	StoreListing ();
 	
 	return true;
 }
@@ -976,8 +1213,10 @@ bool CPerformanceConfig::ListPerformances()
 	for (unsigned i=0; i<NUM_PERFORMANCES; i++)
 	{
 		m_PerformanceFileName[i].clear();
+		m_bPerformanceCached[i] = false;
 	}
 	m_nLastPerformance=0;
+	m_nNextCacheID=0;
 	if (m_nPerformanceBank == 0)
 	{
 		// The first bank is the default performance directory
@@ -986,81 +1225,240 @@ bool CPerformanceConfig::ListPerformances()
 	
 	if (m_bPerformanceDirectoryExists)
 	{
-		DIR Directory;
-		FILINFO FileInfo;
-		FRESULT Result;
-		std::string PerfDir = "SD:/" PERFORMANCE_DIR + AddPerformanceBankDirName(m_nPerformanceBank);
-#ifdef VERBOSE_DEBUG
-		LOGNOTE("Listing Performances from %s", PerfDir.c_str());
-#endif
-		Result = f_opendir (&Directory, PerfDir.c_str());
-		if (Result != FR_OK)
+		if (   !m_bListed[m_nPerformanceBank]
+		    && !ScanPerformances (m_nPerformanceBank))
 		{
 			return false;
 		}
-		unsigned nPIndex;
 
-		Result = f_findfirst (&Directory, &FileInfo, PerfDir.c_str(), "*.ini");
-		for (unsigned i = 0; Result == FR_OK && FileInfo.fname[0]; i++)
+		for (const TListingEntry &rEntry : m_Listing[m_nPerformanceBank])
 		{
-			if (!(FileInfo.fattrib & (AM_HID | AM_SYS)))  
+			m_PerformanceFileName[rEntry.nID] = rEntry.Name;
+
+			if (rEntry.nID > m_nLastPerformance)
 			{
-				std::string OriFileName = FileInfo.fname;
-				size_t nLen = OriFileName.length();
-				if (   nLen > 8 && nLen <26	 && strcmp(OriFileName.substr(6,1).c_str(), "_")==0)
-				{
-					// Note: m_nLastPerformance - refers to the number (index) of the last performance in memory,
-					//       which includes a default performance.
-					//
-					//       Filenames on the disk start from 1 to match what the user might see in MIDI.
-					//       So this means that actually file 000001_ will correspond to index position [0].
-					//       For the default bank though, ID 1 is the default performance, so will already exist.
-					//          m_PerformanceFileName[0] = default performance (file 000001)
-					//          m_PerformanceFileName[1] = first available on-disk performance (file 000002)
-					//
-					// Note2: filenames assume 6 digits, underscore, name, finally ".ini"
-					//        i.e.   123456_Performance Name.ini
-					//
-					nPIndex=stoi(OriFileName.substr(0,6));
-					if ((nPIndex < 1) || (nPIndex >= (NUM_PERFORMANCES+1)))
-					{
-						// Index is out of range - skip to next file
-						LOGNOTE ("Performance number out of range: %s (%d to %d)", FileInfo.fname, 1, NUM_PERFORMANCES);
-					}
-					else
-					{
-						// Convert from "user facing" 1..indexed number to internal 0..indexed
-						nPIndex = nPIndex-1;
-						if (m_PerformanceFileName[nPIndex].empty())
-						{
-							if(nPIndex > m_nLastPerformance)
-							{
-								m_nLastPerformance=nPIndex;
-							}
+				m_nLastPerformance = rEntry.nID;
+			}
+		}
+	}
+
+	// The performances of the bank are parsed by CacheNextPerformance() in
+	// the background, or when they are loaded.
+	
+	return true;
+}
+
+// List the performances of all banks, so that selecting a bank does not need
+// to access the SD card. Bank 0 is the performance directory itself, if there
+// is no bank directory for it.
+void CPerformanceConfig::ListAllPerformances (void)
+{
+	unsigned nFiles = 0;
+	for (unsigned nBankID = 0; nBankID < NUM_PERFORMANCE_BANKS; nBankID++)
+	{
+		m_Listing[nBankID].clear ();
+		m_bListed[nBankID] = false;
+
+		if (   m_bPerformanceDirectoryExists
+		    && (nBankID == 0 || IsValidPerformanceBank (nBankID))
+		    && ScanPerformances (nBankID))
+		{
+			nFiles += m_Listing[nBankID].size ();
+		}
+	}
 
-							std::string FileName = OriFileName.substr(0,OriFileName.length()-4).substr(7,14);
+	LOGNOTE ("%u performance files listed", nFiles);
+}
+
+bool CPerformanceConfig::ScanPerformances (unsigned nBankID)
+{
+	assert (nBankID < NUM_PERFORMANCE_BANKS);
+	m_Listing[nBankID].clear ();
+	m_bListed[nBankID] = false;
 
-							m_PerformanceFileName[nPIndex] = FileName;
+	DIR Directory;
+	FILINFO FileInfo;
+	FRESULT Result;
+	std::string PerfDir = "SD:/" PERFORMANCE_DIR + AddPerformanceBankDirName(nBankID);
 #ifdef VERBOSE_DEBUG
-							LOGNOTE ("Loading performance %s (%d, %s)", OriFileName.c_str(), nPIndex, FileName.c_str());
+	LOGNOTE("Listing Performances from %s", PerfDir.c_str());
 #endif
-						}
-						else
-						{
-							LOGNOTE ("Duplicate performance %s", OriFileName.c_str());
-						}
-					}
-				}
-			}
+	Result = f_opendir (&Directory, PerfDir.c_str());
+	if (Result != FR_OK)
+	{
+		return false;
+	}
+
+	// For the default bank ID 0 is the default performance, so will already
+	// exist and file 000001_ is a duplicate.
+	bool bFound[NUM_PERFORMANCES] = {false};
+	bFound[0] = nBankID == 0;
+
+	for (Result = f_findfirst (&Directory, &FileInfo, PerfDir.c_str(), "*.ini");
+	     Result == FR_OK && FileInfo.fname[0];
+	     Result = f_findnext (&Directory, &FileInfo))
+	{
+		if (FileInfo.fattrib & (AM_HID | AM_SYS))
+		{
+			continue;
+		}
 
-			Result = f_findnext (&Directory, &FileInfo);
+		// Filenames assume 6 digits, underscore, name, finally ".ini"
+		// i.e.   123456_Performance Name.ini
+		// Filenames on the disk start from 1 to match what the user might
+		// see in MIDI. So file 000001_ corresponds to index position [0].
+		const char *pFileName = FileInfo.fname;
+		size_t nLen = strlen (pFileName);
+		if (   nLen < 7+4 || nLen >= 26
+		    || pFileName[6] != '_')
+		{
+			continue;
 		}
-		f_closedir (&Directory);
+
+		unsigned nPIndex = 0;
+		unsigned i;
+		for (i = 0; i < 6 && '0' <= pFileName[i] && pFileName[i] <= '9'; i++)
+		{
+			nPIndex = nPIndex*10 + pFileName[i] - '0';
+		}
+
+		if (i < 6)
+		{
+			continue;
+		}
+
+		if ((nPIndex < 1) || (nPIndex >= (NUM_PERFORMANCES+1)))
+		{
+			// Index is out of range - skip to next file
+			LOGNOTE ("Performance number out of range: %s (%d to %d)", pFileName, 1, NUM_PERFORMANCES);
+
+			continue;
+		}
+
+		// Convert from "user facing" 1..indexed number to internal 0..indexed
+		nPIndex = nPIndex-1;
+		if (bFound[nPIndex])
+		{
+			LOGNOTE ("Duplicate performance %s", pFileName);
+
+			continue;
+		}
+		bFound[nPIndex] = true;
+
+		TListingEntry Entry;
+		Entry.nID = nPIndex;
+
+		size_t nNameLen = nLen - 7 - 4;
+		if (nNameLen > sizeof Entry.Name - 1)
+		{
+			nNameLen = sizeof Entry.Name - 1;
+		}
+		memcpy (Entry.Name, pFileName + 7, nNameLen);
+		Entry.Name[nNameLen] = '\0';
+
+		m_Listing[nBankID].push_back (Entry);
+#ifdef VERBOSE_DEBUG
+		LOGNOTE ("Found performance %s (%d, %s)", pFileName, nPIndex, Entry.Name);
+#endif
 	}
-	
+	f_closedir (&Directory);
+
+	m_bListed[nBankID] = true;
+
+	return true;
+}
+
+// Updates the listing of the current bank after a performance file has been
+// created or deleted
+void CPerformanceConfig::StoreListing (void)
+{
+	std::vector<TListingEntry> &rListing = m_Listing[m_nPerformanceBank];
+	rListing.clear ();
+
+	for (unsigned nID = 0; nID <= m_nLastPerformance && nID < NUM_PERFORMANCES; nID++)
+	{
+		if (   m_PerformanceFileName[nID].empty ()
+		    || (m_nPerformanceBank == 0 && nID == 0))
+		{
+			continue;
+		}
+
+		TListingEntry Entry;
+		Entry.nID = nID;
+		strncpy (Entry.Name, m_PerformanceFileName[nID].c_str (), sizeof Entry.Name - 1);
+		Entry.Name[sizeof Entry.Name - 1] = '\0';
+
+		rListing.push_back (Entry);
+	}
+
+	m_bListed[m_nPerformanceBank] = true;
+}
+
+void CPerformanceConfig::FileChanged (const char *pPath)
+{
+	assert (pPath);
+
+	// "SD:/performance..." or "SD:performance...", includes performance.ini
+	if (strncasecmp (pPath, "SD:", 3) == 0)
+	{
+		pPath += 3;
+	}
+
+	while (*pPath == '/')
+	{
+		pPath++;
+	}
+
+	if (strncasecmp (pPath, PERFORMANCE_DIR, strlen (PERFORMANCE_DIR)) == 0)
+	{
+		__atomic_fetch_add (&s_nFileChanges, 1, __ATOMIC_RELAXED);
+	}
+}
+
+bool CPerformanceConfig::UpdateListings (void)
+{
+	unsigned nChanges = __atomic_load_n (&s_nFileChanges, __ATOMIC_RELAXED);
+	if (nChanges == m_nListingChanges)
+	{
+		return false;
+	}
+
+	m_nListingChanges = nChanges;
+
+	LOGNOTE ("Performance directory has been modified");
+
+	unsigned nBankID = m_nPerformanceBank;
+
+	ListPerformanceBanks ();
+	ListAllPerformances ();
+
+	if (!IsValidPerformanceBank (nBankID))
+	{
+		nBankID = 0;
+	}
+
+	m_nPerformanceBank = nBankID;
+	ListPerformances ();
+
 	return true;
 }
 
+bool CPerformanceConfig::CacheNextPerformance (void)
+{
+	for (; m_nNextCacheID <= m_nLastPerformance && m_nNextCacheID < NUM_PERFORMANCES; m_nNextCacheID++)
+	{
+		if (   IsValidPerformance (m_nNextCacheID)
+		    && !m_bPerformanceCached[m_nNextCacheID])
+		{
+			CachePerformance (m_nNextCacheID++);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void CPerformanceConfig::SetNewPerformance (unsigned nID)
 {
 	assert (nID < NUM_PERFORMANCES);
@@ -1068,6 +1466,7 @@ void CPerformanceConfig::SetNewPerformance (unsigned nID)
 	std::string FileN = GetPerformanceFullFilePath(nID);
 
 	new (&m_Properties) CPropertiesFatFsFile(FileN.c_str(), m_pFileSystem);
+	m_nPropertiesID = nID;
 #ifdef VERBOSE_DEBUG
 	LOGNOTE("Selecting Performance: %d (%s)", nID+1, FileN.c_str());
 #endif
@@ -1127,6 +1526,7 @@ bool CPerformanceConfig::DeletePerformance(unsigned nID)
 			m_nActualPerformance =0;
 			//nMenuSelectedPerformance=0;
 			m_PerformanceFileName[nID].clear();
+			m_bPerformanceCached[nID] = false;
 			// If this was the last performance in the bank...
 			if (nID == m_nLastPerformance)
 			{
@@ -1136,6 +1536,7 @@ bool CPerformanceConfig::DeletePerformance(unsigned nID)
 					m_nLastPerformance--;
 				} while (!IsValidPerformance(m_nLastPerformance) && (m_nLastPerformance > 0));
 			}
+			StoreListing ();
 			bOK=true;
 		}
 		else
@@ -1152,6 +1553,11 @@ bool CPerformanceConfig::ListPerformanceBanks()
 	m_nLastPerformance = 0;
 	m_nLastPerformanceBank = 0;
 
+	for (unsigned nBankID = 0; nBankID < NUM_PERFORMANCE_BANKS; nBankID++)
+	{
+		m_PerformanceBankName[nBankID].clear ();
+	}
+
 	// Open performance directory
 	DIR Directory;
 	FILINFO FileInfo;
@@ -1165,6 +1571,7 @@ bool CPerformanceConfig::ListPerformanceBanks()
 		m_bPerformanceDirectoryExists = false;
 		return false;
 	}
+	m_bPerformanceDirectoryExists = true;
 
 	unsigned nNumBanks = 0;
 	m_nLastPerformanceBank = 0;
@@ -26,6 +26,7 @@
 #include "config.h"
 #include <fatfs/ff.h>
 #include <Properties/propertiesfatfsfile.h>
+#include <vector>
 #define NUM_VOICE_PARAM 156
 #define NUM_PERFORMANCES 128
 #define NUM_PERFORMANCE_BANKS 128
@@ -36,7 +37,8 @@ public:
 	CPerformanceConfig (FATFS *pFileSystem);
 	~CPerformanceConfig (void);
 	
-	bool Init (unsigned nToneGenerators);
+	// bVoiceDataBase64 selects the format of the voice data on Save()
+	bool Init (unsigned nToneGenerators, bool bVoiceDataBase64 = false);
 
 	bool Load (void);
 
@@ -88,8 +90,8 @@ public:
 	void SetPortamentoMode (unsigned nValue, unsigned nTG);
 	void SetPortamentoGlissando (unsigned nValue, unsigned nTG);
 	void SetPortamentoTime (unsigned nValue, unsigned nTG);
-	void SetVoiceDataToTxt (const uint8_t *pData, unsigned nTG); 
-	uint8_t *GetVoiceDataFromTxt (unsigned nTG);
+	void SetVoiceData (const uint8_t *pData, unsigned nTG);	// NUM_VOICE_PARAM bytes
+	uint8_t *GetVoiceData (unsigned nTG);
 	void SetMonoMode (bool bOKValue, unsigned nTG); 
 
 	void SetModulationWheelRange (unsigned nValue, unsigned nTG);
@@ -149,39 +151,106 @@ public:
 	std::string GetPerformanceBankName(unsigned nBankID);
 	bool IsValidPerformanceBank(unsigned nBankID);
 
+	// The performances of all banks are listed once by Init(). The FTP server
+	// calls FileChanged() after it has modified a file or directory (FatFs
+	// path), so that the listings are built again by UpdateListings(), if
+	// this was below the performance directory (returns true then).
+	static void FileChanged (const char *pPath);
+	bool UpdateListings (void);
+
+	// parses the next performance of the current bank, which is not cached
+	// yet, returns false if there is none
+	bool CacheNextPerformance (void);
+
+private:
+	friend class CPerformanceConfigProbe;	// tests the voice data formats on the host
+
+	// A parsed performance file. The values are stored in the smallest type,
+	// which holds their range, so that a whole bank can be kept in memory.
+	struct TPerformance
+	{
+		bool		bValid;		// at least one TG has a MIDI channel
+
+		uint16_t	nBankNumber[CConfig::AllToneGenerators];
+		uint8_t		nVoiceNumber[CConfig::AllToneGenerators];
+		uint8_t		nMIDIChannel[CConfig::AllToneGenerators];
+		uint8_t		nVolume[CConfig::AllToneGenerators];
+		uint8_t		nPan[CConfig::AllToneGenerators];
+		int8_t		nDetune[CConfig::AllToneGenerators];
+		uint8_t		nCutoff[CConfig::AllToneGenerators];
+		uint8_t		nResonance[CConfig::AllToneGenerators];
+		uint8_t		nNoteLimitLow[CConfig::AllToneGenerators];
+		uint8_t		nNoteLimitHigh[CConfig::AllToneGenerators];
+		int8_t		nNoteShift[CConfig::AllToneGenerators];
+		uint8_t		nReverbSend[CConfig::AllToneGenerators];
+		uint8_t		nPitchBendRange[CConfig::AllToneGenerators];
+		uint8_t		nPitchBendStep[CConfig::AllToneGenerators];
+		uint8_t		nPortamentoMode[CConfig::AllToneGenerators];
+		uint8_t		nPortamentoGlissando[CConfig::AllToneGenerators];
+		uint8_t		nPortamentoTime[CConfig::AllToneGenerators];
+		uint8_t		VoiceData[CConfig::AllToneGenerators][NUM_VOICE_PARAM];
+		bool		bVoiceDataFilled[CConfig::AllToneGenerators];
+		bool		bMonoMode[CConfig::AllToneGenerators];
+
+		uint8_t		nModulationWheelRange[CConfig::AllToneGenerators];
+		uint8_t		nModulationWheelTarget[CConfig::AllToneGenerators];
+		uint8_t		nFootControlRange[CConfig::AllToneGenerators];
+		uint8_t		nFootControlTarget[CConfig::AllToneGenerators];
+		uint8_t		nBreathControlRange[CConfig::AllToneGenerators];
+		uint8_t		nBreathControlTarget[CConfig::AllToneGenerators];
+		uint8_t		nAftertouchRange[CConfig::AllToneGenerators];
+		uint8_t		nAftertouchTarget[CConfig::AllToneGenerators];
+
+		bool		bCompressorEnable;
+		bool		bReverbEnable;
+		uint8_t		nReverbSize;
+		uint8_t		nReverbHighDamp;
+		uint8_t		nReverbLowDamp;
+		uint8_t		nReverbLowPass;
+		uint8_t		nReverbDiffusion;
+		uint8_t		nReverbLevel;
+	};
+
+	void Parse (CPropertiesFatFsFile &rProperties, TPerformance *pPerformance);
+	void CachePerformance (unsigned nID);		// read and parse the file
+
+	// a performance file "123456_Name.ini" of a bank
+	struct TListingEntry
+	{
+		uint8_t		nID;			// 0 .. NUM_PERFORMANCES-1
+		char		Name[15];		// without number and extension
+	};
+
+	void ListAllPerformances (void);
+	bool ScanPerformances (unsigned nBankID);	// read the listing from disk
+	void StoreListing (void);			// of the current bank
+
+	// VoiceData# is hex text: "XX XX .. XX"
+	static void EncodeVoiceDataHex (const uint8_t *pData, char *pBuffer);
+	static bool DecodeVoiceDataHex (const char *pText, uint8_t *pData);
+
+	// VoiceDataBase64# is Base64 of the voice data, followed by a Fletcher-16 checksum
+	static void EncodeVoiceDataBase64 (const uint8_t *pData, char *pBuffer);
+	static bool DecodeVoiceDataBase64 (const char *pText, uint8_t *pData);
+	static uint16_t GetVoiceDataChecksum (const uint8_t *pData);
+
 private:
+	static const unsigned VoiceDataHexLength = NUM_VOICE_PARAM*3 - 1;
+	static const unsigned VoiceDataBinaryLength = NUM_VOICE_PARAM + 2;
+	static const unsigned VoiceDataBase64Length = (VoiceDataBinaryLength + 2) / 3 * 4;
+
 	CPropertiesFatFsFile m_Properties;
 	
 	unsigned m_nToneGenerators;
 
-	unsigned m_nBankNumber[CConfig::AllToneGenerators];
-	unsigned m_nVoiceNumber[CConfig::AllToneGenerators];
-	unsigned m_nMIDIChannel[CConfig::AllToneGenerators];
-	unsigned m_nVolume[CConfig::AllToneGenerators];
-	unsigned m_nPan[CConfig::AllToneGenerators];
-	int m_nDetune[CConfig::AllToneGenerators];
-	unsigned m_nCutoff[CConfig::AllToneGenerators];
-	unsigned m_nResonance[CConfig::AllToneGenerators];
-	unsigned m_nNoteLimitLow[CConfig::AllToneGenerators];
-	unsigned m_nNoteLimitHigh[CConfig::AllToneGenerators];
-	int m_nNoteShift[CConfig::AllToneGenerators];
-	int m_nReverbSend[CConfig::AllToneGenerators];
-	unsigned m_nPitchBendRange[CConfig::AllToneGenerators];
-	unsigned m_nPitchBendStep[CConfig::AllToneGenerators];
-	unsigned m_nPortamentoMode[CConfig::AllToneGenerators];
-	unsigned m_nPortamentoGlissando[CConfig::AllToneGenerators];
-	unsigned m_nPortamentoTime[CConfig::AllToneGenerators];
-	std::string m_nVoiceDataTxt[CConfig::AllToneGenerators]; 
-	bool m_bMonoMode[CConfig::AllToneGenerators]; 
-
-	unsigned m_nModulationWheelRange[CConfig::AllToneGenerators];
-	unsigned m_nModulationWheelTarget[CConfig::AllToneGenerators];
-	unsigned m_nFootControlRange[CConfig::AllToneGenerators];	
-	unsigned m_nFootControlTarget[CConfig::AllToneGenerators];	
-	unsigned m_nBreathControlRange[CConfig::AllToneGenerators];	
-	unsigned m_nBreathControlTarget[CConfig::AllToneGenerators];	
-	unsigned m_nAftertouchRange[CConfig::AllToneGenerators];	
-	unsigned m_nAftertouchTarget[CConfig::AllToneGenerators];	
+	TPerformance m_Performance;			// the current performance
+	bool m_bVoiceDataBase64;
+
+	// all performances of the current bank, parsed when they are loaded or
+	// in the background after the bank has been selected
+	TPerformance *m_pPerformanceCache;
+	bool m_bPerformanceCached[NUM_PERFORMANCES];
+	unsigned m_nPropertiesID;			// performance, m_Properties refers to
 
 	unsigned m_nLastPerformance;  
 	unsigned m_nActualPerformance = 0;  
@@ -192,18 +261,16 @@ private:
 	//unsigned nMenuSelectedPerformance = 0; 
 	std::string m_PerformanceFileName[NUM_PERFORMANCES];
 	std::string m_PerformanceBankName[NUM_PERFORMANCE_BANKS];
+
+	std::vector<TListingEntry> m_Listing[NUM_PERFORMANCE_BANKS];
+	bool m_bListed[NUM_PERFORMANCE_BANKS];
+	unsigned m_nListingChanges;			// s_nFileChanges, when listed
+	unsigned m_nNextCacheID;			// for CacheNextPerformance()
+
+	static unsigned s_nFileChanges;
 	FATFS *m_pFileSystem; 
 
 	std::string NewPerformanceName="";
-	
-	bool m_bCompressorEnable;
-	bool m_bReverbEnable;
-	unsigned m_nReverbSize;
-	unsigned m_nReverbHighDamp;
-	unsigned m_nReverbLowDamp;
-	unsigned m_nReverbLowPass;
-	unsigned m_nReverbDiffusion;
-	unsigned m_nReverbLevel;
 };
 
 #endif
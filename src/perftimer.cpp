@@ -64,3 +64,88 @@ void CPerformanceTimer::Dump (unsigned nIntervalTicks)
 		std::cout << std::endl;
 	}
 }
+
+CPerformanceCounter::CPerformanceCounter (const char *pName)
+:	m_Name (pName),
+	m_nCount (0),
+	m_nLastDumpCount (0),
+	m_nLastDumpTicks (0)
+{
+}
+
+void CPerformanceCounter::Add (unsigned nCount)
+{
+	m_nCount += nCount;
+}
+
+void CPerformanceCounter::Dump (unsigned nIntervalTicks)
+{
+	unsigned nTicks = CTimer::GetClockTicks ();
+
+	if (nTicks - m_nLastDumpTicks >= nIntervalTicks)
+	{
+		m_nLastDumpTicks = nTicks;
+
+		unsigned nCount = m_nCount;		// may be incremented on another core
+
+		std::cout << m_Name << ": " << nCount - m_nLastDumpCount << " since last dump ("
+			  << nCount << " total)" << std::endl;
+
+		m_nLastDumpCount = nCount;
+	}
+}
+
+CPerformanceGauge::CPerformanceGauge (const char *pName)
+:	m_Name (pName),
+	m_nMinimum ((unsigned) -1),
+	m_nMaximum (0),
+	m_nSum (0),
+	m_nSamples (0),
+	m_nLastDumpSum (0),
+	m_nLastDumpSamples (0),
+	m_nLastDumpTicks (0)
+{
+}
+
+void CPerformanceGauge::Sample (unsigned nValue)
+{
+	if (nValue < m_nMinimum)
+	{
+		m_nMinimum = nValue;
+	}
+
+	if (nValue > m_nMaximum)
+	{
+		m_nMaximum = nValue;
+	}
+
+	m_nSum += nValue;
+	m_nSamples++;
+}
+
+void CPerformanceGauge::Dump (unsigned nIntervalTicks)
+{
+	unsigned nTicks = CTimer::GetClockTicks ();
+
+	if (nTicks - m_nLastDumpTicks >= nIntervalTicks)
+	{
+		m_nLastDumpTicks = nTicks;
+
+		// may be updated on another core
+		unsigned nSamples = m_nSamples;
+		unsigned nSum = m_nSum;
+
+		unsigned nNewSamples = nSamples - m_nLastDumpSamples;
+		if (nNewSamples != 0)
+		{
+			unsigned nAverage10 = (nSum - m_nLastDumpSum) * 10 / nNewSamples;
+
+			std::cout << m_Name << ": Average " << nAverage10 / 10 << "." << nAverage10 % 10
+				  << " since last dump (minimum " << m_nMinimum
+				  << ", maximum " << m_nMaximum << ")" << std::endl;
+		}
+
+		m_nLastDumpSum = nSum;
+		m_nLastDumpSamples = nSamples;
+	}
+}
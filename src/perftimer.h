@@ -43,4 +43,52 @@ private:
 	unsigned m_nLastDumpTicks;
 };
 
+class CPerformanceCounter
+{
+public:
+	CPerformanceCounter (const char *pName);
+
+	void Add (unsigned nCount = 1);
+
+	unsigned GetCount (void) const		{ return m_nCount; }
+
+	void Dump (unsigned nIntervalTicks = CLOCKHZ);
+
+private:
+	std::string m_Name;
+
+	volatile unsigned m_nCount;
+	unsigned m_nLastDumpCount;
+
+	unsigned m_nLastDumpTicks;
+};
+
+// Tracks a level (e.g. a queue occupancy), which is sampled regularly
+class CPerformanceGauge
+{
+public:
+	CPerformanceGauge (const char *pName);
+
+	void Sample (unsigned nValue);
+
+	// since construction
+	unsigned GetMinimum (void) const	{ return m_nMinimum; }
+	unsigned GetMaximum (void) const	{ return m_nMaximum; }
+	unsigned GetSamples (void) const	{ return m_nSamples; }
+
+	void Dump (unsigned nIntervalTicks = CLOCKHZ);
+
+private:
+	std::string m_Name;
+
+	volatile unsigned m_nMinimum;
+	volatile unsigned m_nMaximum;
+	volatile unsigned m_nSum;
+	volatile unsigned m_nSamples;
+	unsigned m_nLastDumpSum;
+	unsigned m_nLastDumpSamples;
+
+	unsigned m_nLastDumpTicks;
+};
+
 #endif
@@ -22,6 +22,7 @@
 //
 
 #include <circle/logger.h>
+#include <circle/timer.h>
 #include <cstring>
 #include "serialmididevice.h"
 #include <assert.h>
@@ -37,17 +38,16 @@ CSerialMIDIDevice::CSerialMIDIDevice (CMiniDexed *pSynthesizer, CInterruptSystem
 :	CMIDIDevice (pSynthesizer, pConfig, pUI),
 	m_pConfig (pConfig),
 	m_Serial (pInterrupt, TRUE, SERIAL_MIDI_DEVICE),
-	m_nSerialState (0),
-	m_nSysEx (0),
+	m_Parser (MessageHandler, this),
+	m_nMaxBacklog (0),
+	m_nOverruns (0),
 	m_SendBuffer (&m_Serial)
 {
 	AddDevice ("ttyS1");
 }
 
 CSerialMIDIDevice::~CSerialMIDIDevice (void)
-
 {
-	m_nSerialState = 255;
 }
 
 boolean CSerialMIDIDevice::Initialize (void)
@@ -63,119 +63,73 @@ boolean CSerialMIDIDevice::Initialize (void)
 
 void CSerialMIDIDevice::Process (void)
 {
-	m_SendBuffer.Update ();
-
-	// Read serial MIDI data
-	u8 Buffer[100];
-	int nResult = m_Serial.Read (Buffer, sizeof Buffer);
-	if (nResult <= 0)
+	const u8 *pMessage;
+	size_t nLength;
+	unsigned nCable;
+	while ((pMessage = m_SendQueue.Get (&nLength, &nCable)) != nullptr)
 	{
-		if(nResult!=0)
-			LOGERR("Serial.Read() error: %d\n",nResult);
-		return;
+		m_SendBuffer.Write (pMessage, nLength);
 	}
 
-/*        if (m_pConfig->GetMIDIDumpEnabled ())
-	{
-		printf("Incoming MIDI data:");
-		for (uint16_t i = 0; i < nResult; i++)
-		{
-			if((i % 8) == 0)
-				printf("\n%04d:",i);
-			printf(" 0x%02x",Buffer[i]);
-		}
-		printf("\n");
-	}*/
-
-	// Process MIDI messages
-	// See: https://www.midi.org/specifications/item/table-1-summary-of-midi-message
-	// "Running status" see: https://www.lim.di.unimi.it/IEEE/MIDI/SOT5.HTM#Running-	
-	
-	for (int i = 0; i < nResult; i++)
-	{
-		u8 uchData = Buffer[i];
-
-		if(uchData == 0xF0)
-		{
-			// SYSEX found
-			m_SerialMessage[m_nSysEx++]=uchData;
-			continue;
-		}
+	m_SendBuffer.Update ();
 
-		// System Real Time messages may appear anywhere in the byte stream, so handle them specially
-		if(uchData == 0xF8 || uchData == 0xFA || uchData == 0xFB || uchData == 0xFC || uchData == 0xFE || uchData == 0xFF)
-		{
-			MIDIMessageHandler (&uchData, 1);
-			continue;
-		}
-		else if(m_nSysEx > 0)
+	// The serial driver receives the data into its buffer from the interrupt
+	// handler. Read all of it, so that the MIDI input is not delayed further,
+	// when it takes longer to get here again (e.g. on a display update).
+	unsigned nBacklog = 0;
+	u8 Buffer[256];
+	int nResult;
+	while ((nResult = m_Serial.Read (Buffer, sizeof Buffer)) != 0)
+	{
+		if (nResult < 0)
 		{
-			m_SerialMessage[m_nSysEx++]=uchData;
-			if ((uchData & 0x80) == 0x80 || m_nSysEx >= MAX_MIDI_MESSAGE)
+			if (nResult == -SERIAL_ERROR_OVERRUN)
 			{
-				if(uchData == 0xF7)
-					MIDIMessageHandler (m_SerialMessage, m_nSysEx);
-				m_nSysEx = 0;
+				__atomic_fetch_add (&m_nOverruns, 1, __ATOMIC_RELAXED);
 			}
-			continue;
-		}
-		else
-		{
-			switch (m_nSerialState)
+			else
 			{
-			case 0:
-			MIDIRestart:
-				if (   (uchData & 0x80) == 0x80		// status byte, all channels
-				    && (uchData & 0xF0) != 0xF0)	// ignore system messages
-				{
-					m_SerialMessage[m_nSerialState++] = uchData;
-				}
-				break;
-	
-			case 1:
-			case 2:
-			DATABytes:
-				if (uchData & 0x80)			// got status when parameter expected
-				{
-					m_nSerialState = 0;
-	
-					goto MIDIRestart;
-				}
-	
-				m_SerialMessage[m_nSerialState++] = uchData;
-	
-				if (   (m_SerialMessage[0] & 0xE0) == 0xC0
-				    || m_nSerialState == 3		// message is complete
-				    || (m_SerialMessage[0] & 0xF0) == 0xD0)   // channel aftertouch
-				{
-					MIDIMessageHandler (m_SerialMessage, m_nSerialState);
-	
-					m_nSerialState = 4; // State 4 for test if 4th byte is a status byte or a data byte 
-				}
-	
-				break;
-			case 4:
-				
-				if ((uchData & 0x80) == 0)  // true data byte, false status byte
-				{
-					m_nSerialState = 1;
-					goto DATABytes;
-				}
-				else 
-				{
-					m_nSerialState = 0;
-					goto MIDIRestart; 
-				}
-				break;
-			default:
-				assert (0);
-				break;
+				LOGERR("Serial.Read() error: %d\n",nResult);
 			}
+
+			// data has been lost, wait for the next status byte
+			m_Parser.Reset ();
+
+			continue;
 		}
+
+		// the serial driver does not provide the arrival time of the data
+		m_Parser.Parse (Buffer, nResult, CTimer::GetClockTicks ());
+
+		nBacklog += nResult;
+	}
+
+	if (nBacklog > m_nMaxBacklog)
+	{
+		m_nMaxBacklog = nBacklog;
 	}
 }
 
 void CSerialMIDIDevice::Send (const u8 *pMessage, size_t nLength, unsigned nCable)
 {
-	m_SendBuffer.Write (pMessage, nLength);
+	m_SendQueue.Put (pMessage, nLength, nCable);
+}
+
+unsigned CSerialMIDIDevice::TakeMaxBacklog (void)
+{
+	return __atomic_exchange_n (&m_nMaxBacklog, 0, __ATOMIC_RELAXED);
+}
+
+unsigned CSerialMIDIDevice::TakeOverruns (void)
+{
+	return __atomic_exchange_n (&m_nOverruns, 0, __ATOMIC_RELAXED);
+}
+
+void CSerialMIDIDevice::MessageHandler (const u8 *pMessage, size_t nLength,
+					unsigned nTimestamp, void *pParam)
+{
+	CSerialMIDIDevice *pThis = static_cast<CSerialMIDIDevice *> (pParam);
+	assert (pThis);
+
+	pThis->MIDIMessageHandler (pMessage, nLength, 0, nTimestamp);
 }
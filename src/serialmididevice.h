@@ -24,6 +24,8 @@
 #define _serialmididevice_h
 
 #include "mididevice.h"
+#include "midiparser.h"
+#include "midisendqueue.h"
 #include "config.h"
 #include <circle/interrupt.h>
 #include <circle/serial.h>
@@ -44,14 +46,26 @@ public:
 
 	void Send (const u8 *pMessage, size_t nLength, unsigned nCable = 0) override;
 
+	CMIDISendQueue *GetSendQueue (void)	{ return &m_SendQueue; }
+
+	// statistics, reset on read
+	unsigned TakeMaxBacklog (void);		// most bytes received in one Process()
+	unsigned TakeOverruns (void);		// receive buffer or UART overruns
+
+private:
+	static void MessageHandler (const u8 *pMessage, size_t nLength,
+				    unsigned nTimestamp, void *pParam);
+
 private:
 	CConfig *m_pConfig;
 
 	CSerialDevice m_Serial;
-	unsigned m_nSerialState;
-	unsigned m_nSysEx;
-	u8 m_SerialMessage[MAX_MIDI_MESSAGE];
+	CMIDIParser m_Parser;
+
+	unsigned m_nMaxBacklog;
+	unsigned m_nOverruns;
 
+	CMIDISendQueue m_SendQueue;
 	CWriteBufferDevice m_SendBuffer;
 };
 
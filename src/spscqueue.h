@@ -0,0 +1,109 @@
+//
+// spscqueue.h
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef _spscqueue_h
+#define _spscqueue_h
+
+#include <assert.h>
+
+// Bounded lock-free queue for exactly one producer and one consumer, which
+// may run on different cores. Put() must only be called by the producer,
+// Peek(), Remove() and Get() only by the consumer. nSize must be a power of 2.
+
+template <class T, unsigned nSize>
+class CSPSCQueue
+{
+	static_assert ((nSize & (nSize - 1)) == 0, "Queue size must be a power of 2");
+
+public:
+	CSPSCQueue (void)
+	:	m_nIn (0),
+		m_nOut (0)
+	{
+	}
+
+	bool IsEmpty (void) const
+	{
+		return   __atomic_load_n (&m_nIn, __ATOMIC_ACQUIRE)
+		      == __atomic_load_n (&m_nOut, __ATOMIC_ACQUIRE);
+	}
+
+	unsigned GetCount (void) const
+	{
+		return   __atomic_load_n (&m_nIn, __ATOMIC_ACQUIRE)
+		       - __atomic_load_n (&m_nOut, __ATOMIC_ACQUIRE);
+	}
+
+	// returns false, if the queue is full
+	bool Put (const T &rEntry)
+	{
+		unsigned nIn = m_nIn;
+		if (nIn - __atomic_load_n (&m_nOut, __ATOMIC_ACQUIRE) >= nSize)
+		{
+			return false;
+		}
+
+		m_Entry[nIn & (nSize - 1)] = rEntry;
+		__atomic_store_n (&m_nIn, nIn + 1, __ATOMIC_RELEASE);
+
+		return true;
+	}
+
+	// returns the oldest entry without removing it, or nullptr if empty
+	const T *Peek (void) const
+	{
+		unsigned nOut = m_nOut;
+		if (__atomic_load_n (&m_nIn, __ATOMIC_ACQUIRE) == nOut)
+		{
+			return nullptr;
+		}
+
+		return &m_Entry[nOut & (nSize - 1)];
+	}
+
+	void Remove (void)
+	{
+		assert (!IsEmpty ());
+		__atomic_store_n (&m_nOut, m_nOut + 1, __ATOMIC_RELEASE);
+	}
+
+	// returns false, if the queue is empty
+	bool Get (T *pEntry)
+	{
+		const T *pHead = Peek ();
+		if (pHead == nullptr)
+		{
+			return false;
+		}
+
+		assert (pEntry);
+		*pEntry = *pHead;
+		Remove ();
+
+		return true;
+	}
+
+private:
+	T m_Entry[nSize];
+
+	unsigned m_nIn;		// free-running, written by the producer only
+	unsigned m_nOut;	// free-running, written by the consumer only
+};
+
+#endif
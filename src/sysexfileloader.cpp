@@ -24,7 +24,10 @@
 #include <string.h>
 #include <strings.h>
 #include <assert.h>
+#include <algorithm>
 #include <circle/logger.h>
+#include <circle/synchronize.h>
+#include <circle/timer.h>
 #include "voices.c"
 
 LOGMODULE ("syxfile");
@@ -62,52 +65,143 @@ uint8_t CSysExFileLoader::s_DefaultVoice[SizeSingleVoice] =	// INIT VOICE
 };
 
 CSysExFileLoader::CSysExFileLoader (const char *pDirName)
-:	m_DirName (pDirName)
+:	m_DirName (pDirName),
+	m_bHeaderlessSysExVoices (false),
+	m_nCacheSize (0),
+	m_pCache (nullptr),
+	m_nUseCount (0),
+	m_nCacheMisses (0),
+	m_nDecodedVoiceHits (0),
+	m_nDecodedVoiceMisses (0),
+	m_pIndexBanks (nullptr),
+	m_nHeapUsed (0)
 {
+	m_IndexFileName = m_DirName + "/bankindex.bin";
 	m_DirName += "/voice";
 	m_nNumHighestBank = 0;
 
-	for (unsigned i = 0; i <= MaxVoiceBankID; i++)
+	memset (m_BankValid, 0, sizeof m_BankValid);
+
+	for (unsigned i = 0; i < DecodedBanks; i++)
 	{
-		m_pVoiceBank[i] = nullptr;
+		m_DecodedBank[i].nSlot = NoSlot;
+		m_DecodedBank[i].nLastUsed = 0;
+		m_DecodedBank[i].nVoicesValid = 0;
 	}
 }
 
 CSysExFileLoader::~CSysExFileLoader (void)
 {
-	for (unsigned i = 0; i <= MaxVoiceBankID; i++)
+	for (TBankEntry &rBank : m_Banks)
 	{
-		delete m_pVoiceBank[i];
+		delete rBank.pVoiceNames;
+
+		if (!m_pCache)
+		{
+			delete rBank.pVoiceBank;
+		}
 	}
+
+	delete [] m_pCache;
 }
 
-void CSysExFileLoader::Load (bool bHeaderlessSysExVoices)
+void CSysExFileLoader::Load (bool bHeaderlessSysExVoices, unsigned nCacheSize)
 {
+	unsigned nStartTicks = CTimer::GetClockTicks ();
+
 	m_nNumHighestBank = 0;
 	m_nBanksLoaded = 0;
+	m_bHeaderlessSysExVoices = bHeaderlessSysExVoices;
 
-    DIR *pDirectory = opendir (m_DirName.c_str ());
-	if (!pDirectory)
+	assert (!m_pCache);
+	m_nCacheSize = nCacheSize;
+	if (m_nCacheSize)
 	{
-		LOGWARN ("Directory %s not found", m_DirName.c_str ());
+		m_pCache = new TCacheEntry[m_nCacheSize];
+		assert (m_pCache);
+		m_nHeapUsed += m_nCacheSize * sizeof (TCacheEntry);
 
-		return;
+		for (unsigned i = 0; i < m_nCacheSize; i++)
+		{
+			m_pCache[i].nSlot = NoSlot;
+			m_pCache[i].bReading = false;
+			m_pCache[i].nLastUsed = 0;
+		}
 	}
 
-	dirent *pEntry;
-	while ((pEntry = readdir (pDirectory)) != nullptr)
+	// use the bank index, if the directory tree has not changed
+	CBankIndex Index (("SD:" + m_DirName).c_str (), ("SD:" + m_IndexFileName).c_str ());
+	uint32_t nSignature = Index.GetSignature (MaxSubDirs, bHeaderlessSysExVoices ? 1 : 0);
+
+	std::vector<CBankIndex::TBank> IndexBanks;
+	bool bFromIndex = Index.Read (nSignature, &IndexBanks);
+	if (bFromIndex)
+	{
+		for (const CBankIndex::TBank &rBank : IndexBanks)
+		{
+			if (   rBank.nBankID > MaxVoiceBankID
+			    || IsValidBank (rBank.nBankID))
+			{
+				continue;
+			}
+
+			AddBank (rBank.nBankID, (m_DirName + rBank.DirName).c_str (),
+				 rBank.FileName.c_str (), rBank.VoiceName);
+		}
+	}
+	else
 	{
-		LoadBank(m_DirName.c_str (), pEntry->d_name, bHeaderlessSysExVoices, 0);
+		DIR *pDirectory = opendir (m_DirName.c_str ());
+		if (!pDirectory)
+		{
+			LOGWARN ("Directory %s not found", m_DirName.c_str ());
+
+			return;
+		}
+
+		m_pIndexBanks = &IndexBanks;
+
+		dirent *pEntry;
+		while ((pEntry = readdir (pDirectory)) != nullptr)
+		{
+			LoadBank(m_DirName.c_str (), pEntry->d_name, bHeaderlessSysExVoices, 0);
+		}
+		LOGDBG ("%u Banks loaded. Highest Bank loaded: #%u", m_nBanksLoaded, m_nNumHighestBank+1);
+
+		closedir (pDirectory);
+
+		m_pIndexBanks = nullptr;
+
+		Index.Write (nSignature, IndexBanks);
 	}
-	LOGDBG ("%u Banks loaded. Highest Bank loaded: #%u", m_nBanksLoaded, m_nNumHighestBank+1);
 
-	closedir (pDirectory);
+	std::sort (m_Banks.begin (), m_Banks.end (),
+		   [] (const TBankEntry &rBank1, const TBankEntry &rBank2)
+		   {
+			return rBank1.nBankID < rBank2.nBankID;
+		   });
+	m_Banks.shrink_to_fit ();
+	m_FileNames.shrink_to_fit ();
+
+	m_nHeapUsed +=   m_Banks.capacity () * sizeof (TBankEntry)
+		       + m_FileNames.capacity ();
+
+	LOGNOTE ("%u banks %s in %u ms (%s), %u KB allocated for banks", m_nBanksLoaded,
+		 m_nCacheSize ? "found" : "loaded",
+		 (CTimer::GetClockTicks () - nStartTicks) / (CLOCKHZ / 1000),
+		 bFromIndex ? "from index" : "full scan",
+		 (unsigned) (m_nHeapUsed / 1024));
 }
 
 void CSysExFileLoader::LoadBank (const char * sDirName, const char * sBankName, bool bHeaderlessSysExVoices, unsigned nSubDirCount)
 {
 	unsigned nBank;
 	size_t nLen = strlen (sBankName);
+
+	if (sBankName[0] == '.')		// ".", ".." and hidden files (not on FAT)
+	{
+		return;
+	}
 	
 	if (   nLen < 5						// "[NNNN]N[_name].syx"
 		|| strcasecmp (&sBankName[nLen-4], ".syx") != 0
@@ -157,102 +251,473 @@ void CSysExFileLoader::LoadBank (const char * sDirName, const char * sBankName,
 		return;
 	}
 
-	if (m_pVoiceBank[nBankIdx])
+	if (IsValidBank (nBankIdx))
 	{
 		LOGWARN ("Bank #%u already loaded", nBank);
 
 		return;
 	}
 
-	m_pVoiceBank[nBankIdx] = new TVoiceBank;
-	assert (m_pVoiceBank[nBankIdx]);
-	assert (sizeof(TVoiceBank) == VoiceSysExHdrSize + VoiceSysExSize);
+	AddBank (nBankIdx, sDirName, sBankName, nullptr);
+}
+
+bool CSysExFileLoader::AddBank (unsigned nBankIdx, const char *pDirName, const char *pFileName,
+				const char (*pVoiceNames)[VoiceNameSize])
+{
+	assert (nBankIdx <= MaxVoiceBankID);
 
-	std::string Filename (sDirName);
+	std::string Filename (pDirName);
 	Filename += "/";
-	Filename += sBankName;
+	Filename += pFileName;
 
-	FILE *pFile = fopen (Filename.c_str (), "rb");
-	if (pFile)
+	TBankEntry Bank;
+	Bank.nBankID = nBankIdx;
+	Bank.pVoiceBank = nullptr;
+	Bank.pVoiceNames = nullptr;
+
+	const TVoiceBank *pVoiceBank = nullptr;
+	if (m_nCacheSize)
 	{
-		bool bBankLoaded = false;
-		if (   fread (m_pVoiceBank[nBankIdx], VoiceSysExHdrSize+VoiceSysExSize, 1, pFile) == 1
-			&& m_pVoiceBank[nBankIdx]->StatusStart == 0xF0
-			&& m_pVoiceBank[nBankIdx]->CompanyID   == 0x43
-			&& m_pVoiceBank[nBankIdx]->Format      == 0x09
-			&& m_pVoiceBank[nBankIdx]->StatusEnd   == 0xF7)
+		Bank.pVoiceNames = new TVoiceNames;
+		assert (Bank.pVoiceNames);
+
+		if (pVoiceNames)
 		{
-			if (m_nBanksLoaded % 100 == 0)
-			{
-				LOGDBG ("Banks successfully loaded #%u", m_nBanksLoaded);
-			}
-			//LOGDBG ("Bank #%u successfully loaded", nBank);
+			memcpy (Bank.pVoiceNames->Name, pVoiceNames, sizeof (TVoiceNames));
+		}
+		else if (!ReadVoiceNames (Filename.c_str (), Bank.pVoiceNames))
+		{
+			LOGWARN ("%s: Invalid size or format", Filename.c_str ());
+
+			delete Bank.pVoiceNames;
+
+			return false;
+		}
+
+		m_nHeapUsed += sizeof (TVoiceNames);
+	}
+	else
+	{
+		Bank.pVoiceBank = new TVoiceBank;
+		assert (Bank.pVoiceBank);
+		assert (sizeof(TVoiceBank) == VoiceSysExHdrSize + VoiceSysExSize);
+
+		if (!ReadBank (Filename.c_str (), Bank.pVoiceBank))
+		{
+			LOGWARN ("%s: Invalid size or format", Filename.c_str ());
+
+			delete Bank.pVoiceBank;
+
+			return false;
+		}
+
+		pVoiceBank = Bank.pVoiceBank;
+		m_nHeapUsed += sizeof (TVoiceBank);
+	}
+
+	if (m_nBanksLoaded % 100 == 0)
+	{
+		LOGDBG ("Banks successfully loaded #%u", m_nBanksLoaded);
+	}
+	//LOGDBG ("Bank #%u successfully loaded", nBank);
+
+	// the directory is needed to read the bank later
+	unsigned nDir = m_DirNames.size ();
+	while (nDir > 0 && m_DirNames[nDir-1] != pDirName)
+	{
+		nDir--;
+	}
+	if (nDir == 0)
+	{
+		m_DirNames.push_back (pDirName);
+		nDir = m_DirNames.size ();
+	}
+	Bank.nDir = nDir-1;
+
+	Bank.nFileName = m_FileNames.length ();
+	m_FileNames.append (pFileName, strlen (pFileName) + 1);
+
+	m_Banks.push_back (Bank);
+	m_BankValid[nBankIdx / 32] |= 1U << (nBankIdx % 32);
+
+	if (nBankIdx > m_nNumHighestBank)
+	{
+		// This is the bank ID of the highest loaded bank
+		m_nNumHighestBank = nBankIdx;
+	}
+	m_nBanksLoaded++;
+
+	if (m_pIndexBanks)
+	{
+		assert (pVoiceBank || Bank.pVoiceNames);
+		assert (strncmp (pDirName, m_DirName.c_str (), m_DirName.length ()) == 0);
+
+		CBankIndex::TBank IndexBank;
+		IndexBank.nBankID = nBankIdx;
+		IndexBank.DirName = pDirName + m_DirName.length ();
+		IndexBank.FileName = pFileName;
+		for (unsigned i = 0; i < VoicesPerBank; i++)
+		{
+			memcpy (IndexBank.VoiceName[i],
+				pVoiceBank ? (const char *) &pVoiceBank->Voice[i][SizePackedVoice - VoiceNameSize]
+					   : Bank.pVoiceNames->Name[i],
+				VoiceNameSize);
+		}
+
+		m_pIndexBanks->push_back (IndexBank);
+	}
+
+	return true;
+}
+
+bool CSysExFileLoader::ReadBank (const char *pFileName, TVoiceBank *pVoiceBank)
+{
+	assert (pVoiceBank);
+
+	FILE *pFile = fopen (pFileName, "rb");
+	if (!pFile)
+	{
+		return false;
+	}
+
+	bool bOK = fread (pVoiceBank, VoiceSysExHdrSize+VoiceSysExSize, 1, pFile) == 1;
+
+	bool bBankLoaded = false;
+	if (   bOK
+	    && pVoiceBank->StatusStart == 0xF0
+	    && pVoiceBank->CompanyID   == 0x43
+	    && pVoiceBank->Format      == 0x09
+	    && pVoiceBank->StatusEnd   == 0xF7)
+	{
+		bBankLoaded = true;
+	}
+	else if (m_bHeaderlessSysExVoices)
+	{
+		// Config says to accept headerless SysEx Voice Banks
+		// so reset file pointer and try again.
+		fseek (pFile, 0, SEEK_SET);
+		bOK = fread (pVoiceBank->Voice, VoiceSysExSize, 1, pFile) == 1;
+
+		if (bOK)
+		{
+			// Add in the missing header items.
+			// Naturally it isn't possible to validate these!
+			pVoiceBank->StatusStart = 0xF0;
+			pVoiceBank->CompanyID   = 0x43;
+			pVoiceBank->Format      = 0x09;
+			pVoiceBank->ByteCountMS = 0x20;
+			pVoiceBank->ByteCountLS = 0x00;
+			pVoiceBank->Checksum    = 0x00;
+			pVoiceBank->StatusEnd   = 0xF7;
 
-			m_BankFileName[nBankIdx] = sBankName;
-			if (nBankIdx > m_nNumHighestBank)
-			{
-				// This is the bank ID of the highest loaded bank
-				m_nNumHighestBank = nBankIdx;
-			}
-			m_nBanksLoaded++;
 			bBankLoaded = true;
 		}
-		else if (bHeaderlessSysExVoices)
+	}
+
+	fclose (pFile);
+
+	return bBankLoaded;
+}
+
+// Reads the voice names only, which is sufficient, if the banks are read on
+// demand. The file is accepted under the same conditions as in ReadBank().
+bool CSysExFileLoader::ReadVoiceNames (const char *pFileName, TVoiceNames *pVoiceNames)
+{
+	assert (pVoiceNames);
+
+	FILE *pFile = fopen (pFileName, "rb");
+	if (!pFile)
+	{
+		return false;
+	}
+
+	uint8_t Header[VoiceSysExHdrSize - 2];		// without Checksum and StatusEnd
+	long nVoicesOffset = -1;
+	if (   fread (Header, sizeof Header, 1, pFile) == 1
+	    && Header[0] == 0xF0			// StatusStart
+	    && Header[1] == 0x43			// CompanyID
+	    && Header[3] == 0x09			// Format
+	    && fseek (pFile, sizeof (TVoiceBank) - 1, SEEK_SET) == 0
+	    && fgetc (pFile) == 0xF7)			// StatusEnd
+	{
+		nVoicesOffset = sizeof Header;
+	}
+	else if (   m_bHeaderlessSysExVoices
+		 && fseek (pFile, VoiceSysExSize - 1, SEEK_SET) == 0
+		 && fgetc (pFile) != EOF)
+	{
+		nVoicesOffset = 0;
+	}
+
+	bool bOK = nVoicesOffset >= 0;
+	for (unsigned i = 0; bOK && i < VoicesPerBank; i++)
+	{
+		bOK =    fseek (pFile, nVoicesOffset + (i+1) * SizePackedVoice - VoiceNameSize, SEEK_SET) == 0
+		      && fread (pVoiceNames->Name[i], VoiceNameSize, 1, pFile) == 1;
+	}
+
+	fclose (pFile);
+
+	return bOK;
+}
+
+unsigned CSysExFileLoader::FindBank (unsigned nBankID) const
+{
+	if (!IsValidBank (nBankID))
+	{
+		return NoSlot;
+	}
+
+	auto Iterator = std::lower_bound (m_Banks.begin (), m_Banks.end (), nBankID,
+					  [] (const TBankEntry &rBank, unsigned nID)
+					  {
+						return rBank.nBankID < nID;
+					  });
+	assert (Iterator != m_Banks.end () && Iterator->nBankID == nBankID);
+
+	return Iterator - m_Banks.begin ();
+}
+
+const CSysExFileLoader::TVoiceBank *CSysExFileLoader::GetBank (unsigned nSlot, bool bMayRead)
+{
+	assert (nSlot < m_Banks.size ());
+	TBankEntry &rBank = m_Banks[nSlot];
+
+	if (!m_nCacheSize)
+	{
+		return rBank.pVoiceBank;
+	}
+
+	TCacheEntry *pEntry = nullptr;
+	if (rBank.pVoiceBank)
+	{
+		for (unsigned i = 0; i < m_nCacheSize; i++)
 		{
-			// Config says to accept headerless SysEx Voice Banks
-			// so reset file pointer and try again.
-			fseek (pFile, 0, SEEK_SET);
-			if (fread (m_pVoiceBank[nBankIdx]->Voice, VoiceSysExSize, 1, pFile) == 1)
+			if (m_pCache[i].nSlot == nSlot)
 			{
-				if (m_nBanksLoaded % 100 == 0)
-				{
-					LOGDBG ("Banks successfully loaded #%u", m_nBanksLoaded);
-				}
-				//LOGDBG ("Bank #%u successfully loaded (headerless)", nBank);
-
-				// Add in the missing header items.
-				// Naturally it isn't possible to validate these!
-				m_pVoiceBank[nBankIdx]->StatusStart = 0xF0;
-				m_pVoiceBank[nBankIdx]->CompanyID   = 0x43;
-				m_pVoiceBank[nBankIdx]->Format      = 0x09;
-				m_pVoiceBank[nBankIdx]->ByteCountMS = 0x20;
-				m_pVoiceBank[nBankIdx]->ByteCountLS = 0x00;
-				m_pVoiceBank[nBankIdx]->Checksum    = 0x00;
-				m_pVoiceBank[nBankIdx]->StatusEnd   = 0xF7;
-
-				m_BankFileName[nBankIdx] = sBankName;
-				if (nBankIdx > m_nNumHighestBank)
-				{
-					// This is the bank ID of the highest loaded bank
-					m_nNumHighestBank = nBankIdx;
-				}
-				bBankLoaded = true;
-				m_nBanksLoaded++;
+				m_pCache[i].nLastUsed = ++m_nUseCount;
+
+				break;
 			}
 		}
 
-		if (!bBankLoaded)
+		return rBank.pVoiceBank;
+	}
+
+	if (!bMayRead)
+	{
+		return nullptr;
+	}
+
+	m_nCacheMisses++;
+
+	// replace the least recently used entry, which is not being read
+	for (unsigned i = 0; i < m_nCacheSize; i++)
+	{
+		if (   !m_pCache[i].bReading
+		    && (   !pEntry
+			|| m_pCache[i].nLastUsed < pEntry->nLastUsed))
 		{
-			LOGWARN ("%s: Invalid size or format", Filename.c_str ());
+			pEntry = &m_pCache[i];
+		}
+	}
 
-			delete m_pVoiceBank[nBankIdx];
-			m_pVoiceBank[nBankIdx] = nullptr;
+	if (!pEntry)
+	{
+		return nullptr;
+	}
+
+	if (pEntry->nSlot != NoSlot)
+	{
+		m_Banks[pEntry->nSlot].pVoiceBank = nullptr;
+	}
+	pEntry->nSlot = NoSlot;
+	pEntry->bReading = true;
+
+	// do not disable interrupts while accessing the disk
+	m_SpinLock.Release ();
+
+	std::string Filename (m_DirNames[rBank.nDir]);
+	Filename += "/";
+	Filename += &m_FileNames[rBank.nFileName];
+
+	bool bOK = ReadBank (Filename.c_str (), &pEntry->Bank);
+	if (!bOK)
+	{
+		LOGWARN ("%s: Cannot read bank", Filename.c_str ());
+	}
+
+	m_SpinLock.Acquire ();
+
+	pEntry->bReading = false;
+	pEntry->nLastUsed = 0;
+
+	if (   bOK
+	    && !rBank.pVoiceBank)		// may have been read by another task meanwhile
+	{
+		pEntry->nSlot = nSlot;
+		pEntry->nLastUsed = ++m_nUseCount;
+		rBank.pVoiceBank = &pEntry->Bank;
+	}
+
+	return rBank.pVoiceBank;
+}
+
+const uint8_t *CSysExFileLoader::GetDecodedVoice (unsigned nSlot, unsigned nVoiceID)
+{
+	assert (nVoiceID < VoicesPerBank);
+
+	for (unsigned i = 0; i < DecodedBanks; i++)
+	{
+		if (   m_DecodedBank[i].nSlot == nSlot
+		    && (m_DecodedBank[i].nVoicesValid & (1U << nVoiceID)))
+		{
+			m_DecodedBank[i].nLastUsed = ++m_nUseCount;
+
+			return m_DecodedBank[i].Voice[nVoiceID];
+		}
+	}
+
+	return nullptr;
+}
+
+uint8_t *CSysExFileLoader::AllocDecodedVoice (unsigned nSlot, unsigned nVoiceID)
+{
+	assert (nVoiceID < VoicesPerBank);
+
+	// use the entry of this bank, or replace the least recently used one
+	TDecodedBank *pDecodedBank = &m_DecodedBank[0];
+	for (unsigned i = 0; i < DecodedBanks; i++)
+	{
+		if (m_DecodedBank[i].nSlot == nSlot)
+		{
+			pDecodedBank = &m_DecodedBank[i];
+
+			break;
 		}
 
-		fclose (pFile);
+		if (m_DecodedBank[i].nLastUsed < pDecodedBank->nLastUsed)
+		{
+			pDecodedBank = &m_DecodedBank[i];
+		}
 	}
-	else
+
+	if (pDecodedBank->nSlot != nSlot)
 	{
-		delete m_pVoiceBank[nBankIdx];
-		m_pVoiceBank[nBankIdx] = nullptr;
+		pDecodedBank->nSlot = nSlot;
+		pDecodedBank->nVoicesValid = 0;
+	}
+
+	pDecodedBank->nVoicesValid |= 1U << nVoiceID;
+	pDecodedBank->nLastUsed = ++m_nUseCount;
+
+	return pDecodedBank->Voice[nVoiceID];
+}
+
+bool CSysExFileLoader::IsVoiceCached (unsigned nBankID, unsigned nVoiceID)
+{
+	unsigned nSlot = FindBank (nBankID);
+	if (   !m_nCacheSize
+	    || nSlot == NoSlot
+	    || nVoiceID >= VoicesPerBank)
+	{
+		return true;
+	}
+
+	m_SpinLock.Acquire ();
+
+	bool bResult =    m_Banks[nSlot].pVoiceBank != nullptr
+		       || GetDecodedVoice (nSlot, nVoiceID) != nullptr;
+
+	m_SpinLock.Release ();
+
+	return bResult;
+}
+
+unsigned CSysExFileLoader::TakeCacheMisses (void)
+{
+	m_SpinLock.Acquire ();
+
+	unsigned nResult = m_nCacheMisses;
+	m_nCacheMisses = 0;
+
+	m_SpinLock.Release ();
+
+	return nResult;
+}
+
+bool CSysExFileLoader::PrefetchBank (unsigned nBankID)
+{
+	assert (CurrentExecutionLevel () == TASK_LEVEL);
+
+	unsigned nSlot = FindBank (nBankID);
+	if (nSlot == NoSlot)
+	{
+		return false;
+	}
+
+	bool bResult = false;
+	for (unsigned nVoiceID = 0; nVoiceID < VoicesPerBank; nVoiceID++)
+	{
+		// do not disable interrupts for longer than one voice
+		m_SpinLock.Acquire ();
+
+		if (!GetDecodedVoice (nSlot, nVoiceID))
+		{
+			const TVoiceBank *pVoiceBank = GetBank (nSlot, true);
+			if (!pVoiceBank)
+			{
+				m_SpinLock.Release ();
+
+				break;
+			}
+
+			DecodePackedVoice (pVoiceBank->Voice[nVoiceID], AllocDecodedVoice (nSlot, nVoiceID));
+
+			bResult = true;
+		}
+
+		m_SpinLock.Release ();
 	}
+
+	return bResult;
+}
+
+unsigned CSysExFileLoader::GetPrefetchLimit (void) const
+{
+	return m_nCacheSize && m_nCacheSize < DecodedBanks ? m_nCacheSize : DecodedBanks;
+}
+
+unsigned CSysExFileLoader::TakeDecodedVoiceHits (void)
+{
+	m_SpinLock.Acquire ();
+
+	unsigned nResult = m_nDecodedVoiceHits;
+	m_nDecodedVoiceHits = 0;
+
+	m_SpinLock.Release ();
+
+	return nResult;
+}
+
+unsigned CSysExFileLoader::TakeDecodedVoiceMisses (void)
+{
+	m_SpinLock.Acquire ();
+
+	unsigned nResult = m_nDecodedVoiceMisses;
+	m_nDecodedVoiceMisses = 0;
+
+	m_SpinLock.Release ();
+
+	return nResult;
 }
 
 std::string CSysExFileLoader::GetBankName (unsigned nBankID)
 {
-	if (nBankID <= MaxVoiceBankID)
+	unsigned nSlot = FindBank (nBankID);
+	if (nSlot != NoSlot)
 	{
-		std::string Result = m_BankFileName[nBankID];
+		std::string Result = &m_FileNames[m_Banks[nSlot].nFileName];
 
 		size_t nLen = Result.length ();
 		if (nLen > 4)
@@ -275,81 +740,94 @@ std::string CSysExFileLoader::GetBankName (unsigned nBankID)
 
 std::string CSysExFileLoader::GetVoiceName (unsigned nBankID, unsigned nVoiceID)
 {
-	if ((nBankID <= MaxVoiceBankID) && (nVoiceID < VoicesPerBank))
+	unsigned nSlot = FindBank (nBankID);
+	if ((nSlot != NoSlot) && (nVoiceID < VoicesPerBank))
 	{
-		if (IsValidBank(nBankID))
+		if (m_Banks[nSlot].pVoiceNames)
+		{
+			// known without reading the bank
+			char sVoiceName[11];
+			memcpy (sVoiceName, m_Banks[nSlot].pVoiceNames->Name[nVoiceID], 10);
+			sVoiceName[10] = 0;
+			std::string result(sVoiceName);
+			return result;
+		}
+
+		bool bMayRead = CurrentExecutionLevel () == TASK_LEVEL;
+
+		m_SpinLock.Acquire ();
+
+		const TVoiceBank *pVoiceBank = GetBank (nSlot, bMayRead);
+		if (pVoiceBank)
 		{
 			// The name is the last 10 characters of the voice data
 			char sVoiceName[11];
-			strncpy (sVoiceName, (char *)((char *)&(m_pVoiceBank[nBankID]->Voice[nVoiceID]) + SizePackedVoice - 10), 10);
+			strncpy (sVoiceName, (const char *)(pVoiceBank->Voice[nVoiceID] + SizePackedVoice - 10), 10);
 			sVoiceName[10] = 0;
+
+			m_SpinLock.Release ();
+
 			std::string result(sVoiceName);
 			return result;
 		}
+
+		m_SpinLock.Release ();
 	}
 	return "INIT VOICE";
 }
 
 unsigned CSysExFileLoader::GetNextBankUp (unsigned nBankID)
 {
-	// Find the next loaded bank "up" from the provided bank ID
-	for (unsigned id=nBankID+1; id <= m_nNumHighestBank; id++)
+	if (m_Banks.empty ())
 	{
-		if (IsValidBank(id))
-		{
-			return id;
-		}
+		return nBankID;
 	}
-	
+
+	// Find the next loaded bank "up" from the provided bank ID
+	auto Iterator = std::upper_bound (m_Banks.begin (), m_Banks.end (), nBankID,
+					  [] (unsigned nID, const TBankEntry &rBank)
+					  {
+						return nID < rBank.nBankID;
+					  });
+
 	// Handle wrap-around
-	for (unsigned id=0; id<nBankID; id++)
+	if (Iterator == m_Banks.end ())
 	{
-		if (IsValidBank(id))
-		{
-			return id;
-		}
+		Iterator = m_Banks.begin ();
 	}
-	
-	// If we get here there are no other banks!
-	return nBankID;
+
+	return Iterator->nBankID;
 }
 
 unsigned CSysExFileLoader::GetNextBankDown (unsigned nBankID)
 {
-	// Find the next loaded bank "down" from the provided bank ID
-	for (int id=((int)nBankID)-1; id >= 0; id--)
+	if (m_Banks.empty ())
 	{
-		if (IsValidBank((unsigned)id))
-		{
-			return id;
-		}
+		return nBankID;
 	}
 
+	// Find the next loaded bank "down" from the provided bank ID
+	auto Iterator = std::lower_bound (m_Banks.begin (), m_Banks.end (), nBankID,
+					  [] (const TBankEntry &rBank, unsigned nID)
+					  {
+						return rBank.nBankID < nID;
+					  });
+
 	// Handle wrap-around
-	for (unsigned id=m_nNumHighestBank; id>nBankID; id--)
+	if (Iterator == m_Banks.begin ())
 	{
-		if (IsValidBank(id))
-		{
-			return id;
-		}
+		Iterator = m_Banks.end ();
 	}
-	
-	// If we get here there are no other banks!
-	return nBankID;
+
+	return (Iterator-1)->nBankID;
 }
 
-bool CSysExFileLoader::IsValidBank (unsigned nBankID)
+bool CSysExFileLoader::IsValidBank (unsigned nBankID) const
 {
-	if (m_pVoiceBank[nBankID])
-	{
-		// Use a valid "status start/end" as an indicator of a valid loaded bank
-		if ((m_pVoiceBank[nBankID]->StatusStart == 0xF0) &&
-			(m_pVoiceBank[nBankID]->StatusEnd == 0xF7))
-		{
-			return true;
-		}
-	}
-	return false;
+	// Only banks with a valid "status start/end" are registered,
+	// regardless if the bank is currently in memory
+	return    nBankID <= MaxVoiceBankID
+	       && (m_BankValid[nBankID / 32] & (1U << (nBankID % 32)));
 }
 
 unsigned CSysExFileLoader::GetNumHighestBank (void)
@@ -360,13 +838,46 @@ unsigned CSysExFileLoader::GetNumHighestBank (void)
 void CSysExFileLoader::GetVoice (unsigned nBankID, unsigned nVoiceID, uint8_t *pVoiceData)
 {
 	if (   nBankID <= MaxVoiceBankID
-	    && nVoiceID <= VoicesPerBank)
+	    && nVoiceID < VoicesPerBank)
 	{
-		if (IsValidBank(nBankID))
+		unsigned nSlot = FindBank (nBankID);
+		if (nSlot != NoSlot)
 		{
-			DecodePackedVoice (m_pVoiceBank[nBankID]->Voice[nVoiceID], pVoiceData);
+			bool bMayRead = CurrentExecutionLevel () == TASK_LEVEL;
 
-			return;
+			m_SpinLock.Acquire ();
+
+			const uint8_t *pDecodedVoice = GetDecodedVoice (nSlot, nVoiceID);
+			if (pDecodedVoice)
+			{
+				m_nDecodedVoiceHits++;
+			}
+			else
+			{
+				m_nDecodedVoiceMisses++;
+
+				const TVoiceBank *pVoiceBank = GetBank (nSlot, bMayRead);
+				if (pVoiceBank)
+				{
+					uint8_t *pVoice = AllocDecodedVoice (nSlot, nVoiceID);
+					DecodePackedVoice (pVoiceBank->Voice[nVoiceID], pVoice);
+
+					pDecodedVoice = pVoice;
+				}
+			}
+
+			if (pDecodedVoice)
+			{
+				memcpy (pVoiceData, pDecodedVoice, SizeSingleVoice);
+
+				m_SpinLock.Release ();
+
+				return;
+			}
+
+			m_SpinLock.Release ();
+
+			LOGWARN ("Bank #%u is not in memory", nBankID+1);
 		}
 		else
 		{
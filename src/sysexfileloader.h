@@ -24,7 +24,10 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include <circle/macros.h>
+#include <circle/spinlock.h>
+#include "bankindex.h"
 
 class CSysExFileLoader		// Loader for DX7 .syx files
 {
@@ -36,6 +39,7 @@ public:
 	static const unsigned VoiceSysExHdrSize = 8; // Additional (optional) Header/Footer bytes for bank of 32 voices
 	static const unsigned VoiceSysExSize = 4096; // Bank of 32 voices as per DX7 MIDI Spec
 	static const unsigned MaxSubDirs = 3; // Number of nested subdirectories supported.
+	static const unsigned VoiceNameSize = 10;
 
 	struct TVoiceBank
 	{
@@ -57,12 +61,14 @@ public:
 	CSysExFileLoader (const char *pDirName = "/sysex");
 	~CSysExFileLoader (void);
 
-	void Load (bool bHeaderlessSysExVoices = false);
+	// nCacheSize = 0 loads all banks into memory. Otherwise only the file names
+	// are collected and up to nCacheSize banks are read on demand (LRU cache).
+	void Load (bool bHeaderlessSysExVoices = false, unsigned nCacheSize = 0);
 
 	std::string GetBankName (unsigned nBankID);	// 0 .. MaxVoiceBankID
 	std::string GetVoiceName (unsigned nBankID, unsigned nVoice); // 0 .. MaxVoiceBankID, 0 .. VoicesPerBank-1
 	unsigned GetNumHighestBank (); // 0 .. MaxVoiceBankID
-	bool     IsValidBank (unsigned nBankID);
+	bool     IsValidBank (unsigned nBankID) const;
 	unsigned GetNextBankUp (unsigned nBankID);
 	unsigned GetNextBankDown (unsigned nBankID);
 
@@ -70,17 +76,107 @@ public:
 		       unsigned nVoiceID,		// 0 .. 31
 		       uint8_t *pVoiceData);		// returns unpacked format (156 bytes)
 
+	// Banks can only be read from disk at TASK_LEVEL. Returns true, if the
+	// voice is available without disk access.
+	bool IsVoiceCached (unsigned nBankID, unsigned nVoiceID);
+
+	// Reads the bank, if needed, and decodes all its voices (TASK_LEVEL only).
+	// Returns false, if there was nothing to do.
+	bool PrefetchBank (unsigned nBankID);
+
+	// number of banks, which can be held in memory at once
+	unsigned GetPrefetchLimit (void) const;
+
+	// statistics of the bank cache, reset on read
+	unsigned TakeCacheMisses (void);
+	unsigned TakeDecodedVoiceHits (void);
+	unsigned TakeDecodedVoiceMisses (void);
+
 private:
 	static void DecodePackedVoice (const uint8_t *pPackedData, uint8_t *pDecodedData);
 
+	// pVoiceNames is nullptr, if the bank has to be read to get the voice names
+	bool AddBank (unsigned nBankIdx, const char *pDirName, const char *pFileName,
+		      const char (*pVoiceNames)[VoiceNameSize]);
+
+	bool ReadBank (const char *pFileName, TVoiceBank *pVoiceBank);
+	struct TVoiceNames;			// see below
+	bool ReadVoiceNames (const char *pFileName, TVoiceNames *pVoiceNames);
+
+	// returns the index into m_Banks, or NoSlot
+	unsigned FindBank (unsigned nBankID) const;
+
+	// m_SpinLock must be held, may release it temporarily to read the bank
+	const TVoiceBank *GetBank (unsigned nSlot, bool bMayRead);
+
+	// m_SpinLock must be held, return nullptr if the voice is not decoded
+	const uint8_t *GetDecodedVoice (unsigned nSlot, unsigned nVoiceID);
+	uint8_t *AllocDecodedVoice (unsigned nSlot, unsigned nVoiceID);
+
 private:
 	std::string m_DirName;
+	std::string m_IndexFileName;
 	
 	unsigned m_nNumHighestBank;
 	unsigned m_nBanksLoaded;
+	bool m_bHeaderlessSysExVoices;
+
+	struct TVoiceNames
+	{
+		char	Name[VoicesPerBank][VoiceNameSize];
+	};
+
+	// Only the valid banks are stored, sorted by bank ID when Load() has
+	// completed. The slots do not change afterwards.
+	struct TBankEntry
+	{
+		uint16_t	nBankID;
+		uint16_t	nDir;			// index into m_DirNames
+		uint32_t	nFileName;		// offset into m_FileNames
+		TVoiceBank	*pVoiceBank;		// nullptr if not in memory
+		TVoiceNames	*pVoiceNames;		// if banks are read on demand
+	};
+
+	std::vector<TBankEntry> m_Banks;
+	std::string m_FileNames;			// null-terminated, back to back
+	std::vector<std::string> m_DirNames;
+	uint32_t m_BankValid[(MaxVoiceBankID+1) / 32];	// bit map
+
+	struct TCacheEntry
+	{
+		TVoiceBank	Bank;
+		unsigned	nSlot;			// NoSlot if free or being read
+		bool		bReading;
+		unsigned	nLastUsed;
+	};
+
+	static const unsigned NoSlot = (unsigned) -1;
+
+	unsigned m_nCacheSize;				// 0 if all banks are loaded
+	TCacheEntry *m_pCache;
+	unsigned m_nUseCount;
+	unsigned m_nCacheMisses;
+	// Decoded (unpacked) voices of the recently used banks, so that program
+	// changes do not need to decode the voice again. Voices are decoded on
+	// first use.
+	struct TDecodedBank
+	{
+		unsigned	nSlot;			// NoSlot if unused
+		unsigned	nLastUsed;
+		uint32_t	nVoicesValid;		// bit mask
+		uint8_t		Voice[VoicesPerBank][SizeSingleVoice];
+	};
+
+	static const unsigned DecodedBanks = 4;		// current bank and neighbours
+	TDecodedBank m_DecodedBank[DecodedBanks];
+	unsigned m_nDecodedVoiceHits;
+	unsigned m_nDecodedVoiceMisses;
+
+	CSpinLock m_SpinLock;
+
+	std::vector<CBankIndex::TBank> *m_pIndexBanks;	// collected during full scan
 
-	TVoiceBank *m_pVoiceBank[MaxVoiceBankID+1];
-	std::string m_BankFileName[MaxVoiceBankID+1];
+	size_t m_nHeapUsed;				// bytes allocated for banks
 
 	static uint8_t s_DefaultVoice[SizeSingleVoice];
 	
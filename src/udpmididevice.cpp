@@ -22,6 +22,7 @@
 //
 
 #include <circle/logger.h>
+#include <circle/timer.h>
 #include <cstring>
 #include "udpmididevice.h"
 #include <assert.h>
@@ -80,7 +81,7 @@ boolean CUDPMIDIDevice::Initialize (void)
 
 void CUDPMIDIDevice::OnAppleMIDIDataReceived(const u8* pData, size_t nSize)
 {
-	MIDIMessageHandler(pData, nSize, VIRTUALCABLE);
+	MIDIMessageHandler(pData, nSize, VIRTUALCABLE, CTimer::GetClockTicks ());
 }
 
 void CUDPMIDIDevice::OnAppleMIDIConnect(const CIPAddress* pIPAddress, const char* pName)
@@ -95,10 +96,27 @@ void CUDPMIDIDevice::OnAppleMIDIDisconnect(const CIPAddress* pIPAddress, const c
 
 void CUDPMIDIDevice::OnUDPMIDIDataReceived(const u8* pData, size_t nSize)
 {
-	MIDIMessageHandler(pData, nSize, VIRTUALCABLE);
+	MIDIMessageHandler(pData, nSize, VIRTUALCABLE, CTimer::GetClockTicks ());
 }
 
 void CUDPMIDIDevice::Send(const u8 *pMessage, size_t nLength, unsigned nCable)
+{
+	m_SendQueue.Put (pMessage, nLength, nCable);
+}
+
+// Sends the queued messages from task context
+void CUDPMIDIDevice::Process (void)
+{
+	const u8 *pMessage;
+	size_t nLength;
+	unsigned nCable;
+	while ((pMessage = m_SendQueue.Get (&nLength, &nCable)) != nullptr)
+	{
+		SendMessage (pMessage, nLength);
+	}
+}
+
+void CUDPMIDIDevice::SendMessage(const u8 *pMessage, size_t nLength)
 {
     bool sentRTP = false;
     if (m_pAppleMIDIParticipant && m_pAppleMIDIParticipant->SendMIDIToHost(pMessage, nLength)) {
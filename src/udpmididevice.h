@@ -26,6 +26,7 @@
 #define _udpmididevice_h
 
 #include "mididevice.h"
+#include "midisendqueue.h"
 #include "config.h"
 #include "net/applemidi.h"
 #include "net/udpmidi.h"
@@ -40,23 +41,31 @@ public:
 	~CUDPMIDIDevice (void);
 
 	boolean Initialize (void);
+
+	void Process (void);
 	virtual void OnAppleMIDIDataReceived(const u8* pData, size_t nSize) override;
 	virtual void OnAppleMIDIConnect(const CIPAddress* pIPAddress, const char* pName) override;
 	virtual void OnAppleMIDIDisconnect(const CIPAddress* pIPAddress, const char* pName) override;
 	virtual void OnUDPMIDIDataReceived(const u8* pData, size_t nSize) override;
 	virtual void Send(const u8 *pMessage, size_t nLength, unsigned nCable = 0) override;
 
+	CMIDISendQueue *GetSendQueue (void)	{ return &m_SendQueue; }
+
+private:
+	void SendMessage(const u8 *pMessage, size_t nLength);
+
 private:
 	CMiniDexed *m_pSynthesizer;
 	CConfig *m_pConfig;
 	CBcmRandomNumberGenerator m_Random;
-	CAppleMIDIParticipant* m_pAppleMIDIParticipant; // AppleMIDI participant instance
-	CUDPMIDIReceiver* m_pUDPMIDIReceiver;
+	CAppleMIDIParticipant* m_pAppleMIDIParticipant = nullptr; // AppleMIDI participant instance
+	CUDPMIDIReceiver* m_pUDPMIDIReceiver = nullptr;
 	CSocket* m_pUDPSendSocket = nullptr;
 	CIPAddress m_UDPDestAddress;
 	unsigned m_UDPDestPort = 1999;
 	CIPAddress m_LastUDPSenderAddress;
 	unsigned m_LastUDPSenderPort = 0;
+	CMIDISendQueue m_SendQueue;
 };
 
 #endif
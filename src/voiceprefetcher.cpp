@@ -0,0 +1,125 @@
+//
+// voiceprefetcher.cpp
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include "voiceprefetcher.h"
+#include <circle/sched/scheduler.h>
+#include <circle/logger.h>
+#include <assert.h>
+
+LOGMODULE ("prefetch");
+
+CVoicePrefetcher::CVoicePrefetcher (CSysExFileLoader *pSysExFileLoader, unsigned nDepth)
+:	m_pSysExFileLoader (pSysExFileLoader),
+	m_nDepth (nDepth),
+	m_bBehind (true),
+	m_nBankID (0),
+	m_nDirection (1),
+	m_nPrefetchedBanks (0)
+{
+	assert (m_pSysExFileLoader);
+
+	// the current bank and one behind must fit too
+	unsigned nLimit = m_pSysExFileLoader->GetPrefetchLimit ();
+	if (m_nDepth + 2 > nLimit)
+	{
+		m_nDepth = nLimit > 2 ? nLimit - 2 : 0;
+		m_bBehind = nLimit >= 2;
+
+		LOGWARN ("Prefetch depth limited to %u", m_nDepth);
+	}
+
+	SetName ("prefetch");
+}
+
+CVoicePrefetcher::~CVoicePrefetcher (void)
+{
+	m_pSysExFileLoader = nullptr;
+}
+
+void CVoicePrefetcher::BankSelected (unsigned nBankID)
+{
+	if (nBankID == m_nBankID)
+	{
+		return;
+	}
+
+	m_nDirection = nBankID > m_nBankID ? 1 : -1;
+	m_nBankID = nBankID;
+
+	m_Event.Set ();
+}
+
+void CVoicePrefetcher::Run (void)
+{
+	while (1)
+	{
+		m_Event.Wait ();
+		m_Event.Clear ();
+
+		unsigned nBankID = m_nBankID;
+		int nDirection = m_nDirection;
+
+		// the voices of the current bank are probably used next
+		Prefetch (nBankID);
+
+		unsigned nNextBankID = nBankID;
+		for (unsigned i = 0; i < m_nDepth; i++)
+		{
+			CScheduler::Get ()->Yield ();
+			if (nBankID != m_nBankID)	// start over with the new bank
+			{
+				break;
+			}
+
+			nNextBankID =   nDirection > 0
+				      ? m_pSysExFileLoader->GetNextBankUp (nNextBankID)
+				      : m_pSysExFileLoader->GetNextBankDown (nNextBankID);
+			Prefetch (nNextBankID);
+		}
+
+		if (!m_bBehind)
+		{
+			continue;
+		}
+
+		CScheduler::Get ()->Yield ();
+		if (nBankID == m_nBankID)
+		{
+			Prefetch (  nDirection > 0
+				  ? m_pSysExFileLoader->GetNextBankDown (nBankID)
+				  : m_pSysExFileLoader->GetNextBankUp (nBankID));
+		}
+	}
+}
+
+void CVoicePrefetcher::Prefetch (unsigned nBankID)
+{
+	if (m_pSysExFileLoader->PrefetchBank (nBankID))
+	{
+		m_nPrefetchedBanks++;
+	}
+}
+
+unsigned CVoicePrefetcher::TakePrefetchedBanks (void)
+{
+	unsigned nResult = m_nPrefetchedBanks;
+	m_nPrefetchedBanks = 0;
+
+	return nResult;
+}
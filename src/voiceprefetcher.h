@@ -0,0 +1,64 @@
+//
+// voiceprefetcher.h
+//
+// See: https://github.com/asb2m10/dexed/blob/master/Documentation/sysex-format.txt
+//
+// MiniDexed - Dexed FM synthesizer for bare metal Raspberry Pi
+// Copyright (C) 2022  The MiniDexed Team
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+#ifndef _voiceprefetcher_h
+#define _voiceprefetcher_h
+
+#include "sysexfileloader.h"
+#include <circle/sched/task.h>
+#include <circle/sched/synchronizationevent.h>
+
+// Low priority task, which reads and decodes the voice banks next to the
+// selected one in advance, so that stepping through the banks does not wait
+// for the SD card or for decoding. It follows the direction, in which the
+// player navigates, and prefetches up to nDepth banks ahead and one bank
+// behind, as far as the loader can hold them without evicting the current
+// bank. The task yields after each bank.
+
+class CVoicePrefetcher : public CTask
+{
+public:
+	CVoicePrefetcher (CSysExFileLoader *pSysExFileLoader, unsigned nDepth);
+	~CVoicePrefetcher (void);
+
+	// may be called from interrupt context
+	void BankSelected (unsigned nBankID);
+
+	void Run (void) override;
+
+	// statistics, reset on read
+	unsigned TakePrefetchedBanks (void);
+
+private:
+	void Prefetch (unsigned nBankID);
+
+private:
+	CSysExFileLoader *m_pSysExFileLoader;
+	unsigned m_nDepth;
+	bool m_bBehind;				// prefetch one bank against the direction
+
+	CSynchronizationEvent m_Event;
+
+	volatile unsigned m_nBankID;
+	volatile int m_nDirection;			// 1 (up) or -1 (down)
+
+	unsigned m_nPrefetchedBanks;
+};
+
+#endif